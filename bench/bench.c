@@ -0,0 +1,1211 @@
+#include "../include/game.h"
+#include "../include/state.h"
+#include "../include/map.h"
+#include "../include/enemy.h"
+#include "../include/collide.h"
+#include "../include/rng.h"
+#include "../include/player.h"
+#include "../include/projectile.h"
+#include "../include/renderer3d.h"
+#include "../include/jobs.h"
+#include "../include/input.h"
+#include "../include/rollback.h"
+#include "../include/timer.h"
+#include "../include/mem.h"
+#include "../include/netproto.h"
+#include "raylib.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define BENCH_WINDOW_WIDTH 800
+#define BENCH_WINDOW_HEIGHT 600
+#define BENCH_TICK_DELTA (1.0f / 60.0f)
+#define BENCH_PROJECTILE_TICKS ((int)ceilf(PROJECTILE_LIFETIME / BENCH_TICK_DELTA))  // Ticks a projectile lives
+#define BENCH_TURN_TICKS ((int)ceilf(ENEMY_DIRECTION_CHANGE_TIME / BENCH_TICK_DELTA))  // Ticks between enemy turns
+#define BENCH_DEFAULT_FRAMES 600
+#define BENCH_WARMUP_FRAMES 30
+#define BENCH_DEFAULT_SEED 12345
+#define BENCH_DEFAULT_TOLERANCE 0.25
+#define BENCH_SLACK_MS 0.05            // Absolute allowance so microsecond phases don't flap
+#define BENCH_DEFAULT_BASELINE "bench/baseline.json"
+#define BENCH_DEFAULT_OUTPUT "bench_results.json"
+#define BENCH_MAX_RESULTS 32
+#define BENCH_NAME_LENGTH 64
+#define BENCH_HOP_INTERVAL 30          // Frames spent in each map while hopping
+#define BENCH_SPIN_FRAMES_PER_TURN 240 // Frames for one full camera rotation
+#define BENCH_BULLETS_PER_FRAME 64     // Shots per frame in the bullet-heavy scenario
+#define BENCH_PLAYER_RADIUS 25.0f
+#define BENCH_ROLLBACK_TICKS 8         // Ticks rewound and simulated again per rollback sample
+#define BENCH_ROLLBACK_CAPACITY 16     // Ticks held by the rollback ring
+#define BENCH_FRAME_BUDGET_MS 16.0     // One frame at 60 Hz
+#define BENCH_ENEMY_COUNT 4096         // Enemies moved per sample by the batched update
+#define BENCH_RECT_COUNT 256           // Walls in the collision kernel phases
+#define BENCH_STRESS_OBSTACLES 5       // Obstacles per map in the stress scenario
+#define BENCH_ROOM_BANDS 10            // Rows of wall posts in the big room
+#define BENCH_ROOM_POSTS 1000          // Posts per row
+#define BENCH_ROOM_ENEMIES 1000        // Enemies roaming the corridors between the rows
+#define BENCH_ROOM_COINS 10
+#define BENCH_SWARM_ENEMIES 500        // Enemies in the open room of the swarm scenario
+#define BENCH_SWARM_PROJECTILES 1000   // Projectiles kept in flight among them
+#define BENCH_CIRCLE_COUNT 1024        // Circles tested against all of them per sample
+#define BENCH_RECT_SIZE 4.0f
+#define BENCH_CIRCLE_RADIUS 5.0f
+#define BENCH_NET_COINS 40            // Coins in the network phase's room, so the first collected-coin word is full
+
+/**
+ * Scripted per-frame driver for a scenario. Runs before the simulation
+ * tick and plays the part of the player's input.
+ * @param state The game state
+ * @param frame Frame index within the phase, counting warmup
+ */
+typedef void (*BenchScript)(GameState* state, int frame);
+
+typedef struct {
+    const char* name;
+    GameMode mode;
+    int map_id;
+    BenchScript setup;  // Called once after the phase's game state is created
+    BenchScript step;   // Called every frame before the tick
+} BenchScenario;
+
+typedef struct {
+    char name[BENCH_NAME_LENGTH];  // "<mode>/<scenario>", e.g. "sim/barrage_2d"
+    int frames;
+    double p50_ms;
+    double p95_ms;
+    double p99_ms;
+    double max_ms;
+    double mean_ms;
+    double frame_budget_ms;  // p99 must stay under this regardless of the baseline (0 = none)
+} BenchResult;
+
+typedef struct {
+    bool sim_only;
+    int frames;
+    int threads;
+    unsigned int seed;
+    double tolerance;
+    const char* baseline_path;
+    const char* output_path;
+    bool write_baseline;
+} BenchOptions;
+
+/**
+ * Put the session into gameplay on a given map, with the player at a free
+ * spot near the middle of the screen.
+ * @param state The game state
+ * @param mode 2D or 3D
+ * @param map_id Map to start in
+ */
+static void bench_enter_gameplay(GameState* state, GameMode mode, int map_id) {
+    state_set_type(state, GAME_STATE_PLAYING);
+    state_set_game_mode(state, mode);
+    state_set_current_map_id(state, map_id);
+    
+    Map* map = state_get_current_map(state);
+    Player* player = state_get_player(state);
+    Vector2 spawn = map_find_valid_spawn_position((Vector2){WORLD_WIDTH / 2.0f, WORLD_HEIGHT / 2.0f},
+                                                  BENCH_PLAYER_RADIUS, map);
+    player_set_position(player, spawn);
+    player_sync_previous_position(player);
+    map_sync_previous_positions(map);
+}
+
+/**
+ * Keep the scripted session in gameplay: full health, and no detours into
+ * the end or name entry screens.
+ * @param state The game state
+ */
+static void bench_keep_playing(GameState* state) {
+    Player* player = state_get_player(state);
+    player_set_health(player, player_get_max_health(player));
+    if (state_get_type(state) != GAME_STATE_PLAYING) {
+        state_set_type(state, GAME_STATE_PLAYING);
+    }
+}
+
+/**
+ * Fire one projectile from the player in a direction that sweeps a full
+ * circle every 60 frames.
+ * @param state The game state
+ * @param frame Frame index
+ */
+static void bench_fire_projectile(GameState* state, int frame) {
+    float angle = (float)frame * (2.0f * PI / 60.0f);
+    Vector2 origin = player_get_position(state_get_player(state));
+    state_spawn_projectile(state, origin, (Vector2){cosf(angle), sinf(angle)});
+}
+
+static void bench_setup_barrage(GameState* state, int frame) {
+    (void)frame;
+    bench_enter_gameplay(state, GAME_MODE_2D, 0);
+}
+
+static void bench_step_barrage(GameState* state, int frame) {
+    bench_keep_playing(state);
+    bench_fire_projectile(state, frame);
+}
+
+static void bench_step_bullets(GameState* state, int frame) {
+    bench_keep_playing(state);
+    
+    // A ring of shots every frame keeps a few thousand projectiles in flight
+    Vector2 origin = player_get_position(state_get_player(state));
+    for (int i = 0; i < BENCH_BULLETS_PER_FRAME; i++) {
+        float angle = (float)(frame * 7 + i * 360 / BENCH_BULLETS_PER_FRAME) * DEG2RAD;
+        state_spawn_projectile(state, origin, (Vector2){cosf(angle), sinf(angle)});
+    }
+}
+
+static void bench_setup_spin(GameState* state, int frame) {
+    (void)frame;
+    player_set_angle(state_get_player(state), 0.0f);
+}
+
+static void bench_step_spin(GameState* state, int frame) {
+    bench_keep_playing(state);
+    player_set_angle(state_get_player(state), (float)frame * (2.0f * PI / BENCH_SPIN_FRAMES_PER_TURN));
+}
+
+static void bench_setup_map_hop(GameState* state, int frame) {
+    (void)frame;
+    bench_enter_gameplay(state, GAME_MODE_2D, 0);
+}
+
+static void bench_step_map_hop(GameState* state, int frame) {
+    bench_keep_playing(state);
+    if (frame > 0 && frame % BENCH_HOP_INTERVAL == 0) {
+        int next_map = (state_get_current_map_id(state) + 1) % NUM_MAPS;
+        bench_enter_gameplay(state, GAME_MODE_2D, next_map);
+    }
+}
+
+static void bench_setup_stress(GameState* state, int frame) {
+    (void)frame;
+    
+    // Fill every map up to the obstacle count the game started with
+    Map* maps = state_get_maps(state);
+    Rng* rng = state_get_rng(state);
+    for (int m = 0; m < NUM_MAPS; m++) {
+        while (maps[m].obstacles.count < BENCH_STRESS_OBSTACLES) {
+            Vector2 desired = {(float)rng_range(rng, 50, WORLD_WIDTH - 50), (float)rng_range(rng, 50, WORLD_HEIGHT - 50)};
+            Vector2 position = map_find_valid_spawn_position(desired, OBSTACLE_RADIUS, &maps[m]);
+            float angle = (float)rng_range(rng, 0, 360) * DEG2RAD;
+            if (!map_add_obstacle(&maps[m], position, (Vector2){cosf(angle) * 2.0f, sinf(angle) * 2.0f}, MAROON)) {
+                break;
+            }
+        }
+    }
+    
+    bench_enter_gameplay(state, GAME_MODE_3D, 0);
+}
+
+static void bench_step_stress(GameState* state, int frame) {
+    bench_keep_playing(state);
+    bench_fire_projectile(state, frame);
+    player_set_angle(state_get_player(state), (float)frame * (2.0f * PI / BENCH_SPIN_FRAMES_PER_TURN));
+}
+
+static void bench_setup_big_room(GameState* state, int frame) {
+    (void)frame;
+    
+    // Rebuild map 0 as rows of thin posts, 60 units apart, with enemies and
+    // coins in the corridors between them
+    Map* map = state_get_current_map(state);
+    Rng* rng = state_get_rng(state);
+    map_clear(map);
+    float post_spacing = (float)WORLD_WIDTH / BENCH_ROOM_POSTS;
+    for (int band = 0; band < BENCH_ROOM_BANDS; band++) {
+        float y = 30.0f + band * 60.0f;
+        for (int post = 0; post < BENCH_ROOM_POSTS; post++) {
+            map_add_wall(map, (Rectangle){post * post_spacing, y, post_spacing * 0.75f, 4.0f});
+        }
+    }
+    map_build_wall_grid(map);
+    for (int i = 0; i < BENCH_ROOM_ENEMIES; i++) {
+        int corridor = i % (BENCH_ROOM_BANDS - 1);
+        Vector2 position = {(float)rng_range(rng, 30, WORLD_WIDTH - 30), 64.0f + corridor * 60.0f};
+        float angle = (float)rng_range(rng, 0, 360) * DEG2RAD;
+        map_add_obstacle(map, position, (Vector2){cosf(angle) * 2.0f, sinf(angle) * 2.0f}, MAROON);
+    }
+    for (int i = 0; i < BENCH_ROOM_COINS; i++) {
+        map_add_coin(map, (Vector2){40.0f + i * 80.0f, 64.0f});
+    }
+    
+    bench_enter_gameplay(state, GAME_MODE_2D, 0);
+}
+
+static void bench_step_big_room(GameState* state, int frame) {
+    (void)frame;
+    bench_keep_playing(state);
+}
+
+static void bench_setup_swarm(GameState* state, int frame) {
+    (void)frame;
+    
+    // Empty map 0 and scatter enemies across it
+    Map* map = state_get_current_map(state);
+    Rng* rng = state_get_rng(state);
+    map_clear(map);
+    map_build_wall_grid(map);
+    for (int i = 0; i < BENCH_SWARM_ENEMIES; i++) {
+        Vector2 position = {(float)rng_range(rng, 20, WORLD_WIDTH - 20), (float)rng_range(rng, 20, WORLD_HEIGHT - 20)};
+        float angle = (float)rng_range(rng, 0, 360) * DEG2RAD;
+        map_add_obstacle(map, position, (Vector2){cosf(angle) * 2.0f, sinf(angle) * 2.0f}, MAROON);
+    }
+    
+    bench_enter_gameplay(state, GAME_MODE_2D, 0);
+}
+
+static void bench_step_swarm(GameState* state, int frame) {
+    (void)frame;
+    bench_keep_playing(state);
+    
+    // Replace the shots that hit something, from random spots in random directions
+    Rng* rng = state_get_rng(state);
+    ProjectilePool* projectiles = state_get_projectiles(state);
+    while (projectiles->count < BENCH_SWARM_PROJECTILES) {
+        Vector2 origin = {(float)rng_range(rng, 0, WORLD_WIDTH), (float)rng_range(rng, 0, WORLD_HEIGHT)};
+        float angle = (float)rng_range(rng, 0, 360) * DEG2RAD;
+        ProjectileHandle shot = state_spawn_projectile(state, origin, (Vector2){cosf(angle), sinf(angle)});
+        if (shot.value == PROJECTILE_HANDLE_NONE.value) break;
+    }
+}
+
+static const BenchScenario BENCH_SCENARIOS[] = {
+    {"barrage_2d", GAME_MODE_2D, 0, bench_setup_barrage, bench_step_barrage},
+    {"bullets_2d", GAME_MODE_2D, 0, bench_setup_barrage, bench_step_bullets},
+    {"spin_3d_map0", GAME_MODE_3D, 0, bench_setup_spin, bench_step_spin},
+    {"spin_3d_map1", GAME_MODE_3D, 1, bench_setup_spin, bench_step_spin},
+    {"spin_3d_map2", GAME_MODE_3D, 2, bench_setup_spin, bench_step_spin},
+    {"spin_3d_map3", GAME_MODE_3D, 3, bench_setup_spin, bench_step_spin},
+    {"map_hop", GAME_MODE_2D, 0, bench_setup_map_hop, bench_step_map_hop},
+    {"stress", GAME_MODE_3D, 0, bench_setup_stress, bench_step_stress},
+    {"big_room", GAME_MODE_2D, 0, bench_setup_big_room, bench_step_big_room},
+    {"swarm_2d", GAME_MODE_2D, 0, bench_setup_swarm, bench_step_swarm}
+};
+
+#define BENCH_SCENARIO_COUNT ((int)(sizeof(BENCH_SCENARIOS) / sizeof(BENCH_SCENARIOS[0])))
+
+/**
+ * qsort comparator for frame times.
+ */
+static int bench_compare_u64(const void* a, const void* b) {
+    uint64_t x = *(const uint64_t*)a;
+    uint64_t y = *(const uint64_t*)b;
+    return (x > y) - (x < y);
+}
+
+/**
+ * Nearest-rank percentile of a sorted sample.
+ * @param sorted Sorted frame times in nanoseconds
+ * @param count Number of samples
+ * @param percentile Percentile in (0, 100]
+ * @return Percentile value in milliseconds
+ */
+static double bench_percentile_ms(const uint64_t* sorted, int count, double percentile) {
+    int rank = (int)ceil(percentile / 100.0 * count);
+    if (rank < 1) rank = 1;
+    if (rank > count) rank = count;
+    return (double)sorted[rank - 1] / 1e6;
+}
+
+/**
+ * Summarize measured frame times. Sorts the samples.
+ * @param name Phase name
+ * @param samples Frame times in nanoseconds
+ * @param count Number of samples
+ * @param result Output summary
+ */
+static void bench_summarize(const char* name, uint64_t* samples, int count, BenchResult* result) {
+    double total_ms = 0.0;
+    for (int i = 0; i < count; i++) {
+        total_ms += (double)samples[i] / 1e6;
+    }
+    qsort(samples, (size_t)count, sizeof(uint64_t), bench_compare_u64);
+    
+    snprintf(result->name, sizeof(result->name), "%s", name);
+    result->frames = count;
+    result->p50_ms = bench_percentile_ms(samples, count, 50.0);
+    result->p95_ms = bench_percentile_ms(samples, count, 95.0);
+    result->p99_ms = bench_percentile_ms(samples, count, 99.0);
+    result->max_ms = (double)samples[count - 1] / 1e6;
+    result->mean_ms = total_ms / count;
+    result->frame_budget_ms = 0.0;
+}
+
+/**
+ * Run one scenario in a fresh game session and summarize its frame times.
+ * @param scenario The scenario
+ * @param index Scenario index, mixed into the random seed
+ * @param options Benchmark options
+ * @param jobs Job system for the renderer
+ * @param result Output summary
+ * @return true on success, false otherwise
+ */
+static bool bench_run_scenario(const BenchScenario* scenario, int index, const BenchOptions* options,
+                               JobSystem* jobs, BenchResult* result) {
+    uint64_t* samples = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)options->frames);
+    CoinCollectorGame* game = game_create();
+    if (!samples || !game) {
+        free(samples);
+        game_destroy(game);
+        return false;
+    }
+    
+    GameCallbacks callbacks = game_get_callbacks(game);
+    void* game_data = game_get_data(game);
+    
+    game_set_seed(game, options->seed + (uint64_t)index);
+    callbacks.init(game_data);
+    renderer3d_set_jobs(jobs);
+    
+    GameState* state = game_get_state(game);
+    if (!state) {
+        free(samples);
+        game_destroy(game);
+        return false;
+    }
+    bench_enter_gameplay(state, scenario->mode, scenario->map_id);
+    scenario->setup(state, 0);
+    
+    // Setup may have grown the maps; size the render snapshot for them
+    // before the measured frames, which must stay off the heap
+    callbacks.publish(game_data);
+    
+    // Scenarios script the state directly; the player presses nothing
+    InputFrame input;
+    input_clear(&input);
+    
+    int total_frames = BENCH_WARMUP_FRAMES + options->frames;
+    for (int frame = 0; frame < total_frames; frame++) {
+        uint64_t start_ns = timer_now_ns();
+        
+        scenario->step(state, frame);
+        mem_frame_begin();
+        callbacks.update(game_data, &input, BENCH_TICK_DELTA);
+        callbacks.publish(game_data);
+        mem_frame_end();
+        if (!options->sim_only) {
+            BeginDrawing();
+            mem_frame_begin();
+            callbacks.render(game_data);
+            mem_frame_end();
+            EndDrawing();
+        }
+        
+        uint64_t elapsed_ns = timer_now_ns() - start_ns;
+        if (frame >= BENCH_WARMUP_FRAMES) {
+            samples[frame - BENCH_WARMUP_FRAMES] = elapsed_ns;
+        }
+    }
+    
+    callbacks.cleanup(game_data);
+    game_destroy(game);
+    
+    char name[BENCH_NAME_LENGTH];
+    snprintf(name, sizeof(name), "%s/%s", options->sim_only ? "sim" : "render", scenario->name);
+    bench_summarize(name, samples, options->frames, result);
+    free(samples);
+    return true;
+}
+
+/**
+ * Time a state snapshot followed by a restore, in a 2D session firing a
+ * steady stream of projectiles. One tick runs between samples so every
+ * snapshot copies fresh data.
+ * @param options Benchmark options
+ * @param result Output summary
+ * @return true on success, false otherwise
+ */
+static bool bench_run_snapshot(const BenchOptions* options, BenchResult* result) {
+    uint64_t* samples = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)options->frames);
+    CoinCollectorGame* game = game_create();
+    if (!samples || !game) {
+        free(samples);
+        game_destroy(game);
+        return false;
+    }
+    
+    GameCallbacks callbacks = game_get_callbacks(game);
+    void* game_data = game_get_data(game);
+    game_set_seed(game, options->seed);
+    callbacks.init(game_data);
+    
+    GameState* state = game_get_state(game);
+    size_t capacity = state_snapshot_max_size(state);
+    uint8_t* buffer = capacity > 0 ? (uint8_t*)malloc(capacity) : NULL;
+    bool ok = buffer != NULL;
+    InputFrame input;
+    input_clear(&input);
+    if (ok) {
+        bench_enter_gameplay(state, GAME_MODE_2D, 0);
+    }
+    
+    int total_frames = BENCH_WARMUP_FRAMES + BENCH_PROJECTILE_TICKS + options->frames;
+    for (int frame = 0; ok && frame < total_frames; frame++) {
+        bench_keep_playing(state);
+        bench_fire_projectile(state, frame);
+        callbacks.update(game_data, &input, BENCH_TICK_DELTA);
+        
+        uint64_t start_ns = timer_now_ns();
+        size_t size = state_snapshot(state, buffer, capacity);
+        ok = size > 0 && state_restore(state, buffer, size);
+        uint64_t elapsed_ns = timer_now_ns() - start_ns;
+        
+        int sample = frame - BENCH_WARMUP_FRAMES - BENCH_PROJECTILE_TICKS;
+        if (sample >= 0) {
+            samples[sample] = elapsed_ns;
+        }
+    }
+    
+    callbacks.cleanup(game_data);
+    game_destroy(game);
+    free(buffer);
+    
+    if (ok) {
+        bench_summarize("state/snapshot_restore", samples, options->frames, result);
+    }
+    free(samples);
+    return ok;
+}
+
+/**
+ * Check that 32-bit snapshot fields survive a delta of any size, including
+ * ones of 2^31 or more whose zigzag form needs 33 bits. The pairs go
+ * through the frame counter and the first word of collected-coin bits.
+ * @param world Captured world with at least 32 coins; its fields are changed
+ * @param baseline Captured world one tick older; its fields are changed
+ * @param decoded World to decode into
+ * @param buffer Snapshot buffer
+ * @param capacity Size of the buffer
+ * @return true if every pair decoded to what was sent
+ */
+static bool bench_check_net_deltas(NetWorldState* world, NetWorldState* baseline, NetWorldState* decoded,
+                                   uint8_t* buffer, size_t capacity) {
+    static const uint32_t pairs[][2] = {
+        {0x00000000u, 0x80000000u}, {0x80000000u, 0x00000000u}, {0x00000001u, 0x80000001u},
+        {0x00000000u, 0x80000005u}, {0x00000000u, 0xFFFFFFFFu}, {0xFFFFFFFFu, 0x00000000u},
+        {0x7FFFFFFFu, 0x80000000u}, {0x00000000u, 0x0000003Fu}, {0x00000000u, 0x000007FFu}
+    };
+    for (size_t i = 0; i < sizeof(pairs) / sizeof(pairs[0]); i++) {
+        baseline->frame_count = pairs[i][0];
+        baseline->coin_collected[0] = pairs[i][0];
+        world->frame_count = pairs[i][1];
+        world->coin_collected[0] = pairs[i][1];
+        size_t size = netproto_write_snapshot(world, baseline, buffer, capacity);
+        if (size == 0 || !netproto_read_snapshot(buffer, size, world->tick, baseline, decoded) ||
+            decoded->frame_count != pairs[i][1] || decoded->coin_collected[0] != pairs[i][1]) {
+            printf("Error: Snapshot delta 0x%08X -> 0x%08X did not survive a round trip\n",
+                   (unsigned)pairs[i][0], (unsigned)pairs[i][1]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Time encoding one tick's network snapshot against the previous tick and
+ * decoding it, in a 2D session firing a steady stream of projectiles.
+ * Before timing, 32-bit fields are checked with deltas of every size.
+ * @param options Benchmark options
+ * @param result Output summary
+ * @return true on success, false if setup failed or a delta did not survive
+ */
+static bool bench_run_net_snapshot(const BenchOptions* options, BenchResult* result) {
+    uint64_t* samples = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)options->frames);
+    CoinCollectorGame* game = game_create();
+    if (!samples || !game) {
+        free(samples);
+        game_destroy(game);
+        return false;
+    }
+    
+    GameCallbacks callbacks = game_get_callbacks(game);
+    void* game_data = game_get_data(game);
+    game_set_seed(game, options->seed);
+    callbacks.init(game_data);
+    
+    GameState* state = game_get_state(game);
+    NetWorldState worlds[2];
+    NetWorldState decoded;
+    netproto_world_init(&worlds[0]);
+    netproto_world_init(&worlds[1]);
+    netproto_world_init(&decoded);
+    uint8_t* buffer = NULL;
+    size_t capacity = 0;
+    InputFrame input;
+    input_clear(&input);
+    
+    bench_enter_gameplay(state, GAME_MODE_2D, 0);
+    Map* map = state_get_current_map(state);
+    Rng rng;
+    rng_seed(&rng, options->seed);
+    bool ok = true;
+    while (ok && map->coin_count < BENCH_NET_COINS) {
+        ok = map_add_coin(map, (Vector2){(float)rng_range(&rng, 0, WORLD_WIDTH), (float)rng_range(&rng, 0, WORLD_HEIGHT)});
+    }
+    
+    int total_frames = BENCH_WARMUP_FRAMES + BENCH_PROJECTILE_TICKS + options->frames;
+    for (int frame = 0; ok && frame < total_frames; frame++) {
+        bench_keep_playing(state);
+        bench_fire_projectile(state, frame);
+        callbacks.update(game_data, &input, BENCH_TICK_DELTA);
+        
+        NetWorldState* world = &worlds[frame % 2];
+        NetWorldState* baseline = &worlds[(frame + 1) % 2];
+        ok = netproto_capture(state, frame, world);
+        size_t max_size = netproto_snapshot_max_size(world);
+        if (ok && max_size > capacity) {
+            free(buffer);
+            buffer = (uint8_t*)malloc(max_size);
+            capacity = buffer ? max_size : 0;
+            ok = buffer != NULL;
+        }
+        if (ok && frame == 1) {
+            ok = bench_check_net_deltas(world, baseline, &decoded, buffer, capacity) &&
+                 netproto_capture(state, frame, world);
+        }
+        if (!ok || frame == 0) continue;
+        
+        uint64_t start_ns = timer_now_ns();
+        size_t size = netproto_write_snapshot(world, baseline, buffer, capacity);
+        ok = size > 0 && netproto_read_snapshot(buffer, size, frame, baseline, &decoded);
+        uint64_t elapsed_ns = timer_now_ns() - start_ns;
+        
+        int sample = frame - BENCH_WARMUP_FRAMES - BENCH_PROJECTILE_TICKS;
+        if (sample >= 0) {
+            samples[sample] = elapsed_ns;
+        }
+    }
+    
+    callbacks.cleanup(game_data);
+    game_destroy(game);
+    netproto_world_release(&worlds[0]);
+    netproto_world_release(&worlds[1]);
+    netproto_world_release(&decoded);
+    free(buffer);
+    
+    if (ok) {
+        bench_summarize("net/snapshot_delta", samples, options->frames, result);
+    }
+    free(samples);
+    return ok;
+}
+
+/**
+ * Script the rollback phase's input: walk a slow square and click on a
+ * point circling the player, so the game fires whenever its cooldown lets
+ * it. Everything the phase changes goes through input, so re-simulated
+ * ticks do the same work as the originals.
+ * @param input Input to fill
+ * @param state The game state
+ * @param frame Frame index
+ */
+static void bench_rollback_input(InputFrame* input, GameState* state, int frame) {
+    static const uint32_t directions[] = {INPUT_BUTTON_RIGHT, INPUT_BUTTON_DOWN, INPUT_BUTTON_LEFT, INPUT_BUTTON_UP};
+    float angle = (float)frame * (2.0f * PI / 60.0f);
+    Vector2 origin = player_get_position(state_get_player(state));
+    
+    input_clear(input);
+    input->held = directions[(frame / 60) % 4] | INPUT_BUTTON_MOUSE_LEFT;
+    input->pressed = INPUT_BUTTON_MOUSE_LEFT;
+    input->mouse_position = (Vector2){origin.x + cosf(angle) * 100.0f, origin.y + sinf(angle) * 100.0f};
+}
+
+/**
+ * Save the state at the start of a tick into the rollback ring, as the
+ * engine does before each update. A tick the ring already ends at, which
+ * is where a rollback resumes, only has its input replaced.
+ * @param callbacks Game callbacks
+ * @param game_data Game data
+ * @param rollback The ring
+ * @param tick Tick about to run
+ * @param input Input it runs with
+ * @param buffer Scratch space for the largest saved game
+ * @param capacity Size of the scratch space
+ * @return true on success, false otherwise
+ */
+static bool bench_rollback_save(const GameCallbacks* callbacks, void* game_data, RollbackBuffer* rollback,
+                                int tick, const InputFrame* input, uint8_t* buffer, size_t capacity) {
+    if (rollback_get_newest_tick(rollback) == tick) {
+        return rollback_set_input(rollback, tick, input);
+    }
+    size_t size = callbacks->save_state(game_data, buffer, capacity);
+    return size > 0 && size <= capacity && rollback_push(rollback, tick, buffer, size, input);
+}
+
+/**
+ * Time a rollback of BENCH_ROLLBACK_TICKS ticks followed by simulating them
+ * again, the way the engine handles a late input: rebuild the old state
+ * from the ring, load it, then run every tick with its state saved again.
+ * The 2D session keeps firing and walking so states change every tick.
+ * The phase must fit in one frame whatever the baseline says.
+ * @param options Benchmark options
+ * @param result Output summary
+ * @return true on success, false otherwise
+ */
+static bool bench_run_rollback(const BenchOptions* options, BenchResult* result) {
+    CoinCollectorGame* game = game_create();
+    RollbackBuffer* rollback = rollback_create(BENCH_ROLLBACK_CAPACITY);
+    uint64_t* samples = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)options->frames);
+    if (!game || !rollback || !samples) {
+        free(samples);
+        rollback_destroy(rollback);
+        game_destroy(game);
+        return false;
+    }
+    
+    GameCallbacks callbacks = game_get_callbacks(game);
+    void* game_data = game_get_data(game);
+    game_set_seed(game, options->seed);
+    callbacks.init(game_data);
+    
+    // Room for the game's save header and the largest possible state
+    GameState* state = game_get_state(game);
+    size_t capacity = state ? callbacks.save_state(game_data, NULL, 0) - state_snapshot_size(state) + state_snapshot_max_size(state) : 0;
+    uint8_t* buffer = capacity > 0 ? (uint8_t*)malloc(capacity) : NULL;
+    bool ok = buffer != NULL;
+    if (ok) {
+        bench_enter_gameplay(state, GAME_MODE_2D, 0);
+    }
+    
+    InputFrame input;
+    InputFrame inputs[BENCH_ROLLBACK_TICKS];
+    int total_frames = BENCH_WARMUP_FRAMES + options->frames;
+    for (int tick = 0; ok && tick < total_frames; tick++) {
+        bench_keep_playing(state);
+        bench_rollback_input(&input, state, tick);
+        ok = bench_rollback_save(&callbacks, game_data, rollback, tick, &input, buffer, capacity);
+        callbacks.update(game_data, &input, BENCH_TICK_DELTA);
+        
+        int sample = tick - BENCH_WARMUP_FRAMES;
+        if (!ok || sample < 0) continue;
+        
+        uint64_t start_ns = timer_now_ns();
+        int first = tick + 1 - BENCH_ROLLBACK_TICKS;
+        for (int i = 0; i < BENCH_ROLLBACK_TICKS; i++) {
+            inputs[i] = *rollback_get_input(rollback, first + i);
+        }
+        size_t size = 0;
+        const void* saved = rollback_rewind(rollback, first, &size);
+        ok = saved && callbacks.load_state(game_data, saved, size);
+        for (int i = 0; ok && i < BENCH_ROLLBACK_TICKS; i++) {
+            ok = bench_rollback_save(&callbacks, game_data, rollback, first + i, &inputs[i], buffer, capacity);
+            callbacks.update(game_data, &inputs[i], BENCH_TICK_DELTA);
+        }
+        samples[sample] = timer_now_ns() - start_ns;
+    }
+    
+    if (ok) {
+        printf("Rollback ring: %d ticks in %zu bytes (one state: %zu bytes)\n",
+               BENCH_ROLLBACK_CAPACITY, rollback_get_state_bytes(rollback),
+               callbacks.save_state(game_data, NULL, 0));
+    }
+    
+    callbacks.cleanup(game_data);
+    game_destroy(game);
+    rollback_destroy(rollback);
+    free(buffer);
+    
+    if (ok) {
+        char name[BENCH_NAME_LENGTH];
+        snprintf(name, sizeof(name), "state/rollback_%d", BENCH_ROLLBACK_TICKS);
+        bench_summarize(name, samples, options->frames, result);
+        result->frame_budget_ms = BENCH_FRAME_BUDGET_MS;
+    }
+    free(samples);
+    return ok;
+}
+
+/**
+ * Time enemy_update_all() over BENCH_ENEMY_COUNT enemies scattered over map
+ * 0, far more than any map holds, to show how the batched update scales.
+ * Headings are queued the way the game queues them.
+ * @param options Benchmark options
+ * @param result Output summary
+ * @return true on success, false otherwise
+ */
+static bool bench_run_enemy_batch(const BenchOptions* options, BenchResult* result) {
+    Map* map = map_create(0);
+    float* arrays = (float*)malloc(sizeof(float) * 5 * BENCH_ENEMY_COUNT);
+    float* timers = (float*)malloc(sizeof(float) * BENCH_ENEMY_COUNT);
+    bool* has_heading = (bool*)malloc(sizeof(bool) * BENCH_ENEMY_COUNT);
+    uint64_t* samples = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)options->frames);
+    if (!map || !arrays || !timers || !has_heading || !samples) {
+        map_destroy(map);
+        free(arrays);
+        free(timers);
+        free(has_heading);
+        free(samples);
+        return false;
+    }
+    
+    EnemyArrays enemies = {
+        arrays, arrays + BENCH_ENEMY_COUNT, arrays + 2 * BENCH_ENEMY_COUNT, arrays + 3 * BENCH_ENEMY_COUNT,
+        timers, has_heading, arrays + 4 * BENCH_ENEMY_COUNT, ENEMY_RADIUS
+    };
+    float* headings = arrays + 4 * BENCH_ENEMY_COUNT;
+    Rng rng;
+    rng_seed(&rng, options->seed);
+    for (int i = 0; i < BENCH_ENEMY_COUNT; i++) {
+        Vector2 desired = {(float)rng_range(&rng, 50, WORLD_WIDTH - 50), (float)rng_range(&rng, 50, WORLD_HEIGHT - 50)};
+        Vector2 position = map_find_valid_spawn_position(desired, ENEMY_RADIUS, map);
+        float angle = enemy_random_heading(&rng);
+        enemies.x[i] = position.x;
+        enemies.y[i] = position.y;
+        enemies.velocity_x[i] = cosf(angle) * ENEMY_SPEED;
+        enemies.velocity_y[i] = sinf(angle) * ENEMY_SPEED;
+        timers[i] = (float)rng_range(&rng, 0, BENCH_TURN_TICKS - 1) * BENCH_TICK_DELTA;
+    }
+    
+    int total_frames = BENCH_WARMUP_FRAMES + options->frames;
+    for (int frame = 0; frame < total_frames; frame++) {
+        for (int i = 0; i < BENCH_ENEMY_COUNT; i++) {
+            has_heading[i] = timers[i] + BENCH_TICK_DELTA >= ENEMY_DIRECTION_CHANGE_TIME;
+            if (has_heading[i]) {
+                headings[i] = enemy_random_heading(&rng);
+            }
+        }
+        
+        uint64_t start_ns = timer_now_ns();
+        enemy_update_all(&enemies, 0, BENCH_ENEMY_COUNT, map, BENCH_TICK_DELTA);
+        uint64_t elapsed_ns = timer_now_ns() - start_ns;
+        
+        int sample = frame - BENCH_WARMUP_FRAMES;
+        if (sample >= 0) {
+            samples[sample] = elapsed_ns;
+        }
+    }
+    
+    char name[BENCH_NAME_LENGTH];
+    snprintf(name, sizeof(name), "kernel/enemy_update_%d", BENCH_ENEMY_COUNT);
+    bench_summarize(name, samples, options->frames, result);
+    
+    map_destroy(map);
+    free(arrays);
+    free(timers);
+    free(has_heading);
+    free(samples);
+    return true;
+}
+
+/**
+ * Time one circle-versus-walls kernel: every sample tests a batch of circles
+ * against a few hundred small walls, so most tests scan the whole set.
+ * Before timing, both kernels are run over the batch and must agree.
+ * @param options Benchmark options
+ * @param vectorized true for collide_circle_first_rect(), false for the scalar kernel
+ * @param result Filled with the phase summary
+ * @return true on success, false if setup failed or the kernels disagree
+ */
+static bool bench_run_circle_walls(const BenchOptions* options, bool vectorized, BenchResult* result) {
+    float* arrays = (float*)malloc(sizeof(float) * 4 * BENCH_RECT_COUNT);
+    float* circles = (float*)malloc(sizeof(float) * 2 * BENCH_CIRCLE_COUNT);
+    uint64_t* samples = (uint64_t*)malloc(sizeof(uint64_t) * (size_t)options->frames);
+    if (!arrays || !circles || !samples) {
+        free(arrays);
+        free(circles);
+        free(samples);
+        return false;
+    }
+    
+    float* left = arrays;
+    float* top = arrays + BENCH_RECT_COUNT;
+    float* right = arrays + 2 * BENCH_RECT_COUNT;
+    float* bottom = arrays + 3 * BENCH_RECT_COUNT;
+    RectArrays rects = {left, top, right, bottom, BENCH_RECT_COUNT};
+    Rng rng;
+    rng_seed(&rng, options->seed);
+    for (int i = 0; i < BENCH_RECT_COUNT; i++) {
+        left[i] = (float)rng_range(&rng, 0, WORLD_WIDTH);
+        top[i] = (float)rng_range(&rng, 0, WORLD_HEIGHT);
+        right[i] = left[i] + BENCH_RECT_SIZE;
+        bottom[i] = top[i] + BENCH_RECT_SIZE;
+    }
+    for (int i = 0; i < BENCH_CIRCLE_COUNT; i++) {
+        circles[i * 2] = (float)rng_range(&rng, 0, WORLD_WIDTH);
+        circles[i * 2 + 1] = (float)rng_range(&rng, 0, WORLD_HEIGHT);
+    }
+    
+    bool agree = true;
+    for (int i = 0; i < BENCH_CIRCLE_COUNT && agree; i++) {
+        agree = collide_circle_first_rect(circles[i * 2], circles[i * 2 + 1], BENCH_CIRCLE_RADIUS, &rects) ==
+                collide_circle_first_rect_scalar(circles[i * 2], circles[i * 2 + 1], BENCH_CIRCLE_RADIUS, &rects);
+    }
+    if (!agree) {
+        printf("Error: The %s and scalar collision kernels disagree\n", collide_get_kernel_name());
+        free(arrays);
+        free(circles);
+        free(samples);
+        return false;
+    }
+    
+    volatile int hits = 0;  // Keeps the work from being optimized away
+    int total_frames = BENCH_WARMUP_FRAMES + options->frames;
+    for (int frame = 0; frame < total_frames; frame++) {
+        int frame_hits = 0;
+        uint64_t start_ns = timer_now_ns();
+        for (int i = 0; i < BENCH_CIRCLE_COUNT; i++) {
+            int rect = vectorized
+                ? collide_circle_first_rect(circles[i * 2], circles[i * 2 + 1], BENCH_CIRCLE_RADIUS, &rects)
+                : collide_circle_first_rect_scalar(circles[i * 2], circles[i * 2 + 1], BENCH_CIRCLE_RADIUS, &rects);
+            frame_hits += rect >= 0;
+        }
+        uint64_t elapsed_ns = timer_now_ns() - start_ns;
+        hits = frame_hits;
+        
+        int sample = frame - BENCH_WARMUP_FRAMES;
+        if (sample >= 0) {
+            samples[sample] = elapsed_ns;
+        }
+    }
+    
+    char name[BENCH_NAME_LENGTH];
+    snprintf(name, sizeof(name), "kernel/circle_walls_%d%s", BENCH_RECT_COUNT, vectorized ? "" : "_scalar");
+    bench_summarize(name, samples, options->frames, result);
+    (void)hits;
+    
+    free(arrays);
+    free(circles);
+    free(samples);
+    return true;
+}
+
+/**
+ * Write results as JSON.
+ * @param path Output file path
+ * @param results Results to write
+ * @param count Number of results
+ * @return true on success, false otherwise
+ */
+static bool bench_write_results(const char* path, const BenchResult* results, int count) {
+    FILE* file = fopen(path, "w");
+    if (!file) {
+        printf("Error: Could not write %s\n", path);
+        return false;
+    }
+    
+    fprintf(file, "{\n  \"phases\": [\n");
+    for (int i = 0; i < count; i++) {
+        fprintf(file, "    {\"name\": \"%s\", \"frames\": %d, \"p50_ms\": %.4f, \"p95_ms\": %.4f, "
+                      "\"p99_ms\": %.4f, \"max_ms\": %.4f, \"mean_ms\": %.4f}%s\n",
+                results[i].name, results[i].frames, results[i].p50_ms, results[i].p95_ms,
+                results[i].p99_ms, results[i].max_ms, results[i].mean_ms,
+                (i + 1 < count) ? "," : "");
+    }
+    fprintf(file, "  ]\n}\n");
+    fclose(file);
+    return true;
+}
+
+/**
+ * Read a number that follows "key": after the given position.
+ * @param text JSON text
+ * @param key Key to look for
+ * @param value Output value
+ * @return true if found, false otherwise
+ */
+static bool bench_read_number(const char* text, const char* key, double* value) {
+    char pattern[BENCH_NAME_LENGTH];
+    snprintf(pattern, sizeof(pattern), "\"%s\":", key);
+    const char* found = strstr(text, pattern);
+    if (!found) return false;
+    *value = strtod(found + strlen(pattern), NULL);
+    return true;
+}
+
+/**
+ * Load results written by bench_write_results. Only understands that
+ * layout: one phase object per line.
+ * @param path Baseline file path
+ * @param results Output results
+ * @param max_results Capacity of the output array
+ * @return Number of results loaded, or -1 if the file could not be read
+ */
+static int bench_load_results(const char* path, BenchResult* results, int max_results) {
+    FILE* file = fopen(path, "r");
+    if (!file) return -1;
+    
+    int count = 0;
+    char line[512];
+    while (count < max_results && fgets(line, sizeof(line), file)) {
+        const char* name = strstr(line, "\"name\": \"");
+        if (!name) continue;
+        name += strlen("\"name\": \"");
+        const char* name_end = strchr(name, '"');
+        if (!name_end || name_end - name >= BENCH_NAME_LENGTH) continue;
+        
+        BenchResult* result = &results[count];
+        memset(result, 0, sizeof(BenchResult));
+        memcpy(result->name, name, (size_t)(name_end - name));
+        
+        double frames = 0.0;
+        bench_read_number(line, "frames", &frames);
+        result->frames = (int)frames;
+        if (bench_read_number(line, "p50_ms", &result->p50_ms) &&
+            bench_read_number(line, "p95_ms", &result->p95_ms) &&
+            bench_read_number(line, "p99_ms", &result->p99_ms)) {
+            bench_read_number(line, "max_ms", &result->max_ms);
+            bench_read_number(line, "mean_ms", &result->mean_ms);
+            count++;
+        }
+    }
+    
+    fclose(file);
+    return count;
+}
+
+/**
+ * Find a result by name.
+ * @param results Results to search
+ * @param count Number of results
+ * @param name Name to find
+ * @return Matching result, or NULL
+ */
+static BenchResult* bench_find_result(BenchResult* results, int count, const char* name) {
+    for (int i = 0; i < count; i++) {
+        if (strcmp(results[i].name, name) == 0) {
+            return &results[i];
+        }
+    }
+    return NULL;
+}
+
+/**
+ * Compare one percentile against its baseline and report a regression.
+ * @param name Phase name
+ * @param label Percentile label
+ * @param current Measured value
+ * @param baseline Baseline value
+ * @param tolerance Allowed relative slowdown
+ * @return true if within budget, false on regression
+ */
+static bool bench_check_budget(const char* name, const char* label, double current, double baseline, double tolerance) {
+    double budget = baseline * (1.0 + tolerance) + BENCH_SLACK_MS;
+    bool ok = current <= budget;
+    if (!ok) {
+        printf("REGRESSION %-22s %s %.4f ms > %.4f ms (baseline %.4f ms +%.0f%%)\n",
+               name, label, current, budget, baseline, tolerance * 100.0);
+    }
+    return ok;
+}
+
+/**
+ * Compare results against a baseline.
+ * @param results Current results
+ * @param count Number of current results
+ * @param baseline Baseline results
+ * @param baseline_count Number of baseline results
+ * @param tolerance Allowed relative slowdown
+ * @return Number of regressed phases
+ */
+static int bench_compare(const BenchResult* results, int count, BenchResult* baseline, int baseline_count, double tolerance) {
+    int regressions = 0;
+    for (int i = 0; i < count; i++) {
+        const BenchResult* base = bench_find_result(baseline, baseline_count, results[i].name);
+        if (!base) {
+            printf("No baseline for %s\n", results[i].name);
+            continue;
+        }
+        
+        bool ok = bench_check_budget(results[i].name, "p50", results[i].p50_ms, base->p50_ms, tolerance);
+        ok = bench_check_budget(results[i].name, "p95", results[i].p95_ms, base->p95_ms, tolerance) && ok;
+        ok = bench_check_budget(results[i].name, "p99", results[i].p99_ms, base->p99_ms, tolerance) && ok;
+        if (!ok) regressions++;
+    }
+    return regressions;
+}
+
+/**
+ * Check the phases that must fit a fixed frame budget.
+ * @param results Current results
+ * @param count Number of current results
+ * @return Number of phases over their budget
+ */
+static int bench_check_frame_budgets(const BenchResult* results, int count) {
+    int over = 0;
+    for (int i = 0; i < count; i++) {
+        if (results[i].frame_budget_ms > 0.0 && results[i].p99_ms > results[i].frame_budget_ms) {
+            printf("OVER BUDGET %-21s p99 %.4f ms > %.1f ms frame\n",
+                   results[i].name, results[i].p99_ms, results[i].frame_budget_ms);
+            over++;
+        }
+    }
+    return over;
+}
+
+/**
+ * Print command line usage.
+ * @param program Program name
+ */
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --sim-only         Skip the window and rendering, time the simulation only\n");
+    fprintf(stderr, "  --frames N         Measured frames per phase (default %d)\n", BENCH_DEFAULT_FRAMES);
+    fprintf(stderr, "  --threads N        Job system threads (0 = one per CPU)\n");
+    fprintf(stderr, "  --seed N           Base random seed (default %d)\n", BENCH_DEFAULT_SEED);
+    fprintf(stderr, "  --baseline FILE    Baseline to compare against (default %s)\n", BENCH_DEFAULT_BASELINE);
+    fprintf(stderr, "  --tolerance F      Allowed slowdown before failing, 0.25 = 25%% (default %.2f)\n", BENCH_DEFAULT_TOLERANCE);
+    fprintf(stderr, "  --write-baseline   Store these results in the baseline instead of comparing\n");
+    fprintf(stderr, "  --output FILE      Where to write the results JSON (default %s)\n", BENCH_DEFAULT_OUTPUT);
+}
+
+/**
+ * Parse command line options.
+ * @param argc Argument count
+ * @param argv Argument values
+ * @param options Options to fill
+ * @return true if all options were valid, false otherwise
+ */
+static bool parse_arguments(int argc, char** argv, BenchOptions* options) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--sim-only") == 0) {
+            options->sim_only = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            options->frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            options->threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            options->seed = (unsigned int)strtoul(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--baseline") == 0 && i + 1 < argc) {
+            options->baseline_path = argv[++i];
+        } else if (strcmp(argv[i], "--tolerance") == 0 && i + 1 < argc) {
+            options->tolerance = atof(argv[++i]);
+        } else if (strcmp(argv[i], "--write-baseline") == 0) {
+            options->write_baseline = true;
+        } else if (strcmp(argv[i], "--output") == 0 && i + 1 < argc) {
+            options->output_path = argv[++i];
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    return options->frames > 0;
+}
+
+int main(int argc, char** argv) {
+    BenchOptions options = {
+        .sim_only = false,
+        .frames = BENCH_DEFAULT_FRAMES,
+        .threads = 0,
+        .seed = BENCH_DEFAULT_SEED,
+        .tolerance = BENCH_DEFAULT_TOLERANCE,
+        .baseline_path = BENCH_DEFAULT_BASELINE,
+        .output_path = BENCH_DEFAULT_OUTPUT,
+        .write_baseline = false
+    };
+    
+    if (!parse_arguments(argc, argv, &options)) {
+        print_usage(argv[0]);
+        return 2;
+    }
+    
+    if (!options.sim_only) {
+        // Hidden, uncapped window so frames measure work rather than vsync
+        SetConfigFlags(FLAG_WINDOW_HIDDEN);
+        InitWindow(BENCH_WINDOW_WIDTH, BENCH_WINDOW_HEIGHT, "GameEngine bench");
+        SetTargetFPS(0);
+        
+        // Hold the 3D view at the window width so runs stay comparable
+        renderer3d_set_column_range(BENCH_WINDOW_WIDTH, BENCH_WINDOW_WIDTH);
+    }
+    
+    JobSystem* jobs = jobs_create(options.threads);
+    
+    BenchResult results[BENCH_MAX_RESULTS];
+    int result_count = 0;
+    for (int i = 0; i < BENCH_SCENARIO_COUNT; i++) {
+        if (!bench_run_scenario(&BENCH_SCENARIOS[i], i, &options, jobs, &results[result_count])) {
+            printf("Error: Scenario %s failed to run\n", BENCH_SCENARIOS[i].name);
+            continue;
+        }
+        result_count++;
+    }
+    
+    if (bench_run_snapshot(&options, &results[result_count])) {
+        result_count++;
+    } else {
+        printf("Error: Snapshot phase failed to run\n");
+    }
+    if (bench_run_net_snapshot(&options, &results[result_count])) {
+        result_count++;
+    } else {
+        printf("Error: Network snapshot phase failed to run\n");
+    }
+    if (bench_run_rollback(&options, &results[result_count])) {
+        result_count++;
+    } else {
+        printf("Error: Rollback phase failed to run\n");
+    }
+    if (bench_run_enemy_batch(&options, &results[result_count])) {
+        result_count++;
+    } else {
+        printf("Error: Enemy batch phase failed to run\n");
+    }
+    for (int vectorized = 0; vectorized <= 1; vectorized++) {
+        if (bench_run_circle_walls(&options, vectorized, &results[result_count])) {
+            result_count++;
+        } else {
+            printf("Error: Circle-versus-walls phase failed to run\n");
+        }
+    }
+    printf("Collision kernel: %s\n", collide_get_kernel_name());
+    
+    jobs_destroy(jobs);
+    if (!options.sim_only) {
+        renderer3d_shutdown();
+        CloseWindow();
+    }
+    
+    printf("\n%-32s %8s %8s %8s %8s\n", "phase", "p50 ms", "p95 ms", "p99 ms", "max ms");
+    for (int i = 0; i < result_count; i++) {
+        printf("%-32s %8.3f %8.3f %8.3f %8.3f\n", results[i].name,
+               results[i].p50_ms, results[i].p95_ms, results[i].p99_ms, results[i].max_ms);
+    }
+    
+    if (!bench_write_results(options.output_path, results, result_count)) {
+        return 2;
+    }
+    printf("Results written to %s\n", options.output_path);
+    int over_budget = bench_check_frame_budgets(results, result_count);
+    
+    BenchResult baseline[BENCH_MAX_RESULTS * 2];
+    int baseline_count = bench_load_results(options.baseline_path, baseline, BENCH_MAX_RESULTS * 2);
+    
+    if (options.write_baseline) {
+        // Replace this mode's phases and keep the other mode's
+        if (baseline_count < 0) baseline_count = 0;
+        for (int i = 0; i < result_count; i++) {
+            BenchResult* existing = bench_find_result(baseline, baseline_count, results[i].name);
+            if (existing) {
+                *existing = results[i];
+            } else if (baseline_count < BENCH_MAX_RESULTS * 2) {
+                baseline[baseline_count++] = results[i];
+            }
+        }
+        if (!bench_write_results(options.baseline_path, baseline, baseline_count)) {
+            return 2;
+        }
+        printf("Baseline written to %s\n", options.baseline_path);
+        return over_budget > 0 ? 1 : 0;
+    }
+    
+    if (baseline_count < 0) {
+        printf("No baseline at %s; run with --write-baseline to create one\n", options.baseline_path);
+        return over_budget > 0 ? 1 : 0;
+    }
+    
+    int regressions = bench_compare(results, result_count, baseline, baseline_count, options.tolerance);
+    if (regressions > 0) {
+        printf("%d phase(s) regressed beyond %.0f%% of %s\n", regressions, options.tolerance * 100.0, options.baseline_path);
+        return 1;
+    }
+    if (over_budget > 0) {
+        return 1;
+    }
+    printf("All phases within %.0f%% of %s\n", options.tolerance * 100.0, options.baseline_path);
+    return 0;
+}
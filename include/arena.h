@@ -0,0 +1,72 @@
+#ifndef ARENA_H
+#define ARENA_H
+
+#include "mem.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+#define ARENA_ALIGNMENT 16  // Every allocation starts on this boundary
+
+typedef struct Arena Arena;
+
+/**
+ * Create a bump allocator over one fixed block. Allocations are a pointer
+ * bump and are all released together by arena_reset(), which makes it a
+ * fit for data that lives for one tick.
+ * @param tag Subsystem the block is charged to
+ * @param capacity Size of the block in bytes
+ * @return Pointer to created arena, or NULL on failure
+ */
+Arena* arena_create(MemTag tag, size_t capacity);
+
+/**
+ * Destroy an arena and its block.
+ * @param arena The arena
+ */
+void arena_destroy(Arena* arena);
+
+/**
+ * Take memory from the arena. The memory is not cleared.
+ * @param arena The arena
+ * @param size Bytes wanted
+ * @return Pointer to the memory, or NULL if the arena is full
+ */
+void* arena_alloc(Arena* arena, size_t size);
+
+/**
+ * Take zeroed memory for an array from the arena.
+ * @param arena The arena
+ * @param count Number of elements
+ * @param size Size of one element
+ * @return Pointer to the memory, or NULL if the arena is full
+ */
+void* arena_calloc(Arena* arena, size_t count, size_t size);
+
+/**
+ * Release everything allocated since the arena was created or last reset.
+ * @param arena The arena
+ */
+void arena_reset(Arena* arena);
+
+/**
+ * Get the bytes allocated since the last reset, padding included.
+ * @param arena The arena
+ * @return Bytes in use
+ */
+size_t arena_get_used(const Arena* arena);
+
+/**
+ * Get the most bytes that were ever in use at once.
+ * @param arena The arena
+ * @return Peak bytes in use
+ */
+size_t arena_get_peak(const Arena* arena);
+
+/**
+ * Get the size of the arena's block.
+ * @param arena The arena
+ * @return Capacity in bytes
+ */
+size_t arena_get_capacity(const Arena* arena);
+
+#endif
@@ -7,11 +7,13 @@ typedef enum {
     AUDIO_SOUND_COIN,
     AUDIO_SOUND_DAMAGE,
     AUDIO_SOUND_VICTORY,
-    AUDIO_SOUND_MENU
+    AUDIO_SOUND_MENU,
+    AUDIO_SOUND_COUNT
 } AudioSoundType;
 
 /**
- * Initialize the audio system.
+ * Initialize the audio system and synthesize every sound into a bank of
+ * preloaded voices, so playing a sound later allocates nothing.
  * @return true if initialization successful, false otherwise
  */
 bool audio_init(void);
@@ -22,17 +24,17 @@ bool audio_init(void);
 void audio_cleanup(void);
 
 /**
- * Play a predefined sound type.
- * @param sound_type The type of sound to play
+ * Silence or restore sound playback, for example while the simulation
+ * fast-forwards through a replay.
+ * @param muted true to drop sounds, false to play them
  */
-void audio_play_sound(AudioSoundType sound_type);
+void audio_set_muted(bool muted);
 
 /**
- * Play a custom blip sound with specified parameters.
- * @param frequency Sound frequency in Hz
- * @param duration Sound duration in seconds
- * @param volume Sound volume (0.0 to 1.0)
+ * Play a predefined sound type on a free voice, or on its oldest voice if
+ * all of them are playing.
+ * @param sound_type The type of sound to play
  */
-void audio_play_blip(float frequency, float duration, float volume);
+void audio_play_sound(AudioSoundType sound_type);
 
 #endif
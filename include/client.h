@@ -0,0 +1,44 @@
+#ifndef CLIENT_H
+#define CLIENT_H
+
+#include "gengine.h"
+#include "game.h"
+#include "net.h"
+
+typedef struct GameClient GameClient;
+
+/**
+ * Create a client that plays a game running on a server. The local game
+ * is never simulated: each tick the client sends its input, acknowledges
+ * the newest snapshot it holds and shows the newest one received, so the
+ * game's own render draws the server's world.
+ * @param game Local game used to hold and draw the received state
+ * @param engine Engine to stop when the server goes quiet
+ * @param server Server address
+ * @return Pointer to created client, or NULL on failure
+ */
+GameClient* client_create(CoinCollectorGame* game, GameEngine* engine, const NetAddress* server);
+
+/**
+ * Destroy a client. The game is not destroyed.
+ * @param client The client
+ */
+void client_destroy(GameClient* client);
+
+/**
+ * Get the callbacks to register with the engine in place of the game's.
+ * Every few seconds and at cleanup the client prints its snapshot rate and
+ * bandwidth.
+ * @param client The client
+ * @return Callbacks that wrap the game's
+ */
+GameCallbacks client_get_callbacks(GameClient* client);
+
+/**
+ * Get the data pointer to register together with client_get_callbacks().
+ * @param client The client
+ * @return Client data pointer
+ */
+void* client_get_data(GameClient* client);
+
+#endif
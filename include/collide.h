@@ -0,0 +1,52 @@
+#ifndef COLLIDE_H
+#define COLLIDE_H
+
+#include <stdbool.h>
+
+/*
+ * Batch collision tests of one circle against many rectangles, with the
+ * rectangles stored as parallel arrays of edges. Built with
+ * -DGENGINE_ENABLE_AVX2=ON the kernel tests 8 rectangles per step, on
+ * other x86 builds 4 with SSE2, and elsewhere one at a time. Every path
+ * gives the same answers as map_check_circle_rect_collision().
+ */
+
+/**
+ * Rectangles as parallel arrays of edges. Views memory owned elsewhere.
+ */
+typedef struct {
+    const float* left;
+    const float* top;
+    const float* right;   // x + width
+    const float* bottom;  // y + height
+    int count;
+} RectArrays;
+
+/**
+ * Find the first rectangle a circle overlaps.
+ * @param x Circle center X
+ * @param y Circle center Y
+ * @param radius Circle radius
+ * @param rects Rectangles to test
+ * @return Index of the first overlapping rectangle, or -1 if none
+ */
+int collide_circle_first_rect(float x, float y, float radius, const RectArrays* rects);
+
+/**
+ * Same as collide_circle_first_rect(), one rectangle at a time. Kept for
+ * comparison and benchmarking.
+ * @param x Circle center X
+ * @param y Circle center Y
+ * @param radius Circle radius
+ * @param rects Rectangles to test
+ * @return Index of the first overlapping rectangle, or -1 if none
+ */
+int collide_circle_first_rect_scalar(float x, float y, float radius, const RectArrays* rects);
+
+/**
+ * Get the instruction set collide_circle_first_rect() was built for.
+ * @return "avx2", "sse2" or "scalar"
+ */
+const char* collide_get_kernel_name(void);
+
+#endif
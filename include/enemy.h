@@ -2,15 +2,53 @@
 #define ENEMY_H
 
 #include "raylib.h"
+#include "rng.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 struct Map;
 
-#define ENEMY_SPEED 2.0f
+#define ENEMY_SPEED 120.0f  // World units per second
 #define ENEMY_RADIUS 20.0f
-#define ENEMY_DIRECTION_CHANGE_FRAMES 120
+#define ENEMY_DIRECTION_CHANGE_TIME 2.0f  // Seconds between direction changes
 
-typedef struct Enemy Enemy;
+/**
+ * An enemy's movement state. Plain data, so a temporary enemy can live on
+ * the stack (see enemy_make()) instead of the heap.
+ */
+typedef struct Enemy {
+    Vector2 position;
+    Vector2 velocity;              // World units per second
+    float radius;
+    float direction_change_timer;  // Seconds since the last direction change
+    Color color;
+    bool has_next_heading;
+    float next_heading;
+} Enemy;
+
+/**
+ * Many enemies as parallel arrays, for example a map's obstacles. They all
+ * have the same radius.
+ */
+typedef struct {
+    float* x;
+    float* y;
+    float* velocity_x;  // World units per second
+    float* velocity_y;
+    float* direction_change_timer;  // Seconds since the last direction change
+    const bool* has_next_heading;  // Per enemy: take next_heading at the next direction change (NULL = none)
+    const float* next_heading;
+    float radius;
+} EnemyArrays;
+
+/**
+ * Build an enemy by value, without allocating.
+ * @param position Starting position
+ * @param velocity Initial velocity
+ * @param color Enemy color
+ * @return The enemy
+ */
+Enemy enemy_make(Vector2 position, Vector2 velocity, Color color);
 
 /**
  * Create a new enemy instance.
@@ -58,9 +96,9 @@ Color enemy_get_color(const Enemy* enemy);
 /**
  * Get the enemy's direction change timer.
  * @param enemy The enemy
- * @return Timer value
+ * @return Seconds since the last direction change
  */
-int enemy_get_direction_timer(const Enemy* enemy);
+float enemy_get_direction_timer(const Enemy* enemy);
 
 /**
  * Set the enemy's position.
@@ -79,16 +117,49 @@ void enemy_set_velocity(Enemy* enemy, Vector2 velocity);
 /**
  * Set the enemy's direction change timer.
  * @param enemy The enemy
- * @param timer New timer value
+ * @param timer Seconds since the last direction change
  */
-void enemy_set_direction_timer(Enemy* enemy, int timer);
+void enemy_set_direction_timer(Enemy* enemy, float timer);
+
+/**
+ * Set the heading the enemy takes at its next direction change, instead of
+ * drawing one during the update. Lets callers draw random numbers up front,
+ * in a fixed order, and update enemies on worker threads.
+ * @param enemy The enemy
+ * @param angle Heading in radians
+ */
+void enemy_set_next_heading(Enemy* enemy, float angle);
+
+/**
+ * Draw a random heading for a direction change.
+ * @param rng Random stream to draw from
+ * @return Heading in radians
+ */
+float enemy_random_heading(Rng* rng);
 
 /**
  * Update enemy state and movement.
  * @param enemy The enemy
  * @param current_map Current map for collision detection
+ * @param rng Stream for a new heading when none was queued (NULL keeps the current one)
+ * @param delta_time Tick length in seconds
+ */
+void enemy_update(Enemy* enemy, const struct Map* current_map, Rng* rng, float delta_time);
+
+/**
+ * Update a range of enemies in one pass over the arrays: direction changes,
+ * movement, wall bounce and world bounds reflection, the same as
+ * enemy_update() on each. An enemy without a queued heading keeps its
+ * heading when it changes direction. Each enemy reads only the walls and
+ * writes only its own entries, so disjoint ranges can run on different
+ * threads.
+ * @param enemies The arrays
+ * @param begin First enemy index
+ * @param end One past the last enemy index
+ * @param current_map Current map for collision detection
+ * @param delta_time Tick length in seconds
  */
-void enemy_update(Enemy* enemy, const struct Map* current_map);
+void enemy_update_all(const EnemyArrays* enemies, int begin, int end, const struct Map* current_map, float delta_time);
 
 /**
  * Check if enemy is colliding with the player.
@@ -2,8 +2,10 @@
 #define GAME_H
 
 #include "gengine.h"
+#include "state.h"
 #include "raylib.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 typedef struct CoinCollectorGame CoinCollectorGame;
 
@@ -40,4 +42,46 @@ void* game_get_data(CoinCollectorGame* game);
  */
 void game_set_engine(CoinCollectorGame* game, GameEngine* engine);
 
+/**
+ * Seed the game's random stream, overriding the engine's seed. Gives
+ * parallel sessions different streams. Call before the init callback.
+ * @param game The game
+ * @param seed Seed value
+ */
+void game_set_seed(CoinCollectorGame* game, uint64_t seed);
+
+/**
+ * Choose whether the game loads high scores from HIGH_SCORE_FILENAME and
+ * saves new ones there. On by default. Only one game may do so: extra
+ * sessions tick in parallel and would write the file at the same time.
+ * Call before the init callback.
+ * @param game The game
+ * @param persist true to use the file, false to keep scores in memory only
+ */
+void game_set_persist_high_scores(CoinCollectorGame* game, bool persist);
+
+/**
+ * Get the game's simulation state. Valid between the init and cleanup
+ * callbacks; intended for tools such as the benchmark that script a session.
+ * @param game The game
+ * @return The game state, or NULL if not initialized
+ */
+GameState* game_get_state(CoinCollectorGame* game);
+
+/**
+ * Get the entry highlighted on the mode select screen, which the game
+ * keeps outside its state.
+ * @param game The game
+ * @return 0 for 2D, 1 for 3D
+ */
+int game_get_selected_mode(CoinCollectorGame* game);
+
+/**
+ * Set the entry highlighted on the mode select screen, for example to
+ * mirror a server's.
+ * @param game The game
+ * @param selected_mode 0 for 2D, 1 for 3D
+ */
+void game_set_selected_mode(CoinCollectorGame* game, int selected_mode);
+
 #endif
@@ -2,28 +2,58 @@
 #define GENGINE_H
 
 #include "raylib.h"
+#include "jobs.h"
+#include "input.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
+
+#define GENGINE_DEFAULT_TICK_RATE 60
+#define GENGINE_DEFAULT_KEYFRAME_INTERVAL 600  // Ticks between replay keyframes
+#define GENGINE_MAX_SESSIONS 256  // Game sessions per engine, counting the registered game
 
 typedef struct GameEngine GameEngine;
 typedef struct GameInterface GameInterface;
 
 typedef struct {
     void (*init)(void* game_data);
-    void (*update)(void* game_data, float delta_time);
+    void (*update)(void* game_data, const InputFrame* input, float delta_time);  // Each press reaches one tick
     void (*render)(void* game_data);
     void (*cleanup)(void* game_data);
     void (*handle_input)(void* game_data, int key);
+    void (*publish)(void* game_data);  // Snapshot sim state for render (optional)
+    // Write the simulation state to buffer and return its size, or only the size
+    // if buffer is NULL or too small (optional, enables replay keyframes)
+    size_t (*save_state)(void* game_data, void* buffer, size_t capacity);
+    bool (*load_state)(void* game_data, const void* buffer, size_t size);  // Undo save_state (optional)
 } GameCallbacks;
 
+// Fills an extra session's input for its next tick; tick counts that session's ticks from 0
+typedef void (*SessionInputCallback)(void* user_data, int tick, InputFrame* input);
+
 typedef struct {
     int screen_width;
     int screen_height;
     const char* window_title;
     int target_fps;
+    int tick_rate;    // Fixed simulation ticks per second (0 = default)
+    bool headless;    // Run without window, audio or rendering, uncapped
+    bool paced;       // Headless: run ticks at tick_rate in real time instead of uncapped
+    int max_frames;   // Stop after this many frames (0 = run until stopped)
+    bool pipelined;   // Simulate the next frame on a worker thread while rendering
+    const char* trace_path;  // Write a Chrome trace of engine zones here (NULL = off)
+    int job_threads;  // Job system threads, counting the caller (0 = one per CPU)
+    uint64_t seed;    // Gameplay random seed (0 = pick one from the clock)
+    const char* record_path;  // Record every tick's input to this replay file (NULL = off)
+    const char* replay_path;  // Play this replay's input instead of the player's (NULL = off)
+    int keyframe_interval;    // Ticks between full-state keyframes in recordings (0 = default)
+    int replay_start_tick;    // Seek the replay to this tick before the first frame
+    int rollback_ticks;       // Past ticks kept for gengine_request_rollback (0 = off)
 } EngineConfig;
 
 /**
- * Create a new game engine instance.
+ * Create a new game engine instance. When the configuration names a replay
+ * to play, its seed and tick rate replace the configured ones.
  * @param config Engine configuration
  * @return Pointer to created engine, or NULL on failure
  */
@@ -43,8 +73,47 @@ void gengine_destroy(GameEngine* engine);
  */
 void gengine_register_game(GameEngine* engine, GameCallbacks* callbacks, void* game_data);
 
+/**
+ * Add another game session next to the registered game. Sessions share
+ * nothing but the engine's job system; in headless mode every session runs
+ * one tick per frame and the sessions are spread over the job system's
+ * threads, so each update must only touch its own game data. Each session
+ * has its own input frame, filled by read_input before every tick or by
+ * the caller through gengine_get_session_input() between frames; it never
+ * sees the registered game's input. Extra sessions are ignored when
+ * running with a window, which belongs to the registered game alone.
+ * @param engine The engine
+ * @param callbacks Game callbacks structure (publish and render are unused)
+ * @param game_data Game-specific data pointer
+ * @param read_input Fills the session's input before each of its ticks, on a job thread (NULL = none)
+ * @param input_data Passed to read_input
+ * @return true if the session was added, false if the engine is full
+ */
+bool gengine_add_session(GameEngine* engine, GameCallbacks* callbacks, void* game_data,
+                         SessionInputCallback read_input, void* input_data);
+
+/**
+ * Get an extra session's input frame, to fill between frames. Presses
+ * stay latched until the session's next tick consumes them.
+ * @param engine The engine
+ * @param session Session number, 1 for the first added with gengine_add_session()
+ * @return The session's input, or NULL if there is no such session
+ */
+InputFrame* gengine_get_session_input(GameEngine* engine, int session);
+
+/**
+ * Get the number of game sessions, counting the registered game.
+ * @param engine The engine
+ * @return Session count
+ */
+int gengine_get_session_count(GameEngine* engine);
+
 /**
  * Run the engine main loop.
+ * Every frame the engine calls publish (if set) while no update is running,
+ * then render. In pipelined mode the ticks for the next frame run on a
+ * worker thread at the same time as render, so render must only read the
+ * data captured by publish.
  * @param engine The engine to run
  */
 void gengine_run(GameEngine* engine);
@@ -56,6 +125,95 @@ void gengine_run(GameEngine* engine);
  */
 int gengine_get_frame_count(GameEngine* engine);
 
+/**
+ * Get the number of simulation ticks run so far.
+ * Gameplay timers and scores count ticks, which are independent of the
+ * display refresh rate.
+ * @param engine The engine
+ * @return Current tick count
+ */
+int gengine_get_tick_count(GameEngine* engine);
+
+/**
+ * Get the fixed simulation tick rate.
+ * @param engine The engine
+ * @return Ticks per second
+ */
+int gengine_get_tick_rate(GameEngine* engine);
+
+/**
+ * Get the render interpolation factor between the previous and the current
+ * simulation state.
+ * @param engine The engine
+ * @return Blend factor in [0, 1) (0 = previous tick, 1 = current tick)
+ */
+float gengine_get_interpolation_alpha(GameEngine* engine);
+
+/**
+ * Get the CPU time the last frame took to simulate and draw. The wait for
+ * the frame rate cap and vsync is not included, so this shows how much of
+ * the frame budget is actually used.
+ * @param engine The engine
+ * @return Frame work time in milliseconds, or 0 before the first frame
+ */
+float gengine_get_frame_work_ms(GameEngine* engine);
+
+/**
+ * Get the time available for one frame at the target frame rate.
+ * @param engine The engine
+ * @return Frame budget in milliseconds
+ */
+float gengine_get_frame_budget_ms(GameEngine* engine);
+
+/**
+ * Move replay playback to a tick before the next frame. The engine
+ * restores the nearest keyframe at or before the tick and simulates only
+ * the rest. Seeking back needs a keyframe, which recordings only hold for
+ * games with save_state and load_state callbacks.
+ * @param engine The engine
+ * @param tick Replay tick to continue from
+ * @return true if the seek was queued, false if not playing a replay or while recording
+ */
+bool gengine_request_seek(GameEngine* engine, int tick);
+
+/**
+ * Rewind the registered game to the start of a recent tick before the next
+ * frame and simulate it forward to the current tick again, for example
+ * when a late remote input arrives for a tick that already ran. Needs
+ * EngineConfig.rollback_ticks and the save_state and load_state callbacks;
+ * extra sessions are not rewound.
+ * @param engine The engine
+ * @param tick First tick to simulate again, among the last rollback_ticks ticks
+ * @param inputs Inputs for ticks tick, tick + 1, ... (NULL keeps the ones they ran with)
+ * @param input_count Number of inputs, the rest keep the ones they ran with
+ * @return true if the rollback was queued, false if the tick is not held or
+ *         while recording or playing a replay
+ */
+bool gengine_request_rollback(GameEngine* engine, int tick, const InputFrame* inputs, int input_count);
+
+/**
+ * Get the bytes the rollback ring uses to hold past states.
+ * @param engine The engine
+ * @return Size in bytes, or 0 if rollback is off
+ */
+size_t gengine_get_rollback_bytes(GameEngine* engine);
+
+/**
+ * Get the gameplay random seed. When the configuration asks for none, a
+ * seed is picked at creation and printed so the run can be reproduced.
+ * @param engine The engine
+ * @return Seed value
+ */
+uint64_t gengine_get_seed(GameEngine* engine);
+
+/**
+ * Get the engine's job system. Available from the init callback until the
+ * run loop returns.
+ * @param engine The engine
+ * @return The job system, or NULL if none is running
+ */
+JobSystem* gengine_get_jobs(GameEngine* engine);
+
 /**
  * Check if the engine is currently running.
  * @param engine The engine
@@ -64,7 +222,22 @@ int gengine_get_frame_count(GameEngine* engine);
 bool gengine_is_running(GameEngine* engine);
 
 /**
- * Request the engine to stop.
+ * Check if the engine is running in headless mode.
+ * @param engine The engine
+ * @return true if headless, false otherwise
+ */
+bool gengine_is_headless(GameEngine* engine);
+
+/**
+ * Get the simulated frames per second measured by the last headless run.
+ * @param engine The engine
+ * @return Simulated frames per second, or 0 if not available
+ */
+double gengine_get_simulated_fps(GameEngine* engine);
+
+/**
+ * Request the engine to stop. Safe to call from a game's update, also
+ * when it runs on the simulation worker; the loop ends after the frame.
  * @param engine The engine
  */
 void gengine_stop(GameEngine* engine);
@@ -6,16 +6,18 @@
 #define MAX_HIGH_SCORES 10
 #define HIGH_SCORE_FILENAME "highscores.txt"
 #define MAX_NAME_LENGTH 20
+#define HIGH_SCORE_FILE_TIME_SCALE 60.0f  // Steps per second of times in the file, the tick rate scores were first kept at
 
 typedef struct {
     char name[MAX_NAME_LENGTH + 1];
-    int frame_count;
+    float completion_time;  // Seconds from the start of play to the last coin
     int coins_collected;
     float health_remaining;
 } HighScore;
 
 /**
- * Load high scores from file.
+ * Load high scores from file. Times are kept in the file in steps of
+ * 1/HIGH_SCORE_FILE_TIME_SCALE seconds, whatever the tick rate.
  * @param high_scores Array to store high scores
  * @param count Output parameter for number of high scores loaded
  */
@@ -29,17 +31,18 @@ void highscore_load(HighScore* high_scores, int* count);
 void highscore_save(const HighScore* high_scores, int count);
 
 /**
- * Add a new high score if it qualifies.
+ * Add a new high score if it qualifies. The file is not touched; save with
+ * highscore_save().
  * @param high_scores Array of high scores (will be modified)
  * @param count Current count (will be updated)
  * @param name Player name
- * @param frame_count Completion frame count
+ * @param completion_time Completion time in seconds
  * @param coins_collected Number of coins collected
  * @param health_remaining Remaining health
  * @return true if high score was added, false otherwise
  */
 bool highscore_add(HighScore* high_scores, int* count, const char* name, 
-                   int frame_count, int coins_collected, float health_remaining);
+                   float completion_time, int coins_collected, float health_remaining);
 
 #endif
 
@@ -0,0 +1,81 @@
+#ifndef INPUT_H
+#define INPUT_H
+
+#include "raylib.h"
+#include <stdint.h>
+#include <stdbool.h>
+
+#define INPUT_MAX_CHARS 32
+
+/**
+ * Game actions. Keys that do the same thing (W and the up arrow, say) map
+ * to one button, so the simulation never sees raw key codes.
+ */
+typedef enum {
+    INPUT_BUTTON_UP           = 1 << 0,   // W / up arrow
+    INPUT_BUTTON_DOWN         = 1 << 1,   // S / down arrow
+    INPUT_BUTTON_LEFT         = 1 << 2,   // A / left arrow
+    INPUT_BUTTON_RIGHT        = 1 << 3,   // D / right arrow
+    INPUT_BUTTON_TURN_LEFT    = 1 << 4,   // Q
+    INPUT_BUTTON_TURN_RIGHT   = 1 << 5,   // E
+    INPUT_BUTTON_FIRE         = 1 << 6,   // Space
+    INPUT_BUTTON_CONFIRM      = 1 << 7,   // Enter
+    INPUT_BUTTON_BACK         = 1 << 8,   // Escape
+    INPUT_BUTTON_HIGH_SCORES  = 1 << 9,   // H
+    INPUT_BUTTON_ERASE        = 1 << 10,  // Backspace
+    INPUT_BUTTON_MOUSE_LEFT   = 1 << 11,
+    INPUT_BUTTON_MOUSE_RIGHT  = 1 << 12
+} InputButton;
+
+/**
+ * Everything the simulation reads from the player for one tick. Filled
+ * once per frame from the window, or from a script, recording or network
+ * packet, and handed to the update callback.
+ */
+typedef struct {
+    uint32_t held;            // InputButton bits down at the last poll
+    uint32_t pressed;         // InputButton bits that went down since the last tick
+    Vector2 mouse_position;
+    int chars[INPUT_MAX_CHARS];  // Characters typed since the last tick
+    int char_count;
+} InputFrame;
+
+/**
+ * Reset an input frame to no input.
+ * @param frame The frame
+ */
+void input_clear(InputFrame* frame);
+
+/**
+ * Sample the window's keyboard and mouse into a frame. Held buttons and the
+ * mouse position are replaced; presses and typed characters are added to
+ * the ones not yet consumed, so none are lost on frames that run no tick.
+ * Must be called on the thread that owns the window.
+ * @param frame The frame to update
+ */
+void input_poll(InputFrame* frame);
+
+/**
+ * Drop the presses and typed characters after a tick has seen them. Held
+ * buttons and the mouse position carry over to the next tick.
+ * @param frame The frame
+ */
+void input_consume(InputFrame* frame);
+
+/**
+ * Check if any of the given buttons is held down.
+ * @param frame The frame
+ * @param buttons One or more InputButton bits
+ * @return true if any is down, false otherwise
+ */
+bool input_is_down(const InputFrame* frame, uint32_t buttons);
+
+/**
+ * Check if any of the given buttons was pressed since the last tick.
+ * @param frame The frame
+ * @param buttons One or more InputButton bits
+ * @return true if any was pressed, false otherwise
+ */
+bool input_was_pressed(const InputFrame* frame, uint32_t buttons);
+
+#endif
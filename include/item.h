@@ -12,7 +12,23 @@ typedef enum {
     ITEM_TYPE_COUNT
 } ItemType;
 
-typedef struct Item Item;
+/**
+ * An item in the world. Plain data, so a temporary item can live on the
+ * stack (see item_make()) instead of the heap.
+ */
+typedef struct Item {
+    ItemType type;
+    Vector2 position;
+    bool collected;
+} Item;
+
+/**
+ * Build an item by value, without allocating.
+ * @param type Type of item
+ * @param position Position of the item
+ * @return The item
+ */
+Item item_make(ItemType type, Vector2 position);
 
 /**
  * Create a new item instance.
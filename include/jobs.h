@@ -0,0 +1,83 @@
+#ifndef JOBS_H
+#define JOBS_H
+
+#include <stdbool.h>
+
+#define JOBS_MAX_THREADS 64
+#define JOBS_DEQUE_CAPACITY 256
+
+typedef struct JobSystem JobSystem;
+
+typedef void (*JobFunction)(void* user_data);
+typedef void (*JobRangeFunction)(void* user_data, int begin, int end);
+
+/**
+ * A set of jobs that can be waited on together. Initialize with
+ * JOB_GROUP_INIT or jobs_group_init() before the first jobs_group_run().
+ */
+typedef struct {
+    volatile int pending;
+} JobGroup;
+
+#define JOB_GROUP_INIT {0}
+
+/**
+ * Create a work-stealing job system. Every worker owns a deque: it pushes
+ * and pops its own jobs at the bottom, and idle workers steal from the top
+ * of the others. Threads outside the pool share one extra deque and help
+ * run jobs while they wait.
+ * @param thread_count Threads that run jobs, counting the calling thread
+ *                     (0 = one per CPU, 1 = run everything on the caller)
+ * @return Pointer to created job system, or NULL on failure
+ */
+JobSystem* jobs_create(int thread_count);
+
+/**
+ * Stop the workers and destroy the job system. No jobs may be pending.
+ * @param jobs The job system to destroy
+ */
+void jobs_destroy(JobSystem* jobs);
+
+/**
+ * Get the number of threads that run jobs, counting the caller.
+ * @param jobs The job system
+ * @return Thread count (1 if jobs is NULL)
+ */
+int jobs_get_thread_count(const JobSystem* jobs);
+
+/**
+ * Reset a job group to empty.
+ * @param group The group
+ */
+void jobs_group_init(JobGroup* group);
+
+/**
+ * Queue a job as part of a group.
+ * @param jobs The job system (NULL runs the job immediately)
+ * @param group The group to add the job to
+ * @param function Job entry point
+ * @param user_data Argument passed to the job
+ */
+void jobs_group_run(JobSystem* jobs, JobGroup* group, JobFunction function, void* user_data);
+
+/**
+ * Wait until every job in the group has finished, running queued jobs on
+ * the calling thread in the meantime.
+ * @param jobs The job system
+ * @param group The group
+ */
+void jobs_group_wait(JobSystem* jobs, JobGroup* group);
+
+/**
+ * Run function over [0, count) split into chunks of at least grain items,
+ * and return when all chunks are done. Runs inline when the range fits in
+ * one chunk or the job system has no workers.
+ * @param jobs The job system (may be NULL)
+ * @param count Number of items
+ * @param grain Minimum items per chunk
+ * @param function Called with user_data and a [begin, end) sub-range
+ * @param user_data Argument passed to every chunk
+ */
+void jobs_parallel_for(JobSystem* jobs, int count, int grain, JobRangeFunction function, void* user_data);
+
+#endif
@@ -2,28 +2,29 @@
 #define MAP_H
 
 #include "raylib.h"
+#include "arena.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
 typedef struct Map Map;
 typedef struct Wall Wall;
 typedef struct Exit Exit;
 typedef struct Entrance Entrance;
 typedef struct Coin Coin;
-typedef struct Obstacle Obstacle;
 
-#define MAX_WALLS 20
-#define MAX_EXITS 4
-#define MAX_ENTRANCES 4
-#define MAX_COINS 10
-#define MAX_OBSTACLES 5
 #define NUM_MAPS 4
+#define MAP_ARENA_SIZE (16 * 1024)  // Starting storage per map; grows when contents outgrow it
 
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
+#define WORLD_WIDTH 800   // Play area size in world units, independent of the window
+#define WORLD_HEIGHT 600
 #define EXIT_WIDTH 60.0f
 #define EXIT_HEIGHT 60.0f
 #define PLAYER_RADIUS 25.0f
 #define OBSTACLE_RADIUS 20.0f
+#define MAP_GRID_CELL_SIZE (2.0f * PLAYER_RADIUS)  // A player-sized query touches at most 2x2 cells
+#define MAP_GRID_MAX_CELLS 16384  // Cells double in size until the grid fits in this many
+#define MAP_GRID_MIN_WALLS 32     // Circle and box queries scan rooms with fewer walls directly
 
 struct Wall {
     Rectangle rect;
@@ -44,26 +45,85 @@ struct Coin {
     bool collected;
 };
 
-struct Obstacle {
-    Vector2 position;
-    Vector2 velocity;
-    float radius;
-    int direction_change_timer;
-    Color color;
-};
+/**
+ * Edges of a map's walls as parallel arrays, a copy of the Wall array kept
+ * for the batch kernels in collide.h.
+ */
+typedef struct {
+    float* left;
+    float* top;
+    float* right;   // x + width
+    float* bottom;  // y + height
+} WallBounds;
+
+/**
+ * Uniform grid over a map's walls. Every wall is listed in each cell its
+ * rectangle touches, and the grid covers the world and every wall, so a
+ * query only visits the cells around it. Entries of a cell are contiguous
+ * and keep a copy of the wall's edges for the kernels in collide.h.
+ */
+typedef struct {
+    float origin_x;       // World position of the top-left corner of cell (0, 0)
+    float origin_y;
+    float cell_size;
+    float inverse_cell_size;  // 1 / cell_size, so finding a cell takes no division
+    int columns;
+    int rows;
+    int32_t* cell_start;  // columns * rows + 1 offsets; cell c holds entries [cell_start[c], cell_start[c + 1])
+    int32_t* wall_index;  // Wall of each entry
+    float* left;          // Edges of each entry's wall
+    float* top;
+    float* right;
+    float* bottom;
+    int cell_count;
+    int cell_capacity;    // Offsets the cell_start array holds
+    int entry_count;
+    int entry_capacity;
+    bool current;         // false once walls change, until map_build_wall_grid()
+} WallGrid;
+
+/**
+ * A map's obstacles, as parallel arrays so the per-tick update is one pass
+ * over each array (see enemy_update_all()). Every obstacle has radius
+ * OBSTACLE_RADIUS.
+ */
+typedef struct {
+    int count;
+    int capacity;
+    float* x;
+    float* y;
+    float* velocity_x;  // World units per second
+    float* velocity_y;
+    float* previous_x;  // Position at the start of the current tick
+    float* previous_y;
+    float* direction_change_timer;  // Seconds since the last direction change
+    Color* color;
+} ObstacleSet;
 
+/**
+ * A room. Every array lives in the map's arena and doubles in capacity when
+ * full; when the arena runs out, the contents move to one twice the size.
+ * Walls, exits, entrances and coin positions are fixed once a map is built;
+ * only coin collection and obstacles change during play.
+ */
 struct Map {
     int map_id;
-    Wall walls[MAX_WALLS];
+    Arena* arena;
+    Wall* walls;
     int wall_count;
-    Exit exits[MAX_EXITS];
+    int wall_capacity;
+    WallBounds wall_bounds;  // Same walls, written together with walls
+    WallGrid wall_grid;      // Walls by grid cell, built after the walls are added
+    Exit* exits;
     int exit_count;
-    Entrance entrances[MAX_ENTRANCES];
+    int exit_capacity;
+    Entrance* entrances;
     int entrance_count;
-    Coin coins[MAX_COINS];
+    int entrance_capacity;
+    Coin* coins;
     int coin_count;
-    Obstacle obstacles[MAX_OBSTACLES];
-    int obstacle_count;
+    int coin_capacity;
+    ObstacleSet obstacles;
     Color bg_color;
 };
 
@@ -81,12 +141,79 @@ Map* map_create(int map_id);
 void map_destroy(Map* map);
 
 /**
- * Initialize a map with the specified ID.
+ * Initialize a map with the specified ID. Creates the map's arena on first
+ * use and reuses it after that, so initializing the same room again does
+ * not allocate. IDs without a built-in layout give an empty room.
  * @param map The map to initialize
  * @param map_id The ID of the map
  */
 void map_init(Map* map, int map_id);
 
+/**
+ * Free the storage of a map that was initialized in place rather than
+ * created with map_create(). The map must be initialized again before use.
+ * @param map The map
+ */
+void map_release(Map* map);
+
+/**
+ * Remove everything from a map, keeping its ID, colour and storage.
+ * @param map The map
+ */
+void map_clear(Map* map);
+
+/**
+ * Make one map a copy of another, reusing the destination's storage when it
+ * is big enough.
+ * @param dest Map to overwrite; zeroed or initialized
+ * @param source Map to copy
+ * @return true on success, false if storage could not grow (dest is then empty)
+ */
+bool map_copy(Map* dest, const Map* source);
+
+/**
+ * Get the size of a map's snapshot: the parts that change during play,
+ * which are coin collection and the obstacles.
+ * @param map The map
+ * @return Size in bytes
+ */
+size_t map_snapshot_size(const Map* map);
+
+/**
+ * Write a map's snapshot.
+ * @param map The map
+ * @param buffer Destination, map_snapshot_size() bytes
+ * @return Bytes written
+ */
+size_t map_snapshot(const Map* map, void* buffer);
+
+/**
+ * Check a map snapshot against a map: the coins must match the map's.
+ * @param map The map it would be restored into
+ * @param buffer Snapshot data
+ * @param size Bytes available
+ * @return Size of the snapshot in bytes, or 0 if it is invalid for this map
+ */
+size_t map_check_snapshot(const Map* map, const void* buffer, size_t size);
+
+/**
+ * Make room for a snapshot's obstacles, so map_restore() cannot fail.
+ * Allocates only if the snapshot holds more obstacles than the map has
+ * room for now.
+ * @param map The map
+ * @param buffer Snapshot that passed map_check_snapshot()
+ * @return true on success, false if the storage could not grow (the map is then unchanged)
+ */
+bool map_reserve_snapshot(Map* map, const void* buffer);
+
+/**
+ * Restore a map from a snapshot that passed map_check_snapshot(), after
+ * map_reserve_snapshot() made room for it.
+ * @param map The map
+ * @param buffer Snapshot data
+ */
+void map_restore(Map* map, const void* buffer);
+
 /**
  * Check if a circle collides with a rectangle.
  * @param circle_pos Center position of the circle
@@ -96,6 +223,27 @@ void map_init(Map* map, int map_id);
  */
 bool map_check_circle_rect_collision(Vector2 circle_pos, float radius, Rectangle rect);
 
+/**
+ * Check if a circle collides with any of a map's walls.
+ * @param map The map to check against
+ * @param circle_pos Center position of the circle
+ * @param radius Radius of the circle
+ * @return true if collision detected, false otherwise
+ */
+bool map_check_circle_wall_collision(const Map* map, Vector2 circle_pos, float radius);
+
+/**
+ * Check if an axis-aligned box overlaps any of a map's walls. Touching
+ * edges do not count, as with CheckCollisionRecs().
+ * @param map The map to check against
+ * @param left Left edge of the box
+ * @param top Top edge of the box
+ * @param right Right edge of the box
+ * @param bottom Bottom edge of the box
+ * @return true if they overlap, false otherwise
+ */
+bool map_check_box_wall_collision(const Map* map, float left, float top, float right, float bottom);
+
 /**
  * Check if a position is valid for spawning (not colliding with walls).
  * @param position Position to check
@@ -149,10 +297,17 @@ const Coin* map_get_coins(const Map* map, int* count);
 /**
  * Get obstacles from a map.
  * @param map The map to query
- * @param count Output parameter for obstacle count
- * @return Pointer to obstacles array
+ * @return Pointer to the map's obstacles
  */
-const Obstacle* map_get_obstacles(const Map* map, int* count);
+const ObstacleSet* map_get_obstacles(const Map* map);
+
+/**
+ * Get an obstacle's position.
+ * @param map The map containing the obstacle
+ * @param index Index of the obstacle
+ * @return Current position, or (0, 0) if invalid index
+ */
+Vector2 map_get_obstacle_position(const Map* map, int index);
 
 /**
  * Get the background color of a map.
@@ -177,21 +332,70 @@ int map_get_id(const Map* map);
 Coin* map_get_coin_mutable(Map* map, int index);
 
 /**
- * Get a mutable reference to an obstacle in a map.
+ * Record every obstacle's current position as its previous simulation state.
+ * Call at the start of each tick and when a map becomes current.
+ * @param map The map to update
+ */
+void map_sync_previous_positions(Map* map);
+
+/**
+ * Get an obstacle's position blended between the previous and current tick.
  * @param map The map containing the obstacle
  * @param index Index of the obstacle
- * @return Pointer to obstacle, or NULL if invalid index
+ * @param alpha Blend factor (0 = previous tick, 1 = current tick)
+ * @return Interpolated position for rendering, or (0, 0) if invalid index
  */
-Obstacle* map_get_obstacle_mutable(Map* map, int index);
+Vector2 map_get_obstacle_interpolated_position(const Map* map, int index, float alpha);
 
 /**
- * Update an obstacle's state in a map.
+ * Move an obstacle.
  * @param map The map containing the obstacle
  * @param index Index of the obstacle
- * @param new_position New position of the obstacle
- * @param new_velocity New velocity of the obstacle
- * @param new_timer New direction change timer value
+ * @param position New position
+ * @param snap true to also make it the previous position, so it is drawn there without blending
+ */
+void map_set_obstacle_position(Map* map, int index, Vector2 position, bool snap);
+
+/**
+ * Add an obstacle to a map.
+ * @param map The map
+ * @param position Spawn position
+ * @param velocity Initial velocity in world units per second
+ * @param color Obstacle color
+ * @return true on success, false if storage could not grow
+ */
+bool map_add_obstacle(Map* map, Vector2 position, Vector2 velocity, Color color);
+
+/**
+ * Add a wall to a map. Wall queries scan every wall from then until
+ * map_build_wall_grid() is called.
+ * @param map The map
+ * @param rect The wall's rectangle
+ * @return true on success, false if storage could not grow
+ */
+bool map_add_wall(Map* map, Rectangle rect);
+
+/**
+ * Index a map's walls by grid cell. map_init() does this for the built-in
+ * rooms; call it again after adding walls.
+ * @param map The map
+ * @return true on success, false if storage could not grow
+ */
+bool map_build_wall_grid(Map* map);
+
+/**
+ * Get a map's wall grid.
+ * @param map The map
+ * @return The grid, or NULL if walls were added since it was built
+ */
+const WallGrid* map_get_wall_grid(const Map* map);
+
+/**
+ * Add an uncollected coin to a map.
+ * @param map The map
+ * @param position Coin position
+ * @return true on success, false if storage could not grow
  */
-void map_update_obstacle(Map* map, int index, Vector2 new_position, Vector2 new_velocity, int new_timer);
+bool map_add_coin(Map* map, Vector2 position);
 
 #endif
@@ -0,0 +1,173 @@
+#ifndef MEM_H
+#define MEM_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Heap allocation for the engine and game. These behave like malloc,
+ * calloc, realloc and free, and charge every block to a subsystem tag so
+ * live bytes, high-water marks and allocations per frame can be read per
+ * subsystem. Every block starts on a 64-byte cache line. Built with
+ * -DGENGINE_CHECK_FRAME_ALLOCS=ON they also abort with an error when
+ * called on a thread that is inside a frame, between mem_frame_begin() and
+ * mem_frame_end(), which proves a steady-state frame never touches the
+ * heap. The engine runs each game update, publish and
+ * render callback as a frame. Per-tick scratch memory belongs in an Arena.
+ */
+
+/**
+ * Subsystem a heap block is charged to.
+ */
+typedef enum {
+    MEM_TAG_ENGINE,
+    MEM_TAG_THREAD,
+    MEM_TAG_JOBS,
+    MEM_TAG_GAME,
+    MEM_TAG_MAP,
+    MEM_TAG_STATE,
+    MEM_TAG_ROLLBACK,
+    MEM_TAG_REPLAY,
+    MEM_TAG_NET,
+    MEM_TAG_TRACE,
+    MEM_TAG_AUDIO,
+    MEM_TAG_COUNT
+} MemTag;
+
+/**
+ * Kind of raylib handle whose loads and unloads are counted.
+ */
+typedef enum {
+    MEM_RESOURCE_SOUND,
+    MEM_RESOURCE_TEXTURE,
+    MEM_RESOURCE_RENDER_TEXTURE,
+    MEM_RESOURCE_COUNT
+} MemResource;
+
+/**
+ * Heap use of one subsystem, or of all of them.
+ */
+typedef struct {
+    int64_t live_bytes;
+    int64_t peak_bytes;         // Highest live_bytes since start
+    int64_t live_allocations;
+    int64_t total_allocations;  // Every alloc, calloc and realloc since start
+    int64_t frame_allocations;  // In the last frame closed by mem_next_frame()
+    int64_t frame_bytes;
+} MemStats;
+
+/**
+ * Handles of one raylib resource kind.
+ */
+typedef struct {
+    int64_t live;
+    int64_t peak;   // Most loaded at once
+    int64_t total;  // Loads since start
+} MemResourceStats;
+
+/**
+ * Allocate memory.
+ * @param tag Subsystem to charge
+ * @param size Bytes wanted
+ * @return Pointer to the memory, or NULL on failure
+ */
+void* mem_alloc(MemTag tag, size_t size);
+
+/**
+ * Allocate zeroed memory for an array.
+ * @param tag Subsystem to charge
+ * @param count Number of elements
+ * @param size Size of one element
+ * @return Pointer to the memory, or NULL on failure
+ */
+void* mem_calloc(MemTag tag, size_t count, size_t size);
+
+/**
+ * Resize memory from mem_alloc(), keeping its contents.
+ * @param tag Subsystem to charge; the block moves to it
+ * @param pointer Memory to resize, or NULL to allocate
+ * @param size New size in bytes
+ * @return Pointer to the resized memory, or NULL on failure (the old memory is kept)
+ */
+void* mem_realloc(MemTag tag, void* pointer, size_t size);
+
+/**
+ * Release memory from mem_alloc(), mem_calloc() or mem_realloc().
+ * @param pointer Memory to release, or NULL
+ */
+void mem_free(void* pointer);
+
+/**
+ * Mark the calling thread as running a frame. Frames nest.
+ */
+void mem_frame_begin(void);
+
+/**
+ * Mark the end of a frame begun on the calling thread.
+ */
+void mem_frame_end(void);
+
+/**
+ * Close the per-frame counters: allocations since the previous call become
+ * the last frame's. The engine calls this once per frame.
+ */
+void mem_next_frame(void);
+
+/**
+ * Count a raylib handle being loaded or unloaded.
+ * @param resource Kind of handle
+ * @param delta +1 after a load, -1 after an unload
+ */
+void mem_track_resource(MemResource resource, int delta);
+
+/**
+ * Get a subsystem's heap use.
+ * @param tag The subsystem
+ * @param stats Filled with the numbers
+ */
+void mem_get_stats(MemTag tag, MemStats* stats);
+
+/**
+ * Get the heap use of all subsystems together. The peak is the highest
+ * total seen, not the sum of the subsystem peaks.
+ * @param stats Filled with the numbers
+ */
+void mem_get_total_stats(MemStats* stats);
+
+/**
+ * Get the handle counts of a raylib resource kind.
+ * @param resource Kind of handle
+ * @param stats Filled with the numbers
+ */
+void mem_get_resource_stats(MemResource resource, MemResourceStats* stats);
+
+/**
+ * Get a subsystem's display name.
+ * @param tag The subsystem
+ * @return Name, or "?" for an unknown tag
+ */
+const char* mem_get_tag_name(MemTag tag);
+
+/**
+ * Get a resource kind's display name.
+ * @param resource Kind of handle
+ * @return Plural name, or "?" for an unknown kind
+ */
+const char* mem_get_resource_name(MemResource resource);
+
+/**
+ * Print live and peak use of every subsystem and resource kind that was
+ * ever used.
+ */
+void mem_print_report(void);
+
+/**
+ * Print an error for every subsystem still holding heap memory and every
+ * resource kind with handles still loaded. Call after everything is torn
+ * down.
+ * @return true if nothing leaked, false otherwise
+ */
+bool mem_check_leaks(void);
+
+#endif
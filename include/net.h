@@ -0,0 +1,96 @@
+#ifndef NET_H
+#define NET_H
+
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NET_MAX_PACKET_SIZE 1200  // Stays under common path MTUs, so packets are never fragmented
+
+typedef struct NetSocket NetSocket;
+
+// IPv4 endpoint, both fields in host byte order
+typedef struct {
+    uint32_t host;
+    uint16_t port;
+} NetAddress;
+
+/**
+ * Start the platform's socket library. Must be called before any other
+ * net function; calls nest with net_shutdown().
+ * @return true on success, false otherwise
+ */
+bool net_init(void);
+
+/**
+ * Release the platform's socket library.
+ */
+void net_shutdown(void);
+
+/**
+ * Look up an IPv4 address by name or dotted quad.
+ * @param host Host name, e.g. "localhost" or "127.0.0.1"
+ * @param port Port number
+ * @param address Set to the resolved address
+ * @return true on success, false if the host is unknown
+ */
+bool net_resolve(const char* host, uint16_t port, NetAddress* address);
+
+/**
+ * Parse "host:port" into an address.
+ * @param text Host and port
+ * @param address Set to the resolved address
+ * @return true on success, false if the text is malformed or the host unknown
+ */
+bool net_parse_address(const char* text, NetAddress* address);
+
+/**
+ * Format an address as "a.b.c.d:port".
+ * @param address The address
+ * @param buffer Destination
+ * @param size Size of the destination, at least 22 bytes for the longest address
+ */
+void net_address_to_string(const NetAddress* address, char* buffer, size_t size);
+
+/**
+ * Compare two addresses.
+ * @param a First address
+ * @param b Second address
+ * @return true if host and port match
+ */
+bool net_address_equal(const NetAddress* a, const NetAddress* b);
+
+/**
+ * Open a non-blocking UDP socket bound to a port on all interfaces.
+ * @param port Port to bind, or 0 for any free port
+ * @return Pointer to created socket, or NULL on failure
+ */
+NetSocket* net_socket_open(uint16_t port);
+
+/**
+ * Close a socket.
+ * @param socket The socket
+ */
+void net_socket_close(NetSocket* socket);
+
+/**
+ * Send one datagram.
+ * @param socket The socket
+ * @param address Destination
+ * @param data Payload
+ * @param size Payload size, at most NET_MAX_PACKET_SIZE
+ * @return true if the datagram was handed to the network, false otherwise
+ */
+bool net_socket_send(NetSocket* socket, const NetAddress* address, const void* data, size_t size);
+
+/**
+ * Receive one waiting datagram without blocking.
+ * @param socket The socket
+ * @param address Set to the sender
+ * @param buffer Destination
+ * @param capacity Size of the destination; longer datagrams are cut short
+ * @return Size of the datagram, or -1 if none is waiting
+ */
+int net_socket_receive(NetSocket* socket, NetAddress* address, void* buffer, size_t capacity);
+
+#endif
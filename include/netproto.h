@@ -0,0 +1,219 @@
+#ifndef NETPROTO_H
+#define NETPROTO_H
+
+#include "state.h"
+#include "input.h"
+#include "map.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+#define NETPROTO_DEFAULT_PORT 27960
+#define NETPROTO_HISTORY 64   // Snapshots kept by each side for delta baselines, about 1 s at 60 ticks/s
+#define NETPROTO_NO_TICK (-1)
+#define NETPROTO_FRAGMENT_SIZE 1184  // Snapshot bytes per packet; with its header a packet fits NET_MAX_PACKET_SIZE
+#define NETPROTO_MAX_FRAGMENTS 1024  // Packets per snapshot, so about 1.2 MB
+
+typedef enum {
+    NETPROTO_PACKET_INPUT = 1,    // Client to server: one tick's input and the newest snapshot received
+    NETPROTO_PACKET_SNAPSHOT = 2  // Server to client: part of the world, relative to a snapshot the client acknowledged
+} NetProtoPacketType;
+
+/**
+ * The part of a game state the server sends to clients, quantized: world
+ * positions in 1/8 units, the player's angle in 1/4096 turns, health in
+ * whole points and the invincibility timer in 1/64 seconds. High score
+ * tables are not sent; each client keeps its own. Every coin and obstacle
+ * of the current map and every projectile is included; their arrays are
+ * sized to the counts and owned by the world, so set a world up with
+ * netproto_world_init(), free it with netproto_world_release() and move it
+ * by swapping rather than by assignment.
+ */
+typedef struct {
+    int tick;  // Server tick this world was captured at
+    uint32_t type;
+    uint32_t mode;
+    uint32_t selected_mode;
+    uint32_t map_id;
+    uint32_t frame_count;
+    uint32_t game_start_frame;
+    uint32_t coins_collected;
+    
+    uint32_t player_x;
+    uint32_t player_y;
+    uint32_t player_angle;
+    uint32_t player_health;
+    uint32_t player_invincibility;
+    
+    uint32_t coin_count;
+    uint32_t obstacle_count;
+    uint32_t projectile_count;
+    uint32_t* coin_collected;  // Bit per coin of the current map, 32 coins per word
+    uint32_t* obstacle_x;      // obstacle_count entries each
+    uint32_t* obstacle_y;
+    uint32_t* projectile_x;    // projectile_count entries each
+    uint32_t* projectile_y;
+    
+    uint32_t name_length;
+    uint32_t name[MAX_NAME_LENGTH];
+    
+    uint32_t* storage;        // Holds the arrays above
+    size_t storage_capacity;  // Entries in storage
+} NetWorldState;
+
+/**
+ * One packet's share of an encoded snapshot. Every fragment but the last
+ * carries NETPROTO_FRAGMENT_SIZE bytes.
+ */
+typedef struct {
+    int tick;            // Server tick of the snapshot
+    int baseline_tick;   // Tick the snapshot is relative to (NETPROTO_NO_TICK = none)
+    int index;           // Position of this fragment in the snapshot
+    int count;           // Fragments in the snapshot
+    const uint8_t* data;
+    size_t size;
+} NetSnapshotFragment;
+
+typedef struct {
+    uint32_t sequence;  // Client tick, to drop packets that arrive out of order
+    int ack_tick;       // Newest snapshot tick the client holds (NETPROTO_NO_TICK = none)
+    InputFrame input;
+} NetInputPacket;
+
+/**
+ * Set up an empty world that holds no tick.
+ * @param world World to set up
+ */
+void netproto_world_init(NetWorldState* world);
+
+/**
+ * Free a world's arrays and leave it empty.
+ * @param world World set up with netproto_world_init()
+ */
+void netproto_world_release(NetWorldState* world);
+
+/**
+ * Empty a world and grow its arrays to fit a capture of the largest of a
+ * state's maps with a full projectile pool, so capturing or decoding
+ * worlds of that size never allocates. Call it outside the frame, for
+ * example from an init callback.
+ * @param world World set up with netproto_world_init()
+ * @param state Game state whose maps set the sizes
+ * @return true on success, false if the arrays could not grow
+ */
+bool netproto_world_reserve(NetWorldState* world, GameState* state);
+
+/**
+ * Copy the networked part of a game state, quantized. The world's arrays
+ * grow to fit the current map and projectiles; once they fit, capturing
+ * never allocates.
+ * @param state Game state to read
+ * @param tick Tick to stamp the world with
+ * @param world Destination, set up with netproto_world_init()
+ * @return true on success, false if the arrays could not grow
+ */
+bool netproto_capture(GameState* state, int tick, NetWorldState* world);
+
+/**
+ * Make a game state show a received world. Positions from the previous
+ * call become the previous-tick positions, so rendering interpolates
+ * between the last two snapshots.
+ * @param world Received world
+ * @param state Game state to overwrite
+ * @return true on success, false if the world holds too many projectiles
+ */
+bool netproto_apply(const NetWorldState* world, GameState* state);
+
+/**
+ * Mark every moving object as having stood still since the last tick, for
+ * ticks in which no snapshot arrived.
+ * @param state Game state
+ */
+void netproto_hold(GameState* state);
+
+/**
+ * Get the most bytes netproto_write_snapshot() can take for a world,
+ * whatever the baseline.
+ * @param world World to send
+ * @return Bytes
+ */
+size_t netproto_snapshot_max_size(const NetWorldState* world);
+
+/**
+ * Get the most bytes netproto_write_snapshot() can take for a capture of
+ * the largest of a state's maps with a full projectile pool, to size a
+ * snapshot buffer ahead of the frame.
+ * @param state Game state whose maps set the size
+ * @return Bytes
+ */
+size_t netproto_state_max_size(GameState* state);
+
+/**
+ * Encode a snapshot, to be sent with netproto_write_fragment(). Every
+ * field that equals the baseline costs one bit; changed values are sent as
+ * small, medium or full-width deltas.
+ * @param world World to send
+ * @param baseline World the client acknowledged, or NULL to send everything
+ * @param buffer Destination, netproto_snapshot_max_size() bytes
+ * @param capacity Size of the destination
+ * @return Snapshot size in bytes, or 0 if it does not fit or the baseline is too old
+ */
+size_t netproto_write_snapshot(const NetWorldState* world, const NetWorldState* baseline, uint8_t* buffer, size_t capacity);
+
+/**
+ * Get the number of packets a snapshot is sent in.
+ * @param size Snapshot size in bytes
+ * @return Fragments, or 0 if the snapshot is larger than NETPROTO_MAX_FRAGMENTS allow
+ */
+int netproto_fragment_count(size_t size);
+
+/**
+ * Encode one fragment of a snapshot as a packet.
+ * @param fragment The fragment; data and size are its share of the snapshot
+ * @param buffer Destination, NET_MAX_PACKET_SIZE bytes
+ * @param capacity Size of the destination
+ * @return Packet size in bytes, or 0 if it does not fit
+ */
+size_t netproto_write_fragment(const NetSnapshotFragment* fragment, uint8_t* buffer, size_t capacity);
+
+/**
+ * Decode a snapshot fragment packet. The fragment's data points into the
+ * packet.
+ * @param data Packet
+ * @param size Packet size
+ * @param fragment Destination
+ * @return true if the packet is a well-formed fragment, false otherwise
+ */
+bool netproto_read_fragment(const uint8_t* data, size_t size, NetSnapshotFragment* fragment);
+
+/**
+ * Decode a snapshot put back together from its fragments. The world's
+ * arrays grow to fit it.
+ * @param data Snapshot
+ * @param size Snapshot size
+ * @param tick The snapshot's tick
+ * @param baseline World at the fragments' baseline tick, or NULL if they have none
+ * @param world Destination, set up with netproto_world_init(); not the baseline
+ * @return true on success, false if the snapshot is malformed or the arrays could not grow
+ */
+bool netproto_read_snapshot(const uint8_t* data, size_t size, int tick, const NetWorldState* baseline, NetWorldState* world);
+
+/**
+ * Encode an input packet. Mouse positions are kept to 1/4 pixel.
+ * @param packet Packet to send
+ * @param buffer Destination
+ * @param capacity Size of the destination
+ * @return Packet size in bytes, or 0 if it does not fit
+ */
+size_t netproto_write_input(const NetInputPacket* packet, uint8_t* buffer, size_t capacity);
+
+/**
+ * Decode an input packet.
+ * @param data Packet
+ * @param size Packet size
+ * @param packet Destination
+ * @return true on success, false if the packet is malformed
+ */
+bool netproto_read_input(const uint8_t* data, size_t size, NetInputPacket* packet);
+
+#endif
@@ -2,18 +2,34 @@
 #define PLAYER_H
 
 #include "raylib.h"
+#include "input.h"
 #include <stdbool.h>
+#include <stdint.h>
 
 struct Map;
 
-#define PLAYER_SPEED 5.0f
+#define PLAYER_SPEED 300.0f  // World units per second
 #define PLAYER_RADIUS 25.0f
 #define MAX_HEALTH 100.0f
 #define DAMAGE_PER_HIT 10.0f
-#define INVINCIBILITY_FRAMES 60
+#define INVINCIBILITY_TIME 1.0f  // Seconds after a hit
 
 typedef struct Player Player;
 
+/**
+ * Player fields as stored in a game state snapshot. Plain data with a
+ * fixed layout, so it can be copied as bytes.
+ */
+typedef struct {
+    Vector2 position;
+    Vector2 previous_position;
+    float speed;                // World units per second
+    float health;
+    float max_health;
+    float invincibility_timer;  // Seconds left
+    float angle;
+} PlayerSnapshot;
+
 /**
  * Create a new player instance.
  * @return Pointer to created player, or NULL on failure
@@ -40,6 +56,29 @@ void player_init(Player* player, Vector2 start_position);
  */
 Vector2 player_get_position(const Player* player);
 
+/**
+ * Get the player's position at the start of the current tick.
+ * @param player The player
+ * @return Previous position
+ */
+Vector2 player_get_previous_position(const Player* player);
+
+/**
+ * Get the player's position blended between the previous and current tick.
+ * @param player The player
+ * @param alpha Blend factor (0 = previous tick, 1 = current tick)
+ * @return Interpolated position for rendering
+ */
+Vector2 player_get_interpolated_position(const Player* player, float alpha);
+
+/**
+ * Record the current position as the previous simulation state.
+ * Call at the start of each tick, and after teleporting the player so
+ * rendering does not sweep across the map.
+ * @param player The player
+ */
+void player_sync_previous_position(Player* player);
+
 /**
  * Get the player's current angle (for 3D view).
  * @param player The player
@@ -76,11 +115,11 @@ float player_get_max_health(const Player* player);
 bool player_is_invincible(const Player* player);
 
 /**
- * Get the current invincibility timer value.
+ * Get the time left before the player can be hit again.
  * @param player The player
- * @return Timer value
+ * @return Seconds left
  */
-int player_get_invincibility_timer(const Player* player);
+float player_get_invincibility_timer(const Player* player);
 
 /**
  * Check if the player is alive.
@@ -113,9 +152,11 @@ void player_reset(Player* player, Vector2 start_position);
 /**
  * Update player movement based on input.
  * @param player The player
+ * @param input Player input for this tick
  * @param current_map Current map for collision detection
+ * @param delta_time Tick length in seconds
  */
-void player_update_movement(Player* player, const struct Map* current_map);
+void player_update_movement(Player* player, const InputFrame* input, const struct Map* current_map, float delta_time);
 
 /**
  * Handle player input.
@@ -152,7 +193,22 @@ void player_apply_damage(Player* player, float damage);
 /**
  * Update player state (invincibility timer, etc.).
  * @param player The player
+ * @param delta_time Tick length in seconds
+ */
+void player_update(Player* player, float delta_time);
+
+/**
+ * Copy a player's state into a snapshot record.
+ * @param player The player
+ * @param snapshot Record to fill
+ */
+void player_snapshot(const Player* player, PlayerSnapshot* snapshot);
+
+/**
+ * Replace a player's state with a snapshot record.
+ * @param player The player
+ * @param snapshot Record to restore
  */
-void player_update(Player* player);
+void player_restore(Player* player, const PlayerSnapshot* snapshot);
 
 #endif
@@ -0,0 +1,113 @@
+#ifndef PROFILER_H
+#define PROFILER_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define PROFILER_MAX_ZONES 64
+#define PROFILER_MAX_DEPTH 16
+#define PROFILER_HISTORY 120  // Frames kept in the ring buffer
+
+/**
+ * Timing summary for one zone over the frames in the history ring.
+ */
+typedef struct {
+    const char* name;
+    int parent;      // Enclosing zone, or -1 for top-level zones
+    int depth;       // Nesting depth (0 = top level)
+    double avg_ms;   // Average time per frame
+    double max_ms;   // Worst frame
+    int calls;       // Calls in the most recent frame
+} ProfilerZoneStats;
+
+/*
+ * Scoped zone macros. Each PROFILE_BEGIN must be matched by a PROFILE_END in
+ * the same scope; zones nest. Zone names must be string literals. While a
+ * trace is recording, every zone is also written to it.
+ * Build with -DGENGINE_ENABLE_PROFILER=OFF to compile them out.
+ */
+#ifdef GENGINE_ENABLE_PROFILER
+#define PROFILE_BEGIN(name) \
+    do { \
+        static int profile_zone_id_ = -1; \
+        if (profile_zone_id_ < 0) profile_zone_id_ = profiler_register_zone(name); \
+        profiler_zone_begin(profile_zone_id_); \
+    } while (0)
+#define PROFILE_END() profiler_zone_end()
+#else
+#define PROFILE_BEGIN(name) ((void)0)
+#define PROFILE_END() ((void)0)
+#endif
+
+/**
+ * Initialize the profiler. Call once before any zone is entered.
+ * @return true on success, false otherwise
+ */
+bool profiler_init(void);
+
+/**
+ * Shut down the profiler and release its resources. Registered zones are
+ * kept, so zone ids cached by PROFILE_BEGIN stay valid after a later
+ * profiler_init.
+ */
+void profiler_shutdown(void);
+
+/**
+ * Look up or create a zone by name.
+ * @param name Zone name (must outlive the profiler)
+ * @return Zone id, or -1 if the zone table is full
+ */
+int profiler_register_zone(const char* name);
+
+/**
+ * Enter a zone on the calling thread.
+ * @param zone Zone id from profiler_register_zone
+ */
+void profiler_zone_begin(int zone);
+
+/**
+ * Leave the innermost zone on the calling thread.
+ */
+void profiler_zone_end(void);
+
+/**
+ * Close the current frame and push its zone totals into the history ring.
+ * Call once per frame from the main thread.
+ */
+void profiler_frame_end(void);
+
+/**
+ * Get the number of registered zones.
+ * @return Zone count
+ */
+int profiler_get_zone_count(void);
+
+/**
+ * Get timing statistics for a zone.
+ * @param zone Zone id
+ * @param stats Output statistics
+ * @return true if the zone exists, false otherwise
+ */
+bool profiler_get_zone_stats(int zone, ProfilerZoneStats* stats);
+
+/**
+ * Copy the recorded frame times, oldest first.
+ * @param frame_ms Output array of frame times in milliseconds
+ * @param max_frames Capacity of the output array
+ * @return Number of frames written
+ */
+int profiler_get_frame_times(float* frame_ms, int max_frames);
+
+/**
+ * Check whether the overlay should be drawn.
+ * @return true if visible, false otherwise
+ */
+bool profiler_is_overlay_visible(void);
+
+/**
+ * Show or hide the overlay.
+ * @param visible New visibility
+ */
+void profiler_set_overlay_visible(bool visible);
+
+#endif
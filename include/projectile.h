@@ -3,85 +3,167 @@
 
 #include "raylib.h"
 #include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
 
-#define PROJECTILE_SPEED 10.0f
+#define PROJECTILE_SPEED 600.0f  // World units per second
 #define PROJECTILE_RADIUS 5.0f
 #define PROJECTILE_DAMAGE 20.0f
-#define PROJECTILE_LIFETIME 120  // frames
+#define PROJECTILE_LIFETIME 2.0f  // Seconds
+#define MAX_PROJECTILES 4096      // Live projectiles per pool
+#define PROJECTILE_RECORD_SIZE (sizeof(float) * 7)  // Bytes per projectile in a pool snapshot
 
-typedef struct Projectile Projectile;
+/**
+ * Reference to a projectile that stays safe after the projectile is gone:
+ * the low bits pick a slot and the high bits hold the slot's generation,
+ * which changes every time the slot is reused.
+ */
+typedef struct {
+    uint32_t value;
+} ProjectileHandle;
+
+#define PROJECTILE_HANDLE_NONE ((ProjectileHandle){0})
+
+/**
+ * Every live projectile, as parallel arrays. Live projectiles are packed
+ * into indices [0, count), so the batch update is one straight loop over
+ * each array; removal moves the last projectile into the hole, so order is
+ * not kept. Slots give each projectile a stable identity for handles.
+ * Preallocated at full capacity; nothing here allocates.
+ */
+typedef struct {
+    int count;
+    _Alignas(64) float x[MAX_PROJECTILES];  // Every array starts on a cache line
+    float y[MAX_PROJECTILES];
+    float previous_x[MAX_PROJECTILES];  // Position at the start of the current tick
+    float previous_y[MAX_PROJECTILES];
+    float velocity_x[MAX_PROJECTILES];  // World units per second
+    float velocity_y[MAX_PROJECTILES];
+    float lifetime[MAX_PROJECTILES];    // Seconds left
+    
+    uint16_t slot_of[MAX_PROJECTILES];        // Packed index -> slot
+    uint16_t index_of[MAX_PROJECTILES];       // Slot -> packed index, while the slot is in use
+    uint16_t generation[MAX_PROJECTILES];     // Per slot, never 0
+    uint16_t free_slots[MAX_PROJECTILES];     // Stack of unused slots
+    int free_count;
+} ProjectilePool;
 
 /**
- * Create a new projectile instance.
+ * Empty a pool and reset its handles. Handles from before are not
+ * guaranteed to be recognised as stale; use projectile_pool_clear() on a
+ * pool in use.
+ * @param pool The pool
+ */
+void projectile_pool_init(ProjectilePool* pool);
+
+/**
+ * Remove every projectile. Outstanding handles become stale.
+ * @param pool The pool
+ */
+void projectile_pool_clear(ProjectilePool* pool);
+
+/**
+ * Fire a projectile.
+ * @param pool The pool
  * @param position Starting position
  * @param direction Direction vector (will be normalized)
- * @return Pointer to created projectile, or NULL on failure
+ * @return Handle to the projectile, or PROJECTILE_HANDLE_NONE if the pool is full
  */
-Projectile* projectile_create(Vector2 position, Vector2 direction);
+ProjectileHandle projectile_pool_spawn(ProjectilePool* pool, Vector2 position, Vector2 direction);
 
 /**
- * Destroy a projectile instance.
- * @param projectile The projectile to destroy
+ * Remove the projectile at a packed index by moving the last one into its
+ * place. When iterating, walk the indices downwards so every projectile is
+ * still visited.
+ * @param pool The pool
+ * @param index Packed index
  */
-void projectile_destroy(Projectile* projectile);
+void projectile_pool_remove_at(ProjectilePool* pool, int index);
 
 /**
- * Get the projectile's position.
- * @param projectile The projectile
- * @return Current position
+ * Remove a projectile by handle.
+ * @param pool The pool
+ * @param handle The projectile
+ * @return true if it was removed, false if the handle was stale
  */
-Vector2 projectile_get_position(const Projectile* projectile);
+bool projectile_pool_remove(ProjectilePool* pool, ProjectileHandle handle);
 
 /**
- * Get the projectile's velocity.
- * @param projectile The projectile
- * @return Current velocity
+ * Find a projectile's packed index. Indices change on removal; handles don't.
+ * @param pool The pool
+ * @param handle The projectile
+ * @return Packed index, or -1 if the projectile is gone
  */
-Vector2 projectile_get_velocity(const Projectile* projectile);
+int projectile_pool_find(const ProjectilePool* pool, ProjectileHandle handle);
 
 /**
- * Get the projectile's radius.
- * @param projectile The projectile
- * @return Radius
+ * Get the handle of the projectile at a packed index.
+ * @param pool The pool
+ * @param index Packed index
+ * @return Handle, or PROJECTILE_HANDLE_NONE if the index is out of range
  */
-float projectile_get_radius(const Projectile* projectile);
+ProjectileHandle projectile_pool_get_handle(const ProjectilePool* pool, int index);
 
 /**
- * Get the projectile's damage.
- * @param projectile The projectile
- * @return Damage value
+ * Advance every projectile by one tick, then remove the ones that expired
+ * or left the world.
+ * @param pool The pool
+ * @param delta_time Tick length in seconds
  */
-float projectile_get_damage(const Projectile* projectile);
+void projectile_pool_update(ProjectilePool* pool, float delta_time);
 
 /**
- * Check if the projectile is active (not expired).
- * @param projectile The projectile
- * @return true if active, false otherwise
+ * Get a projectile's position.
+ * @param pool The pool
+ * @param index Packed index
+ * @return Current position
  */
-bool projectile_is_active(const Projectile* projectile);
+Vector2 projectile_pool_get_position(const ProjectilePool* pool, int index);
 
 /**
- * Update projectile position and lifetime.
- * @param projectile The projectile
+ * Get a projectile's position blended between the previous and current tick.
+ * @param pool The pool
+ * @param index Packed index
+ * @param alpha Blend factor (0 = previous tick, 1 = current tick)
+ * @return Interpolated position for rendering
  */
-void projectile_update(Projectile* projectile);
+Vector2 projectile_pool_get_interpolated_position(const ProjectilePool* pool, int index, float alpha);
 
 /**
- * Check if projectile collides with a circle.
- * @param projectile The projectile
+ * Check if a projectile collides with a circle.
+ * @param pool The pool
+ * @param index Packed index
  * @param circle_pos Center of the circle
  * @param circle_radius Radius of the circle
  * @return true if collision detected, false otherwise
  */
-bool projectile_check_circle_collision(const Projectile* projectile, Vector2 circle_pos, float circle_radius);
+bool projectile_pool_check_circle_collision(const ProjectilePool* pool, int index, Vector2 circle_pos, float circle_radius);
 
 /**
- * Check if projectile collides with a rectangle.
- * @param projectile The projectile
+ * Check if a projectile collides with a rectangle.
+ * @param pool The pool
+ * @param index Packed index
  * @param rect Rectangle to check
  * @return true if collision detected, false otherwise
  */
-bool projectile_check_rect_collision(const Projectile* projectile, Rectangle rect);
+bool projectile_pool_check_rect_collision(const ProjectilePool* pool, int index, Rectangle rect);
 
-#endif
+/**
+ * Write the live projectiles as plain bytes: each array in turn, count
+ * entries long, PROJECTILE_RECORD_SIZE bytes per projectile in all.
+ * @param pool The pool
+ * @param out Destination, any alignment
+ * @return Bytes written
+ */
+size_t projectile_pool_snapshot(const ProjectilePool* pool, uint8_t* out);
 
+/**
+ * Replace the projectiles with ones written by projectile_pool_snapshot().
+ * Outstanding handles become stale.
+ * @param pool The pool
+ * @param in Snapshot bytes, any alignment
+ * @param count Number of projectiles in the snapshot, at most MAX_PROJECTILES
+ */
+void projectile_pool_restore(ProjectilePool* pool, const uint8_t* in, int count);
+
+#endif
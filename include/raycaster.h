@@ -8,6 +8,7 @@
 #define RAYCASTER_FOV 60.0f  // Field of view in degrees
 #define RAYCASTER_MAX_DISTANCE 1000.0f
 #define RAYCASTER_WALL_HEIGHT 200.0f
+#define RAYCASTER_REFERENCE_HEIGHT 600.0f  // View height that wall_height is measured against
 
 typedef enum {
     WALL_SIDE_NORTH,
@@ -19,7 +20,7 @@ typedef enum {
 
 typedef struct {
     float distance;
-    float wall_height;
+    float wall_height;    // On-screen height for a RAYCASTER_REFERENCE_HEIGHT tall view
     Color color;
     bool hit;
     Vector2 hit_point;
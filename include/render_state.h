@@ -0,0 +1,67 @@
+#ifndef RENDER_STATE_H
+#define RENDER_STATE_H
+
+#include "raylib.h"
+#include "map.h"
+#include "state.h"
+#include "highscore.h"
+#include <stdbool.h>
+
+/**
+ * Immutable copy of everything the render callback needs for one frame.
+ * The simulation owns GameState and the renderer only ever reads a
+ * RenderState, so both can run at the same time on different threads.
+ */
+typedef struct {
+    GameStateType type;
+    GameMode mode;
+    float time;  // Seconds of ticks so far, for blinking and spinning
+    int selected_mode;
+    int current_map_id;
+    int coins_collected;
+    int total_coins;
+    
+    Vector2 player_position;
+    Vector2 player_previous_position;
+    float player_angle;
+    float player_health;
+    float player_max_health;
+    bool player_invincible;
+    float player_invincibility_timer;
+    
+    Map map;  // Copy of the current map, in storage owned by the render state
+    
+    Vector2 projectile_positions[MAX_PROJECTILES];
+    Vector2 projectile_previous_positions[MAX_PROJECTILES];
+    int projectile_count;
+    
+    HighScore high_scores[MAX_HIGH_SCORES];
+    int high_score_count;
+    char player_name[MAX_NAME_LENGTH + 1];
+    int name_char_count;
+    HighScore pending_score;
+} RenderState;
+
+/**
+ * Copy the renderable parts of a game state into a render state.
+ * @param view Render state to fill
+ * @param state Game state to copy from
+ * @param tick_delta Tick length in seconds, to turn the tick count into time
+ */
+void render_state_capture(RenderState* view, GameState* state, float tick_delta);
+
+/**
+ * Free the storage a render state holds. It can be captured into again.
+ * @param view The render state
+ */
+void render_state_release(RenderState* view);
+
+/**
+ * Get the player's position blended between the previous and current tick.
+ * @param view The render state
+ * @param alpha Blend factor (0 = previous tick, 1 = current tick)
+ * @return Interpolated position
+ */
+Vector2 render_state_get_player_position(const RenderState* view, float alpha);
+
+#endif
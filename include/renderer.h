@@ -4,7 +4,6 @@
 #include "raylib.h"
 #include "map.h"
 #include "highscore.h"
-#include "projectile.h"
 #include <stdbool.h>
 #include <stddef.h>
 
@@ -47,9 +46,9 @@ void renderer_draw_obstacle(Vector2 position, float radius, Color color);
  * Draw the player at the specified position.
  * @param position Position to draw the player
  * @param invincible Whether the player is currently invincible
- * @param invincibility_timer Current invincibility timer value
+ * @param invincibility_timer Seconds of invincibility left
  */
-void renderer_draw_player(Vector2 position, bool invincible, int invincibility_timer);
+void renderer_draw_player(Vector2 position, bool invincible, float invincibility_timer);
 
 /**
  * Draw a health bar.
@@ -88,43 +87,59 @@ void renderer_draw_text(const char* text, int x, int y, int font_size, Color col
  */
 void renderer_draw_fps(int x, int y);
 
+/**
+ * Draw the profiler overlay: per-zone average and worst frame times as a
+ * tree, followed by a graph of recent frame times.
+ * @param x X position
+ * @param y Y position
+ */
+void renderer_draw_profiler_overlay(int x, int y);
+
+/**
+ * Draw the memory overlay: live and peak heap bytes per subsystem, heap
+ * calls in the last frame, and loaded raylib handles.
+ * @param x X position
+ * @param y Y position
+ */
+void renderer_draw_memory_overlay(int x, int y);
+
 /**
  * Draw the start screen.
- * @param frame_count Current frame count
+ * @param time Seconds the game has run, for blinking
  * @param high_scores Array of high scores
  * @param high_score_count Number of high scores
  */
-void renderer_draw_start_screen(int frame_count, const HighScore* high_scores, int high_score_count);
+void renderer_draw_start_screen(float time, const HighScore* high_scores, int high_score_count);
 
 /**
  * Draw the mode selection screen.
- * @param frame_count Current frame count
+ * @param time Seconds the game has run, for blinking
  * @param selected_mode Currently selected mode (0 = 2D, 1 = 3D)
  */
-void renderer_draw_mode_select_screen(int frame_count, int selected_mode);
+void renderer_draw_mode_select_screen(float time, int selected_mode);
 
 /**
  * Draw the end/victory screen.
- * @param frame_count Current frame count
- * @param game_start_frame Frame count when game started
+ * @param time Seconds the game has run, for blinking and spinning
+ * @param completion_time Seconds the finished game took
  * @param total_coins Total number of coins in the game
  * @param health Current health
  * @param max_health Maximum health
  * @param high_scores Array of high scores
  * @param high_score_count Number of high scores
  */
-void renderer_draw_end_screen(int frame_count, int game_start_frame, int total_coins, float health, float max_health, 
+void renderer_draw_end_screen(float time, float completion_time, int total_coins, float health, float max_health, 
                               const HighScore* high_scores, int high_score_count);
 
 /**
  * Draw the name entry screen.
  * @param player_name Current player name being entered
  * @param name_length Length of the current name
- * @param frame_count Current frame count
+ * @param completion_time Completion time in seconds
  * @param coins_collected Number of coins collected
  * @param health_remaining Remaining health
  */
-void renderer_draw_name_entry_screen(const char* player_name, int name_length, int frame_count, int coins_collected, float health_remaining);
+void renderer_draw_name_entry_screen(const char* player_name, int name_length, float completion_time, int coins_collected, float health_remaining);
 
 /**
  * Draw the high scores screen.
@@ -143,18 +158,21 @@ void renderer_draw_projectile(Vector2 position, float radius);
 /**
  * Draw the main game screen.
  * @param current_map Current map being played
- * @param player_position Player's position
+ * @param player_position Player's position (already interpolated)
  * @param invincible Whether player is invincible
- * @param invincibility_timer Current invincibility timer
+ * @param invincibility_timer Seconds of invincibility left
  * @param health Current health
  * @param max_health Maximum health
  * @param current_map_id Current map ID
  * @param coins_collected Number of coins collected
- * @param projectiles Array of projectiles to draw
+ * @param projectile_positions Projectile positions at the current tick
+ * @param projectile_previous_positions Projectile positions at the previous tick
  * @param projectile_count Number of projectiles
+ * @param alpha Interpolation factor between the previous and current tick for moving entities
  */
-void renderer_draw_game_screen(const Map* current_map, Vector2 player_position, bool invincible, int invincibility_timer,
+void renderer_draw_game_screen(const Map* current_map, Vector2 player_position, bool invincible, float invincibility_timer,
                               float health, float max_health, int current_map_id, int coins_collected,
-                              Projectile** projectiles, int projectile_count);
+                              const Vector2* projectile_positions, const Vector2* projectile_previous_positions,
+                              int projectile_count, float alpha);
 
 #endif
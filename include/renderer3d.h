@@ -5,15 +5,95 @@
 #include "map.h"
 #include "player.h"
 #include "raycaster.h"
+#include "jobs.h"
 #include <stdbool.h>
 
+#define RENDERER3D_RAY_GRAIN 32  // Minimum view columns per ray casting job
+
+// Dynamic resolution: the 3D view is cast at a variable number of columns
+// (one ray each) and scaled to the window
+#define RENDERER3D_MIN_COLUMNS 200
+#define RENDERER3D_MAX_COLUMNS 1600
+#define RENDERER3D_COLUMN_STEP 8          // Ray counts are kept to multiples of this
+#define RENDERER3D_SMOOTHING 0.1f         // Weight of the newest frame time
+#define RENDERER3D_DOWNSCALE_LOAD 0.95f   // Shrink the view above this share of the budget
+#define RENDERER3D_UPSCALE_LOAD 0.75f     // Grow the view below this share of the budget
+#define RENDERER3D_DOWNSCALE_FACTOR 0.85f
+#define RENDERER3D_UPSCALE_FACTOR 1.05f
+#define RENDERER3D_RESIZE_COOLDOWN 15     // Frames between resolution changes
+
+/**
+ * Sprites to draw in one 3D frame, with the scratch space used to sort
+ * them. Storage grows with renderer3d_reserve_sprites() and is reused
+ * after that, so drawing never allocates.
+ */
+typedef struct {
+    Vector2* positions;
+    Color* colors;     // Tint of each sprite, for kinds drawn in their own color
+    float* distances;  // Scratch: distance of each visible sprite
+    float* angles;     // Scratch: angle from the view direction
+    int* order;        // Scratch: visible sprites, back to front
+    int count;
+    int capacity;
+} SpriteList;
+
 /**
  * Initialize the 3D renderer.
  */
 void renderer3d_init(void);
 
 /**
- * Render a 3D view using ray casting.
+ * Release the offscreen view target. Call before the window is closed.
+ */
+void renderer3d_shutdown(void);
+
+/**
+ * Limit the ray counts the resolution controller may choose. Passing the
+ * same value twice fixes the resolution.
+ * @param min_columns Fewest rays per frame
+ * @param max_columns Most rays per frame (at most RENDERER3D_MAX_COLUMNS)
+ */
+void renderer3d_set_column_range(int min_columns, int max_columns);
+
+/**
+ * Feed the resolution controller with the last frame's time. The view
+ * shrinks while frames run over budget and grows back while there is
+ * headroom. Call once per frame before renderer3d_render.
+ * @param frame_ms Time the last frame took to produce, in milliseconds
+ * @param budget_ms Frame time to hold, in milliseconds
+ */
+void renderer3d_update_resolution(float frame_ms, float budget_ms);
+
+/**
+ * Get the current number of rays (view columns).
+ * @return Ray count, or 0 before the first 3D frame
+ */
+int renderer3d_get_columns(void);
+
+/**
+ * Set the job system used to cast rays in parallel.
+ * @param jobs The job system, or NULL to cast on the calling thread
+ */
+void renderer3d_set_jobs(JobSystem* jobs);
+
+/**
+ * Make room for at least a number of sprites. Existing sprites are kept.
+ * @param list The sprite list
+ * @param capacity Sprites it must hold
+ * @return true on success, false if storage could not grow
+ */
+bool renderer3d_reserve_sprites(SpriteList* list, int capacity);
+
+/**
+ * Free a sprite list's storage and empty it.
+ * @param list The sprite list
+ */
+void renderer3d_release_sprites(SpriteList* list);
+
+/**
+ * Render a 3D view using ray casting. The view is cast into an offscreen
+ * target at the current ray count and scaled to the window; the HUD is
+ * drawn at window resolution on top.
  * @param map The current map
  * @param player_pos Player position
  * @param player_angle Player viewing angle in radians (0 = right, PI/2 = down)
@@ -21,17 +101,12 @@ void renderer3d_init(void);
  * @param max_health Maximum health
  * @param current_map_id Current map ID
  * @param coins_collected Number of coins collected
- * @param enemy_positions Array of enemy positions
- * @param enemy_count Number of enemies
- * @param enemy_colors Array of enemy colors
- * @param coin_positions Array of coin positions
- * @param coin_count Number of coins
- * @param coin_collected Array indicating which coins are collected
+ * @param enemies Enemies to draw; their scratch space is overwritten
+ * @param coins Coins still to collect; their scratch space is overwritten
  */
 void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
                        float health, float max_health, int current_map_id, int coins_collected,
-                       Vector2* enemy_positions, int enemy_count, Color* enemy_colors,
-                       Vector2* coin_positions, int coin_count, bool* coin_collected);
+                       SpriteList* enemies, SpriteList* coins);
 
 /**
  * Draw a minimap overlay.
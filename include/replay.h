@@ -0,0 +1,142 @@
+#ifndef REPLAY_H
+#define REPLAY_H
+
+#include "input.h"
+#include <stdint.h>
+#include <stdbool.h>
+#include <stddef.h>
+
+#define REPLAY_MOUSE_SCALE 16.0f  // Mouse positions are stored in 1/16 pixel steps
+
+typedef struct ReplayWriter ReplayWriter;
+typedef struct ReplayReader ReplayReader;
+
+/**
+ * Start recording a replay. The seed and tick rate are stored with the
+ * input so playback can rebuild the same session.
+ * @param seed Gameplay random seed of the session
+ * @param tick_rate Fixed simulation ticks per second
+ * @return Pointer to created writer, or NULL on failure
+ */
+ReplayWriter* replay_writer_create(uint64_t seed, int tick_rate);
+
+/**
+ * Destroy a writer without saving.
+ * @param writer The writer
+ */
+void replay_writer_destroy(ReplayWriter* writer);
+
+/**
+ * Append the input of one tick. The mouse position is first rounded to
+ * what the file can hold, in place, so the live session and its playback
+ * see exactly the same input. Call before the tick's update.
+ * @param writer The writer
+ * @param input Input for the tick, rounded in place
+ * @return true on success, false if out of memory
+ */
+bool replay_writer_add_tick(ReplayWriter* writer, InputFrame* input);
+
+/**
+ * Store a full-state keyframe taken before the next tick added, so
+ * playback can start there instead of at the first tick. The input after
+ * a keyframe is encoded independently of the input before it.
+ * @param writer The writer
+ * @param state Saved simulation state
+ * @param size Size of the saved state in bytes
+ * @return true on success, false if out of memory or a keyframe already exists for the tick
+ */
+bool replay_writer_add_keyframe(ReplayWriter* writer, const void* state, size_t size);
+
+/**
+ * Get the number of ticks recorded so far.
+ * @param writer The writer
+ * @return Tick count
+ */
+int replay_writer_get_tick_count(const ReplayWriter* writer);
+
+/**
+ * Write the replay to a file.
+ * @param writer The writer
+ * @param path File to write
+ * @return Bytes written, or 0 on failure
+ */
+long replay_writer_save(ReplayWriter* writer, const char* path);
+
+/**
+ * Open a replay file for playback. The file is mapped into memory rather
+ * than read, so opening and seeking cost the same for any length.
+ * @param path File to read
+ * @return Pointer to created reader, or NULL if the file is missing or invalid
+ */
+ReplayReader* replay_reader_open(const char* path);
+
+/**
+ * Close a reader.
+ * @param reader The reader
+ */
+void replay_reader_destroy(ReplayReader* reader);
+
+/**
+ * Get the gameplay random seed the replay was recorded with.
+ * @param reader The reader
+ * @return Seed value
+ */
+uint64_t replay_reader_get_seed(const ReplayReader* reader);
+
+/**
+ * Get the tick rate the replay was recorded at.
+ * @param reader The reader
+ * @return Ticks per second
+ */
+int replay_reader_get_tick_rate(const ReplayReader* reader);
+
+/**
+ * Get the number of ticks in the replay.
+ * @param reader The reader
+ * @return Tick count
+ */
+int replay_reader_get_tick_count(const ReplayReader* reader);
+
+/**
+ * Read the input of the next tick.
+ * @param reader The reader
+ * @param input Filled with the tick's input
+ * @return true if a tick was read, false at the end of the replay
+ */
+bool replay_reader_next_tick(ReplayReader* reader, InputFrame* input);
+
+/**
+ * Get the number of ticks read so far, which is the tick read next.
+ * @param reader The reader
+ * @return Tick index
+ */
+int replay_reader_get_tick(const ReplayReader* reader);
+
+/**
+ * Get the number of keyframes in the replay.
+ * @param reader The reader
+ * @return Keyframe count
+ */
+int replay_reader_get_keyframe_count(const ReplayReader* reader);
+
+/**
+ * Find the last keyframe at or before a tick without moving playback.
+ * @param reader The reader
+ * @param tick Tick to search for
+ * @return Tick of the keyframe, or -1 if there is none
+ */
+int replay_reader_find_keyframe(const ReplayReader* reader, int tick);
+
+/**
+ * Move playback to the last keyframe at or before a tick. The next tick
+ * read is the keyframe's tick; the caller restores the returned state and
+ * simulates forward from there.
+ * @param reader The reader
+ * @param tick Tick to seek towards
+ * @param state Set to the keyframe's saved state, valid until the reader is destroyed
+ * @param size Set to the size of the saved state in bytes
+ * @return Tick of the keyframe, or -1 if there is none at or before the tick
+ */
+int replay_reader_seek_keyframe(ReplayReader* reader, int tick, const void** state, size_t* size);
+
+#endif
@@ -0,0 +1,45 @@
+#ifndef RNG_H
+#define RNG_H
+
+#include <stdint.h>
+
+/**
+ * Seedable pseudo-random stream (xoshiro128**). Each stream is independent,
+ * so every game session can own one and replay the same values from the
+ * same seed, on any thread.
+ */
+typedef struct {
+    uint32_t s[4];
+} Rng;
+
+/**
+ * Seed a stream. Every seed, including 0, gives a usable stream.
+ * @param rng The stream
+ * @param seed Seed value
+ */
+void rng_seed(Rng* rng, uint64_t seed);
+
+/**
+ * Draw the next 32 random bits.
+ * @param rng The stream
+ * @return Random value
+ */
+uint32_t rng_next(Rng* rng);
+
+/**
+ * Draw an integer in an inclusive range.
+ * @param rng The stream
+ * @param min Smallest value
+ * @param max Largest value
+ * @return Value in [min, max]
+ */
+int rng_range(Rng* rng, int min, int max);
+
+/**
+ * Draw a float in [0, 1).
+ * @param rng The stream
+ * @return Random value
+ */
+float rng_float(Rng* rng);
+
+#endif
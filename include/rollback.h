@@ -0,0 +1,95 @@
+#ifndef ROLLBACK_H
+#define ROLLBACK_H
+
+#include "input.h"
+#include <stdbool.h>
+#include <stddef.h>
+
+typedef struct RollbackBuffer RollbackBuffer;
+
+/**
+ * Create a ring of the last ticks' saved states and inputs. Only the
+ * newest state is kept whole; each older one is stored as the bytes that
+ * differ from the state after it, so a tick typically costs a few hundred
+ * bytes instead of a full snapshot.
+ * @param capacity Number of ticks to keep
+ * @return Pointer to created buffer, or NULL on failure
+ */
+RollbackBuffer* rollback_create(int capacity);
+
+/**
+ * Destroy a rollback buffer.
+ * @param buffer The buffer
+ */
+void rollback_destroy(RollbackBuffer* buffer);
+
+/**
+ * Add the state at the start of a tick together with the tick's input.
+ * When the ring is full the oldest tick is dropped. Stops allocating once
+ * states stop growing and every slot has held a delta of the usual size.
+ * @param buffer The buffer
+ * @param tick Tick number, one past the newest tick held (any tick if empty)
+ * @param state Saved state before the tick runs
+ * @param size Size of the state in bytes
+ * @param input Input the tick runs with
+ * @return true on success, false if the tick is out of sequence or out of memory
+ */
+bool rollback_push(RollbackBuffer* buffer, int tick, const void* state, size_t size, const InputFrame* input);
+
+/**
+ * Rebuild the state at the start of a past tick and drop every newer tick,
+ * so that tick becomes the newest one held. Does not allocate.
+ * @param buffer The buffer
+ * @param tick Tick to go back to
+ * @param size Set to the size of the state in bytes
+ * @return The saved state, valid until the next push, or NULL if the tick is not held
+ */
+const void* rollback_rewind(RollbackBuffer* buffer, int tick, size_t* size);
+
+/**
+ * Drop every tick held, for example after the simulation jumped.
+ * @param buffer The buffer
+ */
+void rollback_clear(RollbackBuffer* buffer);
+
+/**
+ * Get the input a held tick ran with.
+ * @param buffer The buffer
+ * @param tick Tick number
+ * @return The input, or NULL if the tick is not held
+ */
+const InputFrame* rollback_get_input(const RollbackBuffer* buffer, int tick);
+
+/**
+ * Replace the input of a held tick, for example when a late remote input
+ * arrives for it.
+ * @param buffer The buffer
+ * @param tick Tick number
+ * @param input New input
+ * @return true on success, false if the tick is not held
+ */
+bool rollback_set_input(RollbackBuffer* buffer, int tick, const InputFrame* input);
+
+/**
+ * Get the oldest tick held.
+ * @param buffer The buffer
+ * @return Tick number, or -1 if empty
+ */
+int rollback_get_oldest_tick(const RollbackBuffer* buffer);
+
+/**
+ * Get the newest tick held.
+ * @param buffer The buffer
+ * @return Tick number, or -1 if empty
+ */
+int rollback_get_newest_tick(const RollbackBuffer* buffer);
+
+/**
+ * Get the bytes used to hold the states: the newest whole, the rest as
+ * deltas.
+ * @param buffer The buffer
+ * @return Size in bytes
+ */
+size_t rollback_get_state_bytes(const RollbackBuffer* buffer);
+
+#endif
@@ -0,0 +1,47 @@
+#ifndef SERVER_H
+#define SERVER_H
+
+#include "gengine.h"
+#include "game.h"
+#include <stdint.h>
+
+#define SERVER_MAX_CLIENTS 8
+
+typedef struct GameServer GameServer;
+
+/**
+ * Create an authoritative server around a game. The server owns the game's
+ * state: each tick it reads the clients' input packets, runs the game with
+ * the input of the longest-connected client (the others watch), and sends
+ * every client a snapshot delta-encoded against the last one that client
+ * acknowledged. Run it headless with EngineConfig.paced so ticks follow
+ * real time.
+ * @param game The game to serve
+ * @param port UDP port to listen on
+ * @return Pointer to created server, or NULL on failure
+ */
+GameServer* server_create(CoinCollectorGame* game, uint16_t port);
+
+/**
+ * Destroy a server. The game is not destroyed.
+ * @param server The server
+ */
+void server_destroy(GameServer* server);
+
+/**
+ * Get the callbacks to register with the engine in place of the game's.
+ * Every few seconds and at cleanup the server prints its tick cost and
+ * each client's bandwidth.
+ * @param server The server
+ * @return Callbacks that wrap the game's
+ */
+GameCallbacks server_get_callbacks(GameServer* server);
+
+/**
+ * Get the data pointer to register together with server_get_callbacks().
+ * @param server The server
+ * @return Server data pointer
+ */
+void* server_get_data(GameServer* server);
+
+#endif
@@ -0,0 +1,111 @@
+#ifndef SPATIAL_H
+#define SPATIAL_H
+
+#include "arena.h"
+#include "raylib.h"
+#include <stdbool.h>
+#include <stddef.h>
+#include <stdint.h>
+
+/*
+ * Uniform grid over moving entities, rebuilt from their positions every
+ * tick. Entities are bucketed by the cell holding their center; positions
+ * outside the bounds go to the nearest edge cell, so nothing is ever left
+ * out. A query walks the cells a box touches and hands back the entity
+ * indices one row of cells at a time, as a view into the grid: no query
+ * allocates. Results are candidates; the caller still runs the exact test.
+ */
+
+/**
+ * Entities by cell. The arrays come from the arena passed to
+ * spatial_hash_build() and are gone when it resets.
+ */
+typedef struct {
+    float origin_x;           // Top-left corner of cell (0, 0)
+    float origin_y;
+    float cell_size;
+    float inverse_cell_size;
+    int columns;
+    int rows;
+    const int32_t* cell_start;  // columns * rows + 1 offsets into index, row by row
+    const int32_t* index;       // Entity indices, sorted by cell
+    int count;                  // Entities in the grid
+} SpatialHash;
+
+/**
+ * Entity indices from consecutive cells of one row.
+ */
+typedef struct {
+    const int32_t* index;
+    int count;
+} SpatialSpan;
+
+/**
+ * Cursor over the cells a query touches. Fill with spatial_query_box() or
+ * spatial_query_radius(), then drain with spatial_query_next().
+ */
+typedef struct {
+    const SpatialHash* hash;
+    int first_column;
+    int last_column;
+    int row;          // Next row to visit
+    int last_row;
+} SpatialQuery;
+
+/**
+ * Bucket entities by cell. Positions are read as x[i * stride], y[i *
+ * stride] in bytes, so the coordinates may be parallel arrays or fields of
+ * an array of structs.
+ * @param hash Hash to fill
+ * @param arena Arena for the cell table and index
+ * @param bounds Area the cells cover
+ * @param cell_size Edge length of a cell; wider than the query diameters keeps queries to 2x2 cells
+ * @param x First entity's X coordinate
+ * @param y First entity's Y coordinate
+ * @param stride Bytes from one entity's coordinate to the next
+ * @param count Number of entities
+ * @return true on success, false if the arena is full (the hash is then empty)
+ */
+bool spatial_hash_build(SpatialHash* hash, Arena* arena, Rectangle bounds, float cell_size,
+                        const float* x, const float* y, size_t stride, int count);
+
+/**
+ * Get the most arena memory spatial_hash_build() takes for a number of
+ * entities, so an arena can be sized ahead of the tick that builds.
+ * @param bounds Area the cells cover
+ * @param cell_size Edge length of a cell
+ * @param count Number of entities
+ * @return Bytes, alignment padding included
+ */
+size_t spatial_hash_scratch_bytes(Rectangle bounds, float cell_size, int count);
+
+/**
+ * Start a query for entities whose centers may lie in a box.
+ * @param hash The hash
+ * @param left Left edge of the box
+ * @param top Top edge of the box
+ * @param right Right edge of the box
+ * @param bottom Bottom edge of the box
+ * @param query Cursor to start
+ */
+void spatial_query_box(const SpatialHash* hash, float left, float top, float right, float bottom, SpatialQuery* query);
+
+/**
+ * Start a query for entities whose centers may lie within a distance of a
+ * point. For circle-versus-circle tests pass the sum of both radii.
+ * @param hash The hash
+ * @param center Center of the query
+ * @param radius Distance from the center
+ * @param query Cursor to start
+ */
+void spatial_query_radius(const SpatialHash* hash, Vector2 center, float radius, SpatialQuery* query);
+
+/**
+ * Get the next run of candidates.
+ * @param query The cursor
+ * @param span Set to the candidates' indices
+ * @return true if span was set, false once the query is done
+ */
+bool spatial_query_next(SpatialQuery* query, SpatialSpan* span);
+
+#endif
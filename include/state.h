@@ -6,11 +6,14 @@
 #include "player.h"
 #include "highscore.h"
 #include "projectile.h"
+#include "rng.h"
 #include <stdbool.h>
+#include <stdint.h>
+#include <stddef.h>
 
 #define NUM_MAPS 4
 #define MAX_NAME_LENGTH 20
-#define MAX_PROJECTILES 50
+#define STATE_SNAPSHOT_VERSION 7  // Bump whenever the snapshot layout changes
 
 typedef enum {
     GAME_STATE_START,
@@ -246,27 +249,20 @@ bool state_all_coins_collected(const GameState* state);
 void state_reset_coins(GameState* state);
 
 /**
- * Add a projectile to the state.
+ * Fire a projectile.
  * @param state The state
- * @param projectile The projectile to add
- * @return true if added successfully, false if array is full
+ * @param position Starting position
+ * @param direction Direction vector (will be normalized)
+ * @return Handle to the projectile, or PROJECTILE_HANDLE_NONE if the pool is full
  */
-bool state_add_projectile(GameState* state, Projectile* projectile);
+ProjectileHandle state_spawn_projectile(GameState* state, Vector2 position, Vector2 direction);
 
 /**
- * Get all projectiles.
+ * Get the projectile pool.
  * @param state The state
- * @param count Output parameter for projectile count
- * @return Pointer to projectiles array
+ * @return The pool, or NULL if state is NULL
  */
-Projectile** state_get_projectiles(GameState* state, int* count);
-
-/**
- * Remove a projectile at the given index.
- * @param state The state
- * @param index Index of projectile to remove
- */
-void state_remove_projectile(GameState* state, int index);
+ProjectilePool* state_get_projectiles(GameState* state);
 
 /**
  * Clear all projectiles.
@@ -277,22 +273,23 @@ void state_clear_projectiles(GameState* state);
 /**
  * Get the projectile cooldown.
  * @param state The state
- * @return Current cooldown value
+ * @return Seconds until the player can shoot again
  */
-int state_get_projectile_cooldown(const GameState* state);
+float state_get_projectile_cooldown(const GameState* state);
 
 /**
  * Set the projectile cooldown.
  * @param state The state
- * @param cooldown Cooldown value
+ * @param cooldown Seconds until the player can shoot again
  */
-void state_set_projectile_cooldown(GameState* state, int cooldown);
+void state_set_projectile_cooldown(GameState* state, float cooldown);
 
 /**
- * Decrement the projectile cooldown.
+ * Count the projectile cooldown down by one tick.
  * @param state The state
+ * @param delta_time Tick length in seconds
  */
-void state_decrement_projectile_cooldown(GameState* state);
+void state_decrement_projectile_cooldown(GameState* state, float delta_time);
 
 /**
  * Get the current game mode.
@@ -308,5 +305,69 @@ GameMode state_get_game_mode(const GameState* state);
  */
 void state_set_game_mode(GameState* state, GameMode mode);
 
+/**
+ * Restart the gameplay random stream from a seed. The same seed and the
+ * same inputs replay the same session.
+ * @param state The state
+ * @param seed Seed value
+ */
+void state_set_seed(GameState* state, uint64_t seed);
+
+/**
+ * Get the seed the random stream was last started from.
+ * @param state The state
+ * @return Seed value
+ */
+uint64_t state_get_seed(const GameState* state);
+
+/**
+ * Get the gameplay random stream. Only the thread updating the state may
+ * draw from it.
+ * @param state The state
+ * @return The random stream
+ */
+Rng* state_get_rng(GameState* state);
+
+/**
+ * Get the size of a snapshot of the state as it is now.
+ * @param state The state
+ * @return Size in bytes
+ */
+size_t state_snapshot_size(const GameState* state);
+
+/**
+ * Get the largest size a snapshot can have while the maps keep their
+ * current contents, for buffers allocated once.
+ * @param state The game state
+ * @return Size in bytes
+ */
+size_t state_snapshot_max_size(const GameState* state);
+
+/**
+ * Copy the whole game into a buffer: maps, player, projectiles, scores and
+ * the random stream. The snapshot holds no pointers and starts with a
+ * versioned header, so it can be kept, cloned or written to disk. Values
+ * are stored in the machine's byte order. Does not allocate.
+ * @param state The state
+ * @param buffer Destination, any alignment
+ * @param capacity Size of the buffer in bytes
+ * @return Bytes written, or 0 if the buffer is smaller than state_snapshot_size()
+ */
+size_t state_snapshot(const GameState* state, void* buffer, size_t capacity);
+
+/**
+ * Replace the whole game with a snapshot. The state is left unchanged if
+ * the snapshot is rejected, also when a map's storage could not grow.
+ * Allocates only to fit a map with more obstacles than it has room for,
+ * which restoring a recent snapshot of the same game only needs if the
+ * maps were rebuilt since (after the player died). Projectile handles
+ * taken before the restore become stale.
+ * @param state The state, created with state_create
+ * @param buffer Snapshot written by state_snapshot
+ * @param size Size of the snapshot in bytes
+ * @return true on success, false if the snapshot is invalid or from another version
+ */
+bool state_restore(GameState* state, const void* buffer, size_t size);
+
 #endif
 
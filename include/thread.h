@@ -0,0 +1,107 @@
+#ifndef THREAD_H
+#define THREAD_H
+
+#include <stdbool.h>
+
+typedef struct Thread Thread;
+typedef struct ThreadMutex ThreadMutex;
+typedef struct ThreadCond ThreadCond;
+
+typedef void (*ThreadFunction)(void* user_data);
+
+/**
+ * Start a new thread.
+ * @param function Entry point
+ * @param user_data Argument passed to the entry point
+ * @return Pointer to created thread, or NULL on failure
+ */
+Thread* thread_create(ThreadFunction function, void* user_data);
+
+/**
+ * Wait for a thread to finish and release it.
+ * @param thread The thread to join
+ */
+void thread_join(Thread* thread);
+
+/**
+ * Create a mutex.
+ * @return Pointer to created mutex, or NULL on failure
+ */
+ThreadMutex* thread_mutex_create(void);
+
+/**
+ * Destroy a mutex.
+ * @param mutex The mutex to destroy
+ */
+void thread_mutex_destroy(ThreadMutex* mutex);
+
+/**
+ * Lock a mutex.
+ * @param mutex The mutex
+ */
+void thread_mutex_lock(ThreadMutex* mutex);
+
+/**
+ * Unlock a mutex.
+ * @param mutex The mutex
+ */
+void thread_mutex_unlock(ThreadMutex* mutex);
+
+/**
+ * Create a condition variable.
+ * @return Pointer to created condition variable, or NULL on failure
+ */
+ThreadCond* thread_cond_create(void);
+
+/**
+ * Destroy a condition variable.
+ * @param cond The condition variable to destroy
+ */
+void thread_cond_destroy(ThreadCond* cond);
+
+/**
+ * Atomically release the mutex and wait for a signal, then re-acquire it.
+ * @param cond The condition variable
+ * @param mutex The locked mutex
+ */
+void thread_cond_wait(ThreadCond* cond, ThreadMutex* mutex);
+
+/**
+ * Wake one waiting thread.
+ * @param cond The condition variable
+ */
+void thread_cond_signal(ThreadCond* cond);
+
+/**
+ * Wake all waiting threads.
+ * @param cond The condition variable
+ */
+void thread_cond_broadcast(ThreadCond* cond);
+
+/**
+ * Get the number of logical CPUs available to the process.
+ * @return CPU count (at least 1)
+ */
+int thread_get_cpu_count(void);
+
+/**
+ * Give up the rest of the calling thread's time slice.
+ */
+void thread_yield(void);
+
+/**
+ * Atomically add to an integer.
+ * @param value The integer
+ * @param delta Amount to add
+ * @return The new value
+ */
+int thread_atomic_add(volatile int* value, int delta);
+
+/**
+ * Atomically read an integer.
+ * @param value The integer
+ * @return Current value
+ */
+int thread_atomic_load(volatile int* value);
+
+#endif
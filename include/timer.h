@@ -0,0 +1,20 @@
+#ifndef TIMER_H
+#define TIMER_H
+
+#include <stdint.h>
+
+/**
+ * Get a monotonic timestamp.
+ * Independent of the window system, so it also works in headless mode.
+ * @return Current time in nanoseconds since an unspecified epoch
+ */
+uint64_t timer_now_ns(void);
+
+/**
+ * Block the calling thread for about the given time. The operating system
+ * may oversleep by its scheduler granularity.
+ * @param duration_ns Time to sleep in nanoseconds
+ */
+void timer_sleep_ns(uint64_t duration_ns);
+
+#endif
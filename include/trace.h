@@ -0,0 +1,64 @@
+#ifndef TRACE_H
+#define TRACE_H
+
+#include <stdbool.h>
+#include <stdint.h>
+
+#define TRACE_RING_CAPACITY 16384
+#define TRACE_FILE_BUFFER_SIZE 65536
+
+/*
+ * Streaming Chrome trace-event writer. Load the output in chrome://tracing
+ * or https://ui.perfetto.dev. Events are queued in a fixed ring and
+ * formatted on a background thread, so recording one costs a mutex and a
+ * copy. When the writer falls behind, new events are dropped and counted
+ * rather than blocking the caller.
+ *
+ * Names are stored by pointer and must outlive the trace (string literals).
+ */
+
+/**
+ * Open a trace file and start the writer thread.
+ * @param path Output file path
+ * @return true on success, false otherwise
+ */
+bool trace_start(const char* path);
+
+/**
+ * Flush all queued events, stop the writer and close the file.
+ */
+void trace_stop(void);
+
+/**
+ * Check whether a trace is being recorded.
+ * @return true if recording, false otherwise
+ */
+bool trace_is_enabled(void);
+
+/**
+ * Wake the writer thread to drain queued events. Call once per frame.
+ */
+void trace_flush(void);
+
+/**
+ * Name the calling thread in the trace.
+ * @param name Thread name
+ */
+void trace_set_thread_name(const char* name);
+
+/**
+ * Record a completed zone on the calling thread.
+ * @param name Zone name
+ * @param start_ns Start time from timer_now_ns()
+ * @param duration_ns Duration in nanoseconds
+ */
+void trace_complete(const char* name, uint64_t start_ns, uint64_t duration_ns);
+
+/**
+ * Record the current value of a counter.
+ * @param name Counter name
+ * @param value Counter value
+ */
+void trace_counter(const char* name, double value);
+
+#endif
@@ -0,0 +1,74 @@
+#include "../include/arena.h"
+#include "../include/mem.h"
+#include <stdint.h>
+#include <string.h>
+
+struct Arena {
+    uint8_t* base;
+    size_t capacity;
+    size_t used;
+    size_t peak;
+};
+
+Arena* arena_create(MemTag tag, size_t capacity) {
+    if (capacity == 0) return NULL;
+    
+    Arena* arena = (Arena*)mem_alloc(tag, sizeof(Arena));
+    if (!arena) return NULL;
+    
+    arena->base = (uint8_t*)mem_alloc(tag, capacity);
+    if (!arena->base) {
+        mem_free(arena);
+        return NULL;
+    }
+    arena->capacity = capacity;
+    arena->used = 0;
+    arena->peak = 0;
+    return arena;
+}
+
+void arena_destroy(Arena* arena) {
+    if (!arena) return;
+    mem_free(arena->base);
+    mem_free(arena);
+}
+
+void* arena_alloc(Arena* arena, size_t size) {
+    if (!arena) return NULL;
+    
+    // The block itself comes from mem_alloc, so aligning offsets aligns addresses
+    size_t start = (arena->used + ARENA_ALIGNMENT - 1) & ~(size_t)(ARENA_ALIGNMENT - 1);
+    if (start > arena->capacity || size > arena->capacity - start) return NULL;
+    
+    arena->used = start + size;
+    if (arena->used > arena->peak) {
+        arena->peak = arena->used;
+    }
+    return arena->base + start;
+}
+
+void* arena_calloc(Arena* arena, size_t count, size_t size) {
+    if (size != 0 && count > SIZE_MAX / size) return NULL;
+    void* memory = arena_alloc(arena, count * size);
+    if (memory) {
+        memset(memory, 0, count * size);
+    }
+    return memory;
+}
+
+void arena_reset(Arena* arena) {
+    if (!arena) return;
+    arena->used = 0;
+}
+
+size_t arena_get_used(const Arena* arena) {
+    return arena ? arena->used : 0;
+}
+
+size_t arena_get_peak(const Arena* arena) {
+    return arena ? arena->peak : 0;
+}
+
+size_t arena_get_capacity(const Arena* arena) {
+    return arena ? arena->capacity : 0;
+}
@@ -1,32 +1,47 @@
 #include "../include/audio.h"
+#include "../include/mem.h"
 #include "raylib.h"
 #include <math.h>
-#include <stdlib.h>
+#include <stdio.h>
 
 #define SAMPLE_RATE 44100
-#define BLIP_DURATION 0.1f
+#define AUDIO_VOICES_PER_SOUND 4  // Overlapping plays of one sound; past this the oldest is cut off
+
+static bool audio_muted = false;
+static bool audio_ready = false;
 
 static const struct {
     float frequency;
     float duration;
     float volume;
-} SOUND_PRESETS[] = {
+} SOUND_PRESETS[AUDIO_SOUND_COUNT] = {
     [AUDIO_SOUND_COIN] = {800.0f, 0.1f, 0.5f},
     [AUDIO_SOUND_DAMAGE] = {200.0f, 0.15f, 0.6f},
     [AUDIO_SOUND_VICTORY] = {523.25f, 0.1f, 0.4f},
     [AUDIO_SOUND_MENU] = {400.0f, 0.08f, 0.3f}
 };
 
+// One preset, synthesized once. Voice 0 owns the samples; the others are
+// aliases sharing them, so a sound can overlap itself without another upload.
+typedef struct {
+    Sound voices[AUDIO_VOICES_PER_SOUND];
+    int voice_count;  // Voices loaded (0 = the preset failed to load)
+    int next_voice;   // Oldest started voice, reused when all are playing
+} AudioBankEntry;
+
+static AudioBankEntry g_bank[AUDIO_SOUND_COUNT];
+
 /**
  * Generate a simple blip sound using a sine wave.
  * @param frequency Sound frequency in Hz
  * @param duration Sound duration in seconds
  * @param volume Sound volume (0.0 to 1.0)
- * @return Generated wave structure
+ * @return Generated wave structure; free its data with mem_free(), or NULL data on failure
  */
 static Wave generate_blip(float frequency, float duration, float volume) {
     int sampleCount = (int)(SAMPLE_RATE * duration);
-    float* samples = (float*)malloc(sampleCount * sizeof(float) * 2);
+    float* samples = (float*)mem_alloc(MEM_TAG_AUDIO, sampleCount * sizeof(float) * 2);
+    if (!samples) return (Wave){0};
     
     for (int i = 0; i < sampleCount; i++) {
         float t = (float)i / SAMPLE_RATE;
@@ -53,27 +68,96 @@ static Wave generate_blip(float frequency, float duration, float volume) {
     return wave;
 }
 
+/**
+ * Synthesize a preset and load its voices.
+ * @param entry Bank entry to fill
+ * @param sound_type The preset
+ * @return true if at least the first voice loaded, false otherwise
+ */
+static bool audio_load_sound(AudioBankEntry* entry, AudioSoundType sound_type) {
+    entry->voice_count = 0;
+    entry->next_voice = 0;
+    
+    Wave wave = generate_blip(SOUND_PRESETS[sound_type].frequency, SOUND_PRESETS[sound_type].duration,
+                              SOUND_PRESETS[sound_type].volume);
+    if (!wave.data) return false;
+    
+    // The samples are copied into the audio buffer, so the wave can go now
+    Sound sound = LoadSoundFromWave(wave);
+    mem_free(wave.data);
+    if (sound.frameCount == 0) return false;
+    
+    entry->voices[entry->voice_count++] = sound;
+    mem_track_resource(MEM_RESOURCE_SOUND, 1);
+    while (entry->voice_count < AUDIO_VOICES_PER_SOUND) {
+        Sound alias = LoadSoundAlias(sound);
+        if (alias.frameCount == 0) break;
+        entry->voices[entry->voice_count++] = alias;
+        mem_track_resource(MEM_RESOURCE_SOUND, 1);
+    }
+    return true;
+}
+
+/**
+ * Unload a preset's voices, aliases before the sound that owns the samples.
+ * @param entry Bank entry to empty
+ */
+static void audio_unload_sound(AudioBankEntry* entry) {
+    for (int i = entry->voice_count - 1; i >= 0; i--) {
+        if (i > 0) {
+            UnloadSoundAlias(entry->voices[i]);
+        } else {
+            UnloadSound(entry->voices[i]);
+        }
+        mem_track_resource(MEM_RESOURCE_SOUND, -1);
+    }
+    entry->voice_count = 0;
+}
+
 bool audio_init(void) {
     InitAudioDevice();
-    return IsAudioDeviceReady();
+    if (!IsAudioDeviceReady()) return false;
+    
+    for (int i = 0; i < AUDIO_SOUND_COUNT; i++) {
+        if (!audio_load_sound(&g_bank[i], (AudioSoundType)i)) {
+            printf("Error: Could not load sound %d\n", i);
+        }
+    }
+    audio_ready = true;
+    return true;
 }
 
 void audio_cleanup(void) {
+    if (audio_ready) {
+        for (int i = 0; i < AUDIO_SOUND_COUNT; i++) {
+            audio_unload_sound(&g_bank[i]);
+        }
+        audio_ready = false;
+    }
     CloseAudioDevice();
 }
 
-void audio_play_sound(AudioSoundType sound_type) {
-    if (sound_type < 0 || sound_type >= sizeof(SOUND_PRESETS) / sizeof(SOUND_PRESETS[0])) {
-        return;
-    }
-    
-    const float* preset = (const float*)&SOUND_PRESETS[sound_type];
-    audio_play_blip(preset[0], preset[1], preset[2]);
+void audio_set_muted(bool muted) {
+    audio_muted = muted;
 }
 
-void audio_play_blip(float frequency, float duration, float volume) {
-    Wave wave = generate_blip(frequency, duration, volume);
-    Sound sound = LoadSoundFromWave(wave);
-    PlaySound(sound);
-    UnloadWave(wave);
+void audio_play_sound(AudioSoundType sound_type) {
+    // Nothing to play through in headless runs
+    if (audio_muted || !audio_ready) return;
+    if (sound_type < 0 || sound_type >= AUDIO_SOUND_COUNT) return;
+    
+    AudioBankEntry* entry = &g_bank[sound_type];
+    if (entry->voice_count == 0) return;
+    
+    // Take the first idle voice; if all are busy, restart the oldest
+    int voice = entry->next_voice;
+    for (int i = 0; i < entry->voice_count; i++) {
+        int candidate = (entry->next_voice + i) % entry->voice_count;
+        if (!IsSoundPlaying(entry->voices[candidate])) {
+            voice = candidate;
+            break;
+        }
+    }
+    PlaySound(entry->voices[voice]);
+    entry->next_voice = (voice + 1) % entry->voice_count;
 }
@@ -0,0 +1,356 @@
+#include "../include/client.h"
+#include "../include/netproto.h"
+#include "../include/timer.h"
+#include "../include/profiler.h"
+#include "../include/mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define CLIENT_TIMEOUT_NS 5000000000ull
+#define CLIENT_REPORT_INTERVAL_NS 5000000000ull
+
+struct GameClient {
+    CoinCollectorGame* game;
+    GameCallbacks callbacks;  // The game's own
+    void* game_data;
+    GameEngine* engine;
+    NetSocket* socket;
+    NetAddress server;
+    
+    NetWorldState history[NETPROTO_HISTORY];  // Received worlds, by tick modulo NETPROTO_HISTORY
+    NetWorldState incoming;  // Decoded into, then swapped into history
+    int newest_tick;     // Newest world received (NETPROTO_NO_TICK = none)
+    uint32_t sequence;   // Last input packet sent
+    uint64_t start_ns;   // First tick, for the connect timeout
+    uint64_t last_snapshot_ns;
+    uint8_t packet[NET_MAX_PACKET_SIZE];
+    
+    // Snapshot being put back together from its fragments
+    int assembly_tick;           // NETPROTO_NO_TICK = none
+    int assembly_baseline_tick;
+    int assembly_count;          // Fragments in the snapshot
+    int assembly_received;       // Distinct fragments so far
+    size_t assembly_size;        // Known once the last fragment is in
+    uint8_t* assembly;           // NETPROTO_FRAGMENT_SIZE bytes per fragment
+    size_t assembly_capacity;
+    bool fragment_received[NETPROTO_MAX_FRAGMENTS];
+    
+    // Traffic since the last report
+    uint64_t report_ns;
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    int snapshots_received;
+    int full_snapshots;
+    int dropped_snapshots;  // Late, or relative to a world no longer held
+};
+
+GameClient* client_create(CoinCollectorGame* game, GameEngine* engine, const NetAddress* server) {
+    if (!game || !server) return NULL;
+    
+    GameClient* client = (GameClient*)mem_alloc(MEM_TAG_NET, sizeof(GameClient));
+    if (!client) return NULL;
+    memset(client, 0, sizeof(GameClient));
+    
+    client->socket = net_socket_open(0);
+    if (!client->socket) {
+        mem_free(client);
+        return NULL;
+    }
+    
+    client->game = game;
+    client->callbacks = game_get_callbacks(game);
+    client->game_data = game_get_data(game);
+    client->engine = engine;
+    client->server = *server;
+    client->newest_tick = NETPROTO_NO_TICK;
+    client->assembly_tick = NETPROTO_NO_TICK;
+    for (int i = 0; i < NETPROTO_HISTORY; i++) {
+        netproto_world_init(&client->history[i]);
+    }
+    netproto_world_init(&client->incoming);
+    
+    char name[32];
+    net_address_to_string(server, name, sizeof(name));
+    printf("Connecting to %s\n", name);
+    return client;
+}
+
+void client_destroy(GameClient* client) {
+    if (!client) return;
+    net_socket_close(client->socket);
+    for (int i = 0; i < NETPROTO_HISTORY; i++) {
+        netproto_world_release(&client->history[i]);
+    }
+    netproto_world_release(&client->incoming);
+    mem_free(client->assembly);
+    mem_free(client);
+}
+
+/**
+ * Grow the snapshot buffer to hold a number of fragments.
+ * @param client The client
+ * @param count Fragments
+ * @return true on success, false if the buffer could not grow
+ */
+static bool client_grow_assembly(GameClient* client, int count) {
+    size_t capacity = (size_t)count * NETPROTO_FRAGMENT_SIZE;
+    if (capacity <= client->assembly_capacity) return true;
+    
+    uint8_t* assembly = (uint8_t*)mem_realloc(MEM_TAG_NET, client->assembly, capacity);
+    if (!assembly) {
+        printf("Error: Could not allocate %zu bytes for a snapshot\n", capacity);
+        return false;
+    }
+    client->assembly = assembly;
+    client->assembly_capacity = capacity;
+    return true;
+}
+
+/**
+ * Size the world history and the snapshot buffer for the largest of the
+ * client's own maps, which the server shares, so ticks receive snapshots
+ * without allocating.
+ * @param client The client
+ * @return true on success, false if memory ran out (ticks then grow what they need)
+ */
+static bool client_reserve(GameClient* client) {
+    GameState* state = game_get_state(client->game);
+    bool reserved = netproto_world_reserve(&client->incoming, state);
+    for (int i = 0; reserved && i < NETPROTO_HISTORY; i++) {
+        reserved = netproto_world_reserve(&client->history[i], state);
+    }
+    if (!reserved) {
+        printf("Error: Could not reserve the snapshot history\n");
+        return false;
+    }
+    
+    size_t max_size = netproto_state_max_size(state);
+    return client_grow_assembly(client, (int)((max_size + NETPROTO_FRAGMENT_SIZE - 1) / NETPROTO_FRAGMENT_SIZE));
+}
+
+/**
+ * Start putting a snapshot together, dropping any unfinished older one.
+ * @param client The client
+ * @param fragment First fragment to arrive of the snapshot
+ * @return true on success, false if the buffer could not grow
+ */
+static bool client_start_assembly(GameClient* client, const NetSnapshotFragment* fragment) {
+    if (client->assembly_tick != NETPROTO_NO_TICK) {
+        client->dropped_snapshots++;
+        client->assembly_tick = NETPROTO_NO_TICK;
+    }
+    
+    // Sized for the largest map at init; grows only for a server whose maps outgrew the client's
+    if (!client_grow_assembly(client, fragment->count)) return false;
+    
+    client->assembly_tick = fragment->tick;
+    client->assembly_baseline_tick = fragment->baseline_tick;
+    client->assembly_count = fragment->count;
+    client->assembly_received = 0;
+    client->assembly_size = 0;
+    memset(client->fragment_received, 0, sizeof(bool) * (size_t)fragment->count);
+    return true;
+}
+
+/**
+ * Decode the snapshot put together from its fragments into the history.
+ * @param client The client
+ * @return true if it was decoded, false if it was dropped
+ */
+static bool client_finish_assembly(GameClient* client) {
+    int tick = client->assembly_tick;
+    int baseline_tick = client->assembly_baseline_tick;
+    client->assembly_tick = NETPROTO_NO_TICK;
+    
+    const NetWorldState* baseline = NULL;
+    if (baseline_tick != NETPROTO_NO_TICK) {
+        baseline = &client->history[baseline_tick % NETPROTO_HISTORY];
+        if (baseline->tick != baseline_tick) baseline = NULL;
+    }
+    if ((baseline_tick != NETPROTO_NO_TICK && !baseline) ||
+        !netproto_read_snapshot(client->assembly, client->assembly_size, tick, baseline, &client->incoming)) {
+        client->dropped_snapshots++;
+        return false;
+    }
+    
+    // Swap, so the history slot's arrays are reused for the next snapshot
+    NetWorldState spare = client->history[tick % NETPROTO_HISTORY];
+    client->history[tick % NETPROTO_HISTORY] = client->incoming;
+    client->incoming = spare;
+    client->newest_tick = tick;
+    client->snapshots_received++;
+    if (baseline_tick == NETPROTO_NO_TICK) client->full_snapshots++;
+    return true;
+}
+
+/**
+ * Put every waiting snapshot fragment in place and decode each snapshot
+ * that is complete and newer than the newest one held. Only the newest
+ * snapshot is put together; fragments of older ones are dropped.
+ * @param client The client
+ * @return true if a newer world arrived
+ */
+static bool client_receive(GameClient* client) {
+    bool received = false;
+    NetAddress address;
+    int size;
+    while ((size = net_socket_receive(client->socket, &address, client->packet, sizeof(client->packet))) >= 0) {
+        NetSnapshotFragment fragment;
+        if (!net_address_equal(&address, &client->server) ||
+            !netproto_read_fragment(client->packet, (size_t)size, &fragment)) {
+            continue;
+        }
+        client->bytes_received += (uint64_t)size;
+        
+        if (fragment.tick <= client->newest_tick ||
+            (client->assembly_tick != NETPROTO_NO_TICK && fragment.tick < client->assembly_tick)) {
+            if (fragment.index == 0) client->dropped_snapshots++;
+            continue;
+        }
+        if (fragment.tick != client->assembly_tick && !client_start_assembly(client, &fragment)) continue;
+        if (fragment.count != client->assembly_count || fragment.baseline_tick != client->assembly_baseline_tick ||
+            client->fragment_received[fragment.index]) {
+            continue;
+        }
+        
+        size_t offset = (size_t)fragment.index * NETPROTO_FRAGMENT_SIZE;
+        memcpy(client->assembly + offset, fragment.data, fragment.size);
+        client->fragment_received[fragment.index] = true;
+        client->assembly_received++;
+        if (fragment.index == fragment.count - 1) {
+            client->assembly_size = offset + fragment.size;
+        }
+        if (client->assembly_received == client->assembly_count && client_finish_assembly(client)) {
+            received = true;
+        }
+    }
+    return received;
+}
+
+/**
+ * Print the snapshot rate and traffic since the last report, then start a
+ * new report period.
+ * @param client The client
+ * @param now_ns Current time
+ */
+static void client_report(GameClient* client, uint64_t now_ns) {
+    double seconds = (double)(now_ns - client->report_ns) / 1e9;
+    if (seconds <= 0.0) return;
+    
+    double average = client->snapshots_received > 0 ? (double)client->bytes_received / client->snapshots_received : 0.0;
+    printf("Client: server tick %d, %.0f snapshots/s, down %.2f KB/s (%.0f B/snapshot, %d full, %d dropped), up %.2f KB/s\n",
+           client->newest_tick, client->snapshots_received / seconds, client->bytes_received / 1024.0 / seconds,
+           average, client->full_snapshots, client->dropped_snapshots, client->bytes_sent / 1024.0 / seconds);
+    
+    client->report_ns = now_ns;
+    client->bytes_sent = 0;
+    client->bytes_received = 0;
+    client->snapshots_received = 0;
+    client->full_snapshots = 0;
+    client->dropped_snapshots = 0;
+}
+
+/**
+ * Client init callback.
+ * @param data Client pointer
+ */
+static void client_init_callback(void* data) {
+    GameClient* client = (GameClient*)data;
+    if (client->callbacks.init) client->callbacks.init(client->game_data);
+    client_reserve(client);
+    client->start_ns = timer_now_ns();
+    client->report_ns = client->start_ns;
+}
+
+/**
+ * Client update callback: show the newest snapshot and send this tick's
+ * input.
+ * @param data Client pointer
+ * @param input This tick's input
+ * @param delta_time Unused; the server runs the simulation
+ */
+static void client_update_callback(void* data, const InputFrame* input, float delta_time) {
+    GameClient* client = (GameClient*)data;
+    (void)delta_time;
+    GameState* state = game_get_state(client->game);
+    uint64_t now_ns = timer_now_ns();
+    
+    PROFILE_BEGIN("client_receive");
+    if (client_receive(client)) {
+        const NetWorldState* world = &client->history[client->newest_tick % NETPROTO_HISTORY];
+        if (!netproto_apply(world, state)) {
+            printf("Error: Snapshot %d holds too many projectiles\n", world->tick);
+        }
+        game_set_selected_mode(client->game, (int)world->selected_mode);
+        client->last_snapshot_ns = now_ns;
+    } else {
+        netproto_hold(state);
+    }
+    PROFILE_END();
+    
+    PROFILE_BEGIN("client_send");
+    NetInputPacket packet;
+    packet.sequence = ++client->sequence;
+    packet.ack_tick = client->newest_tick;
+    packet.input = *input;
+    size_t size = netproto_write_input(&packet, client->packet, sizeof(client->packet));
+    if (size > 0 && net_socket_send(client->socket, &client->server, client->packet, size)) {
+        client->bytes_sent += size;
+    }
+    PROFILE_END();
+    
+    uint64_t heard_ns = client->newest_tick == NETPROTO_NO_TICK ? client->start_ns : client->last_snapshot_ns;
+    if (now_ns - heard_ns >= CLIENT_TIMEOUT_NS) {
+        printf(client->newest_tick == NETPROTO_NO_TICK ? "Error: No answer from the server\n"
+                                                       : "Error: Lost the connection to the server\n");
+        gengine_stop(client->engine);
+    }
+    if (now_ns - client->report_ns >= CLIENT_REPORT_INTERVAL_NS) {
+        client_report(client, now_ns);
+    }
+}
+
+/**
+ * Client cleanup callback: print the last report, then clean up the game.
+ * @param data Client pointer
+ */
+static void client_cleanup_callback(void* data) {
+    GameClient* client = (GameClient*)data;
+    client_report(client, timer_now_ns());
+    if (client->callbacks.cleanup) client->callbacks.cleanup(client->game_data);
+}
+
+/**
+ * Client publish callback.
+ * @param data Client pointer
+ */
+static void client_publish_callback(void* data) {
+    GameClient* client = (GameClient*)data;
+    if (client->callbacks.publish) client->callbacks.publish(client->game_data);
+}
+
+/**
+ * Client render callback.
+ * @param data Client pointer
+ */
+static void client_render_callback(void* data) {
+    GameClient* client = (GameClient*)data;
+    if (client->callbacks.render) client->callbacks.render(client->game_data);
+}
+
+GameCallbacks client_get_callbacks(GameClient* client) {
+    GameCallbacks callbacks = {0};
+    if (client) {
+        callbacks.init = client_init_callback;
+        callbacks.update = client_update_callback;
+        callbacks.render = client_render_callback;
+        callbacks.cleanup = client_cleanup_callback;
+        callbacks.publish = client_publish_callback;
+    }
+    return callbacks;
+}
+
+void* client_get_data(GameClient* client) {
+    return client;
+}
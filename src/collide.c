@@ -0,0 +1,103 @@
+#include "../include/collide.h"
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define COLLIDE_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define COLLIDE_SSE2
+#endif
+
+/**
+ * Test a circle against one rectangle of a set.
+ * @param x Circle center X
+ * @param y Circle center Y
+ * @param radius_sq Circle radius, squared
+ * @param rects The rectangles
+ * @param index Rectangle to test
+ * @return true if they overlap, false otherwise
+ */
+static bool collide_circle_rect_at(float x, float y, float radius_sq, const RectArrays* rects, int index) {
+    // Compare and select rather than fminf()/fmaxf(), which compilers may
+    // leave as library calls; the same as the vector min/max for non-NaN input
+    float closest_x = x < rects->right[index] ? x : rects->right[index];
+    closest_x = closest_x > rects->left[index] ? closest_x : rects->left[index];
+    float closest_y = y < rects->bottom[index] ? y : rects->bottom[index];
+    closest_y = closest_y > rects->top[index] ? closest_y : rects->top[index];
+    
+    float distance_x = x - closest_x;
+    float distance_y = y - closest_y;
+    
+    return (distance_x * distance_x + distance_y * distance_y) < radius_sq;
+}
+
+/**
+ * Find the lowest set lane of a comparison mask.
+ * @param mask Non-zero mask from a movemask instruction
+ * @return Index of the lowest set bit
+ */
+static int collide_first_lane(int mask) {
+    int lane = 0;
+    while (!(mask & 1)) {
+        mask >>= 1;
+        lane++;
+    }
+    return lane;
+}
+
+int collide_circle_first_rect_scalar(float x, float y, float radius, const RectArrays* rects) {
+    float radius_sq = radius * radius;
+    for (int i = 0; i < rects->count; i++) {
+        if (collide_circle_rect_at(x, y, radius_sq, rects, i)) return i;
+    }
+    return -1;
+}
+
+int collide_circle_first_rect(float x, float y, float radius, const RectArrays* rects) {
+    float radius_sq = radius * radius;
+    int i = 0;
+
+#if defined(COLLIDE_AVX2)
+    __m256 center_x = _mm256_set1_ps(x);
+    __m256 center_y = _mm256_set1_ps(y);
+    __m256 limit = _mm256_set1_ps(radius_sq);
+    for (; i + 8 <= rects->count; i += 8) {
+        __m256 closest_x = _mm256_max_ps(_mm256_loadu_ps(rects->left + i), _mm256_min_ps(center_x, _mm256_loadu_ps(rects->right + i)));
+        __m256 closest_y = _mm256_max_ps(_mm256_loadu_ps(rects->top + i), _mm256_min_ps(center_y, _mm256_loadu_ps(rects->bottom + i)));
+        __m256 distance_x = _mm256_sub_ps(center_x, closest_x);
+        __m256 distance_y = _mm256_sub_ps(center_y, closest_y);
+        __m256 distance_sq = _mm256_add_ps(_mm256_mul_ps(distance_x, distance_x), _mm256_mul_ps(distance_y, distance_y));
+        int mask = _mm256_movemask_ps(_mm256_cmp_ps(distance_sq, limit, _CMP_LT_OQ));
+        if (mask) return i + collide_first_lane(mask);
+    }
+#elif defined(COLLIDE_SSE2)
+    __m128 center_x = _mm_set1_ps(x);
+    __m128 center_y = _mm_set1_ps(y);
+    __m128 limit = _mm_set1_ps(radius_sq);
+    for (; i + 4 <= rects->count; i += 4) {
+        __m128 closest_x = _mm_max_ps(_mm_loadu_ps(rects->left + i), _mm_min_ps(center_x, _mm_loadu_ps(rects->right + i)));
+        __m128 closest_y = _mm_max_ps(_mm_loadu_ps(rects->top + i), _mm_min_ps(center_y, _mm_loadu_ps(rects->bottom + i)));
+        __m128 distance_x = _mm_sub_ps(center_x, closest_x);
+        __m128 distance_y = _mm_sub_ps(center_y, closest_y);
+        __m128 distance_sq = _mm_add_ps(_mm_mul_ps(distance_x, distance_x), _mm_mul_ps(distance_y, distance_y));
+        int mask = _mm_movemask_ps(_mm_cmplt_ps(distance_sq, limit));
+        if (mask) return i + collide_first_lane(mask);
+    }
+#endif
+    
+    // What's left after the last full vector, or everything without SIMD
+    for (; i < rects->count; i++) {
+        if (collide_circle_rect_at(x, y, radius_sq, rects, i)) return i;
+    }
+    return -1;
+}
+
+const char* collide_get_kernel_name(void) {
+#if defined(COLLIDE_AVX2)
+    return "avx2";
+#elif defined(COLLIDE_SSE2)
+    return "sse2";
+#else
+    return "scalar";
+#endif
+}
@@ -1,36 +1,49 @@
 #include "../include/enemy.h"
 #include "../include/map.h"
+#include "../include/mem.h"
 #include "raylib.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
+/**
+ * Check if an enemy's bounding square overlaps any wall. Same test as
+ * CheckCollisionRecs(), through the map's wall grid.
+ * @param x Center X
+ * @param y Center Y
+ * @param radius Half the square's side
+ * @param map The map
+ * @return true if any wall overlaps, false otherwise
+ */
+static bool enemy_overlaps_walls(float x, float y, float radius, const struct Map* map) {
+    float left = x - radius;
+    float top = y - radius;
+    float size = radius * 2;
+    return map_check_box_wall_collision(map, left, top, left + size, top + size);
+}
 
-struct Enemy {
-    Vector2 position;
-    Vector2 velocity;
-    float radius;
-    int direction_change_timer;
-    Color color;
-};
+Enemy enemy_make(Vector2 position, Vector2 velocity, Color color) {
+    Enemy enemy;
+    enemy.position = position;
+    enemy.velocity = velocity;
+    enemy.radius = ENEMY_RADIUS;
+    enemy.direction_change_timer = 0.0f;
+    enemy.color = color;
+    enemy.has_next_heading = false;
+    enemy.next_heading = 0.0f;
+    return enemy;
+}
 
 Enemy* enemy_create(Vector2 position, Vector2 velocity, Color color) {
-    Enemy* enemy = (Enemy*)malloc(sizeof(Enemy));
+    Enemy* enemy = (Enemy*)mem_alloc(MEM_TAG_GAME, sizeof(Enemy));
     if (!enemy) return NULL;
     
-    enemy->position = position;
-    enemy->velocity = velocity;
-    enemy->radius = ENEMY_RADIUS;
-    enemy->direction_change_timer = 0;
-    enemy->color = color;
-    
+    *enemy = enemy_make(position, velocity, color);
     return enemy;
 }
 
 void enemy_destroy(Enemy* enemy) {
-    if (enemy) free(enemy);
+    if (enemy) mem_free(enemy);
 }
 
 Vector2 enemy_get_position(const Enemy* enemy) {
@@ -53,8 +66,8 @@ Color enemy_get_color(const Enemy* enemy) {
     return enemy->color;
 }
 
-int enemy_get_direction_timer(const Enemy* enemy) {
-    if (!enemy) return 0;
+float enemy_get_direction_timer(const Enemy* enemy) {
+    if (!enemy) return 0.0f;
     return enemy->direction_change_timer;
 }
 
@@ -68,49 +81,88 @@ void enemy_set_velocity(Enemy* enemy, Vector2 velocity) {
     enemy->velocity = velocity;
 }
 
-void enemy_set_direction_timer(Enemy* enemy, int timer) {
+void enemy_set_direction_timer(Enemy* enemy, float timer) {
     if (!enemy) return;
     enemy->direction_change_timer = timer;
 }
 
-void enemy_update(Enemy* enemy, const struct Map* current_map) {
+void enemy_set_next_heading(Enemy* enemy, float angle) {
+    if (!enemy) return;
+    enemy->next_heading = angle;
+    enemy->has_next_heading = true;
+}
+
+float enemy_random_heading(Rng* rng) {
+    return (float)rng_range(rng, 0, 360) * DEG2RAD;
+}
+
+void enemy_update(Enemy* enemy, const struct Map* current_map, Rng* rng, float delta_time) {
     if (!enemy || !current_map) return;
     
-    enemy->direction_change_timer++;
-    if (enemy->direction_change_timer >= ENEMY_DIRECTION_CHANGE_FRAMES) {
-        float angle = (float)(GetRandomValue(0, 360)) * DEG2RAD;
-        enemy->velocity.x = cosf(angle) * ENEMY_SPEED;
-        enemy->velocity.y = sinf(angle) * ENEMY_SPEED;
-        enemy->direction_change_timer = 0;
+    // Draw a heading only for a direction change that is about to happen
+    if (!enemy->has_next_heading && rng && enemy->direction_change_timer + delta_time >= ENEMY_DIRECTION_CHANGE_TIME) {
+        enemy_set_next_heading(enemy, enemy_random_heading(rng));
     }
     
-    Vector2 new_position = {
-        enemy->position.x + enemy->velocity.x,
-        enemy->position.y + enemy->velocity.y
+    float timer = enemy->direction_change_timer;
+    EnemyArrays arrays = {
+        &enemy->position.x, &enemy->position.y, &enemy->velocity.x, &enemy->velocity.y,
+        &timer, &enemy->has_next_heading, &enemy->next_heading, enemy->radius
     };
+    enemy_update_all(&arrays, 0, 1, current_map, delta_time);
     
-    if (enemy_check_wall_collision(enemy, new_position, current_map)) {
-        enemy->velocity.x = -enemy->velocity.x;
-        enemy->velocity.y = -enemy->velocity.y;
-    } else {
-        enemy->position = new_position;
+    enemy->direction_change_timer = timer;
+    if (timer == 0.0f) {
+        enemy->has_next_heading = false;
     }
+}
+
+void enemy_update_all(const EnemyArrays* enemies, int begin, int end, const struct Map* current_map, float delta_time) {
+    if (!enemies || !current_map) return;
     
-    if (enemy->position.x < enemy->radius) {
-        enemy->position.x = enemy->radius;
-        enemy->velocity.x = -enemy->velocity.x;
-    }
-    if (enemy->position.x > SCREEN_WIDTH - enemy->radius) {
-        enemy->position.x = SCREEN_WIDTH - enemy->radius;
-        enemy->velocity.x = -enemy->velocity.x;
-    }
-    if (enemy->position.y < enemy->radius) {
-        enemy->position.y = enemy->radius;
-        enemy->velocity.y = -enemy->velocity.y;
-    }
-    if (enemy->position.y > SCREEN_HEIGHT - enemy->radius) {
-        enemy->position.y = SCREEN_HEIGHT - enemy->radius;
-        enemy->velocity.y = -enemy->velocity.y;
+    float* x = enemies->x;
+    float* y = enemies->y;
+    float* velocity_x = enemies->velocity_x;
+    float* velocity_y = enemies->velocity_y;
+    float* timer = enemies->direction_change_timer;
+    float radius = enemies->radius;
+    
+    for (int i = begin; i < end; i++) {
+        timer[i] += delta_time;
+        if (timer[i] >= ENEMY_DIRECTION_CHANGE_TIME) {
+            if (enemies->has_next_heading && enemies->has_next_heading[i]) {
+                velocity_x[i] = cosf(enemies->next_heading[i]) * ENEMY_SPEED;
+                velocity_y[i] = sinf(enemies->next_heading[i]) * ENEMY_SPEED;
+            }
+            timer[i] = 0.0f;
+        }
+        
+        float new_x = x[i] + velocity_x[i] * delta_time;
+        float new_y = y[i] + velocity_y[i] * delta_time;
+        if (enemy_overlaps_walls(new_x, new_y, radius, current_map)) {
+            velocity_x[i] = -velocity_x[i];
+            velocity_y[i] = -velocity_y[i];
+        } else {
+            x[i] = new_x;
+            y[i] = new_y;
+        }
+        
+        if (x[i] < radius) {
+            x[i] = radius;
+            velocity_x[i] = -velocity_x[i];
+        }
+        if (x[i] > WORLD_WIDTH - radius) {
+            x[i] = WORLD_WIDTH - radius;
+            velocity_x[i] = -velocity_x[i];
+        }
+        if (y[i] < radius) {
+            y[i] = radius;
+            velocity_y[i] = -velocity_y[i];
+        }
+        if (y[i] > WORLD_HEIGHT - radius) {
+            y[i] = WORLD_HEIGHT - radius;
+            velocity_y[i] = -velocity_y[i];
+        }
     }
 }
 
@@ -125,19 +177,5 @@ bool enemy_check_collision_with_player(const Enemy* enemy, Vector2 player_positi
 bool enemy_check_wall_collision(const Enemy* enemy, Vector2 new_position, const struct Map* current_map) {
     if (!enemy || !current_map) return false;
     
-    Rectangle enemy_rect = {
-        new_position.x - enemy->radius,
-        new_position.y - enemy->radius,
-        enemy->radius * 2,
-        enemy->radius * 2
-    };
-    
-    int wall_count;
-    const Wall* walls = map_get_walls(current_map, &wall_count);
-    for (int i = 0; i < wall_count; i++) {
-        if (CheckCollisionRecs(enemy_rect, walls[i].rect)) {
-            return true;
-        }
-    }
-    return false;
+    return enemy_overlaps_walls(new_position.x, new_position.y, enemy->radius, current_map);
 }
@@ -10,6 +10,15 @@
 #include "../include/state.h"
 #include "../include/highscore.h"
 #include "../include/projectile.h"
+#include "../include/render_state.h"
+#include "../include/profiler.h"
+#include "../include/trace.h"
+#include "../include/jobs.h"
+#include "../include/input.h"
+#include "../include/timer.h"
+#include "../include/arena.h"
+#include "../include/spatial.h"
+#include "../include/mem.h"
 #include "raylib.h"
 #include <stdio.h>
 #include <stdbool.h>
@@ -17,21 +26,92 @@
 #include <string.h>
 #include <stdlib.h>
 
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
 #define PLAYER_RADIUS 25.0f
 #define DAMAGE_PER_HIT 10.0f
-#define PROJECTILE_COOLDOWN 10  // frames between shots
+#define PROJECTILE_COOLDOWN (1.0f / 6.0f)  // Seconds between shots
+#define TURN_SPEED 3.0f  // Keyboard turning in 3D mode, radians per second
 #define OBSTACLE_RADIUS 20.0f
-
-// Shared static variable for mode selection (shared between update and render callbacks)
-static int g_selected_mode = 0;
+#define OBSTACLE_UPDATE_GRAIN 16  // Below this many obstacles the update stays on one thread
+#define GAME_FRAME_ARENA_SIZE (64 * 1024)  // Smallest scratch memory for one tick; grows with the maps
+#define ENTITY_CELL_SIZE (2.0f * (PROJECTILE_RADIUS + OBSTACLE_RADIUS))  // A projectile's query touches at most 2x2 cells
 
 struct CoinCollectorGame {
     GameState* state;
     GameEngine* engine;
+    RenderState view;  // Snapshot the render callback draws from
+    SpriteList enemy_sprites;  // 3D sprites, sized by publish and filled by render
+    SpriteList coin_sprites;
+    bool view_ready;
+    int selected_mode;        // Highlighted entry on the mode select screen
+    Vector2 last_mouse_pos;   // Mouse position at the previous 3D tick
+    uint64_t seed;            // Seed for the game state's random stream
+    bool has_seed;            // Use seed instead of the engine's
+    Arena* frame_arena;       // Scratch memory, released at the start of every tick
+    int scratch_map_id;       // Current map when frame_arena was last checked against the maps
+    bool persist_high_scores; // Load and save the high score file
+    float tick_delta;         // Length of the last tick, to turn tick counts into seconds
 };
 
+/**
+ * Get the scratch memory one tick on a map takes: the heading arrays and
+ * the obstacle and coin hashes.
+ * @param map The map
+ * @return Bytes, alignment padding included
+ */
+static size_t game_tick_scratch_bytes(const Map* map) {
+    Rectangle world = {0, 0, WORLD_WIDTH, WORLD_HEIGHT};
+    size_t obstacles = (size_t)map->obstacles.count;
+    return (sizeof(bool) + sizeof(float)) * obstacles + 2 * ARENA_ALIGNMENT +
+           spatial_hash_scratch_bytes(world, ENTITY_CELL_SIZE, map->obstacles.count) +
+           spatial_hash_scratch_bytes(world, ENTITY_CELL_SIZE, map->coin_count);
+}
+
+/**
+ * Make the tick arena big enough for a tick on any map, replacing it if
+ * not. Maps only gain obstacles outside play, so after the first call
+ * this allocates only when a map was filled up since.
+ * @param game The game
+ * @return true on success, false if a bigger arena could not be created (the old one stays)
+ */
+static bool game_reserve_tick_scratch(CoinCollectorGame* game) {
+    Map* maps = state_get_maps(game->state);
+    size_t needed = GAME_FRAME_ARENA_SIZE;
+    for (int i = 0; i < NUM_MAPS; i++) {
+        size_t bytes = game_tick_scratch_bytes(&maps[i]);
+        if (bytes > needed) needed = bytes;
+    }
+    game->scratch_map_id = state_get_current_map_id(game->state);
+    
+    size_t capacity = arena_get_capacity(game->frame_arena);
+    if (capacity >= needed) return true;
+    
+    while (capacity < needed) {
+        capacity = capacity ? capacity * 2 : GAME_FRAME_ARENA_SIZE;
+    }
+    Arena* arena = arena_create(MEM_TAG_GAME, capacity);
+    if (!arena) {
+        printf("Error: Failed to grow frame arena to %zu bytes\n", capacity);
+        return false;
+    }
+    arena_destroy(game->frame_arena);
+    game->frame_arena = arena;
+    return true;
+}
+
+/**
+ * Grow the render snapshot's storage to fit every map, so that publishing
+ * and drawing stay off the heap whichever map is current.
+ * @param game The game
+ */
+static void game_reserve_view(CoinCollectorGame* game) {
+    Map* maps = state_get_maps(game->state);
+    for (int i = 0; i < NUM_MAPS; i++) {
+        map_copy(&game->view.map, &maps[i]);
+        renderer3d_reserve_sprites(&game->enemy_sprites, maps[i].obstacles.count);
+        renderer3d_reserve_sprites(&game->coin_sprites, maps[i].coin_count);
+    }
+}
+
 /**
  * Game initialization callback.
  * @param game_data Game data pointer
@@ -46,27 +126,127 @@ static void game_init_callback(void* game_data) {
         return;
     }
     
+    if (game->has_seed) {
+        state_set_seed(game->state, game->seed);
+    } else if (game->engine) {
+        state_set_seed(game->state, gengine_get_seed(game->engine));
+    } else {
+        state_set_seed(game->state, timer_now_ns());
+    }
     state_init(game->state);
+    game->tick_delta = 1.0f / (float)(game->engine ? gengine_get_tick_rate(game->engine) : GENGINE_DEFAULT_TICK_RATE);
+    if (game->persist_high_scores) {
+        int* high_score_count;
+        HighScore* high_scores = state_get_high_scores_mutable(game->state, &high_score_count);
+        highscore_load(high_scores, high_score_count);
+        printf("High scores loaded: %d\n", *high_score_count);
+    }
+    game_reserve_view(game);
+    
+    if (!game_reserve_tick_scratch(game)) {
+        printf("Error: Failed to create frame arena\n");
+    }
+    
+    if (game->engine) {
+        renderer3d_set_jobs(gengine_get_jobs(game->engine));
+    }
 }
 
 /**
- * Game update callback.
+ * Shared input for the parallel obstacle update.
+ */
+typedef struct {
+    const Map* map;
+    EnemyArrays enemies;  // The map's obstacles, with headings from the frame arena
+    float delta_time;
+} ObstacleUpdateJob;
+
+/**
+ * Move a range of obstacles by one tick.
+ * @param user_data The ObstacleUpdateJob
+ * @param begin First obstacle index
+ * @param end One past the last obstacle index
+ */
+static void game_update_obstacle_range(void* user_data, int begin, int end) {
+    ObstacleUpdateJob* job = (ObstacleUpdateJob*)user_data;
+    enemy_update_all(&job->enemies, begin, end, job->map, job->delta_time);
+}
+
+/**
+ * Get the furthest any of a map's obstacles moved on one axis this tick.
+ * @param obstacles The map's obstacles, after the update
+ * @return Largest change of x or y since the positions were synced
+ */
+static float game_obstacle_drift(const ObstacleSet* obstacles) {
+    float drift = 0.0f;
+    for (int i = 0; i < obstacles->count; i++) {
+        drift = fmaxf(drift, fabsf(obstacles->x[i] - obstacles->previous_x[i]));
+        drift = fmaxf(drift, fabsf(obstacles->y[i] - obstacles->previous_y[i]));
+    }
+    return drift;
+}
+
+/**
+ * Bucket a map's obstacles by where they are now, in the frame arena.
+ * @param game The game
+ * @param map The map
+ * @param hash Hash to fill; left empty if the arena is full
+ */
+static void game_build_obstacle_hash(CoinCollectorGame* game, const Map* map, SpatialHash* hash) {
+    const ObstacleSet* obstacles = &map->obstacles;
+    if (!spatial_hash_build(hash, game->frame_arena, (Rectangle){0, 0, WORLD_WIDTH, WORLD_HEIGHT}, ENTITY_CELL_SIZE,
+                            obstacles->x, obstacles->y, sizeof(float), obstacles->count)) {
+        // Nothing collides with obstacles this tick; still deterministic
+        printf("Error: Frame arena too small to index %d obstacles\n", obstacles->count);
+    }
+}
+
+/**
+ * Bucket a map's coins by position, in the frame arena. Collected coins
+ * are indexed too and skipped by the caller.
+ * @param game The game
+ * @param map The map
+ * @param hash Hash to fill; left empty if the arena is full
+ */
+static void game_build_coin_hash(CoinCollectorGame* game, const Map* map, SpatialHash* hash) {
+    const Coin* coins = map->coins;
+    if (!spatial_hash_build(hash, game->frame_arena, (Rectangle){0, 0, WORLD_WIDTH, WORLD_HEIGHT}, ENTITY_CELL_SIZE,
+                            coins ? &coins[0].position.x : NULL, coins ? &coins[0].position.y : NULL,
+                            sizeof(Coin), map->coin_count)) {
+        printf("Error: Frame arena too small to index %d coins\n", map->coin_count);
+    }
+}
+
+/**
+ * Advance the game by one tick.
  * @param game_data Game data pointer
- * @param delta_time Time since last frame
+ * @param input Player input for this tick
+ * @param delta_time Tick length in seconds; speeds and timers scale with it
  */
-static void game_update_callback(void* game_data, float delta_time) {
+static void game_update_state(void* game_data, const InputFrame* input, float delta_time) {
     CoinCollectorGame* game = (CoinCollectorGame*)game_data;
     if (!game || !game->state) return;
     
     GameState* state = game->state;
+    game->tick_delta = delta_time;
+    
+    // Checked again on a map change or when the current map outgrew the
+    // arena (filled up, or a larger state loaded); both are rare
+    if (state_get_current_map_id(state) != game->scratch_map_id ||
+        game_tick_scratch_bytes(state_get_current_map(state)) > arena_get_capacity(game->frame_arena)) {
+        game_reserve_tick_scratch(game);
+    }
+    arena_reset(game->frame_arena);
     
     if (game->engine) {
-        state_set_frame_count(state, gengine_get_frame_count(game->engine));
+        state_set_frame_count(state, gengine_get_tick_count(game->engine));
     } else {
         state_increment_frame_count(state);
     }
     
-    if (WindowShouldClose() || IsKeyPressed(KEY_ESCAPE)) {
+    // The engine owns the window and checks WindowShouldClose() itself; the
+    // update may run on a worker thread, where window calls are not allowed
+    if (input_was_pressed(input, INPUT_BUTTON_BACK)) {
         state_set_running(state, false);
         if (game->engine) {
             gengine_stop(game->engine);
@@ -76,11 +256,11 @@ static void game_update_callback(void* game_data, float delta_time) {
     GameStateType current_state = state_get_type(state);
     
     if (current_state == GAME_STATE_START) {
-        if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER)) {
+        if (input_was_pressed(input, INPUT_BUTTON_FIRE | INPUT_BUTTON_CONFIRM)) {
             audio_play_sound(AUDIO_SOUND_MENU);
             state_set_type(state, GAME_STATE_MODE_SELECT);
         }
-        if (IsKeyPressed(KEY_H)) {
+        if (input_was_pressed(input, INPUT_BUTTON_HIGH_SCORES)) {
             audio_play_sound(AUDIO_SOUND_MENU);
             state_set_type(state, GAME_STATE_HIGH_SCORES);
         }
@@ -88,31 +268,31 @@ static void game_update_callback(void* game_data, float delta_time) {
     }
     
     if (current_state == GAME_STATE_MODE_SELECT) {
-        if (IsKeyPressed(KEY_UP) || IsKeyPressed(KEY_W)) {
+        if (input_was_pressed(input, INPUT_BUTTON_UP)) {
             audio_play_sound(AUDIO_SOUND_MENU);
-            g_selected_mode = 0;
+            game->selected_mode = 0;
         }
-        if (IsKeyPressed(KEY_DOWN) || IsKeyPressed(KEY_S)) {
+        if (input_was_pressed(input, INPUT_BUTTON_DOWN)) {
             audio_play_sound(AUDIO_SOUND_MENU);
-            g_selected_mode = 1;
+            game->selected_mode = 1;
         }
-        if (IsKeyPressed(KEY_ENTER)) {
+        if (input_was_pressed(input, INPUT_BUTTON_CONFIRM)) {
             audio_play_sound(AUDIO_SOUND_MENU);
-            state_set_game_mode(state, (g_selected_mode == 0) ? GAME_MODE_2D : GAME_MODE_3D);
+            state_set_game_mode(state, (game->selected_mode == 0) ? GAME_MODE_2D : GAME_MODE_3D);
             state_set_type(state, GAME_STATE_PLAYING);
             state_set_game_start_frame(state, state_get_frame_count(state));
-            g_selected_mode = 0;  // Reset for next time
+            game->selected_mode = 0;  // Reset for next time
         }
-        if (IsKeyPressed(KEY_ESCAPE)) {
+        if (input_was_pressed(input, INPUT_BUTTON_BACK)) {
             audio_play_sound(AUDIO_SOUND_MENU);
             state_set_type(state, GAME_STATE_START);
-            g_selected_mode = 0;  // Reset for next time
+            game->selected_mode = 0;  // Reset for next time
         }
         return;
     }
     
     if (current_state == GAME_STATE_HIGH_SCORES) {
-        if (IsKeyPressed(KEY_ESCAPE) || IsKeyPressed(KEY_H) || IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER)) {
+        if (input_was_pressed(input, INPUT_BUTTON_BACK | INPUT_BUTTON_HIGH_SCORES | INPUT_BUTTON_FIRE | INPUT_BUTTON_CONFIRM)) {
             audio_play_sound(AUDIO_SOUND_MENU);
             state_set_type(state, GAME_STATE_START);
         }
@@ -123,18 +303,17 @@ static void game_update_callback(void* game_data, float delta_time) {
         char* player_name = state_get_player_name(state);
         int name_char_count = state_get_name_char_count(state);
         
-        int key = GetCharPressed();
-        while (key > 0) {
+        for (int i = 0; i < input->char_count; i++) {
+            int key = input->chars[i];
             if ((key >= 32) && (key <= 125) && (name_char_count < MAX_NAME_LENGTH)) {
                 player_name[name_char_count] = (char)key;
                 state_increment_name_char_count(state);
                 name_char_count = state_get_name_char_count(state);
                 player_name[name_char_count] = '\0';
             }
-            key = GetCharPressed();
         }
         
-        if (IsKeyPressed(KEY_BACKSPACE)) {
+        if (input_was_pressed(input, INPUT_BUTTON_ERASE)) {
             if (name_char_count > 0) {
                 state_decrement_name_char_count(state);
                 name_char_count = state_get_name_char_count(state);
@@ -142,22 +321,26 @@ static void game_update_callback(void* game_data, float delta_time) {
             }
         }
         
-        if (IsKeyPressed(KEY_ENTER)) {
+        if (input_was_pressed(input, INPUT_BUTTON_CONFIRM)) {
             audio_play_sound(AUDIO_SOUND_MENU);
             HighScore* pending_score = state_get_pending_score(state);
             int* high_score_count;
             HighScore* high_scores = state_get_high_scores_mutable(state, &high_score_count);
             
+            bool added;
             if (name_char_count > 0) {
-                highscore_add(high_scores, high_score_count, player_name,
-                             pending_score->frame_count,
-                             pending_score->coins_collected,
-                             pending_score->health_remaining);
+                added = highscore_add(high_scores, high_score_count, player_name,
+                                      pending_score->completion_time,
+                                      pending_score->coins_collected,
+                                      pending_score->health_remaining);
             } else {
-                highscore_add(high_scores, high_score_count, "Player",
-                             pending_score->frame_count,
-                             pending_score->coins_collected,
-                             pending_score->health_remaining);
+                added = highscore_add(high_scores, high_score_count, "Player",
+                                      pending_score->completion_time,
+                                      pending_score->coins_collected,
+                                      pending_score->health_remaining);
+            }
+            if (added && game->persist_high_scores) {
+                highscore_save(high_scores, *high_score_count);
             }
             state_set_type(state, GAME_STATE_END);
         }
@@ -165,7 +348,7 @@ static void game_update_callback(void* game_data, float delta_time) {
     }
     
     if (current_state == GAME_STATE_END) {
-        if (IsKeyPressed(KEY_SPACE) || IsKeyPressed(KEY_ENTER)) {
+        if (input_was_pressed(input, INPUT_BUTTON_FIRE | INPUT_BUTTON_CONFIRM)) {
             state_set_type(state, GAME_STATE_START);
             state_reset(state);
         }
@@ -178,30 +361,38 @@ static void game_update_callback(void* game_data, float delta_time) {
     Map* current_map = state_get_current_map(state);
     if (!current_map) return;
     
-    player_update(player);
+    // Keep the last tick's positions so rendering can interpolate
+    player_sync_previous_position(player);
+    map_sync_previous_positions(current_map);
+    
+    // Obstacles by where they start the tick; the player check below
+    // widens its query by how far they have moved since
+    SpatialHash obstacle_hash;
+    game_build_obstacle_hash(game, current_map, &obstacle_hash);
+    
+    player_update(player, delta_time);
     
     // Handle 3D mode rotation and movement
     GameMode mode = state_get_game_mode(state);
     if (mode == GAME_MODE_3D) {
         // Mouse look for smooth rotation
-        static Vector2 last_mouse_pos = {0, 0};
-        Vector2 current_mouse_pos = GetMousePosition();
+        Vector2 current_mouse_pos = input->mouse_position;
         
-        if (IsMouseButtonDown(MOUSE_BUTTON_LEFT) || IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) {
-            float mouse_delta_x = current_mouse_pos.x - last_mouse_pos.x;
+        if (input_is_down(input, INPUT_BUTTON_MOUSE_LEFT | INPUT_BUTTON_MOUSE_RIGHT)) {
+            float mouse_delta_x = current_mouse_pos.x - game->last_mouse_pos.x;
             float rotation_sensitivity = 0.003f;
             float new_angle = player_get_angle(player) + mouse_delta_x * rotation_sensitivity;
             player_set_angle(player, new_angle);
         }
-        last_mouse_pos = current_mouse_pos;
+        game->last_mouse_pos = current_mouse_pos;
         
         // Keyboard rotation (alternative)
-        float rotation_speed = 0.05f;
-        if (IsKeyDown(KEY_Q)) {
+        float rotation_speed = TURN_SPEED * delta_time;
+        if (input_is_down(input, INPUT_BUTTON_TURN_LEFT)) {
             float new_angle = player_get_angle(player) - rotation_speed;
             player_set_angle(player, new_angle);
         }
-        if (IsKeyDown(KEY_E)) {
+        if (input_is_down(input, INPUT_BUTTON_TURN_RIGHT)) {
             float new_angle = player_get_angle(player) + rotation_speed;
             player_set_angle(player, new_angle);
         }
@@ -209,22 +400,22 @@ static void game_update_callback(void* game_data, float delta_time) {
         // 3D movement (forward/backward relative to view angle)
         Vector2 movement = {0.0f, 0.0f};
         float angle = player_get_angle(player);
-        float speed = PLAYER_SPEED;
+        float speed = PLAYER_SPEED * delta_time;
         
-        if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) {
+        if (input_is_down(input, INPUT_BUTTON_UP)) {
             movement.x += cosf(angle) * speed;
             movement.y += sinf(angle) * speed;
         }
-        if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) {
+        if (input_is_down(input, INPUT_BUTTON_DOWN)) {
             movement.x -= cosf(angle) * speed;
             movement.y -= sinf(angle) * speed;
         }
-        if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) {
+        if (input_is_down(input, INPUT_BUTTON_LEFT)) {
             // Strafe left
             movement.x += cosf(angle - PI/2) * speed;
             movement.y += sinf(angle - PI/2) * speed;
         }
-        if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) {
+        if (input_is_down(input, INPUT_BUTTON_RIGHT)) {
             // Strafe right
             movement.x += cosf(angle + PI/2) * speed;
             movement.y += sinf(angle + PI/2) * speed;
@@ -243,42 +434,42 @@ static void game_update_callback(void* game_data, float delta_time) {
         // Boundary checks
         Vector2 pos = player_get_position(player);
         if (pos.x < PLAYER_RADIUS) player_set_position(player, (Vector2){PLAYER_RADIUS, pos.y});
-        if (pos.x > SCREEN_WIDTH - PLAYER_RADIUS) player_set_position(player, (Vector2){SCREEN_WIDTH - PLAYER_RADIUS, pos.y});
+        if (pos.x > WORLD_WIDTH - PLAYER_RADIUS) player_set_position(player, (Vector2){WORLD_WIDTH - PLAYER_RADIUS, pos.y});
         if (pos.y < PLAYER_RADIUS) player_set_position(player, (Vector2){pos.x, PLAYER_RADIUS});
-        if (pos.y > SCREEN_HEIGHT - PLAYER_RADIUS) player_set_position(player, (Vector2){pos.x, SCREEN_HEIGHT - PLAYER_RADIUS});
+        if (pos.y > WORLD_HEIGHT - PLAYER_RADIUS) player_set_position(player, (Vector2){pos.x, WORLD_HEIGHT - PLAYER_RADIUS});
     } else {
         // 2D mode movement (existing code)
-        player_update_movement(player, current_map);
+        player_update_movement(player, input, current_map, delta_time);
     }
     
     // Handle shooting input (only in 2D mode)
     if (mode == GAME_MODE_2D) {
-        state_decrement_projectile_cooldown(state);
+        state_decrement_projectile_cooldown(state, delta_time);
         Vector2 player_pos = player_get_position(player);
         
-        if (state_get_projectile_cooldown(state) <= 0) {
+        if (state_get_projectile_cooldown(state) <= 0.0f) {
             Vector2 shoot_direction = {0, 0};
             bool should_shoot = false;
             
             // Mouse shooting (primary method)
-            if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) {
-                Vector2 mouse_pos = GetMousePosition();
+            if (input_was_pressed(input, INPUT_BUTTON_MOUSE_LEFT)) {
+                Vector2 mouse_pos = input->mouse_position;
                 shoot_direction.x = mouse_pos.x - player_pos.x;
                 shoot_direction.y = mouse_pos.y - player_pos.y;
                 should_shoot = true;
             }
             // Arrow key shooting (alternative)
-            else if (IsKeyPressed(KEY_SPACE)) {
-                if (IsKeyDown(KEY_UP) || IsKeyDown(KEY_W)) {
+            else if (input_was_pressed(input, INPUT_BUTTON_FIRE)) {
+                if (input_is_down(input, INPUT_BUTTON_UP)) {
                     shoot_direction = (Vector2){0, -1};
                     should_shoot = true;
-                } else if (IsKeyDown(KEY_DOWN) || IsKeyDown(KEY_S)) {
+                } else if (input_is_down(input, INPUT_BUTTON_DOWN)) {
                     shoot_direction = (Vector2){0, 1};
                     should_shoot = true;
-                } else if (IsKeyDown(KEY_LEFT) || IsKeyDown(KEY_A)) {
+                } else if (input_is_down(input, INPUT_BUTTON_LEFT)) {
                     shoot_direction = (Vector2){-1, 0};
                     should_shoot = true;
-                } else if (IsKeyDown(KEY_RIGHT) || IsKeyDown(KEY_D)) {
+                } else if (input_is_down(input, INPUT_BUTTON_RIGHT)) {
                     shoot_direction = (Vector2){1, 0};
                     should_shoot = true;
                 }
@@ -287,80 +478,70 @@ static void game_update_callback(void* game_data, float delta_time) {
             if (should_shoot) {
                 float length = sqrtf(shoot_direction.x * shoot_direction.x + shoot_direction.y * shoot_direction.y);
                 if (length > 0.1f) {  // Only shoot if direction is meaningful
-                    Projectile* proj = projectile_create(player_pos, shoot_direction);
-                    if (proj && state_add_projectile(state, proj)) {
+                    ProjectileHandle shot = state_spawn_projectile(state, player_pos, shoot_direction);
+                    if (shot.value != PROJECTILE_HANDLE_NONE.value) {
                         state_set_projectile_cooldown(state, PROJECTILE_COOLDOWN);
                         audio_play_sound(AUDIO_SOUND_MENU);  // Use menu sound for shooting
-                    } else if (proj) {
-                        projectile_destroy(proj);  // Clean up if couldn't add
                     }
                 }
             }
         }
         
-        // Update projectiles
-        int projectile_count;
-        Projectile** projectiles = state_get_projectiles(state, &projectile_count);
-        for (int i = projectile_count - 1; i >= 0; i--) {
-            if (!projectiles[i] || !projectile_is_active(projectiles[i])) {
-                if (projectiles[i]) {
-                    state_remove_projectile(state, i);
-                }
-                continue;
-            }
-            
-            projectile_update(projectiles[i]);
-            
-            if (!projectile_is_active(projectiles[i])) {
-                state_remove_projectile(state, i);
-                continue;
-            }
+        // Move every projectile at once, then retire the ones that hit something
+        ProjectilePool* projectiles = state_get_projectiles(state);
+        projectile_pool_update(projectiles, delta_time);
+        
+        for (int i = projectiles->count - 1; i >= 0; i--) {
+            Vector2 projectile_pos = {projectiles->x[i], projectiles->y[i]};
+            bool hit = map_check_circle_wall_collision(current_map, projectile_pos, PROJECTILE_RADIUS);
             
-            // Check collision with walls
-            int wall_count;
-            const Wall* walls = map_get_walls(current_map, &wall_count);
-            bool hit_wall = false;
-            for (int j = 0; j < wall_count; j++) {
-                if (projectile_check_rect_collision(projectiles[i], walls[j].rect)) {
-                    hit_wall = true;
-                    break;
+            // Damage enemy (for now, just remove projectile)
+            // In the future, we could add enemy health system
+            const ObstacleSet* obstacles = &current_map->obstacles;
+            SpatialQuery query;
+            SpatialSpan span;
+            spatial_query_radius(&obstacle_hash, projectile_pos, PROJECTILE_RADIUS + OBSTACLE_RADIUS, &query);
+            while (!hit && spatial_query_next(&query, &span)) {
+                for (int k = 0; k < span.count && !hit; k++) {
+                    int j = span.index[k];
+                    hit = projectile_pool_check_circle_collision(projectiles, i, (Vector2){obstacles->x[j], obstacles->y[j]}, OBSTACLE_RADIUS);
                 }
             }
             
-            if (hit_wall) {
-                state_remove_projectile(state, i);
-                continue;
-            }
-            
-            // Check collision with enemies
-            Vector2 proj_pos = projectile_get_position(projectiles[i]);
-            for (int j = 0; j < current_map->obstacle_count; j++) {
-                Obstacle* obstacle = &current_map->obstacles[j];
-                if (projectile_check_circle_collision(projectiles[i], obstacle->position, OBSTACLE_RADIUS)) {
-                    // Damage enemy (for now, just remove projectile)
-                    // In the future, we could add enemy health system
-                    state_remove_projectile(state, i);
-                    break;
-                }
+            if (hit) {
+                projectile_pool_remove_at(projectiles, i);
             }
         }
     }
     
-    for (int i = 0; i < current_map->obstacle_count; i++) {
-        Obstacle* obstacle = &current_map->obstacles[i];
-        
-        Enemy* enemy = enemy_create(obstacle->position, obstacle->velocity, obstacle->color);
-        if (enemy) {
-            enemy_set_direction_timer(enemy, obstacle->direction_change_timer);
-            enemy_update(enemy, current_map);
-            
-            obstacle->position = enemy_get_position(enemy);
-            obstacle->velocity = enemy_get_velocity(enemy);
-            obstacle->direction_change_timer = enemy_get_direction_timer(enemy);
-            
-            enemy_destroy(enemy);
+    // Headings for enemies about to turn are drawn here, in obstacle order,
+    // before the parallel update so the stream doesn't depend on scheduling
+    ObstacleSet* obstacles = &current_map->obstacles;
+    bool* has_heading = (bool*)arena_alloc(game->frame_arena, sizeof(bool) * (size_t)obstacles->count);
+    float* headings = (float*)arena_alloc(game->frame_arena, sizeof(float) * (size_t)obstacles->count);
+    if (!has_heading || !headings) {
+        // Without the arrays no enemy turns this tick; still deterministic
+        printf("Error: Frame arena too small for %d obstacles\n", obstacles->count);
+        has_heading = NULL;
+    }
+    for (int i = 0; has_heading && i < obstacles->count; i++) {
+        has_heading[i] = obstacles->direction_change_timer[i] + delta_time >= ENEMY_DIRECTION_CHANGE_TIME;
+        if (has_heading[i]) {
+            headings[i] = enemy_random_heading(state_get_rng(state));
         }
     }
+    ObstacleUpdateJob obstacle_job = {
+        current_map,
+        {obstacles->x, obstacles->y, obstacles->velocity_x, obstacles->velocity_y,
+         obstacles->direction_change_timer, has_heading, headings, OBSTACLE_RADIUS},
+        delta_time
+    };
+    PROFILE_BEGIN("obstacles");
+    jobs_parallel_for(game->engine ? gengine_get_jobs(game->engine) : NULL,
+                      obstacles->count, OBSTACLE_UPDATE_GRAIN,
+                      game_update_obstacle_range, &obstacle_job);
+    PROFILE_END();
+    float drift = game_obstacle_drift(obstacles);  // Before a map change syncs the positions again
     
     // Handle map transitions (works in both modes)
     Vector2 player_pos = player_get_position(player);
@@ -377,21 +558,27 @@ static void game_update_callback(void* game_data, float delta_time) {
         } else if (entrance_count > 0) {
             new_pos = entrances[0].position;
         } else {
-            new_pos = (Vector2){SCREEN_WIDTH/2, SCREEN_HEIGHT/2};
+            new_pos = (Vector2){WORLD_WIDTH/2, WORLD_HEIGHT/2};
         }
         player_set_position(player, new_pos);
+        player_sync_previous_position(player);
+        map_sync_previous_positions(target_map);
         
         printf("Entered map %d\n", target_map_id);
         player_pos = player_get_position(player);  // Update after map change
     }
     
-    // Enemy collision detection (works in both modes)
-    for (int i = 0; i < current_map->obstacle_count; i++) {
-        Obstacle* obstacle = &current_map->obstacles[i];
-        
-        Enemy* enemy = enemy_create(obstacle->position, obstacle->velocity, obstacle->color);
-        if (enemy) {
-            if (enemy_check_collision_with_player(enemy, player_pos, PLAYER_RADIUS) && !player_is_invincible(player)) {
+    // Enemy collision detection (works in both modes). The first hit makes
+    // the player invincible, so the order candidates come in doesn't matter
+    SpatialQuery query;
+    SpatialSpan span;
+    bool player_died = false;
+    spatial_query_radius(&obstacle_hash, player_pos, PLAYER_RADIUS + OBSTACLE_RADIUS + drift, &query);
+    while (!player_died && spatial_query_next(&query, &span)) {
+        for (int k = 0; k < span.count; k++) {
+            int i = span.index[k];
+            Enemy enemy = enemy_make(map_get_obstacle_position(current_map, i), (Vector2){0, 0}, current_map->obstacles.color[i]);
+            if (enemy_check_collision_with_player(&enemy, player_pos, PLAYER_RADIUS) && !player_is_invincible(player)) {
                 player_apply_damage(player, DAMAGE_PER_HIT);
                 audio_play_sound(AUDIO_SOUND_DAMAGE);
                 printf("Hit! Health: %.0f/%.0f\n", player_get_health(player), player_get_max_health(player));
@@ -405,152 +592,173 @@ static void game_update_callback(void* game_data, float delta_time) {
                     for (int j = 0; j < NUM_MAPS; j++) {
                         map_init(&maps[j], j);
                     }
-                    enemy_destroy(enemy);
+                    player_died = true;
                     break;
                 }
             }
-            enemy_destroy(enemy);
         }
     }
     
+    // Every coin is collected on touch, so the order doesn't matter here either
     player_pos = player_get_position(player);
-    for (int i = 0; i < current_map->coin_count; i++) {
-        Coin* coin = &current_map->coins[i];
-        if (!coin->collected) {
-            Item* item = item_create(ITEM_TYPE_COIN, coin->position);
-            if (item) {
-                if (item_check_collision_with_player(item, player_pos, PLAYER_RADIUS)) {
-                    item_collect(item);
-                    coin->collected = true;
-                    state_increment_coins_collected(state);
-                    audio_play_sound(AUDIO_SOUND_COIN);
-                    printf("Coin collected! Total: %d/%d\n", 
-                           state_get_coins_collected(state), state_get_total_coins(state));
+    SpatialHash coin_hash;
+    game_build_coin_hash(game, current_map, &coin_hash);
+    spatial_query_radius(&coin_hash, player_pos, PLAYER_RADIUS + item_get_radius(ITEM_TYPE_COIN), &query);
+    while (spatial_query_next(&query, &span)) {
+        for (int k = 0; k < span.count; k++) {
+            Coin* coin = &current_map->coins[span.index[k]];
+            if (coin->collected) continue;
+            
+            Item item = item_make(ITEM_TYPE_COIN, coin->position);
+            if (item_check_collision_with_player(&item, player_pos, PLAYER_RADIUS)) {
+                item_collect(&item);
+                coin->collected = true;
+                state_increment_coins_collected(state);
+                audio_play_sound(AUDIO_SOUND_COIN);
+                printf("Coin collected! Total: %d/%d\n", 
+                       state_get_coins_collected(state), state_get_total_coins(state));
+                
+                if (state_all_coins_collected(state)) {
+                    int completion_ticks = state_get_frame_count(state) - state_get_game_start_frame(state);
+                    float completion_time = (float)completion_ticks * delta_time;
+                    printf("All coins collected! Game complete in %.2f seconds!\n", completion_time);
                     
-                    if (state_all_coins_collected(state)) {
-                        int completion_frames = state_get_frame_count(state) - state_get_game_start_frame(state);
-                        printf("All coins collected! Game complete in %d frames!\n", completion_frames);
-                        
-                        audio_play_sound(AUDIO_SOUND_VICTORY);
-                        
-                        HighScore* pending_score = state_get_pending_score(state);
-                        pending_score->frame_count = completion_frames;
-                        pending_score->coins_collected = state_get_coins_collected(state);
-                        pending_score->health_remaining = player_get_health(player);
-                        
-                        char* player_name = state_get_player_name(state);
-                        memset(player_name, 0, MAX_NAME_LENGTH + 1);
-                        state_set_name_char_count(state, 0);
-                        
-                        state_set_type(state, GAME_STATE_ENTER_NAME);
-                    }
+                    audio_play_sound(AUDIO_SOUND_VICTORY);
+                    
+                    HighScore* pending_score = state_get_pending_score(state);
+                    pending_score->completion_time = completion_time;
+                    pending_score->coins_collected = state_get_coins_collected(state);
+                    pending_score->health_remaining = player_get_health(player);
+                    
+                    char* player_name = state_get_player_name(state);
+                    memset(player_name, 0, MAX_NAME_LENGTH + 1);
+                    state_set_name_char_count(state, 0);
+                    
+                    state_set_type(state, GAME_STATE_ENTER_NAME);
                 }
-                item_destroy(item);
             }
         }
     }
 }
 
+/**
+ * Game update callback.
+ * @param game_data Game data pointer
+ * @param input Player input for this tick
+ * @param delta_time Tick length in seconds
+ */
+static void game_update_callback(void* game_data, const InputFrame* input, float delta_time) {
+    PROFILE_BEGIN("game_update");
+    game_update_state(game_data, input, delta_time);
+    PROFILE_END();
+}
+
+/**
+ * Game publish callback.
+ * Copies the simulation state into the render snapshot. The engine calls this
+ * while no update is running, so the render callback never touches GameState.
+ * @param game_data Game data pointer
+ */
+static void game_publish_callback(void* game_data) {
+    CoinCollectorGame* game = (CoinCollectorGame*)game_data;
+    if (!game || !game->state) return;
+    
+    render_state_capture(&game->view, game->state, game->tick_delta);
+    game->view.selected_mode = game->selected_mode;
+    renderer3d_reserve_sprites(&game->enemy_sprites, game->view.map.obstacles.count);
+    renderer3d_reserve_sprites(&game->coin_sprites, game->view.map.coin_count);
+    game->view_ready = true;
+    
+    trace_counter("projectiles", game->view.projectile_count);
+    trace_counter("obstacles", game->view.map.obstacles.count);
+}
+
 /**
  * Game render callback.
+ * Draws only from the render snapshot taken by the publish callback.
  * @param game_data Game data pointer
  */
 static void game_render_callback(void* game_data) {
     CoinCollectorGame* game = (CoinCollectorGame*)game_data;
-    if (!game || !game->state) return;
+    if (!game || !game->view_ready) return;
     
-    GameState* state = game->state;
-    GameStateType current_state = state_get_type(state);
+    const RenderState* view = &game->view;
     
-    if (current_state == GAME_STATE_START) {
-        int high_score_count;
-        const HighScore* high_scores = state_get_high_scores(state, &high_score_count);
-        renderer_draw_start_screen(state_get_frame_count(state), high_scores, high_score_count);
+    if (view->type == GAME_STATE_START) {
+        renderer_draw_start_screen(view->time, view->high_scores, view->high_score_count);
         return;
     }
     
-    if (current_state == GAME_STATE_MODE_SELECT) {
-        renderer_draw_mode_select_screen(state_get_frame_count(state), g_selected_mode);
+    if (view->type == GAME_STATE_MODE_SELECT) {
+        renderer_draw_mode_select_screen(view->time, view->selected_mode);
         return;
     }
     
-    if (current_state == GAME_STATE_END) {
-        Player* player = state_get_player(state);
-        if (!player) return;
-        
-        int high_score_count;
-        const HighScore* high_scores = state_get_high_scores(state, &high_score_count);
-        renderer_draw_end_screen(state_get_frame_count(state), state_get_game_start_frame(state),
-                                 state_get_total_coins(state),
-                                 player_get_health(player), player_get_max_health(player),
-                                 high_scores, high_score_count);
+    if (view->type == GAME_STATE_END) {
+        renderer_draw_end_screen(view->time, view->pending_score.completion_time, view->total_coins,
+                                 view->player_health, view->player_max_health,
+                                 view->high_scores, view->high_score_count);
         return;
     }
     
-    if (current_state == GAME_STATE_ENTER_NAME) {
-        HighScore* pending_score = state_get_pending_score(state);
-        renderer_draw_name_entry_screen(state_get_player_name(state), 
-                                       state_get_name_char_count(state),
-                                       pending_score->frame_count,
-                                       pending_score->coins_collected,
-                                       pending_score->health_remaining);
+    if (view->type == GAME_STATE_ENTER_NAME) {
+        renderer_draw_name_entry_screen(view->player_name,
+                                       view->name_char_count,
+                                       view->pending_score.completion_time,
+                                       view->pending_score.coins_collected,
+                                       view->pending_score.health_remaining);
         return;
     }
     
-    if (current_state == GAME_STATE_HIGH_SCORES) {
-        int high_score_count;
-        const HighScore* high_scores = state_get_high_scores(state, &high_score_count);
-        renderer_draw_high_scores_screen(high_scores, high_score_count);
+    if (view->type == GAME_STATE_HIGH_SCORES) {
+        renderer_draw_high_scores_screen(view->high_scores, view->high_score_count);
         return;
     }
     
-    Player* player = state_get_player(state);
-    if (!player) return;
+    const Map* current_map = &view->map;
     
-    Map* current_map = state_get_current_map(state);
-    if (!current_map) return;
+    // Blend between the last two simulation ticks for smooth motion on
+    // displays that refresh faster than the tick rate
+    float alpha = game->engine ? gengine_get_interpolation_alpha(game->engine) : 1.0f;
+    Vector2 player_position = render_state_get_player_position(view, alpha);
     
-    GameMode mode = state_get_game_mode(state);
-    
-    if (mode == GAME_MODE_3D) {
+    if (view->mode == GAME_MODE_3D) {
         // Collect enemy positions and colors for 3D rendering
-        Vector2 enemy_positions[50];
-        Color enemy_colors[50];
-        int enemy_count = 0;
-        
-        for (int i = 0; i < current_map->obstacle_count && enemy_count < 50; i++) {
-            enemy_positions[enemy_count] = current_map->obstacles[i].position;
-            enemy_colors[enemy_count] = current_map->obstacles[i].color;
-            enemy_count++;
+        SpriteList* enemies = &game->enemy_sprites;
+        enemies->count = 0;
+        for (int i = 0; i < current_map->obstacles.count && enemies->count < enemies->capacity; i++) {
+            enemies->positions[enemies->count] = map_get_obstacle_interpolated_position(current_map, i, alpha);
+            enemies->colors[enemies->count] = current_map->obstacles.color[i];
+            enemies->count++;
         }
         
-        // Collect coin positions and collected status for 3D rendering
-        Vector2 coin_positions[50];
-        bool coin_collected[50];
-        int coin_count = 0;
+        // Collect the coins still to pick up
+        SpriteList* coins = &game->coin_sprites;
+        coins->count = 0;
+        for (int i = 0; i < current_map->coin_count && coins->count < coins->capacity; i++) {
+            if (current_map->coins[i].collected) continue;
+            coins->positions[coins->count++] = current_map->coins[i].position;
+        }
         
-        for (int i = 0; i < current_map->coin_count && coin_count < 50; i++) {
-            coin_positions[coin_count] = current_map->coins[i].position;
-            coin_collected[coin_count] = current_map->coins[i].collected;
-            coin_count++;
+        // Let the view resolution follow the time the last frame took
+        if (game->engine) {
+            renderer3d_update_resolution(gengine_get_frame_work_ms(game->engine),
+                                        gengine_get_frame_budget_ms(game->engine));
         }
         
         // Render 3D view
-        renderer3d_render(current_map, player_get_position(player), player_get_angle(player),
-                         player_get_health(player), player_get_max_health(player),
-                         state_get_current_map_id(state), state_get_coins_collected(state),
-                         enemy_positions, enemy_count, enemy_colors,
-                         coin_positions, coin_count, coin_collected);
+        renderer3d_render(current_map, player_position, view->player_angle,
+                         view->player_health, view->player_max_health,
+                         view->current_map_id, view->coins_collected,
+                         enemies, coins);
     } else {
         // Render 2D view
-        int projectile_count;
-        Projectile** projectiles = state_get_projectiles(state, &projectile_count);
-        
-        renderer_draw_game_screen(current_map, player_get_position(player),
-                                 player_is_invincible(player), player_get_invincibility_timer(player),
-                                 player_get_health(player), player_get_max_health(player),
-                                 state_get_current_map_id(state), state_get_coins_collected(state),
-                                 projectiles, projectile_count);
+        renderer_draw_game_screen(current_map, player_position,
+                                 view->player_invincible, view->player_invincibility_timer,
+                                 view->player_health, view->player_max_health,
+                                 view->current_map_id, view->coins_collected,
+                                 view->projectile_positions, view->projectile_previous_positions,
+                                 view->projectile_count, alpha);
     }
 }
 
@@ -562,11 +770,71 @@ static void game_cleanup_callback(void* game_data) {
     CoinCollectorGame* game = (CoinCollectorGame*)game_data;
     if (!game) return;
     
+    // The engine destroys its job system and closes the window after cleanup
+    renderer3d_set_jobs(NULL);
+    renderer3d_shutdown();
+    
     if (game->state) {
         printf("Game cleanup. Total frames: %d\n", state_get_frame_count(game->state));
         state_destroy(game->state);
         game->state = NULL;
     }
+    arena_destroy(game->frame_arena);
+    game->frame_arena = NULL;
+    render_state_release(&game->view);
+    renderer3d_release_sprites(&game->enemy_sprites);
+    renderer3d_release_sprites(&game->coin_sprites);
+    game->view_ready = false;
+}
+
+/**
+ * Saved game: the game's own simulation fields, followed by a state snapshot.
+ */
+typedef struct {
+    int selected_mode;
+    Vector2 last_mouse_pos;
+} GameSaveHeader;
+
+/**
+ * Game save callback.
+ * @param game_data Game data pointer
+ * @param buffer Destination, or NULL to only query the size
+ * @param capacity Size of the buffer in bytes
+ * @return Bytes needed
+ */
+static size_t game_save_state_callback(void* game_data, void* buffer, size_t capacity) {
+    CoinCollectorGame* game = (CoinCollectorGame*)game_data;
+    if (!game || !game->state) return 0;
+    
+    size_t size = sizeof(GameSaveHeader) + state_snapshot_size(game->state);
+    if (!buffer || size > capacity) return size;
+    
+    GameSaveHeader header = {game->selected_mode, game->last_mouse_pos};
+    memcpy(buffer, &header, sizeof(header));
+    state_snapshot(game->state, (uint8_t*)buffer + sizeof(header), capacity - sizeof(header));
+    return size;
+}
+
+/**
+ * Game load callback.
+ * @param game_data Game data pointer
+ * @param buffer Saved game
+ * @param size Size of the saved game in bytes
+ * @return true on success, false if the data is invalid
+ */
+static bool game_load_state_callback(void* game_data, const void* buffer, size_t size) {
+    CoinCollectorGame* game = (CoinCollectorGame*)game_data;
+    if (!game || !game->state || !buffer || size < sizeof(GameSaveHeader)) return false;
+    
+    if (!state_restore(game->state, (const uint8_t*)buffer + sizeof(GameSaveHeader),
+                       size - sizeof(GameSaveHeader))) {
+        return false;
+    }
+    GameSaveHeader header;
+    memcpy(&header, buffer, sizeof(header));
+    game->selected_mode = header.selected_mode;
+    game->last_mouse_pos = header.last_mouse_pos;
+    return true;
 }
 
 /**
@@ -580,7 +848,7 @@ static void game_handle_input_callback(void* game_data, int key) {
 }
 
 CoinCollectorGame* game_create(void) {
-    CoinCollectorGame* game = (CoinCollectorGame*)malloc(sizeof(CoinCollectorGame));
+    CoinCollectorGame* game = (CoinCollectorGame*)mem_alloc(MEM_TAG_GAME, sizeof(CoinCollectorGame));
     if (!game) {
         return NULL;
     }
@@ -588,6 +856,7 @@ CoinCollectorGame* game_create(void) {
     memset(game, 0, sizeof(CoinCollectorGame));
     game->engine = NULL;
     game->state = NULL;
+    game->persist_high_scores = true;
     
     return game;
 }
@@ -598,7 +867,11 @@ void game_destroy(CoinCollectorGame* game) {
     if (game->state) {
         state_destroy(game->state);
     }
-    free(game);
+    arena_destroy(game->frame_arena);
+    render_state_release(&game->view);
+    renderer3d_release_sprites(&game->enemy_sprites);
+    renderer3d_release_sprites(&game->coin_sprites);
+    mem_free(game);
 }
 
 GameCallbacks game_get_callbacks(CoinCollectorGame* game) {
@@ -607,8 +880,11 @@ GameCallbacks game_get_callbacks(CoinCollectorGame* game) {
         callbacks.init = game_init_callback;
         callbacks.update = game_update_callback;
         callbacks.render = game_render_callback;
+        callbacks.publish = game_publish_callback;
         callbacks.cleanup = game_cleanup_callback;
         callbacks.handle_input = game_handle_input_callback;
+        callbacks.save_state = game_save_state_callback;
+        callbacks.load_state = game_load_state_callback;
     }
     return callbacks;
 }
@@ -622,3 +898,30 @@ void game_set_engine(CoinCollectorGame* game, GameEngine* engine) {
         game->engine = engine;
     }
 }
+
+void game_set_seed(CoinCollectorGame* game, uint64_t seed) {
+    if (!game) return;
+    game->seed = seed;
+    game->has_seed = true;
+}
+
+void game_set_persist_high_scores(CoinCollectorGame* game, bool persist) {
+    if (game) {
+        game->persist_high_scores = persist;
+    }
+}
+
+GameState* game_get_state(CoinCollectorGame* game) {
+    if (!game) return NULL;
+    return game->state;
+}
+
+int game_get_selected_mode(CoinCollectorGame* game) {
+    if (!game) return 0;
+    return game->selected_mode;
+}
+
+void game_set_selected_mode(CoinCollectorGame* game, int selected_mode) {
+    if (!game) return;
+    game->selected_mode = selected_mode;
+}
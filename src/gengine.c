@@ -1,27 +1,137 @@
 #include "../include/gengine.h"
 #include "../include/audio.h"
+#include "../include/timer.h"
+#include "../include/thread.h"
+#include "../include/profiler.h"
+#include "../include/trace.h"
+#include "../include/renderer.h"
+#include "../include/input.h"
+#include "../include/replay.h"
+#include "../include/rollback.h"
+#include "../include/mem.h"
 #include <stdlib.h>
 #include <stdio.h>
+#include <string.h>
+
+#define HEADLESS_REPORT_INTERVAL_NS 5000000000ull
+#define MAX_FRAME_TIME 0.25f  // Clamp long stalls so the sim doesn't spiral
+#define REPLAY_SKIP_SECONDS 5  // Left/right arrows skip this far during windowed playback
+#define MEMORY_OVERLAY_X 400   // Right of the profiler overlay, so both fit
+
+// Game session added next to the registered game
+typedef struct {
+    GameCallbacks callbacks;
+    void* game_data;
+    SessionInputCallback read_input;  // Fills input before each tick (NULL = left to the caller)
+    void* input_data;
+    InputFrame input;  // This session's own; presses are consumed by each tick
+    int tick_count;
+    float tick_delta;
+} EngineSession;
 
 struct GameEngine {
     EngineConfig config;
     GameCallbacks callbacks;
     void* game_data;
+    EngineSession* sessions;  // Extra sessions, ticked in parallel when headless
+    int session_count;
     bool running;
     int frame_count;
+    int tick_count;
     bool initialized;
+    double simulated_fps;
+    float tick_delta;
+    double accumulator;
+    float interpolation_alpha;
+    float frame_work_ms;  // CPU time of the last frame, excluding the present wait
+    bool memory_overlay;  // Toggled with F4
+    
+    // Input polled per render frame; presses stay latched until a tick consumes them
+    InputFrame input;
+    ReplayWriter* recorder;  // Records each tick's input (NULL = off)
+    ReplayReader* replay;    // Supplies each tick's input instead of the window (NULL = off)
+    uint8_t* state_buffer;  // Scratch space for saving the game's state
+    size_t state_capacity;
+    int seek_target;  // Replay tick to seek to before the next frame (-1 = none)
+    RollbackBuffer* rollback;     // Recent ticks' states and inputs (NULL = off)
+    InputFrame* rollback_inputs;  // Inputs for the requested rollback, rollback_ticks long
+    int rollback_input_count;
+    int rollback_target;  // Tick to roll back to before the next frame (-1 = none)
+    
+    // Simulation worker used in pipelined mode
+    Thread* sim_thread;
+    ThreadMutex* sim_mutex;
+    ThreadCond* sim_wake;
+    ThreadCond* sim_done;
+    int sim_pending_ticks;
+    bool sim_quit;
+    bool sim_stop;  // A tick on the worker ended the replay or called gengine_stop()
+    
+    JobSystem* jobs;
 };
 
 GameEngine* gengine_create(const EngineConfig* config) {
-    GameEngine* engine = (GameEngine*)malloc(sizeof(GameEngine));
+    GameEngine* engine = (GameEngine*)mem_alloc(MEM_TAG_ENGINE, sizeof(GameEngine));
     if (!engine) {
         return NULL;
     }
     
+    memset(engine, 0, sizeof(GameEngine));
     engine->config = *config;
+    
+    if (engine->config.replay_path) {
+        engine->replay = replay_reader_open(engine->config.replay_path);
+        if (!engine->replay) {
+            mem_free(engine);
+            return NULL;
+        }
+        engine->config.seed = replay_reader_get_seed(engine->replay);
+        engine->config.tick_rate = replay_reader_get_tick_rate(engine->replay);
+        printf("Replaying %s: %d ticks at %d ticks/s\n", engine->config.replay_path,
+               replay_reader_get_tick_count(engine->replay), engine->config.tick_rate);
+    }
+    
+    if (engine->config.tick_rate <= 0) {
+        engine->config.tick_rate = GENGINE_DEFAULT_TICK_RATE;
+    }
+    if (engine->config.keyframe_interval <= 0) {
+        engine->config.keyframe_interval = GENGINE_DEFAULT_KEYFRAME_INTERVAL;
+    }
+    if (engine->config.seed == 0) {
+        engine->config.seed = timer_now_ns();
+        printf("Seed: %llu\n", (unsigned long long)engine->config.seed);
+    }
+    
+    if (engine->config.record_path) {
+        engine->recorder = replay_writer_create(engine->config.seed, engine->config.tick_rate);
+        if (!engine->recorder) {
+            replay_reader_destroy(engine->replay);
+            mem_free(engine);
+            return NULL;
+        }
+    }
+    
+    if (engine->config.rollback_ticks > 0) {
+        engine->rollback = rollback_create(engine->config.rollback_ticks);
+        engine->rollback_inputs = (InputFrame*)mem_calloc(MEM_TAG_ENGINE, (size_t)engine->config.rollback_ticks, sizeof(InputFrame));
+        if (!engine->rollback || !engine->rollback_inputs) {
+            rollback_destroy(engine->rollback);
+            mem_free(engine->rollback_inputs);
+            replay_writer_destroy(engine->recorder);
+            replay_reader_destroy(engine->replay);
+            mem_free(engine);
+            return NULL;
+        }
+    }
     engine->running = false;
     engine->frame_count = 0;
+    engine->tick_count = 0;
     engine->initialized = false;
+    engine->simulated_fps = 0.0;
+    engine->tick_delta = 1.0f / (float)engine->config.tick_rate;
+    engine->accumulator = 0.0;
+    engine->interpolation_alpha = 1.0f;
+    engine->frame_work_ms = 0.0f;
     engine->game_data = NULL;
     
     engine->callbacks.init = NULL;
@@ -29,6 +139,25 @@ GameEngine* gengine_create(const EngineConfig* config) {
     engine->callbacks.render = NULL;
     engine->callbacks.cleanup = NULL;
     engine->callbacks.handle_input = NULL;
+    engine->callbacks.publish = NULL;
+    
+    engine->sim_thread = NULL;
+    engine->sim_mutex = NULL;
+    engine->sim_wake = NULL;
+    engine->sim_done = NULL;
+    engine->sim_pending_ticks = 0;
+    engine->sim_quit = false;
+    engine->sim_stop = false;
+    engine->jobs = NULL;
+    
+    engine->sessions = NULL;
+    engine->session_count = 0;
+    
+    engine->state_buffer = NULL;
+    engine->state_capacity = 0;
+    engine->seek_target = (engine->replay && engine->config.replay_start_tick > 0) ? engine->config.replay_start_tick : -1;
+    engine->rollback_input_count = 0;
+    engine->rollback_target = -1;
     
     return engine;
 }
@@ -48,7 +177,13 @@ void gengine_destroy(GameEngine* engine) {
         CloseWindow();
     }
     
-    free(engine);
+    replay_writer_destroy(engine->recorder);
+    replay_reader_destroy(engine->replay);
+    mem_free(engine->state_buffer);
+    rollback_destroy(engine->rollback);
+    mem_free(engine->rollback_inputs);
+    mem_free(engine->sessions);
+    mem_free(engine);
 }
 
 void gengine_register_game(GameEngine* engine, GameCallbacks* callbacks, void* game_data) {
@@ -58,9 +193,575 @@ void gengine_register_game(GameEngine* engine, GameCallbacks* callbacks, void* g
     engine->game_data = game_data;
 }
 
+bool gengine_add_session(GameEngine* engine, GameCallbacks* callbacks, void* game_data,
+                         SessionInputCallback read_input, void* input_data) {
+    if (!engine || !callbacks) return false;
+    if (engine->session_count + 1 >= GENGINE_MAX_SESSIONS) return false;
+    
+    if (!engine->sessions) {
+        engine->sessions = (EngineSession*)mem_calloc(MEM_TAG_ENGINE, GENGINE_MAX_SESSIONS - 1, sizeof(EngineSession));
+        if (!engine->sessions) return false;
+    }
+    
+    EngineSession* session = &engine->sessions[engine->session_count++];
+    session->callbacks = *callbacks;
+    session->game_data = game_data;
+    session->read_input = read_input;
+    session->input_data = input_data;
+    input_clear(&session->input);
+    session->tick_count = 0;
+    session->tick_delta = engine->tick_delta;
+    return true;
+}
+
+InputFrame* gengine_get_session_input(GameEngine* engine, int session) {
+    if (!engine || session < 1 || session > engine->session_count) return NULL;
+    return &engine->sessions[session - 1].input;
+}
+
+int gengine_get_session_count(GameEngine* engine) {
+    if (!engine) return 0;
+    return 1 + engine->session_count;
+}
+
+/**
+ * Check whether the configured frame limit has been reached.
+ * @param engine The engine
+ * @return true if the engine should stop, false otherwise
+ */
+static bool gengine_frame_limit_reached(const GameEngine* engine) {
+    return engine->config.max_frames > 0 && engine->frame_count >= engine->config.max_frames;
+}
+
+/**
+ * Advance one extra session by a tick. Runs as a job.
+ * @param user_data The EngineSession
+ */
+static void gengine_tick_session(void* user_data) {
+    EngineSession* session = (EngineSession*)user_data;
+    
+    PROFILE_BEGIN("session_tick");
+    if (session->read_input) {
+        session->read_input(session->input_data, session->tick_count, &session->input);
+    }
+    if (session->callbacks.update && session->game_data) {
+        mem_frame_begin();
+        session->callbacks.update(session->game_data, &session->input, session->tick_delta);
+        mem_frame_end();
+    }
+    session->tick_count++;
+    input_consume(&session->input);
+    PROFILE_END();
+}
+
+/**
+ * Save the registered game into the engine's state buffer, growing it if
+ * needed. The caller checks that the game has a save_state callback.
+ * @param engine The engine
+ * @return Size of the saved state, or 0 on failure
+ */
+static size_t gengine_save_state(GameEngine* engine) {
+    size_t size = engine->callbacks.save_state(engine->game_data, engine->state_buffer, engine->state_capacity);
+    if (size > engine->state_capacity) {
+        uint8_t* buffer = (uint8_t*)mem_realloc(MEM_TAG_ENGINE, engine->state_buffer, size);
+        if (!buffer) return 0;
+        engine->state_buffer = buffer;
+        engine->state_capacity = size;
+        size = engine->callbacks.save_state(engine->game_data, buffer, size);
+    }
+    return size <= engine->state_capacity ? size : 0;
+}
+
+/**
+ * Save the registered game into the recording as a keyframe, if the game
+ * supports saving.
+ * @param engine The engine
+ */
+static void gengine_record_keyframe(GameEngine* engine) {
+    if (!engine->callbacks.save_state || !engine->game_data) return;
+    
+    PROFILE_BEGIN("keyframe");
+    size_t size = gengine_save_state(engine);
+    if (size == 0 || !replay_writer_add_keyframe(engine->recorder, engine->state_buffer, size)) {
+        printf("Error: Could not save a replay keyframe at tick %d\n", replay_writer_get_tick_count(engine->recorder));
+    }
+    PROFILE_END();
+}
+
+/**
+ * Run the registered game's update for one tick with the engine's input,
+ * first saving the state and input into the rollback ring when it is on.
+ * A tick the ring already holds as its newest, which is where a rollback
+ * starts, only has its input replaced.
+ * @param engine The engine
+ */
+static void gengine_update(GameEngine* engine) {
+    if (!engine->callbacks.update || !engine->game_data) return;
+    
+    if (engine->rollback && engine->callbacks.save_state) {
+        PROFILE_BEGIN("rollback_save");
+        if (rollback_get_newest_tick(engine->rollback) == engine->tick_count) {
+            rollback_set_input(engine->rollback, engine->tick_count, &engine->input);
+        } else {
+            size_t size = gengine_save_state(engine);
+            if (size == 0 || !rollback_push(engine->rollback, engine->tick_count, engine->state_buffer, size, &engine->input)) {
+                // Out of sequence after a seek: start the history over from here
+                rollback_clear(engine->rollback);
+                if (size == 0 || !rollback_push(engine->rollback, engine->tick_count, engine->state_buffer, size, &engine->input)) {
+                    printf("Error: Could not save tick %d for rollback\n", engine->tick_count);
+                }
+            }
+        }
+        PROFILE_END();
+    }
+    mem_frame_begin();
+    engine->callbacks.update(engine->game_data, &engine->input, engine->tick_delta);
+    mem_frame_end();
+}
+
+/**
+ * Advance the simulation by one fixed tick. In headless mode the extra
+ * sessions tick on the job system while the registered game ticks here.
+ * When playing a replay the tick's input comes from it. The caller stops
+ * the engine once it runs out; the tick may be on the sim worker.
+ * @param engine The engine
+ * @return false if the replay has run out and no tick was run, true otherwise
+ */
+static bool gengine_tick(GameEngine* engine) {
+    if (engine->replay && !replay_reader_next_tick(engine->replay, &engine->input)) {
+        return false;
+    }
+    if (engine->recorder && replay_writer_get_tick_count(engine->recorder) % engine->config.keyframe_interval == 0) {
+        gengine_record_keyframe(engine);
+    }
+    if (engine->recorder && !replay_writer_add_tick(engine->recorder, &engine->input)) {
+        printf("Error: Out of memory recording the replay, recording stopped\n");
+        replay_writer_destroy(engine->recorder);
+        engine->recorder = NULL;
+    }
+    
+    PROFILE_BEGIN("tick");
+    JobGroup sessions = JOB_GROUP_INIT;
+    if (engine->config.headless) {
+        for (int i = 0; i < engine->session_count; i++) {
+            jobs_group_run(engine->jobs, &sessions, gengine_tick_session, &engine->sessions[i]);
+        }
+    }
+    gengine_update(engine);
+    jobs_group_wait(engine->jobs, &sessions);
+    PROFILE_END();
+    engine->tick_count++;
+    input_consume(&engine->input);
+    return true;
+}
+
+/**
+ * Move replay playback to a tick: restore the nearest keyframe at or before
+ * it, unless simulating forward from the current tick is shorter, and
+ * simulate the remaining ticks without sound. Must only be called while no
+ * tick is running.
+ * @param engine The engine
+ * @param tick Target tick, clamped to the replay
+ */
+static void gengine_seek(GameEngine* engine, int tick) {
+    if (engine->recorder) {
+        printf("Error: Cannot seek a replay while recording\n");
+        return;
+    }
+    
+    int tick_count = replay_reader_get_tick_count(engine->replay);
+    if (tick < 0) tick = 0;
+    if (tick > tick_count) tick = tick_count;
+    
+    uint64_t start_ns = timer_now_ns();
+    int current = replay_reader_get_tick(engine->replay);
+    int keyframe_tick = engine->callbacks.load_state ? replay_reader_find_keyframe(engine->replay, tick) : -1;
+    if (keyframe_tick >= 0 && (tick < current || keyframe_tick > current)) {
+        const void* state = NULL;
+        size_t size = 0;
+        if (!engine->game_data ||
+            replay_reader_seek_keyframe(engine->replay, tick, &state, &size) < 0 ||
+            !engine->callbacks.load_state(engine->game_data, state, size)) {
+            printf("Error: Could not restore the replay keyframe at tick %d\n", keyframe_tick);
+            engine->running = false;
+            return;
+        }
+        engine->tick_count = keyframe_tick;
+        input_clear(&engine->input);
+    } else if (tick < current) {
+        printf("Error: The replay has no keyframe to seek back to tick %d\n", tick);
+        return;
+    }
+    
+    PROFILE_BEGIN("seek");
+    int resimulated = tick - replay_reader_get_tick(engine->replay);
+    audio_set_muted(true);
+    while (engine->running && replay_reader_get_tick(engine->replay) < tick) {
+        if (!gengine_tick(engine)) {
+            engine->running = false;
+        }
+    }
+    audio_set_muted(false);
+    PROFILE_END();
+    
+    engine->accumulator = 0.0;
+    printf("Replay at tick %d of %d (simulated %d ticks in %.2f ms)\n", replay_reader_get_tick(engine->replay),
+           tick_count, resimulated, (timer_now_ns() - start_ns) / 1e6);
+}
+
+/**
+ * Rewind the registered game to the start of a held tick and simulate it
+ * forward to the current tick again without sound, using the queued
+ * inputs for the first ticks and the stored ones after that. Must only be
+ * called while no tick is running.
+ * @param engine The engine
+ * @param tick First tick to simulate again
+ */
+static void gengine_rollback(GameEngine* engine, int tick) {
+    int current = engine->tick_count;
+    int ticks = current - tick;
+    if (tick < rollback_get_oldest_tick(engine->rollback) || ticks <= 0 || ticks > engine->config.rollback_ticks) {
+        printf("Error: Cannot roll back to tick %d from tick %d\n", tick, current);
+        return;
+    }
+    
+    PROFILE_BEGIN("rollback");
+    // Rewinding drops the newer ticks, inputs included, so gather them first
+    for (int i = engine->rollback_input_count; i < ticks; i++) {
+        engine->rollback_inputs[i] = *rollback_get_input(engine->rollback, tick + i);
+    }
+    
+    size_t size = 0;
+    const void* state = rollback_rewind(engine->rollback, tick, &size);
+    if (!state || !engine->callbacks.load_state(engine->game_data, state, size)) {
+        printf("Error: Could not restore tick %d for rollback\n", tick);
+        engine->running = false;
+        PROFILE_END();
+        return;
+    }
+    
+    InputFrame live_input = engine->input;
+    engine->tick_count = tick;
+    audio_set_muted(true);
+    for (int i = 0; i < ticks; i++) {
+        engine->input = engine->rollback_inputs[i];
+        gengine_update(engine);
+        engine->tick_count++;
+    }
+    audio_set_muted(false);
+    engine->input = live_input;
+    PROFILE_END();
+}
+
+/**
+ * Carry out a seek or rollback requested since the last frame, if any.
+ * @param engine The engine
+ */
+static void gengine_apply_requests(GameEngine* engine) {
+    if (engine->seek_target >= 0) {
+        int tick = engine->seek_target;
+        engine->seek_target = -1;
+        gengine_seek(engine, tick);
+    }
+    if (engine->rollback_target >= 0) {
+        int tick = engine->rollback_target;
+        engine->rollback_target = -1;
+        gengine_rollback(engine, tick);
+        engine->rollback_input_count = 0;
+    }
+}
+
+/**
+ * Take the render snapshot. Must only be called while no tick is running.
+ * @param engine The engine
+ */
+static void gengine_publish(GameEngine* engine) {
+    PROFILE_BEGIN("publish");
+    if (engine->callbacks.publish && engine->game_data) {
+        mem_frame_begin();
+        engine->callbacks.publish(engine->game_data);
+        mem_frame_end();
+    }
+    PROFILE_END();
+}
+
+/**
+ * Render one frame through the game's render callback, with the profiler
+ * and memory overlays on top when they are enabled. Must be called between BeginDrawing()
+ * and EndDrawing().
+ * @param engine The engine
+ */
+static void gengine_render(GameEngine* engine) {
+    PROFILE_BEGIN("render");
+    if (engine->callbacks.render && engine->game_data) {
+        mem_frame_begin();
+        engine->callbacks.render(engine->game_data);
+        mem_frame_end();
+    }
+    PROFILE_END();
+    
+    if (profiler_is_overlay_visible()) {
+        renderer_draw_profiler_overlay(10, 140);
+    }
+    if (engine->memory_overlay) {
+        renderer_draw_memory_overlay(profiler_is_overlay_visible() ? MEMORY_OVERLAY_X : 10, 140);
+    }
+}
+
+/**
+ * Simulation worker entry point. Sleeps until the render thread hands it a
+ * batch of ticks, runs them and reports back.
+ * @param user_data The engine
+ */
+static void gengine_sim_thread_main(void* user_data) {
+    GameEngine* engine = (GameEngine*)user_data;
+    
+    trace_set_thread_name("simulation");
+    
+    thread_mutex_lock(engine->sim_mutex);
+    while (true) {
+        while (engine->sim_pending_ticks == 0 && !engine->sim_quit) {
+            thread_cond_wait(engine->sim_wake, engine->sim_mutex);
+        }
+        if (engine->sim_pending_ticks == 0) {
+            break;
+        }
+        
+        int ticks = engine->sim_pending_ticks;
+        thread_mutex_unlock(engine->sim_mutex);
+        
+        // engine->running belongs to the render thread; an ended replay is
+        // reported through sim_stop and picked up by gengine_sim_wait()
+        PROFILE_BEGIN("simulate");
+        bool ended = false;
+        for (int i = 0; i < ticks && !ended; i++) {
+            ended = !gengine_tick(engine);
+        }
+        PROFILE_END();
+        
+        thread_mutex_lock(engine->sim_mutex);
+        if (ended) {
+            engine->sim_stop = true;
+        }
+        engine->sim_pending_ticks = 0;
+        thread_cond_signal(engine->sim_done);
+    }
+    thread_mutex_unlock(engine->sim_mutex);
+}
+
+/**
+ * Release the simulation worker's synchronization objects.
+ * @param engine The engine
+ */
+static void gengine_destroy_sim_sync(GameEngine* engine) {
+    if (engine->sim_done) thread_cond_destroy(engine->sim_done);
+    if (engine->sim_wake) thread_cond_destroy(engine->sim_wake);
+    if (engine->sim_mutex) thread_mutex_destroy(engine->sim_mutex);
+    engine->sim_done = NULL;
+    engine->sim_wake = NULL;
+    engine->sim_mutex = NULL;
+}
+
+/**
+ * Start the simulation worker thread.
+ * @param engine The engine
+ * @return true on success, false if threads are unavailable
+ */
+static bool gengine_start_sim_thread(GameEngine* engine) {
+    engine->sim_mutex = thread_mutex_create();
+    engine->sim_wake = thread_cond_create();
+    engine->sim_done = thread_cond_create();
+    engine->sim_pending_ticks = 0;
+    engine->sim_quit = false;
+    
+    if (engine->sim_mutex && engine->sim_wake && engine->sim_done) {
+        engine->sim_thread = thread_create(gengine_sim_thread_main, engine);
+    }
+    
+    if (!engine->sim_thread) {
+        gengine_destroy_sim_sync(engine);
+        return false;
+    }
+    return true;
+}
+
+/**
+ * Stop and join the simulation worker thread.
+ * @param engine The engine
+ */
+static void gengine_stop_sim_thread(GameEngine* engine) {
+    if (!engine->sim_thread) return;
+    
+    thread_mutex_lock(engine->sim_mutex);
+    engine->sim_quit = true;
+    thread_cond_signal(engine->sim_wake);
+    thread_mutex_unlock(engine->sim_mutex);
+    
+    thread_join(engine->sim_thread);
+    engine->sim_thread = NULL;
+    gengine_destroy_sim_sync(engine);
+}
+
+/**
+ * Hand a batch of ticks to the simulation worker without waiting.
+ * @param engine The engine
+ * @param ticks Number of ticks to run
+ */
+static void gengine_sim_begin(GameEngine* engine, int ticks) {
+    if (ticks <= 0) return;
+    
+    thread_mutex_lock(engine->sim_mutex);
+    engine->sim_pending_ticks = ticks;
+    thread_cond_signal(engine->sim_wake);
+    thread_mutex_unlock(engine->sim_mutex);
+}
+
+/**
+ * Wait until the simulation worker has finished its batch.
+ * @param engine The engine
+ * @return false if a tick asked the engine to stop, true otherwise
+ */
+static bool gengine_sim_wait(GameEngine* engine) {
+    thread_mutex_lock(engine->sim_mutex);
+    while (engine->sim_pending_ticks > 0) {
+        thread_cond_wait(engine->sim_done, engine->sim_mutex);
+    }
+    bool keep_running = !engine->sim_stop;
+    thread_mutex_unlock(engine->sim_mutex);
+    return keep_running;
+}
+
+/**
+ * Sleep until a paced headless tick is due and schedule the next one.
+ * After a stall longer than MAX_FRAME_TIME the schedule restarts from now
+ * instead of running the missed ticks back to back.
+ * @param engine The engine
+ * @param deadline_ns Time the tick is due, advanced by one tick
+ */
+static void gengine_wait_for_tick(GameEngine* engine, uint64_t* deadline_ns) {
+    uint64_t now_ns = timer_now_ns();
+    if (now_ns < *deadline_ns) {
+        timer_sleep_ns(*deadline_ns - now_ns);
+    } else if (now_ns - *deadline_ns > (uint64_t)(MAX_FRAME_TIME * 1e9)) {
+        *deadline_ns = now_ns;
+    }
+    *deadline_ns += (uint64_t)(1e9 / engine->config.tick_rate);
+}
+
+/**
+ * Run the main loop without a window, audio device or render callback.
+ * Ticks are driven back to back so the simulation runs as fast as the
+ * CPU allows, or at the tick rate when paced; every loop iteration counts
+ * as one frame.
+ * @param engine The engine to run
+ */
+static void gengine_run_headless(GameEngine* engine) {
+    if (engine->callbacks.init && engine->game_data) {
+        engine->callbacks.init(engine->game_data);
+    }
+    for (int i = 0; i < engine->session_count; i++) {
+        if (engine->sessions[i].callbacks.init && engine->sessions[i].game_data) {
+            engine->sessions[i].callbacks.init(engine->sessions[i].game_data);
+        }
+    }
+    
+    engine->running = true;
+    
+    uint64_t start_ns = timer_now_ns();
+    uint64_t report_ns = start_ns;
+    uint64_t tick_deadline_ns = start_ns;
+    int report_frames = 0;
+    
+    while (engine->running && !gengine_frame_limit_reached(engine)) {
+        if (engine->config.paced) {
+            gengine_wait_for_tick(engine, &tick_deadline_ns);
+        }
+        gengine_apply_requests(engine);
+        if (!engine->running) break;
+        if (!gengine_tick(engine)) {
+            engine->running = false;
+        }
+        engine->frame_count++;
+        profiler_frame_end();
+        mem_next_frame();
+        trace_flush();
+        
+        uint64_t now_ns = timer_now_ns();
+        if (now_ns - report_ns >= HEADLESS_REPORT_INTERVAL_NS) {
+            double interval = (double)(now_ns - report_ns) / 1e9;
+            printf("Headless: %d frames, %.0f frames/s\n",
+                   engine->frame_count, (engine->frame_count - report_frames) / interval);
+            report_ns = now_ns;
+            report_frames = engine->frame_count;
+        }
+    }
+    
+    double elapsed = (double)(timer_now_ns() - start_ns) / 1e9;
+    engine->simulated_fps = (elapsed > 0.0) ? engine->frame_count / elapsed : 0.0;
+    printf("Headless run: %d frames in %.3f s (%.0f frames/s)\n",
+           engine->frame_count, elapsed, engine->simulated_fps);
+    if (engine->session_count > 0) {
+        printf("Headless sessions: %d (%.0f session ticks/s)\n",
+               gengine_get_session_count(engine), engine->simulated_fps * gengine_get_session_count(engine));
+    }
+    
+    for (int i = 0; i < engine->session_count; i++) {
+        if (engine->sessions[i].callbacks.cleanup && engine->sessions[i].game_data) {
+            engine->sessions[i].callbacks.cleanup(engine->sessions[i].game_data);
+        }
+    }
+    if (engine->callbacks.cleanup && engine->game_data) {
+        engine->callbacks.cleanup(engine->game_data);
+    }
+}
+
+/**
+ * Write the recorded replay, if recording.
+ * @param engine The engine
+ */
+static void gengine_save_recording(GameEngine* engine) {
+    if (!engine->recorder) return;
+    
+    long bytes = replay_writer_save(engine->recorder, engine->config.record_path);
+    if (bytes > 0) {
+        printf("Recorded %d ticks to %s (%ld bytes)\n",
+               replay_writer_get_tick_count(engine->recorder), engine->config.record_path, bytes);
+    }
+}
+
 void gengine_run(GameEngine* engine) {
     if (!engine) return;
     
+    if (!profiler_init()) {
+        printf("Failed to initialize profiler\n");
+    }
+    
+    if (engine->config.trace_path && trace_start(engine->config.trace_path)) {
+        trace_set_thread_name("main");
+        printf("Tracing to %s\n", engine->config.trace_path);
+    }
+    
+    engine->jobs = jobs_create(engine->config.job_threads);
+    if (engine->jobs) {
+        printf("Job system: %d threads\n", jobs_get_thread_count(engine->jobs));
+    } else {
+        printf("Failed to create job system, running single-threaded\n");
+    }
+    
+    if (engine->config.headless) {
+        gengine_run_headless(engine);
+        gengine_save_recording(engine);
+        jobs_destroy(engine->jobs);
+        engine->jobs = NULL;
+        trace_stop();
+        profiler_shutdown();
+        return;
+    }
+    
+    if (engine->session_count > 0) {
+        printf("Running with a window: ignoring %d extra sessions\n", engine->session_count);
+    }
+    
     InitWindow(engine->config.screen_width, engine->config.screen_height, engine->config.window_title);
     SetTargetFPS(engine->config.target_fps);
     
@@ -72,26 +773,110 @@ void gengine_run(GameEngine* engine) {
     
     engine->running = true;
     
-    while (engine->running && !WindowShouldClose()) {
-        float delta_time = GetFrameTime();
+    bool pipelined = engine->config.pipelined && gengine_start_sim_thread(engine);
+    if (engine->config.pipelined && !pipelined) {
+        printf("Failed to start simulation thread, running serially\n");
+    }
+    
+    while (engine->running && !WindowShouldClose() && !gengine_frame_limit_reached(engine)) {
+        uint64_t frame_start = timer_now_ns();
+        float frame_time = GetFrameTime();
+        if (frame_time > MAX_FRAME_TIME) {
+            frame_time = MAX_FRAME_TIME;
+        }
         
         if (IsKeyPressed(KEY_ESCAPE)) {
             engine->running = false;
         }
         
-        if (engine->callbacks.update && engine->game_data) {
-            engine->callbacks.update(engine->game_data, delta_time);
+        if (IsKeyPressed(KEY_F3)) {
+            profiler_set_overlay_visible(!profiler_is_overlay_visible());
+        }
+        if (IsKeyPressed(KEY_F4)) {
+            engine->memory_overlay = !engine->memory_overlay;
+        }
+        
+        // Any sim worker is idle here, so a seek or rollback can tick on this thread
+        if (engine->replay) {
+            int skip = REPLAY_SKIP_SECONDS * engine->config.tick_rate;
+            if (IsKeyPressed(KEY_RIGHT)) gengine_request_seek(engine, replay_reader_get_tick(engine->replay) + skip);
+            if (IsKeyPressed(KEY_LEFT)) gengine_request_seek(engine, replay_reader_get_tick(engine->replay) - skip);
         }
+        gengine_apply_requests(engine);
         
-        if (engine->callbacks.render && engine->game_data) {
+        if (pipelined) {
+            // The worker is idle here: snapshot the state it produced last
+            // frame, then let it simulate this frame while that is drawn
+            engine->interpolation_alpha = (float)(engine->accumulator / engine->tick_delta);
+            gengine_publish(engine);
+            
+            if (!engine->replay) {
+                input_poll(&engine->input);
+            }
+            
+            engine->accumulator += frame_time;
+            int ticks = 0;
+            while (engine->accumulator >= engine->tick_delta) {
+                engine->accumulator -= engine->tick_delta;
+                ticks++;
+            }
+            gengine_sim_begin(engine, ticks);
+            trace_counter("ticks_per_frame", ticks);
+            
             BeginDrawing();
-            engine->callbacks.render(engine->game_data);
+            gengine_render(engine);
+            
+            // Finish this frame's ticks before presenting so the frame covers them
+            PROFILE_BEGIN("sim_wait");
+            if (!gengine_sim_wait(engine)) {
+                engine->running = false;
+            }
+            PROFILE_END();
+            
+            engine->frame_work_ms = (float)((timer_now_ns() - frame_start) / 1e6);
+            PROFILE_BEGIN("present");
             EndDrawing();
+            PROFILE_END();
+        } else {
+            if (!engine->replay) {
+                input_poll(&engine->input);
+            }
+            
+            // Fixed-timestep accumulator: run as many whole ticks as real time allows
+            PROFILE_BEGIN("simulate");
+            engine->accumulator += frame_time;
+            int ticks = 0;
+            while (engine->accumulator >= engine->tick_delta) {
+                if (!gengine_tick(engine)) {
+                    engine->running = false;
+                    break;
+                }
+                engine->accumulator -= engine->tick_delta;
+                ticks++;
+            }
+            PROFILE_END();
+            trace_counter("ticks_per_frame", ticks);
+            engine->interpolation_alpha = (float)(engine->accumulator / engine->tick_delta);
+            gengine_publish(engine);
+            
+            BeginDrawing();
+            gengine_render(engine);
+            
+            engine->frame_work_ms = (float)((timer_now_ns() - frame_start) / 1e6);
+            PROFILE_BEGIN("present");
+            EndDrawing();
+            PROFILE_END();
         }
         
+        trace_counter("frame_ms", frame_time * 1000.0);
         engine->frame_count++;
+        profiler_frame_end();
+        mem_next_frame();
+        trace_flush();
     }
     
+    gengine_stop_sim_thread(engine);
+    
     if (engine->callbacks.cleanup && engine->game_data) {
         engine->callbacks.cleanup(engine->game_data);
     }
@@ -101,6 +886,38 @@ void gengine_run(GameEngine* engine) {
         engine->initialized = false;
     }
     CloseWindow();
+    gengine_save_recording(engine);
+    jobs_destroy(engine->jobs);
+    engine->jobs = NULL;
+    trace_stop();
+    profiler_shutdown();
+}
+
+bool gengine_request_seek(GameEngine* engine, int tick) {
+    if (!engine || !engine->replay || engine->recorder) return false;
+    engine->seek_target = tick < 0 ? 0 : tick;
+    return true;
+}
+
+bool gengine_request_rollback(GameEngine* engine, int tick, const InputFrame* inputs, int input_count) {
+    if (!engine || !engine->rollback || engine->recorder || engine->replay) return false;
+    if (!engine->callbacks.save_state || !engine->callbacks.load_state) return false;
+    if (tick < rollback_get_oldest_tick(engine->rollback) || tick >= engine->tick_count) return false;
+    
+    int ticks = engine->tick_count - tick;
+    if (!inputs || input_count < 0) input_count = 0;
+    if (input_count > ticks) input_count = ticks;
+    for (int i = 0; i < input_count; i++) {
+        engine->rollback_inputs[i] = inputs[i];
+    }
+    engine->rollback_input_count = input_count;
+    engine->rollback_target = tick;
+    return true;
+}
+
+size_t gengine_get_rollback_bytes(GameEngine* engine) {
+    if (!engine) return 0;
+    return rollback_get_state_bytes(engine->rollback);
 }
 
 int gengine_get_frame_count(GameEngine* engine) {
@@ -108,12 +925,66 @@ int gengine_get_frame_count(GameEngine* engine) {
     return engine->frame_count;
 }
 
+int gengine_get_tick_count(GameEngine* engine) {
+    if (!engine) return 0;
+    return engine->tick_count;
+}
+
+int gengine_get_tick_rate(GameEngine* engine) {
+    if (!engine) return GENGINE_DEFAULT_TICK_RATE;
+    return engine->config.tick_rate;
+}
+
+float gengine_get_interpolation_alpha(GameEngine* engine) {
+    if (!engine) return 1.0f;
+    return engine->interpolation_alpha;
+}
+
+float gengine_get_frame_work_ms(GameEngine* engine) {
+    if (!engine) return 0.0f;
+    return engine->frame_work_ms;
+}
+
+float gengine_get_frame_budget_ms(GameEngine* engine) {
+    if (!engine || engine->config.target_fps <= 0) return 1000.0f / GENGINE_DEFAULT_TICK_RATE;
+    return 1000.0f / (float)engine->config.target_fps;
+}
+
+uint64_t gengine_get_seed(GameEngine* engine) {
+    if (!engine) return 0;
+    return engine->config.seed;
+}
+
+JobSystem* gengine_get_jobs(GameEngine* engine) {
+    if (!engine) return NULL;
+    return engine->jobs;
+}
+
 bool gengine_is_running(GameEngine* engine) {
     if (!engine) return false;
     return engine->running;
 }
 
+bool gengine_is_headless(GameEngine* engine) {
+    if (!engine) return false;
+    return engine->config.headless;
+}
+
+double gengine_get_simulated_fps(GameEngine* engine) {
+    if (!engine) return 0.0;
+    return engine->simulated_fps;
+}
+
 void gengine_stop(GameEngine* engine) {
     if (!engine) return;
+    
+    // Games call this from their update, which may be on the sim worker;
+    // the render thread then stops once it has collected the batch
+    if (engine->sim_thread) {
+        thread_mutex_lock(engine->sim_mutex);
+        engine->sim_stop = true;
+        thread_mutex_unlock(engine->sim_mutex);
+        return;
+    }
     engine->running = false;
 }
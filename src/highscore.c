@@ -1,7 +1,9 @@
 #include "../include/highscore.h"
+#include "../include/profiler.h"
 #include <stdio.h>
 #include <string.h>
 #include <stdlib.h>
+#include <math.h>
 
 void highscore_load(HighScore* high_scores, int* count) {
     if (!high_scores || !count) return;
@@ -18,8 +20,10 @@ void highscore_load(HighScore* high_scores, int* count) {
     
     while (*count < MAX_HIGH_SCORES && fgets(line, sizeof(line), file) != NULL) {
         char name_buffer[MAX_NAME_LENGTH + 1] = {0};
-        if (sscanf(line, "%20s %d %d %f", name_buffer, &score.frame_count, 
+        int time_steps;
+        if (sscanf(line, "%20s %d %d %f", name_buffer, &time_steps, 
                    &score.coins_collected, &score.health_remaining) == 4) {
+            score.completion_time = (float)time_steps / HIGH_SCORE_FILE_TIME_SCALE;
             strncpy(score.name, name_buffer, MAX_NAME_LENGTH);
             score.name[MAX_NAME_LENGTH] = '\0';
             high_scores[*count] = score;
@@ -33,37 +37,40 @@ void highscore_load(HighScore* high_scores, int* count) {
 void highscore_save(const HighScore* high_scores, int count) {
     if (!high_scores) return;
     
+    PROFILE_BEGIN("highscore_save");
     FILE* file = fopen(HIGH_SCORE_FILENAME, "w");
     if (file == NULL) {
         printf("Error: Could not save high scores to file\n");
+        PROFILE_END();
         return;
     }
     
     for (int i = 0; i < count; i++) {
         fprintf(file, "%s %d %d %.1f\n", 
                 high_scores[i].name,
-                high_scores[i].frame_count,
+                (int)lroundf(high_scores[i].completion_time * HIGH_SCORE_FILE_TIME_SCALE),
                 high_scores[i].coins_collected,
                 high_scores[i].health_remaining);
     }
     
     fclose(file);
+    PROFILE_END();
 }
 
 bool highscore_add(HighScore* high_scores, int* count, const char* name, 
-                   int frame_count, int coins_collected, float health_remaining) {
+                   float completion_time, int coins_collected, float health_remaining) {
     if (!high_scores || !count || !name) return false;
     
     HighScore new_score;
     strncpy(new_score.name, name, MAX_NAME_LENGTH);
     new_score.name[MAX_NAME_LENGTH] = '\0';
-    new_score.frame_count = frame_count;
+    new_score.completion_time = completion_time;
     new_score.coins_collected = coins_collected;
     new_score.health_remaining = health_remaining;
     
     int insert_pos = *count;
     for (int i = 0; i < *count; i++) {
-        if (frame_count < high_scores[i].frame_count) {
+        if (completion_time < high_scores[i].completion_time) {
             insert_pos = i;
             break;
         }
@@ -81,9 +88,8 @@ bool highscore_add(HighScore* high_scores, int* count, const char* name,
         high_scores[insert_pos] = new_score;
         (*count)++;
         
-        highscore_save(high_scores, *count);
-        printf("New high score added! Rank: %d, Name: %s, Frames: %d\n", 
-               insert_pos + 1, name, frame_count);
+        printf("New high score added! Rank: %d, Name: %s, Time: %.2f s\n", 
+               insert_pos + 1, name, completion_time);
         return true;
     }
     
@@ -0,0 +1,79 @@
+#include "../include/input.h"
+#include <string.h>
+
+// Window keys behind each button
+typedef struct {
+    uint32_t button;
+    int key;
+} InputKeyBinding;
+
+static const InputKeyBinding INPUT_KEY_BINDINGS[] = {
+    {INPUT_BUTTON_UP, KEY_W},
+    {INPUT_BUTTON_UP, KEY_UP},
+    {INPUT_BUTTON_DOWN, KEY_S},
+    {INPUT_BUTTON_DOWN, KEY_DOWN},
+    {INPUT_BUTTON_LEFT, KEY_A},
+    {INPUT_BUTTON_LEFT, KEY_LEFT},
+    {INPUT_BUTTON_RIGHT, KEY_D},
+    {INPUT_BUTTON_RIGHT, KEY_RIGHT},
+    {INPUT_BUTTON_TURN_LEFT, KEY_Q},
+    {INPUT_BUTTON_TURN_RIGHT, KEY_E},
+    {INPUT_BUTTON_FIRE, KEY_SPACE},
+    {INPUT_BUTTON_CONFIRM, KEY_ENTER},
+    {INPUT_BUTTON_BACK, KEY_ESCAPE},
+    {INPUT_BUTTON_HIGH_SCORES, KEY_H},
+    {INPUT_BUTTON_ERASE, KEY_BACKSPACE}
+};
+
+#define INPUT_KEY_BINDING_COUNT ((int)(sizeof(INPUT_KEY_BINDINGS) / sizeof(INPUT_KEY_BINDINGS[0])))
+
+void input_clear(InputFrame* frame) {
+    if (!frame) return;
+    memset(frame, 0, sizeof(InputFrame));
+}
+
+void input_poll(InputFrame* frame) {
+    if (!frame) return;
+    
+    uint32_t held = 0;
+    for (int i = 0; i < INPUT_KEY_BINDING_COUNT; i++) {
+        if (IsKeyDown(INPUT_KEY_BINDINGS[i].key)) {
+            held |= INPUT_KEY_BINDINGS[i].button;
+        }
+        if (IsKeyPressed(INPUT_KEY_BINDINGS[i].key)) {
+            frame->pressed |= INPUT_KEY_BINDINGS[i].button;
+        }
+    }
+    
+    if (IsMouseButtonDown(MOUSE_BUTTON_LEFT)) held |= INPUT_BUTTON_MOUSE_LEFT;
+    if (IsMouseButtonDown(MOUSE_BUTTON_RIGHT)) held |= INPUT_BUTTON_MOUSE_RIGHT;
+    if (IsMouseButtonPressed(MOUSE_BUTTON_LEFT)) frame->pressed |= INPUT_BUTTON_MOUSE_LEFT;
+    if (IsMouseButtonPressed(MOUSE_BUTTON_RIGHT)) frame->pressed |= INPUT_BUTTON_MOUSE_RIGHT;
+    
+    frame->held = held;
+    frame->mouse_position = GetMousePosition();
+    
+    int c = GetCharPressed();
+    while (c > 0) {
+        if (frame->char_count < INPUT_MAX_CHARS) {
+            frame->chars[frame->char_count++] = c;
+        }
+        c = GetCharPressed();
+    }
+}
+
+void input_consume(InputFrame* frame) {
+    if (!frame) return;
+    frame->pressed = 0;
+    frame->char_count = 0;
+}
+
+bool input_is_down(const InputFrame* frame, uint32_t buttons) {
+    if (!frame) return false;
+    return (frame->held & buttons) != 0;
+}
+
+bool input_was_pressed(const InputFrame* frame, uint32_t buttons) {
+    if (!frame) return false;
+    return (frame->pressed & buttons) != 0;
+}
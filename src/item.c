@@ -1,4 +1,5 @@
 #include "../include/item.h"
+#include "../include/mem.h"
 #include "raylib.h"
 #include <math.h>
 #include <stdlib.h>
@@ -9,25 +10,24 @@
 #define HEALTH_PACK_RADIUS 18.0f
 #define KEY_RADIUS 12.0f
 
-struct Item {
-    ItemType type;
-    Vector2 position;
-    bool collected;
-};
+Item item_make(ItemType type, Vector2 position) {
+    Item item;
+    item.type = type;
+    item.position = position;
+    item.collected = false;
+    return item;
+}
 
 Item* item_create(ItemType type, Vector2 position) {
-    Item* item = (Item*)malloc(sizeof(Item));
+    Item* item = (Item*)mem_alloc(MEM_TAG_GAME, sizeof(Item));
     if (!item) return NULL;
     
-    item->type = type;
-    item->position = position;
-    item->collected = false;
-    
+    *item = item_make(type, position);
     return item;
 }
 
 void item_destroy(Item* item) {
-    if (item) free(item);
+    if (item) mem_free(item);
 }
 
 ItemType item_get_type(const Item* item) {
@@ -0,0 +1,313 @@
+#include "../include/jobs.h"
+#include "../include/thread.h"
+#include "../include/trace.h"
+#include "../include/mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define JOBS_THREAD_LOCAL __declspec(thread)
+#else
+#define JOBS_THREAD_LOCAL _Thread_local
+#endif
+
+#define JOBS_CHUNKS_PER_THREAD 4  // Extra chunks so stealing can even out uneven work
+
+typedef struct {
+    JobFunction function;
+    JobRangeFunction range_function;
+    void* user_data;
+    int begin;
+    int end;
+    JobGroup* group;
+} Job;
+
+typedef struct {
+    ThreadMutex* mutex;
+    Job jobs[JOBS_DEQUE_CAPACITY];
+    int top;     // Thieves take from here (oldest job)
+    int bottom;  // The owner pushes and pops here (newest job)
+} JobDeque;
+
+typedef struct {
+    JobSystem* jobs;
+    int index;
+} JobWorker;
+
+struct JobSystem {
+    int worker_count;
+    Thread* threads[JOBS_MAX_THREADS];
+    JobWorker workers[JOBS_MAX_THREADS];
+    JobDeque* deques;  // One per worker, plus a shared one for outside threads
+    int deque_count;
+    
+    ThreadMutex* sleep_mutex;
+    ThreadCond* sleep_cond;
+    volatile int queued;  // Jobs sitting in any deque
+    bool quit;
+};
+
+static JOBS_THREAD_LOCAL JobSystem* g_worker_owner = NULL;
+static JOBS_THREAD_LOCAL int g_worker_index = 0;
+
+/**
+ * Get the deque the calling thread pushes to.
+ * @param jobs The job system
+ * @return Deque index
+ */
+static int jobs_self_index(const JobSystem* jobs) {
+    return (g_worker_owner == jobs) ? g_worker_index : jobs->worker_count;
+}
+
+/**
+ * Push a job onto the bottom of a deque.
+ * @param deque The deque
+ * @param job The job
+ * @return true on success, false if the deque is full
+ */
+static bool jobs_deque_push(JobDeque* deque, const Job* job) {
+    thread_mutex_lock(deque->mutex);
+    bool pushed = deque->bottom - deque->top < JOBS_DEQUE_CAPACITY;
+    if (pushed) {
+        deque->jobs[deque->bottom % JOBS_DEQUE_CAPACITY] = *job;
+        deque->bottom++;
+    }
+    thread_mutex_unlock(deque->mutex);
+    return pushed;
+}
+
+/**
+ * Take the newest job from a deque (owner side) or the oldest (thief side).
+ * @param deque The deque
+ * @param steal true to take from the top, false for the bottom
+ * @param job Output job
+ * @return true if a job was taken, false if the deque was empty
+ */
+static bool jobs_deque_take(JobDeque* deque, bool steal, Job* job) {
+    thread_mutex_lock(deque->mutex);
+    bool taken = deque->bottom > deque->top;
+    if (taken) {
+        if (steal) {
+            *job = deque->jobs[deque->top % JOBS_DEQUE_CAPACITY];
+            deque->top++;
+        } else {
+            deque->bottom--;
+            *job = deque->jobs[deque->bottom % JOBS_DEQUE_CAPACITY];
+        }
+    }
+    thread_mutex_unlock(deque->mutex);
+    return taken;
+}
+
+/**
+ * Run a job and mark it finished in its group.
+ * @param job The job
+ */
+static void jobs_execute(const Job* job) {
+    if (job->range_function) {
+        job->range_function(job->user_data, job->begin, job->end);
+    } else {
+        job->function(job->user_data);
+    }
+    thread_atomic_add(&job->group->pending, -1);
+}
+
+/**
+ * Run one queued job: the newest from the caller's own deque, otherwise
+ * the oldest stolen from another.
+ * @param jobs The job system
+ * @param self Deque index of the calling thread
+ * @return true if a job ran, false if every deque was empty
+ */
+static bool jobs_try_run_one(JobSystem* jobs, int self) {
+    Job job;
+    bool found = jobs_deque_take(&jobs->deques[self], false, &job);
+    for (int i = 1; !found && i < jobs->deque_count; i++) {
+        found = jobs_deque_take(&jobs->deques[(self + i) % jobs->deque_count], true, &job);
+    }
+    if (!found) return false;
+    
+    thread_atomic_add(&jobs->queued, -1);
+    jobs_execute(&job);
+    return true;
+}
+
+/**
+ * Wake sleeping workers after jobs were queued.
+ * @param jobs The job system
+ */
+static void jobs_wake_workers(JobSystem* jobs) {
+    thread_mutex_lock(jobs->sleep_mutex);
+    thread_cond_broadcast(jobs->sleep_cond);
+    thread_mutex_unlock(jobs->sleep_mutex);
+}
+
+/**
+ * Queue a job on the calling thread's deque, or run it inline if the deque
+ * is full.
+ * @param jobs The job system
+ * @param job The job
+ */
+static void jobs_submit(JobSystem* jobs, const Job* job) {
+    if (jobs_deque_push(&jobs->deques[jobs_self_index(jobs)], job)) {
+        thread_atomic_add(&jobs->queued, 1);
+    } else {
+        jobs_execute(job);
+    }
+}
+
+/**
+ * Worker thread entry point.
+ * @param user_data The worker's JobWorker record
+ */
+static void jobs_worker_main(void* user_data) {
+    JobWorker* worker = (JobWorker*)user_data;
+    JobSystem* jobs = worker->jobs;
+    g_worker_owner = jobs;
+    g_worker_index = worker->index;
+    trace_set_thread_name("job worker");
+    
+    while (true) {
+        if (jobs_try_run_one(jobs, worker->index)) {
+            continue;
+        }
+        
+        thread_mutex_lock(jobs->sleep_mutex);
+        while (!jobs->quit && thread_atomic_load(&jobs->queued) == 0) {
+            thread_cond_wait(jobs->sleep_cond, jobs->sleep_mutex);
+        }
+        bool quit = jobs->quit;
+        thread_mutex_unlock(jobs->sleep_mutex);
+        if (quit) break;
+    }
+}
+
+JobSystem* jobs_create(int thread_count) {
+    if (thread_count <= 0) {
+        thread_count = thread_get_cpu_count();
+    }
+    if (thread_count > JOBS_MAX_THREADS) {
+        thread_count = JOBS_MAX_THREADS;
+    }
+    
+    JobSystem* jobs = (JobSystem*)mem_alloc(MEM_TAG_JOBS, sizeof(JobSystem));
+    if (!jobs) return NULL;
+    memset(jobs, 0, sizeof(JobSystem));
+    
+    jobs->deque_count = thread_count;  // One per worker plus the shared deque
+    jobs->deques = (JobDeque*)mem_calloc(MEM_TAG_JOBS, (size_t)jobs->deque_count, sizeof(JobDeque));
+    jobs->sleep_mutex = thread_mutex_create();
+    jobs->sleep_cond = thread_cond_create();
+    if (!jobs->deques || !jobs->sleep_mutex || !jobs->sleep_cond) {
+        jobs_destroy(jobs);
+        return NULL;
+    }
+    
+    for (int i = 0; i < jobs->deque_count; i++) {
+        jobs->deques[i].mutex = thread_mutex_create();
+        if (!jobs->deques[i].mutex) {
+            jobs_destroy(jobs);
+            return NULL;
+        }
+    }
+    
+    for (int i = 0; i < thread_count - 1; i++) {
+        jobs->workers[i].jobs = jobs;
+        jobs->workers[i].index = i;
+        jobs->threads[i] = thread_create(jobs_worker_main, &jobs->workers[i]);
+        if (!jobs->threads[i]) {
+            printf("Error: Could not start job worker %d\n", i);
+            jobs_destroy(jobs);
+            return NULL;
+        }
+        jobs->worker_count++;
+    }
+    
+    return jobs;
+}
+
+void jobs_destroy(JobSystem* jobs) {
+    if (!jobs) return;
+    
+    if (jobs->sleep_mutex) {
+        thread_mutex_lock(jobs->sleep_mutex);
+        jobs->quit = true;
+        thread_cond_broadcast(jobs->sleep_cond);
+        thread_mutex_unlock(jobs->sleep_mutex);
+    }
+    for (int i = 0; i < jobs->worker_count; i++) {
+        thread_join(jobs->threads[i]);
+    }
+    
+    if (jobs->deques) {
+        for (int i = 0; i < jobs->deque_count; i++) {
+            thread_mutex_destroy(jobs->deques[i].mutex);
+        }
+        mem_free(jobs->deques);
+    }
+    thread_cond_destroy(jobs->sleep_cond);
+    thread_mutex_destroy(jobs->sleep_mutex);
+    mem_free(jobs);
+}
+
+int jobs_get_thread_count(const JobSystem* jobs) {
+    if (!jobs) return 1;
+    return jobs->worker_count + 1;
+}
+
+void jobs_group_init(JobGroup* group) {
+    if (!group) return;
+    group->pending = 0;
+}
+
+void jobs_group_run(JobSystem* jobs, JobGroup* group, JobFunction function, void* user_data) {
+    if (!group || !function) return;
+    
+    Job job = {function, NULL, user_data, 0, 0, group};
+    thread_atomic_add(&group->pending, 1);
+    if (!jobs || jobs->worker_count == 0) {
+        jobs_execute(&job);
+        return;
+    }
+    jobs_submit(jobs, &job);
+    jobs_wake_workers(jobs);
+}
+
+void jobs_group_wait(JobSystem* jobs, JobGroup* group) {
+    if (!group) return;
+    
+    while (thread_atomic_load(&group->pending) > 0) {
+        if (!jobs || !jobs_try_run_one(jobs, jobs_self_index(jobs))) {
+            thread_yield();
+        }
+    }
+}
+
+void jobs_parallel_for(JobSystem* jobs, int count, int grain, JobRangeFunction function, void* user_data) {
+    if (count <= 0 || !function) return;
+    if (grain < 1) grain = 1;
+    
+    int threads = jobs_get_thread_count(jobs);
+    if (threads <= 1 || count <= grain) {
+        function(user_data, 0, count);
+        return;
+    }
+    
+    int chunks = threads * JOBS_CHUNKS_PER_THREAD;
+    int chunk_size = (count + chunks - 1) / chunks;
+    if (chunk_size < grain) chunk_size = grain;
+    
+    // Queue every chunk but the first, which the caller runs itself
+    JobGroup group = JOB_GROUP_INIT;
+    for (int begin = chunk_size; begin < count; begin += chunk_size) {
+        int end = (begin + chunk_size < count) ? begin + chunk_size : count;
+        Job job = {NULL, function, user_data, begin, end, &group};
+        thread_atomic_add(&group.pending, 1);
+        jobs_submit(jobs, &job);
+    }
+    jobs_wake_workers(jobs);
+    
+    function(user_data, 0, chunk_size);
+    jobs_group_wait(jobs, &group);
+}
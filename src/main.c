@@ -1,43 +1,267 @@
 #include "../include/gengine.h"
 #include "../include/game.h"
+#include "../include/renderer3d.h"
+#include "../include/net.h"
+#include "../include/netproto.h"
+#include "../include/server.h"
+#include "../include/client.h"
+#include "../include/replay.h"
+#include "../include/mem.h"
 #include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
 
 #define SCREEN_WIDTH 800
 #define SCREEN_HEIGHT 600
 #define WINDOW_TITLE "Coin Collector Game"
 #define TARGET_FPS 60
 
-int main(void) {
+/**
+ * Print command line usage.
+ * @param program Program name
+ */
+static void print_usage(const char* program) {
+    fprintf(stderr, "Usage: %s [options]\n", program);
+    fprintf(stderr, "  --headless      Run the simulation without window, audio or rendering\n");
+    fprintf(stderr, "  --frames N      Stop after N frames (0 = unlimited)\n");
+    fprintf(stderr, "  --tick-rate N   Fixed simulation ticks per second (default %d)\n", GENGINE_DEFAULT_TICK_RATE);
+    fprintf(stderr, "  --pipelined     Simulate the next frame on a second thread while rendering\n");
+    fprintf(stderr, "  --trace FILE    Record a Chrome trace (chrome://tracing, Perfetto) to FILE\n");
+    fprintf(stderr, "  --threads N     Job system threads including the main thread (0 = one per CPU)\n");
+    fprintf(stderr, "  --record FILE   Record every tick's input and the seed to a replay FILE\n");
+    fprintf(stderr, "  --replay FILE   Play back a replay FILE (with --headless: as fast as possible)\n");
+    fprintf(stderr, "  --seek TICK     Start replay playback at TICK (arrow keys skip while playing)\n");
+    fprintf(stderr, "  --keyframes N   Ticks between state keyframes in recordings (default %d)\n",
+            GENGINE_DEFAULT_KEYFRAME_INTERVAL);
+    fprintf(stderr, "  --rollback N    Keep the last N ticks' states for rollback and resimulation\n");
+    fprintf(stderr, "  --seed N        Gameplay random seed (default: from the clock)\n");
+    fprintf(stderr, "  --sessions N    Run N independent game sessions in parallel (headless only)\n");
+    fprintf(stderr, "  --server PORT   Run an authoritative headless server on UDP PORT (e.g. %d)\n",
+            NETPROTO_DEFAULT_PORT);
+    fprintf(stderr, "  --connect HOST:PORT  Play on a server (with --headless: send no input, report traffic)\n");
+    fprintf(stderr, "  --width N       Window width in pixels (default %d)\n", SCREEN_WIDTH);
+    fprintf(stderr, "  --height N      Window height in pixels (default %d)\n", SCREEN_HEIGHT);
+    fprintf(stderr, "  --columns N     Fix the 3D view at N rays (default: scale %d-%d to the frame budget)\n",
+            RENDERER3D_MIN_COLUMNS, RENDERER3D_MAX_COLUMNS);
+    fprintf(stderr, "  --leak-check    Exit with an error if heap memory or raylib handles are left at exit\n");
+}
+
+/**
+ * Parse command line options into the engine configuration.
+ * @param argc Argument count
+ * @param argv Argument values
+ * @param config Configuration to fill
+ * @param session_count Number of game sessions to run
+ * @param server_port UDP port to serve on (0 = not a server)
+ * @param connect_address Server to play on as "host:port" (NULL = not a client)
+ * @param leak_check Fail the run if anything is still allocated at exit
+ * @return true if all options were valid, false otherwise
+ */
+static bool parse_arguments(int argc, char** argv, EngineConfig* config, int* session_count,
+                            int* server_port, const char** connect_address, bool* leak_check) {
+    for (int i = 1; i < argc; i++) {
+        if (strcmp(argv[i], "--headless") == 0) {
+            config->headless = true;
+        } else if (strcmp(argv[i], "--frames") == 0 && i + 1 < argc) {
+            config->max_frames = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--tick-rate") == 0 && i + 1 < argc) {
+            config->tick_rate = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--pipelined") == 0) {
+            config->pipelined = true;
+        } else if (strcmp(argv[i], "--trace") == 0 && i + 1 < argc) {
+            config->trace_path = argv[++i];
+        } else if (strcmp(argv[i], "--threads") == 0 && i + 1 < argc) {
+            config->job_threads = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--record") == 0 && i + 1 < argc) {
+            config->record_path = argv[++i];
+        } else if (strcmp(argv[i], "--replay") == 0 && i + 1 < argc) {
+            config->replay_path = argv[++i];
+        } else if (strcmp(argv[i], "--seek") == 0 && i + 1 < argc) {
+            config->replay_start_tick = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--keyframes") == 0 && i + 1 < argc) {
+            config->keyframe_interval = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--rollback") == 0 && i + 1 < argc) {
+            config->rollback_ticks = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--seed") == 0 && i + 1 < argc) {
+            config->seed = strtoull(argv[++i], NULL, 10);
+        } else if (strcmp(argv[i], "--sessions") == 0 && i + 1 < argc) {
+            *session_count = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--server") == 0 && i + 1 < argc) {
+            *server_port = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--connect") == 0 && i + 1 < argc) {
+            *connect_address = argv[++i];
+        } else if (strcmp(argv[i], "--width") == 0 && i + 1 < argc) {
+            config->screen_width = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--height") == 0 && i + 1 < argc) {
+            config->screen_height = atoi(argv[++i]);
+        } else if (strcmp(argv[i], "--columns") == 0 && i + 1 < argc) {
+            int columns = atoi(argv[++i]);
+            renderer3d_set_column_range(columns, columns);
+        } else if (strcmp(argv[i], "--leak-check") == 0) {
+            *leak_check = true;
+        } else {
+            fprintf(stderr, "Unknown option: %s\n", argv[i]);
+            return false;
+        }
+    }
+    return true;
+}
+
+/**
+ * Feed an extra session the next tick of its own replay reader, and no
+ * input once the replay has run out.
+ * @param user_data The session's ReplayReader
+ * @param tick The session's tick (unused; the reader keeps its place)
+ * @param input Input to fill
+ */
+static void read_session_replay(void* user_data, int tick, InputFrame* input) {
+    (void)tick;
+    if (!replay_reader_next_tick((ReplayReader*)user_data, input)) {
+        input_clear(input);
+    }
+}
+
+int main(int argc, char** argv) {
     EngineConfig config = {
         .screen_width = SCREEN_WIDTH,
         .screen_height = SCREEN_HEIGHT,
         .window_title = WINDOW_TITLE,
-        .target_fps = TARGET_FPS
+        .target_fps = TARGET_FPS,
+        .tick_rate = GENGINE_DEFAULT_TICK_RATE,
+        .headless = false,
+        .max_frames = 0,
+        .pipelined = false,
+        .trace_path = NULL,
+        .job_threads = 0,
+        .seed = 0,
+        .record_path = NULL,
+        .replay_path = NULL,
+        .keyframe_interval = 0,
+        .replay_start_tick = 0,
+        .rollback_ticks = 0,
+        .paced = false
     };
     
-    GameEngine* engine = gengine_create(&config);
-    if (!engine) {
-        fprintf(stderr, "Failed to create game engine\n");
+    int session_count = 1;
+    int server_port = 0;
+    const char* connect_address = NULL;
+    bool leak_check = false;
+    if (!parse_arguments(argc, argv, &config, &session_count, &server_port, &connect_address, &leak_check)) {
+        print_usage(argv[0]);
+        return 1;
+    }
+    if (config.screen_width <= 0 || config.screen_height <= 0) {
+        fprintf(stderr, "Invalid window size: %dx%d\n", config.screen_width, config.screen_height);
+        return 1;
+    }
+    if (session_count < 1 || session_count > GENGINE_MAX_SESSIONS) {
+        fprintf(stderr, "Session count must be between 1 and %d\n", GENGINE_MAX_SESSIONS);
+        return 1;
+    }
+    if (session_count > 1 && !config.headless) {
+        fprintf(stderr, "--sessions needs --headless\n");
         return 1;
     }
     
-    CoinCollectorGame* game = game_create();
-    if (!game) {
-        fprintf(stderr, "Failed to create game\n");
-        gengine_destroy(engine);
+    bool networked = server_port != 0 || connect_address;
+    if (server_port < 0 || server_port > 65535) {
+        fprintf(stderr, "Server port must be between 1 and 65535\n");
         return 1;
     }
+    if (server_port != 0 && connect_address) {
+        fprintf(stderr, "--server and --connect cannot be combined\n");
+        return 1;
+    }
+    if (networked && (session_count > 1 || config.record_path || config.replay_path)) {
+        fprintf(stderr, "--server and --connect cannot be combined with --sessions, --record or --replay\n");
+        return 1;
+    }
+    if (server_port != 0) {
+        config.headless = true;
+    }
+    // Networked peers tick in real time even without a window
+    config.paced = networked;
     
-    game_set_engine(game, engine);
+    GameEngine* engine = gengine_create(&config);
+    if (!engine) {
+        fprintf(stderr, "Failed to create game engine\n");
+        return 1;
+    }
     
-    GameCallbacks callbacks = game_get_callbacks(game);
+    // The first game is the one the engine renders and the only one using
+    // the high score file; the others only tick. With a replay each of the
+    // others reads the file on its own
+    CoinCollectorGame* games[GENGINE_MAX_SESSIONS];
+    ReplayReader* session_replays[GENGINE_MAX_SESSIONS] = {NULL};
+    for (int i = 0; i < session_count; i++) {
+        games[i] = game_create();
+        if (!games[i]) {
+            fprintf(stderr, "Failed to create game\n");
+            for (int j = 0; j < i; j++) {
+                game_destroy(games[j]);
+                replay_reader_destroy(session_replays[j]);
+            }
+            gengine_destroy(engine);
+            return 1;
+        }
+        
+        game_set_engine(games[i], engine);
+        game_set_seed(games[i], gengine_get_seed(engine) + (uint64_t)i);
+        game_set_persist_high_scores(games[i], i == 0);
+        
+        GameCallbacks callbacks = game_get_callbacks(games[i]);
+        
+        if (i == 0) {
+            gengine_register_game(engine, &callbacks, game_get_data(games[i]));
+        } else {
+            session_replays[i] = config.replay_path ? replay_reader_open(config.replay_path) : NULL;
+            gengine_add_session(engine, &callbacks, game_get_data(games[i]),
+                                session_replays[i] ? read_session_replay : NULL, session_replays[i]);
+        }
+    }
     
-    gengine_register_game(engine, &callbacks, game_get_data(game));
+    // A server or client sits between the engine and the first game
+    GameServer* server = NULL;
+    GameClient* client = NULL;
+    bool ready = !networked || net_init();
+    if (ready && server_port != 0) {
+        server = server_create(games[0], (uint16_t)server_port);
+        ready = server != NULL;
+        if (ready) {
+            GameCallbacks callbacks = server_get_callbacks(server);
+            gengine_register_game(engine, &callbacks, server_get_data(server));
+        }
+    } else if (ready && connect_address) {
+        NetAddress address;
+        client = net_parse_address(connect_address, &address) ? client_create(games[0], engine, &address) : NULL;
+        ready = client != NULL;
+        if (ready) {
+            GameCallbacks callbacks = client_get_callbacks(client);
+            gengine_register_game(engine, &callbacks, client_get_data(client));
+        }
+    }
     
-    gengine_run(engine);
+    if (ready) {
+        gengine_run(engine);
+    } else {
+        fprintf(stderr, "Failed to start networking\n");
+    }
     
-    game_destroy(game);
+    server_destroy(server);
+    client_destroy(client);
+    if (networked) {
+        net_shutdown();
+    }
+    for (int i = 0; i < session_count; i++) {
+        game_destroy(games[i]);
+        replay_reader_destroy(session_replays[i]);
+    }
     gengine_destroy(engine);
     
-    return 0;
+    // Everything is torn down, so whatever is still live has leaked
+    mem_print_report();
+    if (leak_check && !mem_check_leaks()) {
+        return 1;
+    }
+    return ready ? 0 : 1;
 }
@@ -1,12 +1,32 @@
 #include "../include/map.h"
+#include "../include/collide.h"
+#include "../include/mem.h"
 #include "raylib.h"
 #include <stdio.h>
 #include <stdbool.h>
 #include <math.h>
 #include <stdlib.h>
+#include <string.h>
 
-#define OBSTACLE_SPEED 2.0f
-#define OBSTACLE_DIRECTION_CHANGE_FRAMES 120
+#define OBSTACLE_SPEED 120.0f  // World units per second on each axis
+#define MAP_MIN_CAPACITY 8  // Elements in an array's first allocation
+
+// Bytes per element across each group of parallel arrays, and how many arrays
+#define MAP_WALL_BYTES (sizeof(Wall) + 4 * sizeof(float))
+#define MAP_WALL_ARRAYS 5
+#define MAP_OBSTACLE_BYTES (7 * sizeof(float) + sizeof(Color))
+#define MAP_OBSTACLE_ARRAYS 8
+#define MAP_GRID_ENTRY_BYTES (sizeof(int32_t) + 4 * sizeof(float))
+#define MAP_GRID_ENTRY_ARRAYS 5
+
+// Snapshot: coin and obstacle counts, a byte per coin, then the obstacle arrays
+#define MAP_SNAPSHOT_HEADER_SIZE (2 * sizeof(int32_t))
+#define MAP_OBSTACLE_RECORD_SIZE (7 * sizeof(float) + sizeof(Color))
+
+/**
+ * Function that moves one group of a map's arrays to a new capacity.
+ */
+typedef void (*MapPlaceFn)(Map* map, int capacity);
 
 bool map_check_circle_rect_collision(Vector2 circle_pos, float radius, Rectangle rect) {
     float closest_x = fmaxf(rect.x, fminf(circle_pos.x, rect.x + rect.width));
@@ -18,19 +38,103 @@ bool map_check_circle_rect_collision(Vector2 circle_pos, float radius, Rectangle
     return (distance_x * distance_x + distance_y * distance_y) < (radius * radius);
 }
 
-bool map_is_valid_spawn_position(Vector2 position, float radius, const Map* map) {
-    if (position.x < radius || position.x > SCREEN_WIDTH - radius ||
-        position.y < radius || position.y > SCREEN_HEIGHT - radius) {
-        return false;
+/**
+ * Get the grid column or row a coordinate falls in, clamped to the grid.
+ * Walls never reach past the grid, so a clamped query still finds them.
+ * @param position X or Y coordinate
+ * @param origin The grid's origin on the same axis
+ * @param inverse_cell_size 1 / cell size
+ * @param cells Columns or rows in the grid
+ * @return Column or row index
+ */
+static int map_grid_cell(float position, float origin, float inverse_cell_size, int cells) {
+    float cell = (position - origin) * inverse_cell_size;
+    if (!(cell >= 0.0f)) return 0;
+    if (cell >= (float)cells) return cells - 1;
+    return (int)cell;
+}
+
+bool map_check_circle_wall_collision(const Map* map, Vector2 circle_pos, float radius) {
+    // A few walls take less time to test than finding their cells
+    const WallGrid* grid = map_get_wall_grid(map);
+    if (!grid || map->wall_count < MAP_GRID_MIN_WALLS) {
+        const WallBounds* bounds = &map->wall_bounds;
+        RectArrays walls = {bounds->left, bounds->top, bounds->right, bounds->bottom, map->wall_count};
+        return collide_circle_first_rect(circle_pos.x, circle_pos.y, radius, &walls) >= 0;
     }
     
-    for (int i = 0; i < map->wall_count; i++) {
-        if (map_check_circle_rect_collision(position, radius, map->walls[i].rect)) {
-            return false;
+    // Only the cells under the circle's bounding box can hold a wall it touches
+    int first_column = map_grid_cell(circle_pos.x - radius, grid->origin_x, grid->inverse_cell_size, grid->columns);
+    int last_column = map_grid_cell(circle_pos.x + radius, grid->origin_x, grid->inverse_cell_size, grid->columns);
+    int first_row = map_grid_cell(circle_pos.y - radius, grid->origin_y, grid->inverse_cell_size, grid->rows);
+    int last_row = map_grid_cell(circle_pos.y + radius, grid->origin_y, grid->inverse_cell_size, grid->rows);
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            int cell = row * grid->columns + column;
+            int start = grid->cell_start[cell];
+            RectArrays walls = {grid->left + start, grid->top + start, grid->right + start, grid->bottom + start,
+                                grid->cell_start[cell + 1] - start};
+            if (collide_circle_first_rect(circle_pos.x, circle_pos.y, radius, &walls) >= 0) return true;
         }
     }
+    return false;
+}
+
+/**
+ * Check if a box overlaps any rectangle of a set of edge arrays.
+ * @param left Left edges
+ * @param top Top edges
+ * @param right Right edges
+ * @param bottom Bottom edges
+ * @param count Number of rectangles
+ * @param box_left Left edge of the box
+ * @param box_top Top edge of the box
+ * @param box_right Right edge of the box
+ * @param box_bottom Bottom edge of the box
+ * @return true if any overlaps, false otherwise
+ */
+static bool map_box_overlaps_any(const float* left, const float* top, const float* right, const float* bottom, int count,
+                                 float box_left, float box_top, float box_right, float box_bottom) {
+    for (int i = 0; i < count; i++) {
+        if (box_left < right[i] && box_right > left[i] && box_top < bottom[i] && box_bottom > top[i]) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool map_check_box_wall_collision(const Map* map, float left, float top, float right, float bottom) {
+    const WallGrid* grid = map_get_wall_grid(map);
+    if (!grid || map->wall_count < MAP_GRID_MIN_WALLS) {
+        const WallBounds* bounds = &map->wall_bounds;
+        return map_box_overlaps_any(bounds->left, bounds->top, bounds->right, bounds->bottom, map->wall_count,
+                                    left, top, right, bottom);
+    }
     
-    return true;
+    int first_column = map_grid_cell(left, grid->origin_x, grid->inverse_cell_size, grid->columns);
+    int last_column = map_grid_cell(right, grid->origin_x, grid->inverse_cell_size, grid->columns);
+    int first_row = map_grid_cell(top, grid->origin_y, grid->inverse_cell_size, grid->rows);
+    int last_row = map_grid_cell(bottom, grid->origin_y, grid->inverse_cell_size, grid->rows);
+    for (int row = first_row; row <= last_row; row++) {
+        for (int column = first_column; column <= last_column; column++) {
+            int cell = row * grid->columns + column;
+            int start = grid->cell_start[cell];
+            if (map_box_overlaps_any(grid->left + start, grid->top + start, grid->right + start, grid->bottom + start,
+                                     grid->cell_start[cell + 1] - start, left, top, right, bottom)) {
+                return true;
+            }
+        }
+    }
+    return false;
+}
+
+bool map_is_valid_spawn_position(Vector2 position, float radius, const Map* map) {
+    if (position.x < radius || position.x > WORLD_WIDTH - radius ||
+        position.y < radius || position.y > WORLD_HEIGHT - radius) {
+        return false;
+    }
+    
+    return !map_check_circle_wall_collision(map, position, radius);
 }
 
 Vector2 map_find_valid_spawn_position(Vector2 desired_pos, float radius, const Map* map) {
@@ -57,28 +161,467 @@ Vector2 map_find_valid_spawn_position(Vector2 desired_pos, float radius, const M
         search_radius += radius;
     }
     
-    Vector2 safe_pos = {SCREEN_WIDTH / 2.0f, SCREEN_HEIGHT / 2.0f};
+    Vector2 safe_pos = {WORLD_WIDTH / 2.0f, WORLD_HEIGHT / 2.0f};
     return safe_pos;
 }
 
+/**
+ * memcpy() that accepts the NULL arrays of an empty group.
+ * @param dest Destination
+ * @param source Source
+ * @param bytes Bytes to copy; nothing is touched when 0
+ */
+static void map_copy_bytes(void* dest, const void* source, size_t bytes) {
+    if (bytes > 0) {
+        memcpy(dest, source, bytes);
+    }
+}
+
+/**
+ * Copy an array into new storage from the map's arena. The caller has made
+ * sure the arena has room (see map_ensure_space()).
+ * @param map The map
+ * @param array Current array, or NULL
+ * @param count Elements to keep
+ * @param capacity Elements the new array holds
+ * @param element_size Size of one element
+ * @return The new array, or NULL for a capacity of 0
+ */
+static void* map_move_array(Map* map, const void* array, int count, int capacity, size_t element_size) {
+    if (capacity <= 0) return NULL;
+    void* moved = arena_alloc(map->arena, element_size * (size_t)capacity);
+    if (moved) {
+        map_copy_bytes(moved, array, element_size * (size_t)count);
+    }
+    return moved;
+}
+
+/**
+ * Move the walls and their edge arrays to new storage (a MapPlaceFn).
+ * @param map The map
+ * @param capacity Elements the new storage holds
+ */
+static void map_place_walls(Map* map, int capacity) {
+    int count = map->wall_count;
+    WallBounds* bounds = &map->wall_bounds;
+    map->walls = (Wall*)map_move_array(map, map->walls, count, capacity, sizeof(Wall));
+    bounds->left = (float*)map_move_array(map, bounds->left, count, capacity, sizeof(float));
+    bounds->top = (float*)map_move_array(map, bounds->top, count, capacity, sizeof(float));
+    bounds->right = (float*)map_move_array(map, bounds->right, count, capacity, sizeof(float));
+    bounds->bottom = (float*)map_move_array(map, bounds->bottom, count, capacity, sizeof(float));
+    map->wall_capacity = capacity;
+}
+
+/**
+ * Move the exits to new storage (a MapPlaceFn).
+ * @param map The map
+ * @param capacity Elements the new storage holds
+ */
+static void map_place_exits(Map* map, int capacity) {
+    map->exits = (Exit*)map_move_array(map, map->exits, map->exit_count, capacity, sizeof(Exit));
+    map->exit_capacity = capacity;
+}
+
+/**
+ * Move the entrances to new storage (a MapPlaceFn).
+ * @param map The map
+ * @param capacity Elements the new storage holds
+ */
+static void map_place_entrances(Map* map, int capacity) {
+    map->entrances = (Entrance*)map_move_array(map, map->entrances, map->entrance_count, capacity, sizeof(Entrance));
+    map->entrance_capacity = capacity;
+}
+
+/**
+ * Move the coins to new storage (a MapPlaceFn).
+ * @param map The map
+ * @param capacity Elements the new storage holds
+ */
+static void map_place_coins(Map* map, int capacity) {
+    map->coins = (Coin*)map_move_array(map, map->coins, map->coin_count, capacity, sizeof(Coin));
+    map->coin_capacity = capacity;
+}
+
+/**
+ * Move the obstacle arrays to new storage (a MapPlaceFn).
+ * @param map The map
+ * @param capacity Elements the new storage holds
+ */
+static void map_place_obstacles(Map* map, int capacity) {
+    ObstacleSet* obstacles = &map->obstacles;
+    int count = obstacles->count;
+    obstacles->x = (float*)map_move_array(map, obstacles->x, count, capacity, sizeof(float));
+    obstacles->y = (float*)map_move_array(map, obstacles->y, count, capacity, sizeof(float));
+    obstacles->velocity_x = (float*)map_move_array(map, obstacles->velocity_x, count, capacity, sizeof(float));
+    obstacles->velocity_y = (float*)map_move_array(map, obstacles->velocity_y, count, capacity, sizeof(float));
+    obstacles->previous_x = (float*)map_move_array(map, obstacles->previous_x, count, capacity, sizeof(float));
+    obstacles->previous_y = (float*)map_move_array(map, obstacles->previous_y, count, capacity, sizeof(float));
+    obstacles->direction_change_timer = (float*)map_move_array(map, obstacles->direction_change_timer, count, capacity, sizeof(float));
+    obstacles->color = (Color*)map_move_array(map, obstacles->color, count, capacity, sizeof(Color));
+    obstacles->capacity = capacity;
+}
+
+/**
+ * Move the wall grid's cell offsets to new storage (a MapPlaceFn).
+ * @param map The map
+ * @param capacity Offsets the new storage holds
+ */
+static void map_place_grid_cells(Map* map, int capacity) {
+    WallGrid* grid = &map->wall_grid;
+    int count = grid->cell_count > 0 ? grid->cell_count + 1 : 0;
+    grid->cell_start = (int32_t*)map_move_array(map, grid->cell_start, count, capacity, sizeof(int32_t));
+    grid->cell_capacity = capacity;
+}
+
+/**
+ * Move the wall grid's entries to new storage (a MapPlaceFn).
+ * @param map The map
+ * @param capacity Entries the new storage holds
+ */
+static void map_place_grid_entries(Map* map, int capacity) {
+    WallGrid* grid = &map->wall_grid;
+    int count = grid->entry_count;
+    grid->wall_index = (int32_t*)map_move_array(map, grid->wall_index, count, capacity, sizeof(int32_t));
+    grid->left = (float*)map_move_array(map, grid->left, count, capacity, sizeof(float));
+    grid->top = (float*)map_move_array(map, grid->top, count, capacity, sizeof(float));
+    grid->right = (float*)map_move_array(map, grid->right, count, capacity, sizeof(float));
+    grid->bottom = (float*)map_move_array(map, grid->bottom, count, capacity, sizeof(float));
+    grid->entry_capacity = capacity;
+}
+
+/**
+ * Get the arena bytes a group of arrays takes, alignment padding included.
+ * @param element_bytes Bytes per element across the group
+ * @param capacity Elements per array
+ * @param array_count Arrays in the group
+ * @return Bytes
+ */
+static size_t map_group_bytes(size_t element_bytes, int capacity, int array_count) {
+    if (capacity <= 0) return 0;
+    return element_bytes * (size_t)capacity + (size_t)array_count * ARENA_ALIGNMENT;
+}
+
+/**
+ * Make sure the map's arena has room for more arrays. If it doesn't, every
+ * array moves into a new arena at least twice the size, which leaves the
+ * space wasted by earlier growth behind.
+ * @param map The map
+ * @param bytes Bytes about to be allocated, padding included
+ * @return true on success, false if a bigger arena could not be created
+ */
+static bool map_ensure_space(Map* map, size_t bytes) {
+    size_t capacity = arena_get_capacity(map->arena);
+    if (map->arena && capacity - arena_get_used(map->arena) >= bytes) return true;
+    
+    size_t live = map_group_bytes(MAP_WALL_BYTES, map->wall_capacity, MAP_WALL_ARRAYS) +
+                  map_group_bytes(sizeof(Exit), map->exit_capacity, 1) +
+                  map_group_bytes(sizeof(Entrance), map->entrance_capacity, 1) +
+                  map_group_bytes(sizeof(Coin), map->coin_capacity, 1) +
+                  map_group_bytes(MAP_OBSTACLE_BYTES, map->obstacles.capacity, MAP_OBSTACLE_ARRAYS) +
+                  map_group_bytes(sizeof(int32_t), map->wall_grid.cell_capacity, 1) +
+                  map_group_bytes(MAP_GRID_ENTRY_BYTES, map->wall_grid.entry_capacity, MAP_GRID_ENTRY_ARRAYS);
+    capacity = capacity ? capacity * 2 : MAP_ARENA_SIZE;
+    while (capacity < live + bytes) {
+        capacity *= 2;
+    }
+    
+    Arena* arena = arena_create(MEM_TAG_MAP, capacity);
+    if (!arena) {
+        printf("Error: Could not grow storage of map %d to %zu bytes\n", map->map_id, capacity);
+        return false;
+    }
+    Arena* old = map->arena;
+    map->arena = arena;
+    map_place_walls(map, map->wall_capacity);
+    map_place_exits(map, map->exit_capacity);
+    map_place_entrances(map, map->entrance_capacity);
+    map_place_coins(map, map->coin_capacity);
+    map_place_obstacles(map, map->obstacles.capacity);
+    map_place_grid_cells(map, map->wall_grid.cell_capacity);
+    map_place_grid_entries(map, map->wall_grid.entry_capacity);
+    arena_destroy(old);
+    return true;
+}
+
+/**
+ * Grow a group of arrays so it holds at least the given number of elements,
+ * doubling its capacity.
+ * @param map The map
+ * @param capacity The group's current capacity
+ * @param needed Elements wanted
+ * @param element_bytes Bytes per element across the group
+ * @param array_count Arrays in the group
+ * @param place Moves the group to a new capacity
+ * @return true on success, false if storage could not grow
+ */
+static bool map_reserve(Map* map, int capacity, int needed, size_t element_bytes, int array_count, MapPlaceFn place) {
+    if (needed <= capacity) return true;
+    
+    int grown = capacity > 0 ? capacity : MAP_MIN_CAPACITY;
+    while (grown < needed) {
+        grown *= 2;
+    }
+    if (!map_ensure_space(map, map_group_bytes(element_bytes, grown, array_count))) return false;
+    place(map, grown);
+    return true;
+}
+
+/**
+ * Forget every array and count. The storage itself belongs to the arena.
+ * @param map The map
+ */
+static void map_forget_contents(Map* map) {
+    Arena* arena = map->arena;
+    int map_id = map->map_id;
+    Color bg_color = map->bg_color;
+    memset(map, 0, sizeof(Map));
+    map->arena = arena;
+    map->map_id = map_id;
+    map->bg_color = bg_color;
+}
+
+bool map_add_wall(Map* map, Rectangle rect) {
+    if (!map) return false;
+    if (!map_reserve(map, map->wall_capacity, map->wall_count + 1, MAP_WALL_BYTES, MAP_WALL_ARRAYS, map_place_walls)) {
+        return false;
+    }
+    
+    int i = map->wall_count++;
+    map->walls[i] = (Wall){rect};
+    map->wall_bounds.left[i] = rect.x;
+    map->wall_bounds.top[i] = rect.y;
+    map->wall_bounds.right[i] = rect.x + rect.width;
+    map->wall_bounds.bottom[i] = rect.y + rect.height;
+    map->wall_grid.current = false;
+    return true;
+}
+
+/**
+ * Get the range of grid cells a wall touches.
+ * @param grid The grid
+ * @param wall Index of the wall
+ * @param bounds The map's wall edges
+ * @param first_column Output first column
+ * @param last_column Output last column
+ * @param first_row Output first row
+ * @param last_row Output last row
+ */
+static void map_grid_wall_cells(const WallGrid* grid, const WallBounds* bounds, int wall,
+                                int* first_column, int* last_column, int* first_row, int* last_row) {
+    *first_column = map_grid_cell(bounds->left[wall], grid->origin_x, grid->inverse_cell_size, grid->columns);
+    *last_column = map_grid_cell(bounds->right[wall], grid->origin_x, grid->inverse_cell_size, grid->columns);
+    *first_row = map_grid_cell(bounds->top[wall], grid->origin_y, grid->inverse_cell_size, grid->rows);
+    *last_row = map_grid_cell(bounds->bottom[wall], grid->origin_y, grid->inverse_cell_size, grid->rows);
+}
+
+bool map_build_wall_grid(Map* map) {
+    if (!map) return false;
+    WallGrid* grid = &map->wall_grid;
+    const WallBounds* bounds = &map->wall_bounds;
+    grid->current = false;
+    
+    // Cover the world and every wall, so no wall lies past the edge cells
+    float min_x = 0.0f;
+    float min_y = 0.0f;
+    float max_x = WORLD_WIDTH;
+    float max_y = WORLD_HEIGHT;
+    for (int i = 0; i < map->wall_count; i++) {
+        min_x = fminf(min_x, bounds->left[i]);
+        min_y = fminf(min_y, bounds->top[i]);
+        max_x = fmaxf(max_x, bounds->right[i]);
+        max_y = fmaxf(max_y, bounds->bottom[i]);
+    }
+    
+    float cell_size = MAP_GRID_CELL_SIZE;
+    float columns = ceilf((max_x - min_x) / cell_size);
+    float rows = ceilf((max_y - min_y) / cell_size);
+    while (columns * rows > MAP_GRID_MAX_CELLS) {
+        cell_size *= 2.0f;
+        columns = ceilf((max_x - min_x) / cell_size);
+        rows = ceilf((max_y - min_y) / cell_size);
+    }
+    
+    grid->origin_x = min_x;
+    grid->origin_y = min_y;
+    grid->cell_size = cell_size;
+    grid->inverse_cell_size = 1.0f / cell_size;
+    grid->columns = columns > 1.0f ? (int)columns : 1;
+    grid->rows = rows > 1.0f ? (int)rows : 1;
+    grid->cell_count = 0;
+    grid->entry_count = 0;
+    int cell_count = grid->columns * grid->rows;
+    if (!map_reserve(map, grid->cell_capacity, cell_count + 1, sizeof(int32_t), 1, map_place_grid_cells)) {
+        return false;
+    }
+    
+    // Count the entries of each cell, one slot ahead, then sum into offsets
+    int32_t* cell_start = grid->cell_start;
+    memset(cell_start, 0, sizeof(int32_t) * (size_t)(cell_count + 1));
+    for (int i = 0; i < map->wall_count; i++) {
+        int first_column, last_column, first_row, last_row;
+        map_grid_wall_cells(grid, bounds, i, &first_column, &last_column, &first_row, &last_row);
+        for (int row = first_row; row <= last_row; row++) {
+            for (int column = first_column; column <= last_column; column++) {
+                cell_start[row * grid->columns + column + 1]++;
+            }
+        }
+    }
+    for (int cell = 0; cell < cell_count; cell++) {
+        cell_start[cell + 1] += cell_start[cell];
+    }
+    grid->cell_count = cell_count;
+    
+    int entry_count = cell_start[cell_count];
+    if (!map_reserve(map, grid->entry_capacity, entry_count, MAP_GRID_ENTRY_BYTES, MAP_GRID_ENTRY_ARRAYS,
+                     map_place_grid_entries)) {
+        return false;
+    }
+    cell_start = grid->cell_start;
+    
+    // Fill using each cell's offset as its cursor, which leaves it at the
+    // next cell's start; shifting the offsets up by one restores them
+    for (int i = 0; i < map->wall_count; i++) {
+        int first_column, last_column, first_row, last_row;
+        map_grid_wall_cells(grid, bounds, i, &first_column, &last_column, &first_row, &last_row);
+        for (int row = first_row; row <= last_row; row++) {
+            for (int column = first_column; column <= last_column; column++) {
+                int entry = cell_start[row * grid->columns + column]++;
+                grid->wall_index[entry] = i;
+                grid->left[entry] = bounds->left[i];
+                grid->top[entry] = bounds->top[i];
+                grid->right[entry] = bounds->right[i];
+                grid->bottom[entry] = bounds->bottom[i];
+            }
+        }
+    }
+    memmove(cell_start + 1, cell_start, sizeof(int32_t) * (size_t)cell_count);
+    cell_start[0] = 0;
+    grid->entry_count = entry_count;
+    grid->current = true;
+    return true;
+}
+
+const WallGrid* map_get_wall_grid(const Map* map) {
+    if (!map || !map->wall_grid.current) return NULL;
+    return &map->wall_grid;
+}
+
+/**
+ * Append an exit.
+ * @param map The map
+ * @param exit The exit
+ * @return true on success, false if storage could not grow
+ */
+static bool map_push_exit(Map* map, Exit exit) {
+    if (!map_reserve(map, map->exit_capacity, map->exit_count + 1, sizeof(Exit), 1, map_place_exits)) return false;
+    map->exits[map->exit_count++] = exit;
+    return true;
+}
+
+/**
+ * Append an entrance.
+ * @param map The map
+ * @param position Where the player arrives
+ * @return true on success, false if storage could not grow
+ */
+static bool map_push_entrance(Map* map, Vector2 position) {
+    if (!map_reserve(map, map->entrance_capacity, map->entrance_count + 1, sizeof(Entrance), 1, map_place_entrances)) {
+        return false;
+    }
+    map->entrances[map->entrance_count++] = (Entrance){position};
+    return true;
+}
+
+bool map_add_coin(Map* map, Vector2 position) {
+    if (!map) return false;
+    if (!map_reserve(map, map->coin_capacity, map->coin_count + 1, sizeof(Coin), 1, map_place_coins)) return false;
+    map->coins[map->coin_count++] = (Coin){position, false};
+    return true;
+}
+
+/**
+ * Append an obstacle, starting with no motion to blend from.
+ * @param map The map
+ * @param position Spawn position
+ * @param velocity Initial velocity
+ * @param timer Initial direction change timer in seconds
+ * @param color Obstacle color
+ * @return true on success, false if storage could not grow
+ */
+static bool map_push_obstacle(Map* map, Vector2 position, Vector2 velocity, float timer, Color color) {
+    ObstacleSet* obstacles = &map->obstacles;
+    if (!map_reserve(map, obstacles->capacity, obstacles->count + 1, MAP_OBSTACLE_BYTES, MAP_OBSTACLE_ARRAYS,
+                     map_place_obstacles)) {
+        return false;
+    }
+    
+    int i = obstacles->count++;
+    obstacles->x[i] = position.x;
+    obstacles->y[i] = position.y;
+    obstacles->velocity_x[i] = velocity.x;
+    obstacles->velocity_y[i] = velocity.y;
+    obstacles->previous_x[i] = position.x;
+    obstacles->previous_y[i] = position.y;
+    obstacles->direction_change_timer[i] = timer;
+    obstacles->color[i] = color;
+    return true;
+}
+
+/**
+ * Move an obstacle out of any wall it was placed in. Only the current
+ * position moves; the map syncs previous positions when it becomes current.
+ * @param map The map
+ * @param index Index of the obstacle
+ */
+static void map_move_obstacle_to_valid_position(Map* map, int index) {
+    Vector2 desired = {map->obstacles.x[index], map->obstacles.y[index]};
+    Vector2 valid_pos = map_find_valid_spawn_position(desired, OBSTACLE_RADIUS, map);
+    map->obstacles.x[index] = valid_pos.x;
+    map->obstacles.y[index] = valid_pos.y;
+}
+
 Map* map_create(int map_id) {
-    Map* map = (Map*)malloc(sizeof(Map));
+    Map* map = (Map*)mem_calloc(MEM_TAG_MAP, 1, sizeof(Map));
     if (!map) return NULL;
     map_init(map, map_id);
     return map;
 }
 
 void map_destroy(Map* map) {
-    if (map) free(map);
+    if (!map) return;
+    map_release(map);
+    mem_free(map);
 }
 
-void map_init(Map* map, int map_id) {
-    map->map_id = map_id;
+void map_release(Map* map) {
+    if (!map) return;
+    arena_destroy(map->arena);
+    memset(map, 0, sizeof(Map));
+}
+
+void map_clear(Map* map) {
+    if (!map) return;
     map->wall_count = 0;
     map->exit_count = 0;
     map->entrance_count = 0;
     map->coin_count = 0;
-    map->obstacle_count = 0;
+    map->obstacles.count = 0;
+    map->wall_grid.cell_count = 0;
+    map->wall_grid.entry_count = 0;
+    map->wall_grid.current = false;
+}
+
+void map_init(Map* map, int map_id) {
+    map->map_id = map_id;
+    if (map->arena) {
+        arena_reset(map->arena);
+    } else {
+        map->arena = arena_create(MEM_TAG_MAP, MAP_ARENA_SIZE);
+        if (!map->arena) {
+            printf("Error: Could not create storage for map %d\n", map_id);
+        }
+    }
+    map_forget_contents(map);
     
     switch(map_id) {
         case 0: map->bg_color = (Color){240, 240, 255, 255}; break;
@@ -89,26 +632,26 @@ void map_init(Map* map, int map_id) {
     }
     
     if (map_id == 0) {
-        map->walls[map->wall_count++] = (Wall){(Rectangle){50, 50, 150, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){250, 50, 150, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){50, 50, 20, 150}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){50, 250, 20, 150}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){200, 200, 100, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){200, 200, 20, 100}};
+        map_add_wall(map, (Rectangle){50, 50, 150, 20});
+        map_add_wall(map, (Rectangle){250, 50, 150, 20});
+        map_add_wall(map, (Rectangle){50, 50, 20, 150});
+        map_add_wall(map, (Rectangle){50, 250, 20, 150});
+        map_add_wall(map, (Rectangle){200, 200, 100, 20});
+        map_add_wall(map, (Rectangle){200, 200, 20, 100});
         
-        map->exits[map->exit_count++] = (Exit){(Rectangle){SCREEN_WIDTH - EXIT_WIDTH - 20, SCREEN_HEIGHT/2 - EXIT_HEIGHT/2, EXIT_WIDTH, EXIT_HEIGHT}, 1, 0};
-        map->exits[map->exit_count++] = (Exit){(Rectangle){SCREEN_WIDTH/2 - EXIT_WIDTH/2, SCREEN_HEIGHT - EXIT_HEIGHT - 20, EXIT_WIDTH, EXIT_HEIGHT}, 2, 0};
+        map_push_exit(map, (Exit){(Rectangle){WORLD_WIDTH - EXIT_WIDTH - 20, WORLD_HEIGHT/2 - EXIT_HEIGHT/2, EXIT_WIDTH, EXIT_HEIGHT}, 1, 0});
+        map_push_exit(map, (Exit){(Rectangle){WORLD_WIDTH/2 - EXIT_WIDTH/2, WORLD_HEIGHT - EXIT_HEIGHT - 20, EXIT_WIDTH, EXIT_HEIGHT}, 2, 0});
         
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH/2, SCREEN_HEIGHT/2}};
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){50, SCREEN_HEIGHT/2}};
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH/2, 50}};
+        map_push_entrance(map, (Vector2){WORLD_WIDTH/2, WORLD_HEIGHT/2});
+        map_push_entrance(map, (Vector2){50, WORLD_HEIGHT/2});
+        map_push_entrance(map, (Vector2){WORLD_WIDTH/2, 50});
         
-        map->coins[map->coin_count++] = (Coin){(Vector2){150, 150}, false};
-        map->coins[map->coin_count++] = (Coin){(Vector2){350, 200}, false};
-        map->coins[map->coin_count++] = (Coin){(Vector2){150, 350}, false};
+        map_add_coin(map, (Vector2){150, 150});
+        map_add_coin(map, (Vector2){350, 200});
+        map_add_coin(map, (Vector2){150, 350});
         
-        map->obstacles[map->obstacle_count++] = (Obstacle){(Vector2){300, 250}, (Vector2){OBSTACLE_SPEED, OBSTACLE_SPEED}, OBSTACLE_RADIUS, 0, RED};
-        map->obstacles[map->obstacle_count++] = (Obstacle){(Vector2){200, 300}, (Vector2){-OBSTACLE_SPEED, OBSTACLE_SPEED}, OBSTACLE_RADIUS, 60, RED};
+        map_push_obstacle(map, (Vector2){300, 250}, (Vector2){OBSTACLE_SPEED, OBSTACLE_SPEED}, 0.0f, RED);
+        map_push_obstacle(map, (Vector2){200, 300}, (Vector2){-OBSTACLE_SPEED, OBSTACLE_SPEED}, 1.0f, RED);
         
         for (int i = 0; i < map->entrance_count; i++) {
             Vector2 valid_pos = map_find_valid_spawn_position(map->entrances[i].position, PLAYER_RADIUS, map);
@@ -118,98 +661,100 @@ void map_init(Map* map, int map_id) {
             map->entrances[i].position = valid_pos;
         }
         
-        for (int i = 0; i < map->obstacle_count; i++) {
-            Vector2 valid_pos = map_find_valid_spawn_position(map->obstacles[i].position, OBSTACLE_RADIUS, map);
-            map->obstacles[i].position = valid_pos;
+        for (int i = 0; i < map->obstacles.count; i++) {
+            map_move_obstacle_to_valid_position(map, i);
         }
     }
     else if (map_id == 1) {
-        map->walls[map->wall_count++] = (Wall){(Rectangle){450, 50, 150, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){650, 50, 150, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){450, 50, 20, 150}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){450, 250, 20, 150}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){600, 200, 100, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){600, 200, 20, 100}};
+        map_add_wall(map, (Rectangle){450, 50, 150, 20});
+        map_add_wall(map, (Rectangle){650, 50, 150, 20});
+        map_add_wall(map, (Rectangle){450, 50, 20, 150});
+        map_add_wall(map, (Rectangle){450, 250, 20, 150});
+        map_add_wall(map, (Rectangle){600, 200, 100, 20});
+        map_add_wall(map, (Rectangle){600, 200, 20, 100});
         
-        map->exits[map->exit_count++] = (Exit){(Rectangle){20, SCREEN_HEIGHT/2 - EXIT_HEIGHT/2, EXIT_WIDTH, EXIT_HEIGHT}, 0, 1};
-        map->exits[map->exit_count++] = (Exit){(Rectangle){SCREEN_WIDTH/2 - EXIT_WIDTH/2, SCREEN_HEIGHT - EXIT_HEIGHT - 20, EXIT_WIDTH, EXIT_HEIGHT}, 3, 0};
+        map_push_exit(map, (Exit){(Rectangle){20, WORLD_HEIGHT/2 - EXIT_HEIGHT/2, EXIT_WIDTH, EXIT_HEIGHT}, 0, 1});
+        map_push_exit(map, (Exit){(Rectangle){WORLD_WIDTH/2 - EXIT_WIDTH/2, WORLD_HEIGHT - EXIT_HEIGHT - 20, EXIT_WIDTH, EXIT_HEIGHT}, 3, 0});
         
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH/2, SCREEN_HEIGHT/2}};
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH - 50, SCREEN_HEIGHT/2}};
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH/2, 50}};
+        map_push_entrance(map, (Vector2){WORLD_WIDTH/2, WORLD_HEIGHT/2});
+        map_push_entrance(map, (Vector2){WORLD_WIDTH - 50, WORLD_HEIGHT/2});
+        map_push_entrance(map, (Vector2){WORLD_WIDTH/2, 50});
         
-        map->coins[map->coin_count++] = (Coin){(Vector2){550, 150}, false};
-        map->coins[map->coin_count++] = (Coin){(Vector2){750, 200}, false};
-        map->coins[map->coin_count++] = (Coin){(Vector2){550, 350}, false};
+        map_add_coin(map, (Vector2){550, 150});
+        map_add_coin(map, (Vector2){750, 200});
+        map_add_coin(map, (Vector2){550, 350});
         
-        map->obstacles[map->obstacle_count++] = (Obstacle){(Vector2){600, 250}, (Vector2){OBSTACLE_SPEED, -OBSTACLE_SPEED}, OBSTACLE_RADIUS, 30, RED};
-        map->obstacles[map->obstacle_count++] = (Obstacle){(Vector2){700, 300}, (Vector2){-OBSTACLE_SPEED, OBSTACLE_SPEED}, OBSTACLE_RADIUS, 90, RED};
+        map_push_obstacle(map, (Vector2){600, 250}, (Vector2){OBSTACLE_SPEED, -OBSTACLE_SPEED}, 0.5f, RED);
+        map_push_obstacle(map, (Vector2){700, 300}, (Vector2){-OBSTACLE_SPEED, OBSTACLE_SPEED}, 1.5f, RED);
         
         for (int i = 0; i < map->entrance_count; i++) {
             map->entrances[i].position = map_find_valid_spawn_position(map->entrances[i].position, PLAYER_RADIUS, map);
         }
-        for (int i = 0; i < map->obstacle_count; i++) {
-            map->obstacles[i].position = map_find_valid_spawn_position(map->obstacles[i].position, OBSTACLE_RADIUS, map);
+        for (int i = 0; i < map->obstacles.count; i++) {
+            map_move_obstacle_to_valid_position(map, i);
         }
     }
     else if (map_id == 2) {
-        map->walls[map->wall_count++] = (Wall){(Rectangle){50, 400, 150, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){250, 400, 150, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){50, 400, 20, 150}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){50, 600, 20, 150}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){200, 550, 100, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){200, 550, 20, 100}};
+        map_add_wall(map, (Rectangle){50, 400, 150, 20});
+        map_add_wall(map, (Rectangle){250, 400, 150, 20});
+        map_add_wall(map, (Rectangle){50, 400, 20, 150});
+        map_add_wall(map, (Rectangle){50, 600, 20, 150});
+        map_add_wall(map, (Rectangle){200, 550, 100, 20});
+        map_add_wall(map, (Rectangle){200, 550, 20, 100});
         
-        map->exits[map->exit_count++] = (Exit){(Rectangle){SCREEN_WIDTH/2 - EXIT_WIDTH/2, 20, EXIT_WIDTH, EXIT_HEIGHT}, 0, 2};
-        map->exits[map->exit_count++] = (Exit){(Rectangle){SCREEN_WIDTH - EXIT_WIDTH - 20, SCREEN_HEIGHT/2 - EXIT_HEIGHT/2, EXIT_WIDTH, EXIT_HEIGHT}, 3, 1};
+        map_push_exit(map, (Exit){(Rectangle){WORLD_WIDTH/2 - EXIT_WIDTH/2, 20, EXIT_WIDTH, EXIT_HEIGHT}, 0, 2});
+        map_push_exit(map, (Exit){(Rectangle){WORLD_WIDTH - EXIT_WIDTH - 20, WORLD_HEIGHT/2 - EXIT_HEIGHT/2, EXIT_WIDTH, EXIT_HEIGHT}, 3, 1});
         
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH/2, SCREEN_HEIGHT/2}};
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH/2, SCREEN_HEIGHT - 50}};
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){50, SCREEN_HEIGHT/2}};
+        map_push_entrance(map, (Vector2){WORLD_WIDTH/2, WORLD_HEIGHT/2});
+        map_push_entrance(map, (Vector2){WORLD_WIDTH/2, WORLD_HEIGHT - 50});
+        map_push_entrance(map, (Vector2){50, WORLD_HEIGHT/2});
         
-        map->coins[map->coin_count++] = (Coin){(Vector2){150, 500}, false};
-        map->coins[map->coin_count++] = (Coin){(Vector2){350, 450}, false};
-        map->coins[map->coin_count++] = (Coin){(Vector2){150, 350}, false};
+        map_add_coin(map, (Vector2){150, 500});
+        map_add_coin(map, (Vector2){350, 450});
+        map_add_coin(map, (Vector2){150, 350});
         
-        map->obstacles[map->obstacle_count++] = (Obstacle){(Vector2){300, 500}, (Vector2){OBSTACLE_SPEED, OBSTACLE_SPEED}, OBSTACLE_RADIUS, 45, RED};
-        map->obstacles[map->obstacle_count++] = (Obstacle){(Vector2){200, 450}, (Vector2){-OBSTACLE_SPEED, OBSTACLE_SPEED}, OBSTACLE_RADIUS, 120, RED};
+        map_push_obstacle(map, (Vector2){300, 500}, (Vector2){OBSTACLE_SPEED, OBSTACLE_SPEED}, 0.75f, RED);
+        map_push_obstacle(map, (Vector2){200, 450}, (Vector2){-OBSTACLE_SPEED, OBSTACLE_SPEED}, 2.0f, RED);
         
         for (int i = 0; i < map->entrance_count; i++) {
             map->entrances[i].position = map_find_valid_spawn_position(map->entrances[i].position, PLAYER_RADIUS, map);
         }
-        for (int i = 0; i < map->obstacle_count; i++) {
-            map->obstacles[i].position = map_find_valid_spawn_position(map->obstacles[i].position, OBSTACLE_RADIUS, map);
+        for (int i = 0; i < map->obstacles.count; i++) {
+            map_move_obstacle_to_valid_position(map, i);
         }
     }
     else if (map_id == 3) {
-        map->walls[map->wall_count++] = (Wall){(Rectangle){450, 400, 150, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){650, 400, 150, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){450, 400, 20, 150}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){450, 600, 20, 150}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){600, 550, 100, 20}};
-        map->walls[map->wall_count++] = (Wall){(Rectangle){600, 550, 20, 100}};
+        map_add_wall(map, (Rectangle){450, 400, 150, 20});
+        map_add_wall(map, (Rectangle){650, 400, 150, 20});
+        map_add_wall(map, (Rectangle){450, 400, 20, 150});
+        map_add_wall(map, (Rectangle){450, 600, 20, 150});
+        map_add_wall(map, (Rectangle){600, 550, 100, 20});
+        map_add_wall(map, (Rectangle){600, 550, 20, 100});
         
-        map->exits[map->exit_count++] = (Exit){(Rectangle){SCREEN_WIDTH/2 - EXIT_WIDTH/2, 20, EXIT_WIDTH, EXIT_HEIGHT}, 1, 2};
-        map->exits[map->exit_count++] = (Exit){(Rectangle){20, SCREEN_HEIGHT/2 - EXIT_HEIGHT/2, EXIT_WIDTH, EXIT_HEIGHT}, 2, 2};
+        map_push_exit(map, (Exit){(Rectangle){WORLD_WIDTH/2 - EXIT_WIDTH/2, 20, EXIT_WIDTH, EXIT_HEIGHT}, 1, 2});
+        map_push_exit(map, (Exit){(Rectangle){20, WORLD_HEIGHT/2 - EXIT_HEIGHT/2, EXIT_WIDTH, EXIT_HEIGHT}, 2, 2});
         
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH/2, SCREEN_HEIGHT/2}};
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH/2, SCREEN_HEIGHT - 50}};
-        map->entrances[map->entrance_count++] = (Entrance){(Vector2){SCREEN_WIDTH - 50, SCREEN_HEIGHT/2}};
+        map_push_entrance(map, (Vector2){WORLD_WIDTH/2, WORLD_HEIGHT/2});
+        map_push_entrance(map, (Vector2){WORLD_WIDTH/2, WORLD_HEIGHT - 50});
+        map_push_entrance(map, (Vector2){WORLD_WIDTH - 50, WORLD_HEIGHT/2});
         
-        map->coins[map->coin_count++] = (Coin){(Vector2){550, 500}, false};
-        map->coins[map->coin_count++] = (Coin){(Vector2){750, 450}, false};
-        map->coins[map->coin_count++] = (Coin){(Vector2){550, 350}, false};
+        map_add_coin(map, (Vector2){550, 500});
+        map_add_coin(map, (Vector2){750, 450});
+        map_add_coin(map, (Vector2){550, 350});
         
-        map->obstacles[map->obstacle_count++] = (Obstacle){(Vector2){600, 500}, (Vector2){OBSTACLE_SPEED, -OBSTACLE_SPEED}, OBSTACLE_RADIUS, 75, RED};
-        map->obstacles[map->obstacle_count++] = (Obstacle){(Vector2){700, 450}, (Vector2){-OBSTACLE_SPEED, -OBSTACLE_SPEED}, OBSTACLE_RADIUS, 15, RED};
+        map_push_obstacle(map, (Vector2){600, 500}, (Vector2){OBSTACLE_SPEED, -OBSTACLE_SPEED}, 1.25f, RED);
+        map_push_obstacle(map, (Vector2){700, 450}, (Vector2){-OBSTACLE_SPEED, -OBSTACLE_SPEED}, 0.25f, RED);
         
         for (int i = 0; i < map->entrance_count; i++) {
             map->entrances[i].position = map_find_valid_spawn_position(map->entrances[i].position, PLAYER_RADIUS, map);
         }
-        for (int i = 0; i < map->obstacle_count; i++) {
-            map->obstacles[i].position = map_find_valid_spawn_position(map->obstacles[i].position, OBSTACLE_RADIUS, map);
+        for (int i = 0; i < map->obstacles.count; i++) {
+            map_move_obstacle_to_valid_position(map, i);
         }
     }
+    
+    map_build_wall_grid(map);
+    map_sync_previous_positions(map);
 }
 
 const Wall* map_get_walls(const Map* map, int* count) {
@@ -232,9 +777,13 @@ const Coin* map_get_coins(const Map* map, int* count) {
     return map->coins;
 }
 
-const Obstacle* map_get_obstacles(const Map* map, int* count) {
-    if (count) *count = map->obstacle_count;
-    return map->obstacles;
+const ObstacleSet* map_get_obstacles(const Map* map) {
+    return &map->obstacles;
+}
+
+Vector2 map_get_obstacle_position(const Map* map, int index) {
+    if (!map || index < 0 || index >= map->obstacles.count) return (Vector2){0, 0};
+    return (Vector2){map->obstacles.x[index], map->obstacles.y[index]};
 }
 
 Color map_get_background_color(const Map* map) {
@@ -250,14 +799,201 @@ Coin* map_get_coin_mutable(Map* map, int index) {
     return &map->coins[index];
 }
 
-Obstacle* map_get_obstacle_mutable(Map* map, int index) {
-    if (!map || index < 0 || index >= map->obstacle_count) return NULL;
-    return &map->obstacles[index];
+void map_sync_previous_positions(Map* map) {
+    if (!map) return;
+    map_copy_bytes(map->obstacles.previous_x, map->obstacles.x, sizeof(float) * (size_t)map->obstacles.count);
+    map_copy_bytes(map->obstacles.previous_y, map->obstacles.y, sizeof(float) * (size_t)map->obstacles.count);
+}
+
+Vector2 map_get_obstacle_interpolated_position(const Map* map, int index, float alpha) {
+    if (!map || index < 0 || index >= map->obstacles.count) return (Vector2){0, 0};
+    const ObstacleSet* obstacles = &map->obstacles;
+    return (Vector2){
+        obstacles->previous_x[index] + (obstacles->x[index] - obstacles->previous_x[index]) * alpha,
+        obstacles->previous_y[index] + (obstacles->y[index] - obstacles->previous_y[index]) * alpha
+    };
 }
 
-void map_update_obstacle(Map* map, int index, Vector2 new_position, Vector2 new_velocity, int new_timer) {
-    if (!map || index < 0 || index >= map->obstacle_count) return;
-    map->obstacles[index].position = new_position;
-    map->obstacles[index].velocity = new_velocity;
-    map->obstacles[index].direction_change_timer = new_timer;
+void map_set_obstacle_position(Map* map, int index, Vector2 position, bool snap) {
+    if (!map || index < 0 || index >= map->obstacles.count) return;
+    map->obstacles.x[index] = position.x;
+    map->obstacles.y[index] = position.y;
+    if (snap) {
+        map->obstacles.previous_x[index] = position.x;
+        map->obstacles.previous_y[index] = position.y;
+    }
+}
+
+bool map_add_obstacle(Map* map, Vector2 position, Vector2 velocity, Color color) {
+    if (!map) return false;
+    return map_push_obstacle(map, position, velocity, 0.0f, color);
+}
+
+bool map_copy(Map* dest, const Map* source) {
+    if (!dest || !source) return false;
+    
+    // Emptied first, so growing doesn't carry the old contents along
+    map_clear(dest);
+    dest->map_id = source->map_id;
+    dest->bg_color = source->bg_color;
+    const ObstacleSet* from = &source->obstacles;
+    ObstacleSet* to = &dest->obstacles;
+    if (!map_reserve(dest, dest->wall_capacity, source->wall_count, MAP_WALL_BYTES, MAP_WALL_ARRAYS, map_place_walls) ||
+        !map_reserve(dest, dest->exit_capacity, source->exit_count, sizeof(Exit), 1, map_place_exits) ||
+        !map_reserve(dest, dest->entrance_capacity, source->entrance_count, sizeof(Entrance), 1, map_place_entrances) ||
+        !map_reserve(dest, dest->coin_capacity, source->coin_count, sizeof(Coin), 1, map_place_coins) ||
+        !map_reserve(dest, to->capacity, from->count, MAP_OBSTACLE_BYTES, MAP_OBSTACLE_ARRAYS, map_place_obstacles) ||
+        !map_reserve(dest, dest->wall_grid.cell_capacity, source->wall_grid.cell_count + 1, sizeof(int32_t), 1,
+                     map_place_grid_cells) ||
+        !map_reserve(dest, dest->wall_grid.entry_capacity, source->wall_grid.entry_count, MAP_GRID_ENTRY_BYTES,
+                     MAP_GRID_ENTRY_ARRAYS, map_place_grid_entries)) {
+        return false;
+    }
+    
+    size_t walls = (size_t)source->wall_count;
+    map_copy_bytes(dest->walls, source->walls, sizeof(Wall) * walls);
+    map_copy_bytes(dest->wall_bounds.left, source->wall_bounds.left, sizeof(float) * walls);
+    map_copy_bytes(dest->wall_bounds.top, source->wall_bounds.top, sizeof(float) * walls);
+    map_copy_bytes(dest->wall_bounds.right, source->wall_bounds.right, sizeof(float) * walls);
+    map_copy_bytes(dest->wall_bounds.bottom, source->wall_bounds.bottom, sizeof(float) * walls);
+    dest->wall_count = source->wall_count;
+    
+    // Same grid, keeping the destination's storage
+    const WallGrid* grid = &source->wall_grid;
+    WallGrid* dest_grid = &dest->wall_grid;
+    int32_t* cell_start = dest_grid->cell_start;
+    int32_t* wall_index = dest_grid->wall_index;
+    float* left = dest_grid->left;
+    float* top = dest_grid->top;
+    float* right = dest_grid->right;
+    float* bottom = dest_grid->bottom;
+    int cell_capacity = dest_grid->cell_capacity;
+    int entry_capacity = dest_grid->entry_capacity;
+    *dest_grid = *grid;
+    dest_grid->cell_start = cell_start;
+    dest_grid->wall_index = wall_index;
+    dest_grid->left = left;
+    dest_grid->top = top;
+    dest_grid->right = right;
+    dest_grid->bottom = bottom;
+    dest_grid->cell_capacity = cell_capacity;
+    dest_grid->entry_capacity = entry_capacity;
+    size_t offsets = grid->cell_count > 0 ? (size_t)grid->cell_count + 1 : 0;
+    size_t entries = (size_t)grid->entry_count;
+    map_copy_bytes(cell_start, grid->cell_start, sizeof(int32_t) * offsets);
+    map_copy_bytes(wall_index, grid->wall_index, sizeof(int32_t) * entries);
+    map_copy_bytes(left, grid->left, sizeof(float) * entries);
+    map_copy_bytes(top, grid->top, sizeof(float) * entries);
+    map_copy_bytes(right, grid->right, sizeof(float) * entries);
+    map_copy_bytes(bottom, grid->bottom, sizeof(float) * entries);
+    
+    map_copy_bytes(dest->exits, source->exits, sizeof(Exit) * (size_t)source->exit_count);
+    dest->exit_count = source->exit_count;
+    map_copy_bytes(dest->entrances, source->entrances, sizeof(Entrance) * (size_t)source->entrance_count);
+    dest->entrance_count = source->entrance_count;
+    map_copy_bytes(dest->coins, source->coins, sizeof(Coin) * (size_t)source->coin_count);
+    dest->coin_count = source->coin_count;
+    
+    size_t obstacles = (size_t)from->count;
+    map_copy_bytes(to->x, from->x, sizeof(float) * obstacles);
+    map_copy_bytes(to->y, from->y, sizeof(float) * obstacles);
+    map_copy_bytes(to->velocity_x, from->velocity_x, sizeof(float) * obstacles);
+    map_copy_bytes(to->velocity_y, from->velocity_y, sizeof(float) * obstacles);
+    map_copy_bytes(to->previous_x, from->previous_x, sizeof(float) * obstacles);
+    map_copy_bytes(to->previous_y, from->previous_y, sizeof(float) * obstacles);
+    map_copy_bytes(to->direction_change_timer, from->direction_change_timer, sizeof(float) * obstacles);
+    map_copy_bytes(to->color, from->color, sizeof(Color) * obstacles);
+    to->count = from->count;
+    return true;
+}
+
+size_t map_snapshot_size(const Map* map) {
+    if (!map) return 0;
+    return MAP_SNAPSHOT_HEADER_SIZE + (size_t)map->coin_count + MAP_OBSTACLE_RECORD_SIZE * (size_t)map->obstacles.count;
+}
+
+size_t map_snapshot(const Map* map, void* buffer) {
+    if (!map || !buffer) return 0;
+    
+    const ObstacleSet* obstacles = &map->obstacles;
+    int32_t counts[2] = {map->coin_count, obstacles->count};
+    uint8_t* out = (uint8_t*)buffer;
+    map_copy_bytes(out, counts, sizeof(counts));
+    out += sizeof(counts);
+    for (int i = 0; i < map->coin_count; i++) {
+        *out++ = map->coins[i].collected ? 1 : 0;
+    }
+    
+    size_t n = (size_t)obstacles->count;
+    map_copy_bytes(out, obstacles->x, sizeof(float) * n);
+    out += sizeof(float) * n;
+    map_copy_bytes(out, obstacles->y, sizeof(float) * n);
+    out += sizeof(float) * n;
+    map_copy_bytes(out, obstacles->velocity_x, sizeof(float) * n);
+    out += sizeof(float) * n;
+    map_copy_bytes(out, obstacles->velocity_y, sizeof(float) * n);
+    out += sizeof(float) * n;
+    map_copy_bytes(out, obstacles->previous_x, sizeof(float) * n);
+    out += sizeof(float) * n;
+    map_copy_bytes(out, obstacles->previous_y, sizeof(float) * n);
+    out += sizeof(float) * n;
+    map_copy_bytes(out, obstacles->direction_change_timer, sizeof(float) * n);
+    out += sizeof(float) * n;
+    map_copy_bytes(out, obstacles->color, sizeof(Color) * n);
+    out += sizeof(Color) * n;
+    return (size_t)(out - (uint8_t*)buffer);
+}
+
+size_t map_check_snapshot(const Map* map, const void* buffer, size_t size) {
+    if (!map || !buffer || size < MAP_SNAPSHOT_HEADER_SIZE) return 0;
+    
+    int32_t counts[2];
+    map_copy_bytes(counts, buffer, sizeof(counts));
+    if (counts[0] != map->coin_count || counts[1] < 0) return 0;
+    
+    if (size - MAP_SNAPSHOT_HEADER_SIZE < (size_t)counts[0]) return 0;
+    size_t records = size - MAP_SNAPSHOT_HEADER_SIZE - (size_t)counts[0];
+    if ((size_t)counts[1] > records / MAP_OBSTACLE_RECORD_SIZE) return 0;
+    return MAP_SNAPSHOT_HEADER_SIZE + (size_t)counts[0] + MAP_OBSTACLE_RECORD_SIZE * (size_t)counts[1];
+}
+
+bool map_reserve_snapshot(Map* map, const void* buffer) {
+    if (!map || !buffer) return false;
+    
+    int32_t counts[2];
+    map_copy_bytes(counts, buffer, sizeof(counts));
+    return map_reserve(map, map->obstacles.capacity, counts[1], MAP_OBSTACLE_BYTES, MAP_OBSTACLE_ARRAYS,
+                       map_place_obstacles);
+}
+
+void map_restore(Map* map, const void* buffer) {
+    if (!map || !buffer) return;
+    
+    ObstacleSet* obstacles = &map->obstacles;
+    int32_t counts[2];
+    const uint8_t* in = (const uint8_t*)buffer;
+    map_copy_bytes(counts, in, sizeof(counts));
+    in += sizeof(counts);
+    if (counts[1] > obstacles->capacity) return;  // map_reserve_snapshot() was skipped or failed
+    for (int i = 0; i < map->coin_count; i++) {
+        map->coins[i].collected = *in++ != 0;
+    }
+    
+    size_t n = (size_t)counts[1];
+    map_copy_bytes(obstacles->x, in, sizeof(float) * n);
+    in += sizeof(float) * n;
+    map_copy_bytes(obstacles->y, in, sizeof(float) * n);
+    in += sizeof(float) * n;
+    map_copy_bytes(obstacles->velocity_x, in, sizeof(float) * n);
+    in += sizeof(float) * n;
+    map_copy_bytes(obstacles->velocity_y, in, sizeof(float) * n);
+    in += sizeof(float) * n;
+    map_copy_bytes(obstacles->previous_x, in, sizeof(float) * n);
+    in += sizeof(float) * n;
+    map_copy_bytes(obstacles->previous_y, in, sizeof(float) * n);
+    in += sizeof(float) * n;
+    map_copy_bytes(obstacles->direction_change_timer, in, sizeof(float) * n);
+    in += sizeof(float) * n;
+    map_copy_bytes(obstacles->color, in, sizeof(Color) * n);
+    obstacles->count = counts[1];
 }
@@ -0,0 +1,368 @@
+#include "../include/mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+// Each block is prefixed with its size and tag. Blocks are padded so the
+// caller's memory starts on a cache line, which structure-of-arrays data
+// such as the projectile pool relies on.
+#define MEM_ALIGNMENT 64
+#define MEM_OVERHEAD (sizeof(MemHeader) + MEM_ALIGNMENT - 1)
+
+typedef struct {
+    void* block;  // What malloc returned
+    size_t size;
+    int tag;
+} MemHeader;
+
+typedef struct {
+    volatile int64_t live_bytes;
+    volatile int64_t peak_bytes;
+    volatile int64_t live_allocations;
+    volatile int64_t total_allocations;
+    volatile int64_t frame_allocations;  // Since the last mem_next_frame()
+    volatile int64_t frame_bytes;
+    volatile int64_t last_frame_allocations;
+    volatile int64_t last_frame_bytes;
+} MemCounters;
+
+typedef struct {
+    volatile int64_t live;
+    volatile int64_t peak;
+    volatile int64_t total;
+} MemResourceCounters;
+
+static MemCounters g_tags[MEM_TAG_COUNT];
+static MemCounters g_total;
+static MemResourceCounters g_resources[MEM_RESOURCE_COUNT];
+
+static const char* const MEM_TAG_NAMES[MEM_TAG_COUNT] = {
+    [MEM_TAG_ENGINE] = "engine",
+    [MEM_TAG_THREAD] = "thread",
+    [MEM_TAG_JOBS] = "jobs",
+    [MEM_TAG_GAME] = "game",
+    [MEM_TAG_MAP] = "map",
+    [MEM_TAG_STATE] = "state",
+    [MEM_TAG_ROLLBACK] = "rollback",
+    [MEM_TAG_REPLAY] = "replay",
+    [MEM_TAG_NET] = "net",
+    [MEM_TAG_TRACE] = "trace",
+    [MEM_TAG_AUDIO] = "audio"
+};
+
+static const char* const MEM_RESOURCE_NAMES[MEM_RESOURCE_COUNT] = {
+    [MEM_RESOURCE_SOUND] = "sounds",
+    [MEM_RESOURCE_TEXTURE] = "textures",
+    [MEM_RESOURCE_RENDER_TEXTURE] = "render textures"
+};
+
+#ifdef GENGINE_CHECK_FRAME_ALLOCS
+
+#if defined(_MSC_VER)
+#define MEM_THREAD_LOCAL __declspec(thread)
+#else
+#define MEM_THREAD_LOCAL _Thread_local
+#endif
+
+// Frames the calling thread is inside
+static MEM_THREAD_LOCAL int g_frame_depth = 0;
+
+/**
+ * Abort if the calling thread is inside a frame.
+ * @param operation Name of the heap call, for the message
+ * @param size Bytes involved
+ */
+static void mem_check_frame(const char* operation, size_t size) {
+    if (g_frame_depth > 0) {
+        printf("Error: %s of %zu bytes in the middle of a frame\n", operation, size);
+        fflush(stdout);
+        abort();
+    }
+}
+
+#define MEM_CHECK_FRAME(operation, size) mem_check_frame(operation, size)
+#else
+#define MEM_CHECK_FRAME(operation, size) ((void)0)
+#endif
+
+/**
+ * Atomically add to a counter.
+ * @param value The counter
+ * @param delta Amount to add
+ * @return The new value
+ */
+static int64_t mem_atomic_add(volatile int64_t* value, int64_t delta) {
+#if defined(_MSC_VER)
+    return InterlockedExchangeAdd64((volatile LONG64*)value, delta) + delta;
+#else
+    return __atomic_add_fetch(value, delta, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * Atomically read a counter.
+ * @param value The counter
+ * @return Its value
+ */
+static int64_t mem_atomic_load(volatile int64_t* value) {
+#if defined(_MSC_VER)
+    return InterlockedCompareExchange64((volatile LONG64*)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * Atomically replace a counter.
+ * @param value The counter
+ * @param replacement New value
+ * @return The old value
+ */
+static int64_t mem_atomic_exchange(volatile int64_t* value, int64_t replacement) {
+#if defined(_MSC_VER)
+    return InterlockedExchange64((volatile LONG64*)value, replacement);
+#else
+    return __atomic_exchange_n(value, replacement, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * Atomically raise a high-water mark.
+ * @param peak The mark
+ * @param value Value just reached
+ */
+static void mem_atomic_raise(volatile int64_t* peak, int64_t value) {
+    int64_t seen = mem_atomic_load(peak);
+    while (value > seen) {
+#if defined(_MSC_VER)
+        int64_t previous = InterlockedCompareExchange64((volatile LONG64*)peak, value, seen);
+        if (previous == seen) break;
+        seen = previous;
+#else
+        if (__atomic_compare_exchange_n(peak, &seen, value, true, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) break;
+#endif
+    }
+}
+
+/**
+ * Count a new block against one set of counters.
+ * @param counters Counters to charge
+ * @param size Bytes in the block
+ */
+static void mem_counters_add(MemCounters* counters, size_t size) {
+    int64_t live = mem_atomic_add(&counters->live_bytes, (int64_t)size);
+    mem_atomic_raise(&counters->peak_bytes, live);
+    mem_atomic_add(&counters->live_allocations, 1);
+    mem_atomic_add(&counters->total_allocations, 1);
+    mem_atomic_add(&counters->frame_allocations, 1);
+    mem_atomic_add(&counters->frame_bytes, (int64_t)size);
+}
+
+/**
+ * Count a released block against one set of counters.
+ * @param counters Counters to credit
+ * @param size Bytes in the block
+ */
+static void mem_counters_remove(MemCounters* counters, size_t size) {
+    mem_atomic_add(&counters->live_bytes, -(int64_t)size);
+    mem_atomic_add(&counters->live_allocations, -1);
+}
+
+/**
+ * Read one set of counters.
+ * @param counters Counters to read
+ * @param stats Filled with the numbers
+ */
+static void mem_counters_read(MemCounters* counters, MemStats* stats) {
+    stats->live_bytes = mem_atomic_load(&counters->live_bytes);
+    stats->peak_bytes = mem_atomic_load(&counters->peak_bytes);
+    stats->live_allocations = mem_atomic_load(&counters->live_allocations);
+    stats->total_allocations = mem_atomic_load(&counters->total_allocations);
+    stats->frame_allocations = mem_atomic_load(&counters->last_frame_allocations);
+    stats->frame_bytes = mem_atomic_load(&counters->last_frame_bytes);
+}
+
+/**
+ * Turn a raw block into the caller's pointer, recording and charging it.
+ * @param block Raw block from malloc, MEM_OVERHEAD bytes larger than asked
+ * @param tag Subsystem to charge
+ * @param size Bytes the caller asked for
+ * @return Aligned pointer past the header
+ */
+static void* mem_attach(void* block, MemTag tag, size_t size) {
+    if ((unsigned)tag >= MEM_TAG_COUNT) tag = MEM_TAG_ENGINE;
+    
+    uintptr_t start = ((uintptr_t)block + sizeof(MemHeader) + MEM_ALIGNMENT - 1) & ~(uintptr_t)(MEM_ALIGNMENT - 1);
+    MemHeader* header = (MemHeader*)start - 1;
+    header->block = block;
+    header->size = size;
+    header->tag = (int)tag;
+    mem_counters_add(&g_tags[tag], size);
+    mem_counters_add(&g_total, size);
+    return (void*)start;
+}
+
+/**
+ * Find a block's header and credit its bytes back.
+ * @param pointer Pointer from mem_attach()
+ * @return The raw block
+ */
+static void* mem_detach(void* pointer) {
+    MemHeader* header = (MemHeader*)pointer - 1;
+    mem_counters_remove(&g_tags[header->tag], header->size);
+    mem_counters_remove(&g_total, header->size);
+    return header->block;
+}
+
+void* mem_alloc(MemTag tag, size_t size) {
+    MEM_CHECK_FRAME("malloc", size);
+    if (size > SIZE_MAX - MEM_OVERHEAD) return NULL;
+    
+    void* block = malloc(MEM_OVERHEAD + size);
+    return block ? mem_attach(block, tag, size) : NULL;
+}
+
+void* mem_calloc(MemTag tag, size_t count, size_t size) {
+    MEM_CHECK_FRAME("calloc", count * size);
+    if (size != 0 && count > (SIZE_MAX - MEM_OVERHEAD) / size) return NULL;
+    
+    void* block = calloc(1, MEM_OVERHEAD + count * size);
+    return block ? mem_attach(block, tag, count * size) : NULL;
+}
+
+void* mem_realloc(MemTag tag, void* pointer, size_t size) {
+    if (!pointer) return mem_alloc(tag, size);
+    MEM_CHECK_FRAME("realloc", size);
+    if (size > SIZE_MAX - MEM_OVERHEAD) return NULL;
+    
+    // realloc() could move the block to a different alignment, so copy instead
+    void* block = malloc(MEM_OVERHEAD + size);
+    if (!block) return NULL;
+    
+    size_t old_size = ((MemHeader*)pointer - 1)->size;
+    void* resized = mem_attach(block, tag, size);
+    memcpy(resized, pointer, old_size < size ? old_size : size);
+    free(mem_detach(pointer));
+    return resized;
+}
+
+void mem_free(void* pointer) {
+    if (!pointer) return;
+    MEM_CHECK_FRAME("free", (size_t)0);
+    free(mem_detach(pointer));
+}
+
+void mem_frame_begin(void) {
+#ifdef GENGINE_CHECK_FRAME_ALLOCS
+    g_frame_depth++;
+#endif
+}
+
+void mem_frame_end(void) {
+#ifdef GENGINE_CHECK_FRAME_ALLOCS
+    if (g_frame_depth > 0) {
+        g_frame_depth--;
+    }
+#endif
+}
+
+void mem_next_frame(void) {
+    for (int i = 0; i <= MEM_TAG_COUNT; i++) {
+        MemCounters* counters = (i < MEM_TAG_COUNT) ? &g_tags[i] : &g_total;
+        mem_atomic_exchange(&counters->last_frame_allocations, mem_atomic_exchange(&counters->frame_allocations, 0));
+        mem_atomic_exchange(&counters->last_frame_bytes, mem_atomic_exchange(&counters->frame_bytes, 0));
+    }
+}
+
+void mem_track_resource(MemResource resource, int delta) {
+    if ((unsigned)resource >= MEM_RESOURCE_COUNT) return;
+    
+    MemResourceCounters* counters = &g_resources[resource];
+    int64_t live = mem_atomic_add(&counters->live, delta);
+    if (delta > 0) {
+        mem_atomic_raise(&counters->peak, live);
+        mem_atomic_add(&counters->total, delta);
+    }
+}
+
+void mem_get_stats(MemTag tag, MemStats* stats) {
+    if (!stats) return;
+    if ((unsigned)tag >= MEM_TAG_COUNT) {
+        memset(stats, 0, sizeof(MemStats));
+        return;
+    }
+    mem_counters_read(&g_tags[tag], stats);
+}
+
+void mem_get_total_stats(MemStats* stats) {
+    if (!stats) return;
+    mem_counters_read(&g_total, stats);
+}
+
+void mem_get_resource_stats(MemResource resource, MemResourceStats* stats) {
+    if (!stats) return;
+    if ((unsigned)resource >= MEM_RESOURCE_COUNT) {
+        memset(stats, 0, sizeof(MemResourceStats));
+        return;
+    }
+    stats->live = mem_atomic_load(&g_resources[resource].live);
+    stats->peak = mem_atomic_load(&g_resources[resource].peak);
+    stats->total = mem_atomic_load(&g_resources[resource].total);
+}
+
+const char* mem_get_tag_name(MemTag tag) {
+    return ((unsigned)tag < MEM_TAG_COUNT) ? MEM_TAG_NAMES[tag] : "?";
+}
+
+const char* mem_get_resource_name(MemResource resource) {
+    return ((unsigned)resource < MEM_RESOURCE_COUNT) ? MEM_RESOURCE_NAMES[resource] : "?";
+}
+
+void mem_print_report(void) {
+    MemStats stats;
+    printf("Memory:    %12s %12s %12s\n", "live bytes", "peak bytes", "allocations");
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        mem_get_stats((MemTag)i, &stats);
+        if (stats.total_allocations == 0) continue;
+        printf("  %-8s %12lld %12lld %12lld\n", MEM_TAG_NAMES[i], (long long)stats.live_bytes,
+               (long long)stats.peak_bytes, (long long)stats.total_allocations);
+    }
+    mem_get_total_stats(&stats);
+    printf("  %-8s %12lld %12lld %12lld\n", "total", (long long)stats.live_bytes,
+           (long long)stats.peak_bytes, (long long)stats.total_allocations);
+    
+    for (int i = 0; i < MEM_RESOURCE_COUNT; i++) {
+        MemResourceStats resource;
+        mem_get_resource_stats((MemResource)i, &resource);
+        if (resource.total == 0) continue;
+        printf("  %s: %lld loaded, %lld live, %lld at most\n", MEM_RESOURCE_NAMES[i],
+               (long long)resource.total, (long long)resource.live, (long long)resource.peak);
+    }
+}
+
+bool mem_check_leaks(void) {
+    bool clean = true;
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        MemStats stats;
+        mem_get_stats((MemTag)i, &stats);
+        if (stats.live_allocations != 0) {
+            printf("Error: %s leaked %lld bytes in %lld allocations\n", MEM_TAG_NAMES[i],
+                   (long long)stats.live_bytes, (long long)stats.live_allocations);
+            clean = false;
+        }
+    }
+    for (int i = 0; i < MEM_RESOURCE_COUNT; i++) {
+        MemResourceStats resource;
+        mem_get_resource_stats((MemResource)i, &resource);
+        if (resource.live != 0) {
+            printf("Error: %lld %s still loaded\n", (long long)resource.live, MEM_RESOURCE_NAMES[i]);
+            clean = false;
+        }
+    }
+    return clean;
+}
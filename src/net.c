@@ -0,0 +1,219 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "../include/net.h"
+#include "../include/mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <winsock2.h>
+#include <ws2tcpip.h>
+typedef SOCKET NetHandle;
+#define NET_INVALID_HANDLE INVALID_SOCKET
+#else
+#include <arpa/inet.h>
+#include <errno.h>
+#include <fcntl.h>
+#include <netdb.h>
+#include <netinet/in.h>
+#include <sys/socket.h>
+#include <unistd.h>
+typedef int NetHandle;
+#define NET_INVALID_HANDLE (-1)
+#endif
+
+struct NetSocket {
+    NetHandle handle;
+};
+
+#if defined(_WIN32)
+static int net_init_count = 0;  // Nesting depth of net_init()
+#endif
+
+bool net_init(void) {
+#if defined(_WIN32)
+    if (net_init_count++ > 0) return true;
+    WSADATA data;
+    if (WSAStartup(MAKEWORD(2, 2), &data) != 0) {
+        net_init_count = 0;
+        printf("Error: Could not start Winsock\n");
+        return false;
+    }
+#endif
+    return true;
+}
+
+void net_shutdown(void) {
+#if defined(_WIN32)
+    if (net_init_count > 0 && --net_init_count == 0) {
+        WSACleanup();
+    }
+#endif
+}
+
+/**
+ * Convert an address to the socket library's form.
+ * @param address The address
+ * @param out Destination
+ */
+static void net_to_sockaddr(const NetAddress* address, struct sockaddr_in* out) {
+    memset(out, 0, sizeof(*out));
+    out->sin_family = AF_INET;
+    out->sin_addr.s_addr = htonl(address->host);
+    out->sin_port = htons(address->port);
+}
+
+bool net_resolve(const char* host, uint16_t port, NetAddress* address) {
+    if (!host || !address) return false;
+    
+    struct addrinfo hints;
+    memset(&hints, 0, sizeof(hints));
+    hints.ai_family = AF_INET;
+    hints.ai_socktype = SOCK_DGRAM;
+    
+    struct addrinfo* result = NULL;
+    if (getaddrinfo(host, NULL, &hints, &result) != 0 || !result) {
+        printf("Error: Unknown host %s\n", host);
+        return false;
+    }
+    const struct sockaddr_in* found = (const struct sockaddr_in*)result->ai_addr;
+    address->host = ntohl(found->sin_addr.s_addr);
+    address->port = port;
+    freeaddrinfo(result);
+    return true;
+}
+
+bool net_parse_address(const char* text, NetAddress* address) {
+    if (!text || !address) return false;
+    
+    const char* colon = strrchr(text, ':');
+    if (!colon || colon == text || colon - text >= 256) {
+        printf("Error: Expected HOST:PORT, got %s\n", text);
+        return false;
+    }
+    char* end = NULL;
+    long port = strtol(colon + 1, &end, 10);
+    if (*end != '\0' || port <= 0 || port > 65535) {
+        printf("Error: Invalid port in %s\n", text);
+        return false;
+    }
+    
+    char host[256];
+    memcpy(host, text, (size_t)(colon - text));
+    host[colon - text] = '\0';
+    return net_resolve(host, (uint16_t)port, address);
+}
+
+void net_address_to_string(const NetAddress* address, char* buffer, size_t size) {
+    if (!buffer || size == 0) return;
+    if (!address) {
+        buffer[0] = '\0';
+        return;
+    }
+    snprintf(buffer, size, "%u.%u.%u.%u:%u",
+             (unsigned)(address->host >> 24) & 0xFF, (unsigned)(address->host >> 16) & 0xFF,
+             (unsigned)(address->host >> 8) & 0xFF, (unsigned)address->host & 0xFF, (unsigned)address->port);
+}
+
+bool net_address_equal(const NetAddress* a, const NetAddress* b) {
+    return a && b && a->host == b->host && a->port == b->port;
+}
+
+/**
+ * Close a socket handle.
+ * @param handle The handle
+ */
+static void net_close_handle(NetHandle handle) {
+#if defined(_WIN32)
+    closesocket(handle);
+#else
+    close(handle);
+#endif
+}
+
+NetSocket* net_socket_open(uint16_t port) {
+    NetHandle handle = socket(AF_INET, SOCK_DGRAM, IPPROTO_UDP);
+    if (handle == NET_INVALID_HANDLE) {
+        printf("Error: Could not create a UDP socket\n");
+        return NULL;
+    }
+    
+    NetAddress any = {0, port};
+    struct sockaddr_in address;
+    net_to_sockaddr(&any, &address);
+    if (bind(handle, (const struct sockaddr*)&address, sizeof(address)) != 0) {
+        printf("Error: Could not bind UDP port %u\n", (unsigned)port);
+        net_close_handle(handle);
+        return NULL;
+    }
+
+#if defined(_WIN32)
+    u_long non_blocking = 1;
+    bool ok = ioctlsocket(handle, FIONBIO, &non_blocking) == 0;
+#else
+    int flags = fcntl(handle, F_GETFL, 0);
+    bool ok = flags >= 0 && fcntl(handle, F_SETFL, flags | O_NONBLOCK) == 0;
+#endif
+    if (!ok) {
+        printf("Error: Could not make the UDP socket non-blocking\n");
+        net_close_handle(handle);
+        return NULL;
+    }
+    
+    NetSocket* result = (NetSocket*)mem_alloc(MEM_TAG_NET, sizeof(NetSocket));
+    if (!result) {
+        net_close_handle(handle);
+        return NULL;
+    }
+    result->handle = handle;
+    return result;
+}
+
+void net_socket_close(NetSocket* socket) {
+    if (!socket) return;
+    net_close_handle(socket->handle);
+    mem_free(socket);
+}
+
+bool net_socket_send(NetSocket* socket, const NetAddress* address, const void* data, size_t size) {
+    if (!socket || !address || !data || size > NET_MAX_PACKET_SIZE) return false;
+    
+    struct sockaddr_in destination;
+    net_to_sockaddr(address, &destination);
+    int sent = (int)sendto(socket->handle, (const char*)data, (int)size, 0,
+                           (const struct sockaddr*)&destination, sizeof(destination));
+    return sent == (int)size;
+}
+
+int net_socket_receive(NetSocket* socket, NetAddress* address, void* buffer, size_t capacity) {
+    if (!socket || !buffer) return -1;
+    
+    struct sockaddr_in source;
+#if defined(_WIN32)
+    int source_size = sizeof(source);
+#else
+    socklen_t source_size = sizeof(source);
+#endif
+    // Datagrams from unreachable peers surface as errors; skip past them
+    while (true) {
+        int received = (int)recvfrom(socket->handle, (char*)buffer, (int)capacity, 0,
+                                     (struct sockaddr*)&source, &source_size);
+        if (received >= 0) {
+            if (address) {
+                address->host = ntohl(source.sin_addr.s_addr);
+                address->port = ntohs(source.sin_port);
+            }
+            return received;
+        }
+#if defined(_WIN32)
+        int error = WSAGetLastError();
+        if (error != WSAECONNRESET && error != WSAEMSGSIZE) return -1;
+#else
+        if (errno != ECONNREFUSED && errno != EINTR) return -1;
+#endif
+    }
+}
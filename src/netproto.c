@@ -0,0 +1,741 @@
+#include "../include/netproto.h"
+#include "../include/mem.h"
+#include <math.h>
+#include <string.h>
+
+// Packets are bit streams, least significant bit first:
+//   magic (16 bits), packet type (4 bits), then
+//   input:    sequence (32), ack tick + 1 (32, 0 = none), held and pressed
+//             buttons, mouse x and y, character count and characters
+//   snapshot: tick (32), age of the baseline in ticks (7, 0 = none),
+//             fragment index and count - 1 (10 each), then from the next
+//             whole byte up to NETPROTO_FRAGMENT_SIZE bytes of the snapshot
+// A snapshot holds every NetWorldState field in declaration order, arrays
+// only up to their count. Each field starts with a bit telling whether it
+// differs from the baseline. A changed field narrower than a medium delta
+// is sent whole; wider ones are sent as a zigzag delta of
+// NETPROTO_SMALL_DELTA_BITS (prefix 0) or NETPROTO_MEDIUM_DELTA_BITS
+// (prefix 10), or whole (prefix 11). The coin, obstacle and projectile
+// counts are 32-bit fields, so an unchanged count costs one bit. Array
+// entries past the baseline's count are compared against zero.
+#define NETPROTO_MAGIC 0x4E47u
+#define NETPROTO_MAGIC_BITS 16
+#define NETPROTO_TYPE_BITS 4
+#define NETPROTO_TICK_BITS 32
+#define NETPROTO_AGE_BITS 7
+#define NETPROTO_FRAGMENT_BITS 10
+#define NETPROTO_SMALL_DELTA_BITS 6
+#define NETPROTO_MEDIUM_DELTA_BITS 11
+#define NETPROTO_COUNT_BITS 32
+#define NETPROTO_FIELD_MAX_BITS(bits) ((bits) + 3)  // Changed bit, delta prefix and the whole value
+#define NETPROTO_SCALAR_FIELDS 16                   // Snapshot fields outside the arrays
+#define NETPROTO_MIN_STORAGE 64                     // Entries in a world's first array allocation
+
+#define NETPROTO_POSITION_SCALE 8.0f  // Steps per world unit
+#define NETPROTO_POSITION_BITS 14     // Up to 2048 world units
+#define NETPROTO_ANGLE_BITS 12
+#define NETPROTO_HEALTH_BITS 7
+#define NETPROTO_TIMER_SCALE 64.0f    // Steps per second
+#define NETPROTO_TIMER_BITS 7         // Up to 2 seconds
+#define NETPROTO_MOUSE_SCALE 4.0f     // Steps per pixel
+#define NETPROTO_MOUSE_BITS 16        // Up to 16384 pixels
+#define NETPROTO_BUTTON_BITS 13       // Every InputButton bit
+#define NETPROTO_CHAR_COUNT_BITS 6
+#define NETPROTO_CHAR_BITS 21         // Any Unicode code point
+
+// Reads and writes share one code path so the two can never disagree
+typedef struct {
+    uint8_t* data;  // Packet being written, or read (never modified then)
+    size_t size;    // Capacity when writing, packet size when reading
+    size_t bit;     // Bits written or read so far
+    bool writing;
+    bool failed;    // Ran past the end, or read an impossible value
+} NetBitStream;
+
+/**
+ * Start a bit stream over a buffer.
+ * @param stream Stream to set up
+ * @param data Buffer
+ * @param size Capacity when writing, packet size when reading
+ * @param writing true to write, false to read
+ */
+static void netproto_stream_init(NetBitStream* stream, const uint8_t* data, size_t size, bool writing) {
+    stream->data = (uint8_t*)data;
+    stream->size = size;
+    stream->bit = 0;
+    stream->writing = writing;
+    stream->failed = false;
+}
+
+/**
+ * Write or read an unsigned value of a fixed number of bits. Reading past
+ * the end yields 0 and marks the stream as failed.
+ * @param stream The stream
+ * @param value Value to write, or set to the value read
+ * @param bits Width, 1 to 32
+ */
+static void netproto_serialize_bits(NetBitStream* stream, uint32_t* value, int bits) {
+    if (stream->failed || stream->bit + (size_t)bits > stream->size * 8) {
+        stream->failed = true;
+        if (!stream->writing) *value = 0;
+        return;
+    }
+    
+    uint32_t result = 0;
+    for (int i = 0; i < bits; i++) {
+        size_t byte = stream->bit >> 3;
+        int shift = (int)(stream->bit & 7);
+        if (stream->writing) {
+            if (shift == 0) stream->data[byte] = 0;
+            stream->data[byte] |= (uint8_t)(((*value >> i) & 1u) << shift);
+        } else {
+            result |= (uint32_t)((stream->data[byte] >> shift) & 1u) << i;
+        }
+        stream->bit++;
+    }
+    if (!stream->writing) *value = result;
+}
+
+/**
+ * Write or read a snapshot field relative to its baseline value.
+ * @param stream The stream
+ * @param baseline Baseline value
+ * @param value Value to write, or set to the value read
+ * @param bits Full width of the field
+ */
+static void netproto_serialize_field(NetBitStream* stream, uint32_t baseline, uint32_t* value, int bits) {
+    uint32_t changed = stream->writing ? (*value != baseline) : 0;
+    netproto_serialize_bits(stream, &changed, 1);
+    if (!changed) {
+        if (!stream->writing) *value = baseline;
+        return;
+    }
+    if (bits <= NETPROTO_MEDIUM_DELTA_BITS) {
+        netproto_serialize_bits(stream, value, bits);
+        return;
+    }
+    
+    uint32_t zigzag = 0;
+    uint32_t wide = 0;
+    uint32_t full = 0;
+    if (stream->writing) {
+        // A 32-bit delta's zigzag takes 33 bits, so pick the form before narrowing
+        int64_t delta = (int64_t)*value - (int64_t)baseline;
+        uint64_t wide_zigzag = delta >= 0 ? (uint64_t)delta * 2 : (uint64_t)(-delta) * 2 - 1;
+        wide = wide_zigzag >= (1u << NETPROTO_SMALL_DELTA_BITS);
+        full = wide_zigzag >= (1u << NETPROTO_MEDIUM_DELTA_BITS);
+        zigzag = (uint32_t)wide_zigzag;
+    }
+    netproto_serialize_bits(stream, &wide, 1);
+    if (wide) {
+        netproto_serialize_bits(stream, &full, 1);
+    }
+    if (full) {
+        netproto_serialize_bits(stream, value, bits);
+        return;
+    }
+    
+    netproto_serialize_bits(stream, &zigzag, wide ? NETPROTO_MEDIUM_DELTA_BITS : NETPROTO_SMALL_DELTA_BITS);
+    if (!stream->writing) {
+        int64_t delta = (zigzag & 1u) ? -(int64_t)((zigzag + 1) / 2) : (int64_t)(zigzag / 2);
+        uint32_t mask = (bits >= 32) ? 0xFFFFFFFFu : ((1u << bits) - 1u);
+        *value = (uint32_t)((int64_t)baseline + delta) & mask;
+    }
+}
+
+/**
+ * Write or read an array count relative to its baseline, failing the
+ * stream if a read count exceeds the array.
+ * @param stream The stream
+ * @param baseline Baseline count
+ * @param count Count to write, or set to the count read
+ * @param bits Full width of the field
+ * @param max_count Array capacity
+ */
+static void netproto_serialize_count(NetBitStream* stream, uint32_t baseline, uint32_t* count, int bits, uint32_t max_count) {
+    netproto_serialize_field(stream, baseline, count, bits);
+    if (*count > max_count) {
+        stream->failed = true;
+        *count = 0;
+    }
+}
+
+/**
+ * Get an array entry of a baseline world, which is zero past the count.
+ * @param array The array
+ * @param count Entries in the array
+ * @param index Entry to get
+ * @return The entry, or 0
+ */
+static uint32_t netproto_entry(const uint32_t* array, uint32_t count, uint32_t index) {
+    return index < count ? array[index] : 0;
+}
+
+/**
+ * Get the number of words holding a bit per coin.
+ * @param coin_count Coins
+ * @return Words
+ */
+static uint32_t netproto_coin_words(uint32_t coin_count) {
+    return (uint32_t)(((uint64_t)coin_count + 31) / 32);
+}
+
+/**
+ * Make room in a world for arrays of the given sizes and point the arrays
+ * into it. What the arrays held before is lost.
+ * @param world The world
+ * @param coin_count Coins
+ * @param obstacle_count Obstacles
+ * @param projectile_count Projectiles
+ * @return true on success, false if the storage could not grow
+ */
+static bool netproto_world_grow(NetWorldState* world, uint32_t coin_count, uint32_t obstacle_count,
+                               uint32_t projectile_count) {
+    size_t coin_words = netproto_coin_words(coin_count);
+    size_t needed = coin_words + 2 * ((size_t)obstacle_count + projectile_count);
+    if (needed > world->storage_capacity) {
+        size_t capacity = world->storage_capacity > 0 ? world->storage_capacity : NETPROTO_MIN_STORAGE;
+        while (capacity < needed) {
+            capacity *= 2;
+        }
+        uint32_t* storage = (uint32_t*)mem_realloc(MEM_TAG_NET, world->storage, sizeof(uint32_t) * capacity);
+        if (!storage) return false;
+        world->storage = storage;
+        world->storage_capacity = capacity;
+    }
+    
+    world->coin_collected = world->storage;
+    world->obstacle_x = world->storage + coin_words;
+    world->obstacle_y = world->obstacle_x + obstacle_count;
+    world->projectile_x = world->obstacle_y + obstacle_count;
+    world->projectile_y = world->projectile_x + projectile_count;
+    return true;
+}
+
+/**
+ * Empty a world but keep its storage.
+ * @param world The world
+ * @param tick Tick to stamp it with
+ */
+static void netproto_world_clear(NetWorldState* world, int tick) {
+    uint32_t* storage = world->storage;
+    size_t capacity = world->storage_capacity;
+    memset(world, 0, sizeof(NetWorldState));
+    world->tick = tick;
+    world->storage = storage;
+    world->storage_capacity = capacity;
+}
+
+/**
+ * Write or read every world field against a baseline.
+ * @param stream The stream
+ * @param baseline Baseline world
+ * @param world World to write, or to fill; when reading, its arrays grow to the counts read
+ */
+static void netproto_serialize_world(NetBitStream* stream, const NetWorldState* baseline, NetWorldState* world) {
+    netproto_serialize_field(stream, baseline->type, &world->type, 3);
+    if (world->type > GAME_STATE_MODE_SELECT) stream->failed = true;
+    netproto_serialize_field(stream, baseline->mode, &world->mode, 1);
+    netproto_serialize_field(stream, baseline->selected_mode, &world->selected_mode, 1);
+    netproto_serialize_field(stream, baseline->map_id, &world->map_id, 2);
+    netproto_serialize_field(stream, baseline->frame_count, &world->frame_count, 32);
+    netproto_serialize_field(stream, baseline->game_start_frame, &world->game_start_frame, 32);
+    netproto_serialize_field(stream, baseline->coins_collected, &world->coins_collected, 8);
+    
+    netproto_serialize_field(stream, baseline->player_x, &world->player_x, NETPROTO_POSITION_BITS);
+    netproto_serialize_field(stream, baseline->player_y, &world->player_y, NETPROTO_POSITION_BITS);
+    netproto_serialize_field(stream, baseline->player_angle, &world->player_angle, NETPROTO_ANGLE_BITS);
+    netproto_serialize_field(stream, baseline->player_health, &world->player_health, NETPROTO_HEALTH_BITS);
+    netproto_serialize_field(stream, baseline->player_invincibility, &world->player_invincibility, NETPROTO_TIMER_BITS);
+    
+    netproto_serialize_field(stream, baseline->coin_count, &world->coin_count, NETPROTO_COUNT_BITS);
+    netproto_serialize_field(stream, baseline->obstacle_count, &world->obstacle_count, NETPROTO_COUNT_BITS);
+    netproto_serialize_field(stream, baseline->projectile_count, &world->projectile_count, NETPROTO_COUNT_BITS);
+    uint32_t coin_words = netproto_coin_words(world->coin_count);
+    if (!stream->writing) {
+        // Every entry takes at least a bit, so counts the rest of the
+        // stream can't hold are malformed, not a reason to allocate; nor
+        // are more projectiles than the client's pool holds
+        size_t bits_left = stream->size * 8 - stream->bit;
+        size_t entries = (size_t)coin_words + 2 * ((size_t)world->obstacle_count + world->projectile_count);
+        if (stream->failed || entries > bits_left || world->projectile_count > MAX_PROJECTILES ||
+            !netproto_world_grow(world, world->coin_count, world->obstacle_count, world->projectile_count)) {
+            stream->failed = true;
+            world->coin_count = 0;
+            world->obstacle_count = 0;
+            world->projectile_count = 0;
+            return;
+        }
+    }
+    
+    uint32_t baseline_words = netproto_coin_words(baseline->coin_count);
+    for (uint32_t i = 0; i < coin_words; i++) {
+        uint32_t coins_left = world->coin_count - i * 32;
+        netproto_serialize_field(stream, netproto_entry(baseline->coin_collected, baseline_words, i),
+                                 &world->coin_collected[i], coins_left < 32 ? (int)coins_left : 32);
+    }
+    for (uint32_t i = 0; i < world->obstacle_count; i++) {
+        netproto_serialize_field(stream, netproto_entry(baseline->obstacle_x, baseline->obstacle_count, i),
+                                 &world->obstacle_x[i], NETPROTO_POSITION_BITS);
+        netproto_serialize_field(stream, netproto_entry(baseline->obstacle_y, baseline->obstacle_count, i),
+                                 &world->obstacle_y[i], NETPROTO_POSITION_BITS);
+    }
+    
+    for (uint32_t i = 0; i < world->projectile_count; i++) {
+        netproto_serialize_field(stream, netproto_entry(baseline->projectile_x, baseline->projectile_count, i),
+                                 &world->projectile_x[i], NETPROTO_POSITION_BITS);
+        netproto_serialize_field(stream, netproto_entry(baseline->projectile_y, baseline->projectile_count, i),
+                                 &world->projectile_y[i], NETPROTO_POSITION_BITS);
+    }
+    
+    netproto_serialize_count(stream, baseline->name_length, &world->name_length, 5, MAX_NAME_LENGTH);
+    for (uint32_t i = 0; i < world->name_length; i++) {
+        netproto_serialize_field(stream, baseline->name[i], &world->name[i], 8);
+    }
+}
+
+/**
+ * Quantize a world coordinate.
+ * @param value Coordinate in world units
+ * @return Steps of 1/NETPROTO_POSITION_SCALE, clamped to the field width
+ */
+static uint32_t netproto_quantize_position(float value) {
+    float steps = roundf(value * NETPROTO_POSITION_SCALE);
+    float max_steps = (float)((1u << NETPROTO_POSITION_BITS) - 1u);
+    if (!(steps > 0.0f)) return 0;
+    if (steps > max_steps) return (uint32_t)max_steps;
+    return (uint32_t)steps;
+}
+
+/**
+ * Turn a quantized coordinate back into world units.
+ * @param steps Quantized coordinate
+ * @return Coordinate in world units
+ */
+static float netproto_dequantize_position(uint32_t steps) {
+    return (float)steps / NETPROTO_POSITION_SCALE;
+}
+
+/**
+ * Clamp a non-negative quantity into a field.
+ * @param value Value
+ * @param bits Field width
+ * @return Rounded and clamped value
+ */
+static uint32_t netproto_clamp(float value, int bits) {
+    float max_value = (float)((1u << bits) - 1u);
+    float rounded = roundf(value);
+    if (!(rounded > 0.0f)) return 0;
+    return rounded > max_value ? (uint32_t)max_value : (uint32_t)rounded;
+}
+
+void netproto_world_init(NetWorldState* world) {
+    if (!world) return;
+    memset(world, 0, sizeof(NetWorldState));
+    world->tick = NETPROTO_NO_TICK;
+}
+
+void netproto_world_release(NetWorldState* world) {
+    if (!world) return;
+    mem_free(world->storage);
+    netproto_world_init(world);
+}
+
+/**
+ * Get the most coins and obstacles any of a state's maps holds.
+ * @param state Game state
+ * @param coin_count Set to the most coins
+ * @param obstacle_count Set to the most obstacles
+ */
+static void netproto_largest_map(GameState* state, uint32_t* coin_count, uint32_t* obstacle_count) {
+    Map* maps = state_get_maps(state);
+    *coin_count = 0;
+    *obstacle_count = 0;
+    for (int i = 0; i < NUM_MAPS; i++) {
+        if ((uint32_t)maps[i].coin_count > *coin_count) *coin_count = (uint32_t)maps[i].coin_count;
+        if ((uint32_t)maps[i].obstacles.count > *obstacle_count) *obstacle_count = (uint32_t)maps[i].obstacles.count;
+    }
+}
+
+bool netproto_world_reserve(NetWorldState* world, GameState* state) {
+    if (!world || !state) return false;
+    
+    uint32_t coin_count = 0;
+    uint32_t obstacle_count = 0;
+    netproto_largest_map(state, &coin_count, &obstacle_count);
+    bool grown = netproto_world_grow(world, coin_count, obstacle_count, MAX_PROJECTILES);
+    netproto_world_clear(world, NETPROTO_NO_TICK);
+    return grown;
+}
+
+bool netproto_capture(GameState* state, int tick, NetWorldState* world) {
+    if (!world) return false;
+    netproto_world_clear(world, tick);
+    if (!state) return true;
+    
+    world->type = (uint32_t)state_get_type(state) & 7u;
+    world->mode = (uint32_t)state_get_game_mode(state) & 1u;
+    world->map_id = (uint32_t)state_get_current_map_id(state) & 3u;
+    world->frame_count = (uint32_t)state_get_frame_count(state);
+    world->game_start_frame = (uint32_t)state_get_game_start_frame(state);
+    world->coins_collected = netproto_clamp((float)state_get_coins_collected(state), 8);
+    
+    Player* player = state_get_player(state);
+    Vector2 position = player_get_position(player);
+    float turns = player_get_angle(player) / (2.0f * PI);
+    turns -= floorf(turns);
+    world->player_x = netproto_quantize_position(position.x);
+    world->player_y = netproto_quantize_position(position.y);
+    world->player_angle = (uint32_t)lroundf(turns * (float)(1u << NETPROTO_ANGLE_BITS)) & ((1u << NETPROTO_ANGLE_BITS) - 1u);
+    world->player_health = netproto_clamp(player_get_health(player), NETPROTO_HEALTH_BITS);
+    world->player_invincibility = netproto_clamp(player_get_invincibility_timer(player) * NETPROTO_TIMER_SCALE, NETPROTO_TIMER_BITS);
+    
+    Map* map = state_get_current_map(state);
+    int coin_count = 0;
+    const Coin* coins = map_get_coins(map, &coin_count);
+    const ObstacleSet* obstacles = map_get_obstacles(map);
+    const ProjectilePool* projectiles = state_get_projectiles(state);
+    if (!netproto_world_grow(world, (uint32_t)coin_count, (uint32_t)obstacles->count, (uint32_t)projectiles->count)) {
+        netproto_world_clear(world, NETPROTO_NO_TICK);
+        return false;
+    }
+    
+    world->coin_count = (uint32_t)coin_count;
+    memset(world->coin_collected, 0, sizeof(uint32_t) * netproto_coin_words(world->coin_count));
+    for (uint32_t i = 0; i < world->coin_count; i++) {
+        if (coins[i].collected) world->coin_collected[i / 32] |= 1u << (i % 32);
+    }
+    
+    world->obstacle_count = (uint32_t)obstacles->count;
+    for (uint32_t i = 0; i < world->obstacle_count; i++) {
+        world->obstacle_x[i] = netproto_quantize_position(obstacles->x[i]);
+        world->obstacle_y[i] = netproto_quantize_position(obstacles->y[i]);
+    }
+    
+    world->projectile_count = (uint32_t)projectiles->count;
+    for (uint32_t i = 0; i < world->projectile_count; i++) {
+        world->projectile_x[i] = netproto_quantize_position(projectiles->x[i]);
+        world->projectile_y[i] = netproto_quantize_position(projectiles->y[i]);
+    }
+    
+    int name_length = state_get_name_char_count(state);
+    const char* name = state_get_player_name(state);
+    world->name_length = (uint32_t)(name_length < 0 ? 0 : name_length < MAX_NAME_LENGTH ? name_length : MAX_NAME_LENGTH);
+    for (uint32_t i = 0; i < world->name_length; i++) {
+        world->name[i] = (uint8_t)name[i];
+    }
+    return true;
+}
+
+/**
+ * Move, add or drop the state's projectiles to match a received world.
+ * @param world Received world
+ * @param state Game state to overwrite
+ * @return true on success, false if the world holds too many projectiles
+ */
+static bool netproto_apply_projectiles(const NetWorldState* world, GameState* state) {
+    ProjectilePool* projectiles = state_get_projectiles(state);
+    int count = projectiles->count;
+    while (projectiles->count > (int)world->projectile_count) {
+        projectile_pool_remove_at(projectiles, projectiles->count - 1);
+    }
+    
+    for (uint32_t i = 0; i < world->projectile_count; i++) {
+        Vector2 position = {netproto_dequantize_position(world->projectile_x[i]),
+                            netproto_dequantize_position(world->projectile_y[i])};
+        if ((int)i >= count) {
+            ProjectileHandle added = projectile_pool_spawn(projectiles, position, (Vector2){1.0f, 0.0f});
+            if (added.value == PROJECTILE_HANDLE_NONE.value) return false;
+        }
+        
+        projectiles->previous_x[i] = ((int)i < count) ? projectiles->x[i] : position.x;
+        projectiles->previous_y[i] = ((int)i < count) ? projectiles->y[i] : position.y;
+        projectiles->x[i] = position.x;
+        projectiles->y[i] = position.y;
+        projectiles->velocity_x[i] = position.x - projectiles->previous_x[i];
+        projectiles->velocity_y[i] = position.y - projectiles->previous_y[i];
+    }
+    return true;
+}
+
+bool netproto_apply(const NetWorldState* world, GameState* state) {
+    if (!world || !state) return false;
+    
+    bool map_changed = state_get_current_map_id(state) != (int)world->map_id;
+    state_set_type(state, (GameStateType)world->type);
+    state_set_game_mode(state, (GameMode)world->mode);
+    state_set_current_map_id(state, (int)world->map_id);
+    state_set_frame_count(state, (int)world->frame_count);
+    state_set_game_start_frame(state, (int)world->game_start_frame);
+    state_set_coins_collected(state, (int)world->coins_collected);
+    
+    // Interpolate from the last snapshot, except across a map change
+    Player* player = state_get_player(state);
+    PlayerSnapshot snapshot;
+    player_snapshot(player, &snapshot);
+    Vector2 position = {netproto_dequantize_position(world->player_x), netproto_dequantize_position(world->player_y)};
+    snapshot.previous_position = map_changed ? position : snapshot.position;
+    snapshot.position = position;
+    snapshot.angle = (float)world->player_angle * (2.0f * PI / (float)(1u << NETPROTO_ANGLE_BITS));
+    snapshot.health = (float)world->player_health;
+    snapshot.invincibility_timer = (float)world->player_invincibility / NETPROTO_TIMER_SCALE;
+    player_restore(player, &snapshot);
+    
+    Map* map = state_get_current_map(state);
+    for (uint32_t i = 0; i < world->coin_count && (int)i < map->coin_count; i++) {
+        map_get_coin_mutable(map, (int)i)->collected = (world->coin_collected[i / 32] >> (i % 32)) & 1u;
+    }
+    
+    map_sync_previous_positions(map);
+    if (map->obstacles.count > (int)world->obstacle_count) {
+        map->obstacles.count = (int)world->obstacle_count;
+    }
+    for (uint32_t i = 0; i < world->obstacle_count; i++) {
+        Vector2 obstacle_position = {netproto_dequantize_position(world->obstacle_x[i]),
+                                     netproto_dequantize_position(world->obstacle_y[i])};
+        if ((int)i >= map->obstacles.count) {
+            map_add_obstacle(map, obstacle_position, (Vector2){0.0f, 0.0f}, RED);
+        }
+        map_set_obstacle_position(map, (int)i, obstacle_position, map_changed);
+    }
+    
+    char* name = state_get_player_name(state);
+    for (uint32_t i = 0; i < world->name_length; i++) {
+        name[i] = (char)world->name[i];
+    }
+    name[world->name_length] = '\0';
+    state_set_name_char_count(state, (int)world->name_length);
+    
+    return netproto_apply_projectiles(world, state);
+}
+
+void netproto_hold(GameState* state) {
+    if (!state) return;
+    
+    player_sync_previous_position(state_get_player(state));
+    map_sync_previous_positions(state_get_current_map(state));
+    
+    ProjectilePool* projectiles = state_get_projectiles(state);
+    for (int i = 0; i < projectiles->count; i++) {
+        projectiles->previous_x[i] = projectiles->x[i];
+        projectiles->previous_y[i] = projectiles->y[i];
+    }
+}
+
+/**
+ * Write or read the magic and packet type.
+ * @param stream The stream
+ * @param type Packet type to write, or set to the type read
+ * @return true if the magic matches
+ */
+static bool netproto_serialize_header(NetBitStream* stream, uint32_t* type) {
+    uint32_t magic = NETPROTO_MAGIC;
+    netproto_serialize_bits(stream, &magic, NETPROTO_MAGIC_BITS);
+    netproto_serialize_bits(stream, type, NETPROTO_TYPE_BITS);
+    return !stream->failed && magic == NETPROTO_MAGIC;
+}
+
+/**
+ * Get the most bytes a snapshot of a world with the given counts can take,
+ * whatever the baseline.
+ * @param coin_count Coins
+ * @param obstacle_count Obstacles
+ * @param projectile_count Projectiles
+ * @return Bytes
+ */
+static size_t netproto_max_size(uint32_t coin_count, uint32_t obstacle_count, uint32_t projectile_count) {
+    size_t bits = NETPROTO_SCALAR_FIELDS * NETPROTO_FIELD_MAX_BITS(32) +
+                  (size_t)netproto_coin_words(coin_count) * NETPROTO_FIELD_MAX_BITS(32) +
+                  2 * ((size_t)obstacle_count + projectile_count) * NETPROTO_FIELD_MAX_BITS(NETPROTO_POSITION_BITS) +
+                  MAX_NAME_LENGTH * NETPROTO_FIELD_MAX_BITS(8);
+    return (bits + 7) / 8;
+}
+
+size_t netproto_snapshot_max_size(const NetWorldState* world) {
+    if (!world) return 0;
+    return netproto_max_size(world->coin_count, world->obstacle_count, world->projectile_count);
+}
+
+size_t netproto_state_max_size(GameState* state) {
+    if (!state) return 0;
+    
+    uint32_t coin_count = 0;
+    uint32_t obstacle_count = 0;
+    netproto_largest_map(state, &coin_count, &obstacle_count);
+    return netproto_max_size(coin_count, obstacle_count, MAX_PROJECTILES);
+}
+
+size_t netproto_write_snapshot(const NetWorldState* world, const NetWorldState* baseline, uint8_t* buffer, size_t capacity) {
+    static const NetWorldState empty = {0};
+    if (!world || !buffer) return 0;
+    
+    uint32_t age = baseline ? (uint32_t)(world->tick - baseline->tick) : 0;
+    if (baseline && (age == 0 || age >= (1u << NETPROTO_AGE_BITS))) return 0;
+    
+    // Writing only reads the arrays, so a shallow copy is enough
+    NetBitStream stream;
+    netproto_stream_init(&stream, buffer, capacity, true);
+    NetWorldState copy = *world;
+    netproto_serialize_world(&stream, baseline ? baseline : &empty, &copy);
+    return stream.failed ? 0 : (stream.bit + 7) / 8;
+}
+
+int netproto_fragment_count(size_t size) {
+    size_t count = (size + NETPROTO_FRAGMENT_SIZE - 1) / NETPROTO_FRAGMENT_SIZE;
+    return (count > 0 && count <= NETPROTO_MAX_FRAGMENTS) ? (int)count : 0;
+}
+
+/**
+ * Write or read a fragment packet's header.
+ * @param stream The stream
+ * @param tick Snapshot tick to write, or set to the tick read
+ * @param age Baseline age to write, or set to the age read
+ * @param index Fragment index to write, or set to the index read
+ * @param count Fragment count to write, or set to the count read
+ * @return true if the header is a snapshot fragment's
+ */
+static bool netproto_serialize_fragment_header(NetBitStream* stream, uint32_t* tick, uint32_t* age,
+                                               uint32_t* index, uint32_t* count) {
+    uint32_t type = NETPROTO_PACKET_SNAPSHOT;
+    uint32_t last = stream->writing ? *count - 1 : 0;
+    if (!netproto_serialize_header(stream, &type) || type != NETPROTO_PACKET_SNAPSHOT) return false;
+    netproto_serialize_bits(stream, tick, NETPROTO_TICK_BITS);
+    netproto_serialize_bits(stream, age, NETPROTO_AGE_BITS);
+    netproto_serialize_bits(stream, index, NETPROTO_FRAGMENT_BITS);
+    netproto_serialize_bits(stream, &last, NETPROTO_FRAGMENT_BITS);
+    *count = last + 1;
+    return !stream->failed;
+}
+
+size_t netproto_write_fragment(const NetSnapshotFragment* fragment, uint8_t* buffer, size_t capacity) {
+    if (!fragment || !buffer || (!fragment->data && fragment->size > 0)) return 0;
+    if (fragment->count < 1 || fragment->count > NETPROTO_MAX_FRAGMENTS || fragment->index < 0 ||
+        fragment->index >= fragment->count || fragment->size > NETPROTO_FRAGMENT_SIZE) {
+        return 0;
+    }
+    
+    uint32_t tick = (uint32_t)fragment->tick;
+    uint32_t age = fragment->baseline_tick != NETPROTO_NO_TICK ? (uint32_t)(fragment->tick - fragment->baseline_tick) : 0;
+    uint32_t index = (uint32_t)fragment->index;
+    uint32_t count = (uint32_t)fragment->count;
+    if (fragment->baseline_tick != NETPROTO_NO_TICK && (age == 0 || age >= (1u << NETPROTO_AGE_BITS))) return 0;
+    
+    NetBitStream stream;
+    netproto_stream_init(&stream, buffer, capacity, true);
+    if (!netproto_serialize_fragment_header(&stream, &tick, &age, &index, &count)) return 0;
+    size_t header = (stream.bit + 7) / 8;
+    if (header + fragment->size > capacity) return 0;
+    
+    if (fragment->size > 0) {
+        memcpy(buffer + header, fragment->data, fragment->size);
+    }
+    return header + fragment->size;
+}
+
+bool netproto_read_fragment(const uint8_t* data, size_t size, NetSnapshotFragment* fragment) {
+    if (!data || !fragment) return false;
+    
+    NetBitStream stream;
+    netproto_stream_init(&stream, data, size, false);
+    uint32_t tick = 0;
+    uint32_t age = 0;
+    uint32_t index = 0;
+    uint32_t count = 0;
+    if (!netproto_serialize_fragment_header(&stream, &tick, &age, &index, &count)) return false;
+    if ((int)tick < 0 || age > tick || index >= count) return false;
+    
+    // Only the last fragment may be short
+    size_t header = (stream.bit + 7) / 8;
+    if (header >= size) return false;
+    size_t payload = size - header;
+    if (payload > NETPROTO_FRAGMENT_SIZE ||
+        (index + 1 < count && payload != NETPROTO_FRAGMENT_SIZE)) {
+        return false;
+    }
+    
+    fragment->tick = (int)tick;
+    fragment->baseline_tick = age > 0 ? (int)(tick - age) : NETPROTO_NO_TICK;
+    fragment->index = (int)index;
+    fragment->count = (int)count;
+    fragment->data = data + header;
+    fragment->size = payload;
+    return true;
+}
+
+bool netproto_read_snapshot(const uint8_t* data, size_t size, int tick, const NetWorldState* baseline, NetWorldState* world) {
+    static const NetWorldState empty = {0};
+    if (!data || !world || world == baseline) return false;
+    
+    NetBitStream stream;
+    netproto_stream_init(&stream, data, size, false);
+    netproto_world_clear(world, tick);
+    netproto_serialize_world(&stream, baseline ? baseline : &empty, world);
+    return !stream.failed;
+}
+
+/**
+ * Write or read an input packet's body.
+ * @param stream The stream
+ * @param packet Packet to write, or to fill
+ */
+static void netproto_serialize_input(NetBitStream* stream, NetInputPacket* packet) {
+    uint32_t ack = stream->writing ? (uint32_t)(packet->ack_tick + 1) : 0;
+    netproto_serialize_bits(stream, &packet->sequence, 32);
+    netproto_serialize_bits(stream, &ack, 32);
+    packet->ack_tick = (int)ack - 1;
+    
+    InputFrame* input = &packet->input;
+    uint32_t mouse_x = 0;
+    uint32_t mouse_y = 0;
+    uint32_t char_count = 0;
+    if (stream->writing) {
+        mouse_x = netproto_clamp(input->mouse_position.x * NETPROTO_MOUSE_SCALE, NETPROTO_MOUSE_BITS);
+        mouse_y = netproto_clamp(input->mouse_position.y * NETPROTO_MOUSE_SCALE, NETPROTO_MOUSE_BITS);
+        char_count = (uint32_t)(input->char_count < INPUT_MAX_CHARS ? input->char_count : INPUT_MAX_CHARS);
+    }
+    netproto_serialize_bits(stream, &input->held, NETPROTO_BUTTON_BITS);
+    netproto_serialize_bits(stream, &input->pressed, NETPROTO_BUTTON_BITS);
+    netproto_serialize_bits(stream, &mouse_x, NETPROTO_MOUSE_BITS);
+    netproto_serialize_bits(stream, &mouse_y, NETPROTO_MOUSE_BITS);
+    netproto_serialize_bits(stream, &char_count, NETPROTO_CHAR_COUNT_BITS);
+    if (char_count > INPUT_MAX_CHARS) {
+        stream->failed = true;
+        return;
+    }
+    for (uint32_t i = 0; i < char_count; i++) {
+        uint32_t code = (uint32_t)input->chars[i];
+        netproto_serialize_bits(stream, &code, NETPROTO_CHAR_BITS);
+        input->chars[i] = (int)code;
+    }
+    
+    if (!stream->writing) {
+        input->mouse_position = (Vector2){(float)mouse_x / NETPROTO_MOUSE_SCALE, (float)mouse_y / NETPROTO_MOUSE_SCALE};
+        input->char_count = (int)char_count;
+    }
+}
+
+size_t netproto_write_input(const NetInputPacket* packet, uint8_t* buffer, size_t capacity) {
+    if (!packet || !buffer) return 0;
+    
+    NetBitStream stream;
+    netproto_stream_init(&stream, buffer, capacity, true);
+    uint32_t type = NETPROTO_PACKET_INPUT;
+    netproto_serialize_header(&stream, &type);
+    
+    NetInputPacket copy = *packet;
+    netproto_serialize_input(&stream, &copy);
+    return stream.failed ? 0 : (stream.bit + 7) / 8;
+}
+
+bool netproto_read_input(const uint8_t* data, size_t size, NetInputPacket* packet) {
+    if (!data || !packet) return false;
+    
+    NetBitStream stream;
+    netproto_stream_init(&stream, data, size, false);
+    uint32_t type = 0;
+    if (!netproto_serialize_header(&stream, &type) || type != NETPROTO_PACKET_INPUT) return false;
+    
+    memset(packet, 0, sizeof(NetInputPacket));
+    netproto_serialize_input(&stream, packet);
+    return !stream.failed;
+}
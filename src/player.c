@@ -1,40 +1,41 @@
 #include "../include/player.h"
 #include "../include/map.h"
+#include "../include/mem.h"
 #include "raylib.h"
 #include <math.h>
 #include <stdlib.h>
 #include <string.h>
 
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
 
 struct Player {
     Vector2 position;
-    float speed;
+    Vector2 previous_position;  // Position at the start of the current tick
+    float speed;                // World units per second
     float health;
     float max_health;
-    int invincibility_timer;
+    float invincibility_timer;  // Seconds left
     float angle;  // Viewing angle in radians (0 = right, PI/2 = down)
 };
 
 Player* player_create(void) {
-    Player* player = (Player*)malloc(sizeof(Player));
+    Player* player = (Player*)mem_alloc(MEM_TAG_GAME, sizeof(Player));
     if (!player) return NULL;
     memset(player, 0, sizeof(Player));
     return player;
 }
 
 void player_destroy(Player* player) {
-    if (player) free(player);
+    if (player) mem_free(player);
 }
 
 void player_init(Player* player, Vector2 start_position) {
     if (!player) return;
     player->position = start_position;
+    player->previous_position = start_position;
     player->speed = PLAYER_SPEED;
     player->health = MAX_HEALTH;
     player->max_health = MAX_HEALTH;
-    player->invincibility_timer = 0;
+    player->invincibility_timer = 0.0f;
     player->angle = 0.0f;  // Start facing right
 }
 
@@ -43,6 +44,24 @@ Vector2 player_get_position(const Player* player) {
     return player->position;
 }
 
+Vector2 player_get_previous_position(const Player* player) {
+    if (!player) return (Vector2){0, 0};
+    return player->previous_position;
+}
+
+Vector2 player_get_interpolated_position(const Player* player, float alpha) {
+    if (!player) return (Vector2){0, 0};
+    return (Vector2){
+        player->previous_position.x + (player->position.x - player->previous_position.x) * alpha,
+        player->previous_position.y + (player->position.y - player->previous_position.y) * alpha
+    };
+}
+
+void player_sync_previous_position(Player* player) {
+    if (!player) return;
+    player->previous_position = player->position;
+}
+
 float player_get_angle(const Player* player) {
     if (!player) return 0.0f;
     return player->angle;
@@ -68,11 +87,11 @@ float player_get_max_health(const Player* player) {
 
 bool player_is_invincible(const Player* player) {
     if (!player) return false;
-    return player->invincibility_timer > 0;
+    return player->invincibility_timer > 0.0f;
 }
 
-int player_get_invincibility_timer(const Player* player) {
-    if (!player) return 0;
+float player_get_invincibility_timer(const Player* player) {
+    if (!player) return 0.0f;
     return player->invincibility_timer;
 }
 
@@ -102,28 +121,29 @@ void player_handle_input(Player* player) {
     if (!player) return;
 }
 
-void player_update_movement(Player* player, const struct Map* current_map) {
-    if (!player || !current_map) return;
+void player_update_movement(Player* player, const InputFrame* input, const struct Map* current_map, float delta_time) {
+    if (!player || !input || !current_map) return;
     
     Vector2 movement = {0.0f, 0.0f};
+    float step = player->speed * delta_time;
     
-    if (IsKeyDown(KEY_W) || IsKeyDown(KEY_UP)) {
+    if (input_is_down(input, INPUT_BUTTON_UP)) {
         movement.y -= player->speed;
     }
-    if (IsKeyDown(KEY_S) || IsKeyDown(KEY_DOWN)) {
+    if (input_is_down(input, INPUT_BUTTON_DOWN)) {
         movement.y += player->speed;
     }
-    if (IsKeyDown(KEY_A) || IsKeyDown(KEY_LEFT)) {
+    if (input_is_down(input, INPUT_BUTTON_LEFT)) {
         movement.x -= player->speed;
     }
-    if (IsKeyDown(KEY_D) || IsKeyDown(KEY_RIGHT)) {
+    if (input_is_down(input, INPUT_BUTTON_RIGHT)) {
         movement.x += player->speed;
     }
     
     float length = sqrtf(movement.x * movement.x + movement.y * movement.y);
     if (length > 0.0f) {
-        movement.x = (movement.x / length) * player->speed;
-        movement.y = (movement.y / length) * player->speed;
+        movement.x = (movement.x / length) * step;
+        movement.y = (movement.y / length) * step;
     }
     
     Vector2 new_position = {
@@ -138,28 +158,21 @@ void player_update_movement(Player* player, const struct Map* current_map) {
     if (player->position.x < PLAYER_RADIUS) {
         player->position.x = PLAYER_RADIUS;
     }
-    if (player->position.x > SCREEN_WIDTH - PLAYER_RADIUS) {
-        player->position.x = SCREEN_WIDTH - PLAYER_RADIUS;
+    if (player->position.x > WORLD_WIDTH - PLAYER_RADIUS) {
+        player->position.x = WORLD_WIDTH - PLAYER_RADIUS;
     }
     if (player->position.y < PLAYER_RADIUS) {
         player->position.y = PLAYER_RADIUS;
     }
-    if (player->position.y > SCREEN_HEIGHT - PLAYER_RADIUS) {
-        player->position.y = SCREEN_HEIGHT - PLAYER_RADIUS;
+    if (player->position.y > WORLD_HEIGHT - PLAYER_RADIUS) {
+        player->position.y = WORLD_HEIGHT - PLAYER_RADIUS;
     }
 }
 
 bool player_check_wall_collision(const Player* player, Vector2 new_position, const struct Map* current_map) {
     if (!player || !current_map) return false;
     
-    int wall_count;
-    const Wall* walls = map_get_walls(current_map, &wall_count);
-    for (int i = 0; i < wall_count; i++) {
-        if (map_check_circle_rect_collision(new_position, PLAYER_RADIUS, walls[i].rect)) {
-            return true;
-        }
-    }
-    return false;
+    return map_check_circle_wall_collision(current_map, new_position, PLAYER_RADIUS);
 }
 
 bool player_check_exit_collision(const Player* player, const struct Map* current_map, int* target_map_id, int* target_entrance_id) {
@@ -178,20 +191,42 @@ bool player_check_exit_collision(const Player* player, const struct Map* current
 }
 
 void player_apply_damage(Player* player, float damage) {
-    if (!player || player->invincibility_timer > 0) return;
+    if (!player || player->invincibility_timer > 0.0f) return;
     
     player->health -= damage;
-    player->invincibility_timer = INVINCIBILITY_FRAMES;
+    player->invincibility_timer = INVINCIBILITY_TIME;
     
     if (player->health < 0) {
         player->health = 0;
     }
 }
 
-void player_update(Player* player) {
+void player_update(Player* player, float delta_time) {
     if (!player) return;
     
-    if (player->invincibility_timer > 0) {
-        player->invincibility_timer--;
+    if (player->invincibility_timer > 0.0f) {
+        player->invincibility_timer -= delta_time;
     }
 }
+
+void player_snapshot(const Player* player, PlayerSnapshot* snapshot) {
+    if (!player || !snapshot) return;
+    snapshot->position = player->position;
+    snapshot->previous_position = player->previous_position;
+    snapshot->speed = player->speed;
+    snapshot->health = player->health;
+    snapshot->max_health = player->max_health;
+    snapshot->invincibility_timer = player->invincibility_timer;
+    snapshot->angle = player->angle;
+}
+
+void player_restore(Player* player, const PlayerSnapshot* snapshot) {
+    if (!player || !snapshot) return;
+    player->position = snapshot->position;
+    player->previous_position = snapshot->previous_position;
+    player->speed = snapshot->speed;
+    player->health = snapshot->health;
+    player->max_health = snapshot->max_health;
+    player->invincibility_timer = snapshot->invincibility_timer;
+    player->angle = snapshot->angle;
+}
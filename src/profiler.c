@@ -0,0 +1,255 @@
+#include "../include/profiler.h"
+#include "../include/thread.h"
+#include "../include/timer.h"
+#include "../include/trace.h"
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#endif
+
+#if defined(_MSC_VER)
+#define PROFILER_THREAD_LOCAL __declspec(thread)
+#else
+#define PROFILER_THREAD_LOCAL _Thread_local
+#endif
+
+#define PROFILER_PARENT_UNKNOWN -2
+
+typedef struct {
+    const char* name;
+    volatile int parent;  // Published last, once depth is set
+    int depth;
+} ProfilerZone;
+
+typedef struct {
+    int zone;
+    uint64_t start_ns;
+} ProfilerScope;
+
+// Registered zones outlive profiler_shutdown so the ids PROFILE_BEGIN caches
+// in its function statics still name the same zone after a later init
+static struct {
+    ProfilerZone zones[PROFILER_MAX_ZONES];
+    int zone_count;
+} g_zone_table;
+
+static struct {
+    bool initialized;
+    bool overlay_visible;
+    ThreadMutex* mutex;
+    
+    // Totals for the frame in progress, added to atomically by every thread
+    // and swapped out in profiler_frame_end
+    volatile int64_t frame_ns[PROFILER_MAX_ZONES];
+    volatile int64_t frame_calls[PROFILER_MAX_ZONES];
+    uint64_t frame_start_ns;
+    
+    // Ring of completed frames
+    uint64_t history_ns[PROFILER_HISTORY][PROFILER_MAX_ZONES];
+    uint64_t history_frame_ns[PROFILER_HISTORY];
+    int last_calls[PROFILER_MAX_ZONES];
+    int history_head;
+    int history_count;
+} g_profiler;
+
+// Each thread keeps its own stack of open zones
+static PROFILER_THREAD_LOCAL ProfilerScope g_scope_stack[PROFILER_MAX_DEPTH];
+static PROFILER_THREAD_LOCAL int g_scope_depth = 0;
+
+/**
+ * Atomically add to a frame total.
+ * @param value The total
+ * @param delta Amount to add
+ */
+static void profiler_atomic_add(volatile int64_t* value, int64_t delta) {
+#if defined(_MSC_VER)
+    InterlockedExchangeAdd64((volatile LONG64*)value, delta);
+#else
+    __atomic_add_fetch(value, delta, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * Atomically take a frame total and reset it to zero.
+ * @param value The total
+ * @return The old value
+ */
+static int64_t profiler_atomic_take(volatile int64_t* value) {
+#if defined(_MSC_VER)
+    return InterlockedExchange64((volatile LONG64*)value, 0);
+#else
+    return __atomic_exchange_n(value, 0, __ATOMIC_RELAXED);
+#endif
+}
+
+/**
+ * Record where a zone sits in the tree the first time it closes.
+ * @param zone Zone id
+ * @param parent Enclosing zone, or -1
+ * @param depth Nesting depth
+ */
+static void profiler_place_zone(int zone, int parent, int depth) {
+    ProfilerZone* z = &g_zone_table.zones[zone];
+    thread_mutex_lock(g_profiler.mutex);
+    if (z->parent == PROFILER_PARENT_UNKNOWN) {
+        z->depth = depth;
+#if defined(_MSC_VER)
+        InterlockedExchange((volatile LONG*)&z->parent, parent);
+#else
+        __atomic_store_n(&z->parent, parent, __ATOMIC_RELEASE);
+#endif
+    }
+    thread_mutex_unlock(g_profiler.mutex);
+}
+
+bool profiler_init(void) {
+    if (g_profiler.initialized) return true;
+    
+    memset(&g_profiler, 0, sizeof(g_profiler));
+    g_profiler.mutex = thread_mutex_create();
+    if (!g_profiler.mutex) {
+        return false;
+    }
+    g_profiler.frame_start_ns = timer_now_ns();
+    g_profiler.initialized = true;
+    return true;
+}
+
+void profiler_shutdown(void) {
+    if (!g_profiler.initialized) return;
+    
+    thread_mutex_destroy(g_profiler.mutex);
+    g_profiler.mutex = NULL;
+    g_profiler.initialized = false;
+}
+
+int profiler_register_zone(const char* name) {
+    if (!g_profiler.initialized || !name) return -1;
+    
+    int zone = -1;
+    thread_mutex_lock(g_profiler.mutex);
+    for (int i = 0; i < g_zone_table.zone_count; i++) {
+        if (strcmp(g_zone_table.zones[i].name, name) == 0) {
+            zone = i;
+            break;
+        }
+    }
+    if (zone < 0 && g_zone_table.zone_count < PROFILER_MAX_ZONES) {
+        zone = g_zone_table.zone_count++;
+        g_zone_table.zones[zone].name = name;
+        g_zone_table.zones[zone].parent = PROFILER_PARENT_UNKNOWN;
+        g_zone_table.zones[zone].depth = 0;
+    }
+    thread_mutex_unlock(g_profiler.mutex);
+    return zone;
+}
+
+void profiler_zone_begin(int zone) {
+    // Unregistered zones and overflow still take a slot so PROFILE_END pairs up
+    if (g_scope_depth < PROFILER_MAX_DEPTH) {
+        g_scope_stack[g_scope_depth].zone = zone;
+        g_scope_stack[g_scope_depth].start_ns = timer_now_ns();
+    }
+    g_scope_depth++;
+}
+
+void profiler_zone_end(void) {
+    if (g_scope_depth <= 0) return;
+    
+    g_scope_depth--;
+    if (g_scope_depth >= PROFILER_MAX_DEPTH) return;
+    
+    ProfilerScope scope = g_scope_stack[g_scope_depth];
+    if (scope.zone < 0 || !g_profiler.initialized) return;
+    
+    uint64_t elapsed = timer_now_ns() - scope.start_ns;
+    int parent = (g_scope_depth > 0) ? g_scope_stack[g_scope_depth - 1].zone : -1;
+    
+    // Lock-free apart from the first close of each zone, so workers inside
+    // parallel sections do not queue on each other
+    profiler_atomic_add(&g_profiler.frame_ns[scope.zone], (int64_t)elapsed);
+    profiler_atomic_add(&g_profiler.frame_calls[scope.zone], 1);
+    if (thread_atomic_load(&g_zone_table.zones[scope.zone].parent) == PROFILER_PARENT_UNKNOWN) {
+        profiler_place_zone(scope.zone, parent, g_scope_depth);
+    }
+    
+    trace_complete(g_zone_table.zones[scope.zone].name, scope.start_ns, elapsed);
+}
+
+void profiler_frame_end(void) {
+    if (!g_profiler.initialized) return;
+    
+    uint64_t now = timer_now_ns();
+    int slot = g_profiler.history_head;
+    
+    thread_mutex_lock(g_profiler.mutex);
+    for (int i = 0; i < PROFILER_MAX_ZONES; i++) {
+        g_profiler.history_ns[slot][i] = (uint64_t)profiler_atomic_take(&g_profiler.frame_ns[i]);
+        g_profiler.last_calls[i] = (int)profiler_atomic_take(&g_profiler.frame_calls[i]);
+    }
+    thread_mutex_unlock(g_profiler.mutex);
+    
+    g_profiler.history_frame_ns[slot] = now - g_profiler.frame_start_ns;
+    g_profiler.frame_start_ns = now;
+    g_profiler.history_head = (slot + 1) % PROFILER_HISTORY;
+    if (g_profiler.history_count < PROFILER_HISTORY) {
+        g_profiler.history_count++;
+    }
+}
+
+int profiler_get_zone_count(void) {
+    if (!g_profiler.initialized) return 0;
+    
+    thread_mutex_lock(g_profiler.mutex);
+    int count = g_zone_table.zone_count;
+    thread_mutex_unlock(g_profiler.mutex);
+    return count;
+}
+
+bool profiler_get_zone_stats(int zone, ProfilerZoneStats* stats) {
+    if (!g_profiler.initialized || !stats) return false;
+    
+    thread_mutex_lock(g_profiler.mutex);
+    bool valid = zone >= 0 && zone < g_zone_table.zone_count;
+    if (valid) {
+        uint64_t total_ns = 0;
+        uint64_t max_ns = 0;
+        for (int i = 0; i < g_profiler.history_count; i++) {
+            uint64_t ns = g_profiler.history_ns[i][zone];
+            total_ns += ns;
+            if (ns > max_ns) max_ns = ns;
+        }
+        
+        const ProfilerZone* z = &g_zone_table.zones[zone];
+        stats->name = z->name;
+        stats->parent = (z->parent == PROFILER_PARENT_UNKNOWN) ? -1 : z->parent;
+        stats->depth = z->depth;
+        stats->avg_ms = (g_profiler.history_count > 0)
+            ? (double)total_ns / g_profiler.history_count / 1e6 : 0.0;
+        stats->max_ms = (double)max_ns / 1e6;
+        stats->calls = g_profiler.last_calls[zone];
+    }
+    thread_mutex_unlock(g_profiler.mutex);
+    return valid;
+}
+
+int profiler_get_frame_times(float* frame_ms, int max_frames) {
+    if (!g_profiler.initialized || !frame_ms || max_frames <= 0) return 0;
+    
+    int count = g_profiler.history_count < max_frames ? g_profiler.history_count : max_frames;
+    int start = (g_profiler.history_head - count + PROFILER_HISTORY) % PROFILER_HISTORY;
+    for (int i = 0; i < count; i++) {
+        frame_ms[i] = (float)(g_profiler.history_frame_ns[(start + i) % PROFILER_HISTORY] / 1e6);
+    }
+    return count;
+}
+
+bool profiler_is_overlay_visible(void) {
+    return g_profiler.overlay_visible;
+}
+
+void profiler_set_overlay_visible(bool visible) {
+    g_profiler.overlay_visible = visible;
+}
@@ -1,116 +1,244 @@
 #include "../include/projectile.h"
+#include "../include/map.h"
 #include <math.h>
-#include <stdlib.h>
 #include <string.h>
 
-struct Projectile {
-    Vector2 position;
-    Vector2 velocity;
-    float radius;
-    float damage;
-    int lifetime;
-    int max_lifetime;
-    bool active;
-};
-
-Projectile* projectile_create(Vector2 position, Vector2 direction) {
-    Projectile* projectile = (Projectile*)malloc(sizeof(Projectile));
-    if (!projectile) return NULL;
-    
-    projectile->position = position;
-    projectile->radius = PROJECTILE_RADIUS;
-    projectile->damage = PROJECTILE_DAMAGE;
-    projectile->max_lifetime = PROJECTILE_LIFETIME;
-    projectile->lifetime = PROJECTILE_LIFETIME;
-    projectile->active = true;
+#define PROJECTILE_SLOT_BITS 16
+#define PROJECTILE_SLOT_MASK ((1u << PROJECTILE_SLOT_BITS) - 1)
+
+/**
+ * Build the handle for a slot's current generation.
+ * @param pool The pool
+ * @param slot Slot index
+ * @return Handle
+ */
+static ProjectileHandle projectile_pool_make_handle(const ProjectilePool* pool, int slot) {
+    ProjectileHandle handle = {((uint32_t)pool->generation[slot] << PROJECTILE_SLOT_BITS) | (uint32_t)slot};
+    return handle;
+}
+
+/**
+ * Return a slot to the free stack, moving it to a new generation so old
+ * handles to it stop matching.
+ * @param pool The pool
+ * @param slot Slot index
+ */
+static void projectile_pool_release_slot(ProjectilePool* pool, int slot) {
+    pool->generation[slot]++;
+    if (pool->generation[slot] == 0) {
+        pool->generation[slot] = 1;
+    }
+    pool->free_slots[pool->free_count++] = (uint16_t)slot;
+}
+
+/**
+ * Copy one array into a snapshot.
+ * @param out Write position
+ * @param array Array to copy
+ * @param size Bytes to copy
+ * @return Write position after the array
+ */
+static uint8_t* projectile_write_array(uint8_t* out, const void* array, size_t size) {
+    memcpy(out, array, size);
+    return out + size;
+}
+
+/**
+ * Copy one array out of a snapshot.
+ * @param in Read position
+ * @param array Array to fill
+ * @param size Bytes to copy
+ * @return Read position after the array
+ */
+static const uint8_t* projectile_read_array(const uint8_t* in, void* array, size_t size) {
+    memcpy(array, in, size);
+    return in + size;
+}
+
+void projectile_pool_init(ProjectilePool* pool) {
+    if (!pool) return;
+    
+    pool->count = 0;
+    pool->free_count = 0;
+    // Pushed in reverse so the first spawns take the lowest slots
+    for (int slot = MAX_PROJECTILES - 1; slot >= 0; slot--) {
+        pool->generation[slot] = 1;
+        pool->free_slots[pool->free_count++] = (uint16_t)slot;
+    }
+}
+
+void projectile_pool_clear(ProjectilePool* pool) {
+    if (!pool) return;
+    
+    for (int i = pool->count - 1; i >= 0; i--) {
+        projectile_pool_release_slot(pool, pool->slot_of[i]);
+    }
+    pool->count = 0;
+}
+
+ProjectileHandle projectile_pool_spawn(ProjectilePool* pool, Vector2 position, Vector2 direction) {
+    if (!pool || pool->count >= MAX_PROJECTILES || pool->free_count == 0) return PROJECTILE_HANDLE_NONE;
+    
+    int slot = pool->free_slots[--pool->free_count];
+    int index = pool->count++;
+    pool->slot_of[index] = (uint16_t)slot;
+    pool->index_of[slot] = (uint16_t)index;
+    
+    pool->x[index] = position.x;
+    pool->y[index] = position.y;
+    pool->previous_x[index] = position.x;
+    pool->previous_y[index] = position.y;
+    pool->lifetime[index] = PROJECTILE_LIFETIME;
     
     // Normalize direction and set velocity
     float length = sqrtf(direction.x * direction.x + direction.y * direction.y);
     if (length > 0.0f) {
-        projectile->velocity.x = (direction.x / length) * PROJECTILE_SPEED;
-        projectile->velocity.y = (direction.y / length) * PROJECTILE_SPEED;
+        pool->velocity_x[index] = (direction.x / length) * PROJECTILE_SPEED;
+        pool->velocity_y[index] = (direction.y / length) * PROJECTILE_SPEED;
     } else {
         // Default direction if zero vector
-        projectile->velocity.x = PROJECTILE_SPEED;
-        projectile->velocity.y = 0.0f;
+        pool->velocity_x[index] = PROJECTILE_SPEED;
+        pool->velocity_y[index] = 0.0f;
     }
     
-    return projectile;
+    return projectile_pool_make_handle(pool, slot);
 }
 
-void projectile_destroy(Projectile* projectile) {
-    if (projectile) free(projectile);
-}
-
-Vector2 projectile_get_position(const Projectile* projectile) {
-    if (!projectile) return (Vector2){0, 0};
-    return projectile->position;
-}
-
-Vector2 projectile_get_velocity(const Projectile* projectile) {
-    if (!projectile) return (Vector2){0, 0};
-    return projectile->velocity;
+void projectile_pool_remove_at(ProjectilePool* pool, int index) {
+    if (!pool || index < 0 || index >= pool->count) return;
+    
+    projectile_pool_release_slot(pool, pool->slot_of[index]);
+    
+    int last = --pool->count;
+    if (index != last) {
+        pool->x[index] = pool->x[last];
+        pool->y[index] = pool->y[last];
+        pool->previous_x[index] = pool->previous_x[last];
+        pool->previous_y[index] = pool->previous_y[last];
+        pool->velocity_x[index] = pool->velocity_x[last];
+        pool->velocity_y[index] = pool->velocity_y[last];
+        pool->lifetime[index] = pool->lifetime[last];
+        pool->slot_of[index] = pool->slot_of[last];
+        pool->index_of[pool->slot_of[index]] = (uint16_t)index;
+    }
 }
 
-float projectile_get_radius(const Projectile* projectile) {
-    if (!projectile) return 0.0f;
-    return projectile->radius;
+bool projectile_pool_remove(ProjectilePool* pool, ProjectileHandle handle) {
+    int index = projectile_pool_find(pool, handle);
+    if (index < 0) return false;
+    projectile_pool_remove_at(pool, index);
+    return true;
 }
 
-float projectile_get_damage(const Projectile* projectile) {
-    if (!projectile) return 0.0f;
-    return projectile->damage;
+int projectile_pool_find(const ProjectilePool* pool, ProjectileHandle handle) {
+    if (!pool) return -1;
+    
+    uint32_t slot = handle.value & PROJECTILE_SLOT_MASK;
+    uint32_t generation = handle.value >> PROJECTILE_SLOT_BITS;
+    if (slot >= MAX_PROJECTILES || generation == 0 || pool->generation[slot] != generation) return -1;
+    
+    // A slot on the free stack has already moved to its next generation
+    int index = pool->index_of[slot];
+    return (index < pool->count && pool->slot_of[index] == slot) ? index : -1;
 }
 
-bool projectile_is_active(const Projectile* projectile) {
-    if (!projectile) return false;
-    return projectile->active && projectile->lifetime > 0;
+ProjectileHandle projectile_pool_get_handle(const ProjectilePool* pool, int index) {
+    if (!pool || index < 0 || index >= pool->count) return PROJECTILE_HANDLE_NONE;
+    return projectile_pool_make_handle(pool, pool->slot_of[index]);
 }
 
-void projectile_update(Projectile* projectile) {
-    if (!projectile || !projectile->active) return;
+void projectile_pool_update(ProjectilePool* pool, float delta_time) {
+    if (!pool) return;
     
-    projectile->lifetime--;
-    if (projectile->lifetime <= 0) {
-        projectile->active = false;
-        return;
+    // No branches or calls, so compilers vectorize this
+    int count = pool->count;
+    for (int i = 0; i < count; i++) {
+        pool->previous_x[i] = pool->x[i];
+        pool->previous_y[i] = pool->y[i];
+        pool->x[i] += pool->velocity_x[i] * delta_time;
+        pool->y[i] += pool->velocity_y[i] * delta_time;
+        pool->lifetime[i] -= delta_time;
     }
     
-    projectile->position.x += projectile->velocity.x;
-    projectile->position.y += projectile->velocity.y;
-    
-    // Deactivate if out of bounds
-    #define SCREEN_WIDTH 800
-    #define SCREEN_HEIGHT 600
-    if (projectile->position.x < -projectile->radius || 
-        projectile->position.x > SCREEN_WIDTH + projectile->radius ||
-        projectile->position.y < -projectile->radius || 
-        projectile->position.y > SCREEN_HEIGHT + projectile->radius) {
-        projectile->active = false;
+    // Downwards, so each swapped-in projectile has already been checked
+    for (int i = count - 1; i >= 0; i--) {
+        if (pool->lifetime[i] <= 0.0f ||
+            pool->x[i] < -PROJECTILE_RADIUS || pool->x[i] > WORLD_WIDTH + PROJECTILE_RADIUS ||
+            pool->y[i] < -PROJECTILE_RADIUS || pool->y[i] > WORLD_HEIGHT + PROJECTILE_RADIUS) {
+            projectile_pool_remove_at(pool, i);
+        }
     }
 }
 
-bool projectile_check_circle_collision(const Projectile* projectile, Vector2 circle_pos, float circle_radius) {
-    if (!projectile || !projectile->active) return false;
+Vector2 projectile_pool_get_position(const ProjectilePool* pool, int index) {
+    if (!pool || index < 0 || index >= pool->count) return (Vector2){0, 0};
+    return (Vector2){pool->x[index], pool->y[index]};
+}
+
+Vector2 projectile_pool_get_interpolated_position(const ProjectilePool* pool, int index, float alpha) {
+    if (!pool || index < 0 || index >= pool->count) return (Vector2){0, 0};
+    return (Vector2){
+        pool->previous_x[index] + (pool->x[index] - pool->previous_x[index]) * alpha,
+        pool->previous_y[index] + (pool->y[index] - pool->previous_y[index]) * alpha
+    };
+}
+
+bool projectile_pool_check_circle_collision(const ProjectilePool* pool, int index, Vector2 circle_pos, float circle_radius) {
+    if (!pool || index < 0 || index >= pool->count) return false;
     
-    float dx = projectile->position.x - circle_pos.x;
-    float dy = projectile->position.y - circle_pos.y;
+    float dx = pool->x[index] - circle_pos.x;
+    float dy = pool->y[index] - circle_pos.y;
     float distance = sqrtf(dx * dx + dy * dy);
     
-    return distance < (projectile->radius + circle_radius);
+    return distance < (PROJECTILE_RADIUS + circle_radius);
 }
 
-bool projectile_check_rect_collision(const Projectile* projectile, Rectangle rect) {
-    if (!projectile || !projectile->active) return false;
+bool projectile_pool_check_rect_collision(const ProjectilePool* pool, int index, Rectangle rect) {
+    if (!pool || index < 0 || index >= pool->count) return false;
     
     // Find closest point on rectangle to projectile center
-    float closest_x = fmaxf(rect.x, fminf(projectile->position.x, rect.x + rect.width));
-    float closest_y = fmaxf(rect.y, fminf(projectile->position.y, rect.y + rect.height));
+    float closest_x = fmaxf(rect.x, fminf(pool->x[index], rect.x + rect.width));
+    float closest_y = fmaxf(rect.y, fminf(pool->y[index], rect.y + rect.height));
     
-    float dx = projectile->position.x - closest_x;
-    float dy = projectile->position.y - closest_y;
+    float dx = pool->x[index] - closest_x;
+    float dy = pool->y[index] - closest_y;
     float distance_sq = dx * dx + dy * dy;
     
-    return distance_sq < (projectile->radius * projectile->radius);
+    return distance_sq < (PROJECTILE_RADIUS * PROJECTILE_RADIUS);
+}
+
+size_t projectile_pool_snapshot(const ProjectilePool* pool, uint8_t* out) {
+    if (!pool || !out) return 0;
+    
+    size_t floats = sizeof(float) * (size_t)pool->count;
+    uint8_t* start = out;
+    out = projectile_write_array(out, pool->x, floats);
+    out = projectile_write_array(out, pool->y, floats);
+    out = projectile_write_array(out, pool->previous_x, floats);
+    out = projectile_write_array(out, pool->previous_y, floats);
+    out = projectile_write_array(out, pool->velocity_x, floats);
+    out = projectile_write_array(out, pool->velocity_y, floats);
+    out = projectile_write_array(out, pool->lifetime, floats);
+    return (size_t)(out - start);
 }
 
+void projectile_pool_restore(ProjectilePool* pool, const uint8_t* in, int count) {
+    if (!pool || !in || count < 0 || count > MAX_PROJECTILES) return;
+    
+    projectile_pool_clear(pool);
+    for (int i = 0; i < count; i++) {
+        int slot = pool->free_slots[--pool->free_count];
+        pool->slot_of[i] = (uint16_t)slot;
+        pool->index_of[slot] = (uint16_t)i;
+    }
+    pool->count = count;
+    
+    size_t floats = sizeof(float) * (size_t)count;
+    in = projectile_read_array(in, pool->x, floats);
+    in = projectile_read_array(in, pool->y, floats);
+    in = projectile_read_array(in, pool->previous_x, floats);
+    in = projectile_read_array(in, pool->previous_y, floats);
+    in = projectile_read_array(in, pool->velocity_x, floats);
+    in = projectile_read_array(in, pool->velocity_y, floats);
+    projectile_read_array(in, pool->lifetime, floats);
+}
@@ -3,8 +3,126 @@
 #include <math.h>
 #include <float.h>
 
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
+
+// Nearest wall a ray has hit so far
+typedef struct {
+    float distance;
+    Vector2 point;
+    int wall_index;  // -1 until something is hit
+} RayNearest;
+
+/**
+ * Intersect a ray with one wall and keep the hit if it is the nearest yet.
+ * Uses line-rectangle intersection over the ray's full length.
+ * @param nearest Nearest hit so far, updated on a closer hit
+ * @param start_pos Ray origin
+ * @param dx Ray direction X (unit length)
+ * @param dy Ray direction Y (unit length)
+ * @param walls The map's walls
+ * @param index Wall to test
+ */
+static void raycaster_test_wall(RayNearest* nearest, Vector2 start_pos, float dx, float dy, const Wall* walls, int index) {
+    Rectangle wall = walls[index].rect;
+    
+    // Line-rectangle intersection, with t running from 0 at the start to 1
+    // at RAYCASTER_MAX_DISTANCE
+    float ray_x = dx * RAYCASTER_MAX_DISTANCE;
+    float ray_y = dy * RAYCASTER_MAX_DISTANCE;
+    float t_min = 0.0f;
+    float t_max = 1.0f;
+    
+    // Check x-axis
+    if (dx != 0) {
+        float t1 = (wall.x - start_pos.x) / ray_x;
+        float t2 = (wall.x + wall.width - start_pos.x) / ray_x;
+        float t_near = fminf(t1, t2);
+        float t_far = fmaxf(t1, t2);
+        
+        if (t_near > t_max || t_far < t_min) return;
+        t_min = fmaxf(t_min, t_near);
+        t_max = fminf(t_max, t_far);
+    } else {
+        if (start_pos.x < wall.x || start_pos.x > wall.x + wall.width) return;
+    }
+    
+    // Check y-axis
+    if (dy != 0) {
+        float t1 = (wall.y - start_pos.y) / ray_y;
+        float t2 = (wall.y + wall.height - start_pos.y) / ray_y;
+        float t_near = fminf(t1, t2);
+        float t_far = fmaxf(t1, t2);
+        
+        if (t_near > t_max || t_far < t_min) return;
+        t_min = fmaxf(t_min, t_near);
+        t_max = fminf(t_max, t_far);
+    } else {
+        if (start_pos.y < wall.y || start_pos.y > wall.y + wall.height) return;
+    }
+    
+    if (t_min <= t_max && t_min >= 0 && t_min < 1.0f) {
+        // Calculate actual distance along the ray
+        Vector2 intersection = {
+            start_pos.x + ray_x * t_min,
+            start_pos.y + ray_y * t_min
+        };
+        float dx_intersect = intersection.x - start_pos.x;
+        float dy_intersect = intersection.y - start_pos.y;
+        float dist = sqrtf(dx_intersect * dx_intersect + dy_intersect * dy_intersect);
+        
+        if (dist < nearest->distance && dist > 0.1f) {  // Avoid self-intersection
+            nearest->distance = dist;
+            nearest->point = intersection;
+            nearest->wall_index = index;
+        }
+    }
+}
+
+/**
+ * Walk a ray through the map's wall grid cell by cell (DDA), testing the
+ * walls of each cell, until the nearest hit lies before the next cell.
+ * @param nearest Nearest hit, updated
+ * @param start_pos Ray origin, inside the grid
+ * @param dx Ray direction X (unit length)
+ * @param dy Ray direction Y (unit length)
+ * @param grid The map's wall grid
+ * @param walls The map's walls
+ */
+static void raycaster_walk_grid(RayNearest* nearest, Vector2 start_pos, float dx, float dy,
+                                const WallGrid* grid, const Wall* walls) {
+    float cell_x = (start_pos.x - grid->origin_x) * grid->inverse_cell_size;
+    float cell_y = (start_pos.y - grid->origin_y) * grid->inverse_cell_size;
+    int column = (int)cell_x < grid->columns ? (int)cell_x : grid->columns - 1;
+    int row = (int)cell_y < grid->rows ? (int)cell_y : grid->rows - 1;
+    
+    // Distance along the ray to cross one cell, and to the first crossing
+    float delta_dist_x = (dx == 0) ? FLT_MAX : fabsf(grid->cell_size / dx);
+    float delta_dist_y = (dy == 0) ? FLT_MAX : fabsf(grid->cell_size / dy);
+    int step_x = dx < 0 ? -1 : 1;
+    int step_y = dy < 0 ? -1 : 1;
+    float side_dist_x = (dx < 0 ? cell_x - column : column + 1.0f - cell_x) * delta_dist_x;
+    float side_dist_y = (dy < 0 ? cell_y - row : row + 1.0f - cell_y) * delta_dist_y;
+    
+    for (;;) {
+        int cell = row * grid->columns + column;
+        for (int entry = grid->cell_start[cell]; entry < grid->cell_start[cell + 1]; entry++) {
+            raycaster_test_wall(nearest, start_pos, dx, dy, walls, grid->wall_index[entry]);
+        }
+        
+        // Any wall in a later cell is at least as far as the way out of this one
+        float cell_exit = fminf(side_dist_x, side_dist_y);
+        if (cell_exit >= nearest->distance) return;
+        
+        if (side_dist_x < side_dist_y) {
+            side_dist_x += delta_dist_x;
+            column += step_x;
+            if (column < 0 || column >= grid->columns) return;
+        } else {
+            side_dist_y += delta_dist_y;
+            row += step_y;
+            if (row < 0 || row >= grid->rows) return;
+        }
+    }
+}
 
 RaycastResult raycaster_cast_ray(Vector2 start_pos, float angle, const Map* map) {
     RaycastResult result = {0};
@@ -18,145 +136,62 @@ RaycastResult raycaster_cast_ray(Vector2 start_pos, float angle, const Map* map)
     float dx = cosf(angle);
     float dy = sinf(angle);
     
-    // Step size for DDA algorithm
-    float delta_dist_x = (dx == 0) ? FLT_MAX : fabsf(1.0f / dx);
-    float delta_dist_y = (dy == 0) ? FLT_MAX : fabsf(1.0f / dy);
-    
-    // Current grid position
-    int map_x = (int)start_pos.x;
-    int map_y = (int)start_pos.y;
-    
-    // Step direction
-    int step_x, step_y;
-    float side_dist_x, side_dist_y;
-    
-    if (dx < 0) {
-        step_x = -1;
-        side_dist_x = (start_pos.x - map_x) * delta_dist_x;
-    } else {
-        step_x = 1;
-        side_dist_x = (map_x + 1.0f - start_pos.x) * delta_dist_x;
-    }
-    
-    if (dy < 0) {
-        step_y = -1;
-        side_dist_y = (start_pos.y - map_y) * delta_dist_y;
-    } else {
-        step_y = 1;
-        side_dist_y = (map_y + 1.0f - start_pos.y) * delta_dist_y;
-    }
-    
-    // DDA algorithm
-    bool hit = false;
-    int side = 0; // 0 = x-side, 1 = y-side
-    int wall_index = -1;
-    
-    // Check walls from map
     int wall_count;
     const Wall* walls = map_get_walls(map, &wall_count);
+    RayNearest nearest = {RAYCASTER_MAX_DISTANCE, {0, 0}, -1};
     
-    float min_dist = RAYCASTER_MAX_DISTANCE;
-    Vector2 hit_point = {0, 0};
-    Color hit_color = DARKGRAY;
+    // Walk the wall grid from the start cell; without a current grid, or
+    // from outside it, check every wall
+    const WallGrid* grid = map_get_wall_grid(map);
+    bool in_grid = grid &&
+                   start_pos.x >= grid->origin_x && start_pos.x < grid->origin_x + grid->columns * grid->cell_size &&
+                   start_pos.y >= grid->origin_y && start_pos.y < grid->origin_y + grid->rows * grid->cell_size;
+    if (in_grid) {
+        raycaster_walk_grid(&nearest, start_pos, dx, dy, grid, walls);
+    } else {
+        for (int i = 0; i < wall_count; i++) {
+            raycaster_test_wall(&nearest, start_pos, dx, dy, walls, i);
+        }
+    }
     
-    // Cast ray and check against all walls
-    for (int i = 0; i < wall_count; i++) {
-        Rectangle wall = walls[i].rect;
+    if (nearest.wall_index >= 0) {
+        Rectangle wall = walls[nearest.wall_index].rect;
+        Vector2 intersection = nearest.point;
         
-        // Check if ray intersects with this wall rectangle
-        // Using line-rectangle intersection
-        Vector2 ray_end = {
-            start_pos.x + dx * RAYCASTER_MAX_DISTANCE,
-            start_pos.y + dy * RAYCASTER_MAX_DISTANCE
-        };
+        // Determine which side of the wall was hit
+        // Check which edge of the rectangle is closest to the intersection
+        float dist_to_left = fabsf(intersection.x - wall.x);
+        float dist_to_right = fabsf(intersection.x - (wall.x + wall.width));
+        float dist_to_top = fabsf(intersection.y - wall.y);
+        float dist_to_bottom = fabsf(intersection.y - (wall.y + wall.height));
         
-        // Line-rectangle intersection
-        float t_min = 0.0f;
-        float t_max = 1.0f;
-        
-        // Check x-axis
-        if (dx != 0) {
-            float t1 = (wall.x - start_pos.x) / dx;
-            float t2 = (wall.x + wall.width - start_pos.x) / dx;
-            float t_near = fminf(t1, t2);
-            float t_far = fmaxf(t1, t2);
-            
-            if (t_near > t_max || t_far < t_min) continue;
-            t_min = fmaxf(t_min, t_near);
-            t_max = fminf(t_max, t_far);
-        } else {
-            if (start_pos.x < wall.x || start_pos.x > wall.x + wall.width) continue;
-        }
+        float min_edge_dist = fminf(fminf(dist_to_left, dist_to_right), 
+                                    fminf(dist_to_top, dist_to_bottom));
         
-        // Check y-axis
-        if (dy != 0) {
-            float t1 = (wall.y - start_pos.y) / dy;
-            float t2 = (wall.y + wall.height - start_pos.y) / dy;
-            float t_near = fminf(t1, t2);
-            float t_far = fmaxf(t1, t2);
-            
-            if (t_near > t_max || t_far < t_min) continue;
-            t_min = fmaxf(t_min, t_near);
-            t_max = fminf(t_max, t_far);
+        if (min_edge_dist == dist_to_left) {
+            result.side = WALL_SIDE_WEST;
+        } else if (min_edge_dist == dist_to_right) {
+            result.side = WALL_SIDE_EAST;
+        } else if (min_edge_dist == dist_to_top) {
+            result.side = WALL_SIDE_NORTH;
         } else {
-            if (start_pos.y < wall.y || start_pos.y > wall.y + wall.height) continue;
+            result.side = WALL_SIDE_SOUTH;
         }
         
-        if (t_min <= t_max && t_min >= 0 && t_min < 1.0f) {
-            // Calculate actual distance along the ray
-            Vector2 intersection = {
-                start_pos.x + dx * t_min * RAYCASTER_MAX_DISTANCE,
-                start_pos.y + dy * t_min * RAYCASTER_MAX_DISTANCE
-            };
-            float dx_intersect = intersection.x - start_pos.x;
-            float dy_intersect = intersection.y - start_pos.y;
-            float dist = sqrtf(dx_intersect * dx_intersect + dy_intersect * dy_intersect);
-            
-            if (dist < min_dist && dist > 0.1f) {  // Avoid self-intersection
-                min_dist = dist;
-                hit_point = intersection;
-                hit_color = DARKGRAY;
-                wall_index = i;
-                hit = true;
-                
-                // Determine which side of the wall was hit
-                // Check which edge of the rectangle is closest to the intersection
-                float dist_to_left = fabsf(intersection.x - wall.x);
-                float dist_to_right = fabsf(intersection.x - (wall.x + wall.width));
-                float dist_to_top = fabsf(intersection.y - wall.y);
-                float dist_to_bottom = fabsf(intersection.y - (wall.y + wall.height));
-                
-                float min_edge_dist = fminf(fminf(dist_to_left, dist_to_right), 
-                                            fminf(dist_to_top, dist_to_bottom));
-                
-                if (min_edge_dist == dist_to_left) {
-                    result.side = WALL_SIDE_WEST;
-                } else if (min_edge_dist == dist_to_right) {
-                    result.side = WALL_SIDE_EAST;
-                } else if (min_edge_dist == dist_to_top) {
-                    result.side = WALL_SIDE_NORTH;
-                } else {
-                    result.side = WALL_SIDE_SOUTH;
-                }
-            }
-        }
-    }
-    
-    if (hit) {
         result.hit = true;
-        result.distance = min_dist;
-        result.hit_point = hit_point;
-        result.wall_index = wall_index;
+        result.distance = nearest.distance;
+        result.hit_point = intersection;
+        result.wall_index = nearest.wall_index;
         
         // Calculate perpendicular distance to avoid fisheye effect
-        result.perp_distance = min_dist * cosf(angle - atan2f(dy, dx));
+        result.perp_distance = nearest.distance * cosf(angle - atan2f(dy, dx));
         if (result.perp_distance < 0.1f) result.perp_distance = 0.1f;
         
-        result.color = raycaster_get_shaded_color(hit_color, result.perp_distance, result.side);
+        result.color = raycaster_get_shaded_color(DARKGRAY, result.perp_distance, result.side);
         
         // Calculate wall height based on perpendicular distance (perspective)
         result.wall_height = (RAYCASTER_WALL_HEIGHT / result.perp_distance) * 200.0f;
-        if (result.wall_height > SCREEN_HEIGHT) result.wall_height = SCREEN_HEIGHT;
+        if (result.wall_height > RAYCASTER_REFERENCE_HEIGHT) result.wall_height = RAYCASTER_REFERENCE_HEIGHT;
     } else {
         result.side = WALL_SIDE_UNKNOWN;
         result.perp_distance = RAYCASTER_MAX_DISTANCE;
@@ -0,0 +1,62 @@
+#include "../include/render_state.h"
+#include "../include/player.h"
+#include "../include/projectile.h"
+#include <string.h>
+
+void render_state_capture(RenderState* view, GameState* state, float tick_delta) {
+    if (!view || !state) return;
+    
+    view->type = state_get_type(state);
+    view->mode = state_get_game_mode(state);
+    view->time = (float)state_get_frame_count(state) * tick_delta;
+    view->current_map_id = state_get_current_map_id(state);
+    view->coins_collected = state_get_coins_collected(state);
+    view->total_coins = state_get_total_coins(state);
+    
+    Player* player = state_get_player(state);
+    view->player_position = player_get_position(player);
+    view->player_previous_position = player_get_previous_position(player);
+    view->player_angle = player_get_angle(player);
+    view->player_health = player_get_health(player);
+    view->player_max_health = player_get_max_health(player);
+    view->player_invincible = player_is_invincible(player);
+    view->player_invincibility_timer = player_get_invincibility_timer(player);
+    
+    Map* current_map = state_get_current_map(state);
+    if (current_map) {
+        // Deep copy into the view's own storage, which only grows when this
+        // map holds more than any map copied before
+        map_copy(&view->map, current_map);
+    }
+    
+    const ProjectilePool* projectiles = state_get_projectiles(state);
+    view->projectile_count = projectiles->count;
+    for (int i = 0; i < projectiles->count; i++) {
+        view->projectile_positions[i] = (Vector2){projectiles->x[i], projectiles->y[i]};
+        view->projectile_previous_positions[i] = (Vector2){projectiles->previous_x[i], projectiles->previous_y[i]};
+    }
+    
+    int high_score_count;
+    const HighScore* high_scores = state_get_high_scores(state, &high_score_count);
+    view->high_score_count = high_score_count;
+    if (high_scores && high_score_count > 0) {
+        memcpy(view->high_scores, high_scores, sizeof(HighScore) * high_score_count);
+    }
+    
+    memcpy(view->player_name, state_get_player_name(state), sizeof(view->player_name));
+    view->name_char_count = state_get_name_char_count(state);
+    view->pending_score = *state_get_pending_score(state);
+}
+
+void render_state_release(RenderState* view) {
+    if (!view) return;
+    map_release(&view->map);
+}
+
+Vector2 render_state_get_player_position(const RenderState* view, float alpha) {
+    if (!view) return (Vector2){0, 0};
+    return (Vector2){
+        view->player_previous_position.x + (view->player_position.x - view->player_previous_position.x) * alpha,
+        view->player_previous_position.y + (view->player_position.y - view->player_previous_position.y) * alpha
+    };
+}
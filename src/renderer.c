@@ -1,12 +1,22 @@
 #include "../include/renderer.h"
 #include "../include/highscore.h"
+#include "../include/profiler.h"
+#include "../include/projectile.h"
+#include "../include/mem.h"
 #include "raylib.h"
 #include <stdio.h>
 #include <string.h>
 #include <math.h>
 
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
+#define PROFILER_OVERLAY_WIDTH 380
+#define PROFILER_ROW_HEIGHT 16
+#define PROFILER_GRAPH_HEIGHT 60
+#define PROFILER_GRAPH_MAX_MS 33.3f
+#define PROFILER_BUDGET_MS 16.7f
+#define MEMORY_OVERLAY_WIDTH 300
+#define INVINCIBILITY_BLINK_RATE 12.0f  // Fades in or out per second while invincible
+#define PROMPT_BLINK_RATE 2.0f          // Menu prompts show or hide per second
+#define END_SCREEN_SPIN_SPEED 120.0f    // Degrees per second the victory coins circle
 
 void renderer_init(void) {
 }
@@ -53,11 +63,11 @@ void renderer_draw_obstacle(Vector2 position, float radius, Color color) {
     DrawLineEx((Vector2){position.x - size, position.y + size}, (Vector2){position.x + size, position.y - size}, 3, WHITE);
 }
 
-void renderer_draw_player(Vector2 position, bool invincible, int invincibility_timer) {
+void renderer_draw_player(Vector2 position, bool invincible, float invincibility_timer) {
     Color player_color = BLUE;
     Color player_inner_color = DARKBLUE;
-    if (invincible && invincibility_timer > 0) {
-        if ((invincibility_timer / 5) % 2 == 0) {
+    if (invincible && invincibility_timer > 0.0f) {
+        if ((int)(invincibility_timer * INVINCIBILITY_BLINK_RATE) % 2 == 0) {
             player_color = (Color){player_color.r, player_color.g, player_color.b, 128};
             player_inner_color = (Color){player_inner_color.r, player_inner_color.g, player_inner_color.b, 128};
         } else {
@@ -95,7 +105,7 @@ void renderer_draw_health_bar(float x, float y, float width, float height, float
 
 void renderer_draw_text_centered(const char* text, int y, int font_size, Color color) {
     int width = MeasureText(text, font_size);
-    DrawText(text, SCREEN_WIDTH/2 - width/2, y, font_size, color);
+    DrawText(text, GetScreenWidth()/2 - width/2, y, font_size, color);
 }
 
 void renderer_draw_text(const char* text, int x, int y, int font_size, Color color) {
@@ -106,7 +116,144 @@ void renderer_draw_fps(int x, int y) {
     DrawFPS(x, y);
 }
 
-void renderer_draw_start_screen(int frame_count, const HighScore* high_scores, int high_score_count) {
+void renderer_draw_profiler_overlay(int x, int y) {
+    ProfilerZoneStats stats[PROFILER_MAX_ZONES];
+    int zone_count = profiler_get_zone_count();
+    for (int i = 0; i < zone_count; i++) {
+        if (!profiler_get_zone_stats(i, &stats[i])) {
+            zone_count = i;
+            break;
+        }
+    }
+    
+    // Depth-first order so children are listed under their parent
+    int order[PROFILER_MAX_ZONES];
+    int order_count = 0;
+    int stack[PROFILER_MAX_ZONES];
+    int top = 0;
+    for (int i = zone_count - 1; i >= 0; i--) {
+        if (stats[i].parent < 0) stack[top++] = i;
+    }
+    while (top > 0) {
+        int zone = stack[--top];
+        order[order_count++] = zone;
+        for (int i = zone_count - 1; i >= 0; i--) {
+            if (stats[i].parent == zone) stack[top++] = i;
+        }
+    }
+    
+    float frame_ms[PROFILER_HISTORY];
+    int frame_count = profiler_get_frame_times(frame_ms, PROFILER_HISTORY);
+    float frame_avg = 0.0f;
+    float frame_max = 0.0f;
+    for (int i = 0; i < frame_count; i++) {
+        frame_avg += frame_ms[i];
+        if (frame_ms[i] > frame_max) frame_max = frame_ms[i];
+    }
+    if (frame_count > 0) frame_avg /= frame_count;
+    
+    int height = 50 + (order_count + 1) * PROFILER_ROW_HEIGHT + PROFILER_GRAPH_HEIGHT;
+    DrawRectangle(x, y, PROFILER_OVERLAY_WIDTH, height, (Color){0, 0, 0, 200});
+    DrawRectangleLines(x, y, PROFILER_OVERLAY_WIDTH, height, DARKGRAY);
+    
+    char line[96];
+    snprintf(line, sizeof(line), "Frame  avg %.2f ms  max %.2f ms  (F3)", frame_avg, frame_max);
+    renderer_draw_text(line, x + 8, y + 6, 14, WHITE);
+    
+    int row_y = y + 26;
+    renderer_draw_text("zone", x + 8, row_y, 12, GRAY);
+    renderer_draw_text("avg ms", x + 220, row_y, 12, GRAY);
+    renderer_draw_text("max ms", x + 280, row_y, 12, GRAY);
+    renderer_draw_text("calls", x + 338, row_y, 12, GRAY);
+    row_y += PROFILER_ROW_HEIGHT;
+    
+    for (int i = 0; i < order_count; i++) {
+        const ProfilerZoneStats* zone = &stats[order[i]];
+        Color color = (zone->max_ms > PROFILER_BUDGET_MS) ? ORANGE : LIGHTGRAY;
+        renderer_draw_text(zone->name, x + 8 + zone->depth * 12, row_y, 12, color);
+        snprintf(line, sizeof(line), "%6.2f", zone->avg_ms);
+        renderer_draw_text(line, x + 220, row_y, 12, color);
+        snprintf(line, sizeof(line), "%6.2f", zone->max_ms);
+        renderer_draw_text(line, x + 280, row_y, 12, color);
+        snprintf(line, sizeof(line), "%d", zone->calls);
+        renderer_draw_text(line, x + 338, row_y, 12, color);
+        row_y += PROFILER_ROW_HEIGHT;
+    }
+    
+    // Frame time graph, newest frame on the right
+    int graph_x = x + 8;
+    int graph_y = row_y + 8;
+    int graph_width = PROFILER_OVERLAY_WIDTH - 16;
+    float bar_width = (float)graph_width / PROFILER_HISTORY;
+    DrawRectangle(graph_x, graph_y, graph_width, PROFILER_GRAPH_HEIGHT, (Color){30, 30, 30, 255});
+    
+    for (int i = 0; i < frame_count; i++) {
+        float t = frame_ms[i] / PROFILER_GRAPH_MAX_MS;
+        if (t > 1.0f) t = 1.0f;
+        int bar_height = (int)(t * PROFILER_GRAPH_HEIGHT);
+        int bar_x = graph_x + (int)((PROFILER_HISTORY - frame_count + i) * bar_width);
+        Color color = (frame_ms[i] > PROFILER_BUDGET_MS) ? RED : GREEN;
+        DrawRectangle(bar_x, graph_y + PROFILER_GRAPH_HEIGHT - bar_height,
+                      (int)bar_width > 0 ? (int)bar_width : 1, bar_height, color);
+    }
+    
+    int budget_y = graph_y + PROFILER_GRAPH_HEIGHT - (int)(PROFILER_BUDGET_MS / PROFILER_GRAPH_MAX_MS * PROFILER_GRAPH_HEIGHT);
+    DrawLine(graph_x, budget_y, graph_x + graph_width, budget_y, YELLOW);
+}
+
+void renderer_draw_memory_overlay(int x, int y) {
+    MemStats stats[MEM_TAG_COUNT];
+    int tags[MEM_TAG_COUNT];
+    int tag_count = 0;
+    for (int i = 0; i < MEM_TAG_COUNT; i++) {
+        mem_get_stats((MemTag)i, &stats[i]);
+        if (stats[i].total_allocations > 0) tags[tag_count++] = i;
+    }
+    MemResourceStats resources[MEM_RESOURCE_COUNT];
+    for (int i = 0; i < MEM_RESOURCE_COUNT; i++) {
+        mem_get_resource_stats((MemResource)i, &resources[i]);
+    }
+    MemStats total;
+    mem_get_total_stats(&total);
+    
+    int height = 50 + (tag_count + MEM_RESOURCE_COUNT + 1) * PROFILER_ROW_HEIGHT;
+    DrawRectangle(x, y, MEMORY_OVERLAY_WIDTH, height, (Color){0, 0, 0, 200});
+    DrawRectangleLines(x, y, MEMORY_OVERLAY_WIDTH, height, DARKGRAY);
+    
+    char line[96];
+    snprintf(line, sizeof(line), "Heap  %.1f KB  peak %.1f KB  (F4)", total.live_bytes / 1024.0, total.peak_bytes / 1024.0);
+    renderer_draw_text(line, x + 8, y + 6, 14, WHITE);
+    
+    int row_y = y + 26;
+    renderer_draw_text("subsystem", x + 8, row_y, 12, GRAY);
+    renderer_draw_text("live KB", x + 100, row_y, 12, GRAY);
+    renderer_draw_text("peak KB", x + 170, row_y, 12, GRAY);
+    renderer_draw_text("/frame", x + 240, row_y, 12, GRAY);
+    row_y += PROFILER_ROW_HEIGHT;
+    
+    // Any allocation in a frame is flagged: the steady state should have none
+    for (int i = 0; i < tag_count; i++) {
+        const MemStats* tag = &stats[tags[i]];
+        Color color = (tag->frame_allocations > 0) ? ORANGE : LIGHTGRAY;
+        renderer_draw_text(mem_get_tag_name((MemTag)tags[i]), x + 8, row_y, 12, color);
+        snprintf(line, sizeof(line), "%8.1f", tag->live_bytes / 1024.0);
+        renderer_draw_text(line, x + 100, row_y, 12, color);
+        snprintf(line, sizeof(line), "%8.1f", tag->peak_bytes / 1024.0);
+        renderer_draw_text(line, x + 170, row_y, 12, color);
+        snprintf(line, sizeof(line), "%lld", (long long)tag->frame_allocations);
+        renderer_draw_text(line, x + 240, row_y, 12, color);
+        row_y += PROFILER_ROW_HEIGHT;
+    }
+    
+    for (int i = 0; i < MEM_RESOURCE_COUNT; i++) {
+        snprintf(line, sizeof(line), "%s: %lld live, %lld at most, %lld loaded", mem_get_resource_name((MemResource)i),
+                 (long long)resources[i].live, (long long)resources[i].peak, (long long)resources[i].total);
+        renderer_draw_text(line, x + 8, row_y, 12, LIGHTGRAY);
+        row_y += PROFILER_ROW_HEIGHT;
+    }
+}
+
+void renderer_draw_start_screen(float time, const HighScore* high_scores, int high_score_count) {
     ClearBackground((Color){30, 30, 50, 255});
     
     renderer_draw_text_centered("COIN COLLECTOR", 150, 60, GOLD);
@@ -116,7 +263,7 @@ void renderer_draw_start_screen(int frame_count, const HighScore* high_scores, i
     renderer_draw_text_centered("Avoid red obstacles - they will kill you!", 340, 20, RED);
     renderer_draw_text_centered("Press H to view high scores", 380, 18, YELLOW);
     
-    if ((frame_count / 30) % 2 == 0) {
+    if ((int)(time * PROMPT_BLINK_RATE) % 2 == 0) {
         renderer_draw_text_centered("Press SPACE or ENTER to choose mode", 450, 28, YELLOW);
     }
     
@@ -134,15 +281,15 @@ void renderer_draw_start_screen(int frame_count, const HighScore* high_scores, i
         int max_display = (high_score_count < 3) ? high_score_count : 3;
         for (int i = 0; i < max_display; i++) {
             char score_text[120];
-            snprintf(score_text, sizeof(score_text), "%d. %s - %d frames", 
-                     i + 1, high_scores[i].name, high_scores[i].frame_count);
+            snprintf(score_text, sizeof(score_text), "%d. %s - %.2f s", 
+                     i + 1, high_scores[i].name, high_scores[i].completion_time);
             renderer_draw_text_centered(score_text, y_offset, 16, WHITE);
             y_offset += 18;
         }
     }
 }
 
-void renderer_draw_end_screen(int frame_count, int game_start_frame, int total_coins, float health, float max_health,
+void renderer_draw_end_screen(float time, float completion_time, int total_coins, float health, float max_health,
                               const HighScore* high_scores, int high_score_count) {
     ClearBackground((Color){20, 50, 20, 255});
     
@@ -152,46 +299,45 @@ void renderer_draw_end_screen(int frame_count, int game_start_frame, int total_c
     snprintf(stats, sizeof(stats), "You collected all %d coins!", total_coins);
     renderer_draw_text_centered(stats, 220, 32, WHITE);
     
-    int completion_frames = frame_count - game_start_frame;
-    char frames[100];
-    snprintf(frames, sizeof(frames), "Completion time: %d frames", completion_frames);
-    renderer_draw_text_centered(frames, 260, 24, LIGHTGRAY);
+    char completion[100];
+    snprintf(completion, sizeof(completion), "Completion time: %.2f s", completion_time);
+    renderer_draw_text_centered(completion, 260, 24, LIGHTGRAY);
     
     char health_text[100];
     snprintf(health_text, sizeof(health_text), "Health remaining: %.0f/%.0f", health, max_health);
     renderer_draw_text_centered(health_text, 290, 24, LIGHTGRAY);
     
     if (high_score_count > 0) {
-        renderer_draw_text_centered("HIGH SCORES (Lowest frames = Best)", 330, 20, GOLD);
+        renderer_draw_text_centered("HIGH SCORES (Lowest time = Best)", 330, 20, GOLD);
         int y_offset = 355;
         int max_display = (high_score_count < 5) ? high_score_count : 5;
         for (int i = 0; i < max_display; i++) {
             char score_text[150];
-            snprintf(score_text, sizeof(score_text), "%d. %s - %d frames | Coins: %d | HP: %.0f", 
-                     i + 1, high_scores[i].name, high_scores[i].frame_count, 
+            snprintf(score_text, sizeof(score_text), "%d. %s - %.2f s | Coins: %d | HP: %.0f", 
+                     i + 1, high_scores[i].name, high_scores[i].completion_time, 
                      high_scores[i].coins_collected, high_scores[i].health_remaining);
             renderer_draw_text_centered(score_text, y_offset, 16, WHITE);
             y_offset += 18;
         }
     }
     
-    if ((frame_count / 30) % 2 == 0) {
+    if ((int)(time * PROMPT_BLINK_RATE) % 2 == 0) {
         renderer_draw_text_centered("Press SPACE or ENTER to play again", 480, 28, YELLOW);
     }
     renderer_draw_text_centered("Press ESC to quit", 520, 24, LIGHTGRAY);
     
     for (int i = 0; i < 8; i++) {
-        float angle = (frame_count * 2 + i * 45) * DEG2RAD;
+        float angle = (time * END_SCREEN_SPIN_SPEED + i * 45) * DEG2RAD;
         float radius = 100;
-        float x = SCREEN_WIDTH/2 + cosf(angle) * radius;
-        float y = SCREEN_HEIGHT/2 + 50 + sinf(angle) * radius;
+        float x = GetScreenWidth()/2 + cosf(angle) * radius;
+        float y = GetScreenHeight()/2 + 50 + sinf(angle) * radius;
         DrawCircleV((Vector2){x, y}, COIN_RADIUS, GOLD);
         DrawCircleV((Vector2){x, y}, COIN_RADIUS - 2, YELLOW);
         DrawCircleLinesV((Vector2){x, y}, COIN_RADIUS, ORANGE);
     }
 }
 
-void renderer_draw_mode_select_screen(int frame_count, int selected_mode) {
+void renderer_draw_mode_select_screen(float time, int selected_mode) {
     ClearBackground((Color){30, 30, 50, 255});
     
     renderer_draw_text_centered("SELECT GAME MODE", 150, 50, GOLD);
@@ -201,8 +347,8 @@ void renderer_draw_mode_select_screen(int frame_count, int selected_mode) {
     Color mode2d_bg = (selected_mode == 0) ? (Color){60, 60, 80, 255} : (Color){40, 40, 60, 255};
     
     int mode2d_y = 250;
-    DrawRectangle(SCREEN_WIDTH/2 - 200, mode2d_y - 30, 400, 80, mode2d_bg);
-    DrawRectangleLinesEx((Rectangle){SCREEN_WIDTH/2 - 200, mode2d_y - 30, 400, 80}, 3, mode2d_color);
+    DrawRectangle(GetScreenWidth()/2 - 200, mode2d_y - 30, 400, 80, mode2d_bg);
+    DrawRectangleLinesEx((Rectangle){GetScreenWidth()/2 - 200, mode2d_y - 30, 400, 80}, 3, mode2d_color);
     renderer_draw_text_centered("2D MODE", mode2d_y, 32, mode2d_color);
     renderer_draw_text_centered("Top-down view with full map", mode2d_y + 35, 18, LIGHTGRAY);
     
@@ -211,31 +357,31 @@ void renderer_draw_mode_select_screen(int frame_count, int selected_mode) {
     Color mode3d_bg = (selected_mode == 1) ? (Color){60, 60, 80, 255} : (Color){40, 40, 60, 255};
     
     int mode3d_y = 380;
-    DrawRectangle(SCREEN_WIDTH/2 - 200, mode3d_y - 30, 400, 80, mode3d_bg);
-    DrawRectangleLinesEx((Rectangle){SCREEN_WIDTH/2 - 200, mode3d_y - 30, 400, 80}, 3, mode3d_color);
+    DrawRectangle(GetScreenWidth()/2 - 200, mode3d_y - 30, 400, 80, mode3d_bg);
+    DrawRectangleLinesEx((Rectangle){GetScreenWidth()/2 - 200, mode3d_y - 30, 400, 80}, 3, mode3d_color);
     renderer_draw_text_centered("3D MODE", mode3d_y, 32, mode3d_color);
     renderer_draw_text_centered("First-person raycast view", mode3d_y + 35, 18, LIGHTGRAY);
     
     renderer_draw_text_centered("Use UP/DOWN arrows to select", 480, 20, LIGHTGRAY);
-    if ((frame_count / 30) % 2 == 0) {
+    if ((int)(time * PROMPT_BLINK_RATE) % 2 == 0) {
         renderer_draw_text_centered("Press ENTER to start", 510, 24, YELLOW);
     }
     renderer_draw_text_centered("Press ESC to go back", 540, 18, GRAY);
 }
 
-void renderer_draw_name_entry_screen(const char* player_name, int name_length, int frame_count, int coins_collected, float health_remaining) {
+void renderer_draw_name_entry_screen(const char* player_name, int name_length, float completion_time, int coins_collected, float health_remaining) {
     ClearBackground((Color){30, 30, 50, 255});
     
     renderer_draw_text_centered("ENTER YOUR NAME", 200, 50, GOLD);
     
     char score_info[150];
-    snprintf(score_info, sizeof(score_info), "Frames: %d | Coins: %d | HP: %.0f", 
-             frame_count, coins_collected, health_remaining);
+    snprintf(score_info, sizeof(score_info), "Time: %.2f s | Coins: %d | HP: %.0f", 
+             completion_time, coins_collected, health_remaining);
     renderer_draw_text_centered(score_info, 280, 24, WHITE);
     
     int box_width = 400;
     int box_height = 50;
-    int box_x = SCREEN_WIDTH/2 - box_width/2;
+    int box_x = GetScreenWidth()/2 - box_width/2;
     int box_y = 350;
     
     DrawRectangle(box_x, box_y, box_width, box_height, DARKGRAY);
@@ -252,19 +398,19 @@ void renderer_draw_high_scores_screen(const HighScore* high_scores, int high_sco
     ClearBackground((Color){20, 20, 40, 255});
     
     renderer_draw_text_centered("HIGH SCORES", 50, 60, GOLD);
-    renderer_draw_text_centered("Lowest frames = Best score", 120, 20, LIGHTGRAY);
+    renderer_draw_text_centered("Lowest time = Best score", 120, 20, LIGHTGRAY);
     
     if (high_score_count > 0) {
         int y_offset = 180;
         int max_display = (high_score_count < MAX_HIGH_SCORES) ? high_score_count : MAX_HIGH_SCORES;
         
-        renderer_draw_text_centered("Rank  Name                Frames  Coins  HP", y_offset, 18, YELLOW);
+        renderer_draw_text_centered("Rank  Name                  Time  Coins  HP", y_offset, 18, YELLOW);
         y_offset += 35;
         
         for (int i = 0; i < max_display; i++) {
             char score_text[200];
-            snprintf(score_text, sizeof(score_text), "%2d.   %-20s %6d  %5d  %.0f", 
-                     i + 1, high_scores[i].name, high_scores[i].frame_count, 
+            snprintf(score_text, sizeof(score_text), "%2d.   %-20s %6.2f  %5d  %.0f", 
+                     i + 1, high_scores[i].name, high_scores[i].completion_time, 
                      high_scores[i].coins_collected, high_scores[i].health_remaining);
             renderer_draw_text_centered(score_text, y_offset, 18, WHITE);
             y_offset += 25;
@@ -273,7 +419,7 @@ void renderer_draw_high_scores_screen(const HighScore* high_scores, int high_sco
         renderer_draw_text_centered("No high scores yet!", 300, 32, LIGHTGRAY);
     }
     
-    renderer_draw_text_centered("Press ESC, H, SPACE, or ENTER to return", SCREEN_HEIGHT - 50, 24, YELLOW);
+    renderer_draw_text_centered("Press ESC, H, SPACE, or ENTER to return", GetScreenHeight() - 50, 24, YELLOW);
 }
 
 void renderer_draw_projectile(Vector2 position, float radius) {
@@ -282,9 +428,10 @@ void renderer_draw_projectile(Vector2 position, float radius) {
     DrawCircleLinesV(position, radius, (Color){255, 140, 0, 255});  // Orange color
 }
 
-void renderer_draw_game_screen(const Map* current_map, Vector2 player_position, bool invincible, int invincibility_timer,
+void renderer_draw_game_screen(const Map* current_map, Vector2 player_position, bool invincible, float invincibility_timer,
                                float health, float max_health, int current_map_id, int coins_collected,
-                               Projectile** projectiles, int projectile_count) {
+                               const Vector2* projectile_positions, const Vector2* projectile_previous_positions,
+                               int projectile_count, float alpha) {
     if (!current_map) return;
     
     renderer_draw_map(current_map);
@@ -295,22 +442,23 @@ void renderer_draw_game_screen(const Map* current_map, Vector2 player_position,
         renderer_draw_coin(coins[i].position, coins[i].collected);
     }
     
-    int obstacle_count;
-    const Obstacle* obstacles = map_get_obstacles(current_map, &obstacle_count);
-    for (int i = 0; i < obstacle_count; i++) {
-        renderer_draw_obstacle(obstacles[i].position, obstacles[i].radius, obstacles[i].color);
+    const ObstacleSet* obstacles = map_get_obstacles(current_map);
+    for (int i = 0; i < obstacles->count; i++) {
+        renderer_draw_obstacle(map_get_obstacle_interpolated_position(current_map, i, alpha),
+                               OBSTACLE_RADIUS, obstacles->color[i]);
     }
     
     // Draw projectiles
     for (int i = 0; i < projectile_count; i++) {
-        if (projectiles[i] && projectile_is_active(projectiles[i])) {
-            Vector2 proj_pos = projectile_get_position(projectiles[i]);
-            float proj_radius = projectile_get_radius(projectiles[i]);
-            renderer_draw_projectile(proj_pos, proj_radius);
-        }
+        Vector2 proj_pos = {
+            projectile_previous_positions[i].x + (projectile_positions[i].x - projectile_previous_positions[i].x) * alpha,
+            projectile_previous_positions[i].y + (projectile_positions[i].y - projectile_previous_positions[i].y) * alpha
+        };
+        renderer_draw_projectile(proj_pos, PROJECTILE_RADIUS);
     }
     
-    renderer_draw_health_bar(SCREEN_WIDTH - 220, 20, 200, 20, health, max_health);
+    PROFILE_BEGIN("hud");
+    renderer_draw_health_bar(GetScreenWidth() - 220, 20, 200, 20, health, max_health);
     
     renderer_draw_text("WASD to move", 10, 10, 20, BLACK);
     char map_text[50];
@@ -321,6 +469,7 @@ void renderer_draw_game_screen(const Map* current_map, Vector2 player_position,
     renderer_draw_text(coin_text, 10, 60, 20, GOLD);
     renderer_draw_text("Click or SPACE+Arrow to shoot", 10, 85, 18, DARKGRAY);
     renderer_draw_fps(10, 110);
+    PROFILE_END();
     
     renderer_draw_player(player_position, invincible, invincibility_timer);
 }
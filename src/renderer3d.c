@@ -3,113 +3,288 @@
 #include "../include/player.h"
 #include "../include/raycaster.h"
 #include "../include/renderer.h"
+#include "../include/profiler.h"
+#include "../include/mem.h"
 #include "raylib.h"
 #include <math.h>
 #include <stdio.h>
 
-#define SCREEN_WIDTH 800
-#define SCREEN_HEIGHT 600
 #define FOV_RADIANS (RAYCASTER_FOV * DEG2RAD)
+#define RENDERER3D_MIN_SPRITES 16  // Smallest sprite list allocated
+
+// Wall slice for one view column
+typedef struct {
+    bool hit;
+    int top;
+    int bottom;
+    Color color;
+    float distance;
+} WallStrip;
+
+// Shared input and output of the parallel ray casting jobs
+typedef struct {
+    const Map* map;
+    Vector2 player_pos;
+    float start_angle;
+    float angle_step;
+    int view_height;
+    float height_scale;  // View height relative to RAYCASTER_REFERENCE_HEIGHT
+    WallStrip* strips;
+} RayCastJob;
+
+// Offscreen view that is cast at a variable resolution and scaled to the window
+static struct {
+    RenderTexture2D target;
+    int columns;         // Current ray count (0 = not chosen yet)
+    int min_columns;
+    int max_columns;
+    float smoothed_ms;   // Frame time after smoothing
+    int cooldown;        // Frames to wait before the next resize
+} g_view = {{0}, 0, RENDERER3D_MIN_COLUMNS, RENDERER3D_MAX_COLUMNS, 0.0f, 0};
+
+static JobSystem* g_jobs = NULL;
 
 void renderer3d_init(void) {
     // Initialize 3D renderer if needed
 }
 
+void renderer3d_shutdown(void) {
+    if (g_view.target.id != 0) {
+        UnloadRenderTexture(g_view.target);
+        mem_track_resource(MEM_RESOURCE_RENDER_TEXTURE, -1);
+        g_view.target = (RenderTexture2D){0};
+    }
+}
+
+void renderer3d_set_jobs(JobSystem* jobs) {
+    g_jobs = jobs;
+}
+
+/**
+ * Resize one array of a sprite list.
+ * @param array Array to resize; left as it was on failure
+ * @param capacity New element count
+ * @param element_size Size of one element
+ * @return true on success, false otherwise
+ */
+static bool renderer3d_grow_array(void** array, int capacity, size_t element_size) {
+    void* grown = mem_realloc(MEM_TAG_GAME, *array, element_size * (size_t)capacity);
+    if (!grown) return false;
+    *array = grown;
+    return true;
+}
+
+bool renderer3d_reserve_sprites(SpriteList* list, int capacity) {
+    if (!list) return false;
+    if (capacity <= list->capacity) return true;
+    
+    // Double so a slowly growing count doesn't reallocate every frame
+    int grown = list->capacity * 2;
+    if (grown < RENDERER3D_MIN_SPRITES) grown = RENDERER3D_MIN_SPRITES;
+    if (grown < capacity) grown = capacity;
+    
+    // Arrays that did grow stay valid, so a failure part way is safe
+    if (!renderer3d_grow_array((void**)&list->positions, grown, sizeof(Vector2)) ||
+        !renderer3d_grow_array((void**)&list->colors, grown, sizeof(Color)) ||
+        !renderer3d_grow_array((void**)&list->distances, grown, sizeof(float)) ||
+        !renderer3d_grow_array((void**)&list->angles, grown, sizeof(float)) ||
+        !renderer3d_grow_array((void**)&list->order, grown, sizeof(int))) {
+        printf("Error: Failed to grow sprite list to %d sprites\n", grown);
+        return false;
+    }
+    list->capacity = grown;
+    return true;
+}
+
+void renderer3d_release_sprites(SpriteList* list) {
+    if (!list) return;
+    mem_free(list->positions);
+    mem_free(list->colors);
+    mem_free(list->distances);
+    mem_free(list->angles);
+    mem_free(list->order);
+    *list = (SpriteList){0};
+}
+
+/**
+ * Clamp a ray count to the allowed range and round it down to a multiple
+ * of RENDERER3D_COLUMN_STEP.
+ * @param columns Requested ray count
+ * @return Usable ray count
+ */
+static int renderer3d_clamp_columns(int columns) {
+    columns -= columns % RENDERER3D_COLUMN_STEP;
+    if (columns < g_view.min_columns) columns = g_view.min_columns;
+    if (columns > g_view.max_columns) columns = g_view.max_columns;
+    return columns;
+}
+
+void renderer3d_set_column_range(int min_columns, int max_columns) {
+    if (min_columns < 1) min_columns = 1;
+    if (max_columns > RENDERER3D_MAX_COLUMNS) max_columns = RENDERER3D_MAX_COLUMNS;
+    if (max_columns < min_columns) max_columns = min_columns;
+    
+    g_view.min_columns = min_columns;
+    g_view.max_columns = max_columns;
+    if (g_view.columns != 0) {
+        g_view.columns = renderer3d_clamp_columns(g_view.columns);
+    }
+}
+
+void renderer3d_update_resolution(float frame_ms, float budget_ms) {
+    if (frame_ms <= 0.0f || budget_ms <= 0.0f || g_view.columns == 0) return;
+    
+    // Smooth out single slow frames so the view doesn't flicker between sizes
+    if (g_view.smoothed_ms <= 0.0f) {
+        g_view.smoothed_ms = frame_ms;
+    } else {
+        g_view.smoothed_ms += (frame_ms - g_view.smoothed_ms) * RENDERER3D_SMOOTHING;
+    }
+    
+    if (g_view.cooldown > 0) {
+        g_view.cooldown--;
+        return;
+    }
+    
+    int columns = g_view.columns;
+    if (g_view.smoothed_ms > budget_ms * RENDERER3D_DOWNSCALE_LOAD) {
+        columns = (int)(columns * RENDERER3D_DOWNSCALE_FACTOR);
+    } else if (g_view.smoothed_ms < budget_ms * RENDERER3D_UPSCALE_LOAD) {
+        columns = (int)(columns * RENDERER3D_UPSCALE_FACTOR) + RENDERER3D_COLUMN_STEP;
+    }
+    columns = renderer3d_clamp_columns(columns);
+    
+    if (columns != g_view.columns) {
+        g_view.columns = columns;
+        g_view.cooldown = RENDERER3D_RESIZE_COOLDOWN;
+    }
+}
+
+int renderer3d_get_columns(void) {
+    return g_view.columns;
+}
+
+/**
+ * Make sure the offscreen target matches the requested view size.
+ * @param width View width in pixels
+ * @param height View height in pixels
+ * @return true if the target is usable, false otherwise
+ */
+static bool renderer3d_prepare_target(int width, int height) {
+    if (g_view.target.id != 0 && g_view.target.texture.width == width && g_view.target.texture.height == height) {
+        return true;
+    }
+    
+    renderer3d_shutdown();
+    g_view.target = LoadRenderTexture(width, height);
+    if (g_view.target.id == 0) {
+        printf("Error: Could not create %dx%d 3D view target\n", width, height);
+        return false;
+    }
+    mem_track_resource(MEM_RESOURCE_RENDER_TEXTURE, 1);
+    SetTextureFilter(g_view.target.texture, TEXTURE_FILTER_BILINEAR);
+    return true;
+}
+
+/**
+ * Cast the rays for a range of view columns. Each column writes only its
+ * own strip, so ranges can run on different threads.
+ * @param user_data The RayCastJob
+ * @param begin First column
+ * @param end One past the last column
+ */
+static void renderer3d_cast_columns(void* user_data, int begin, int end) {
+    const RayCastJob* job = (const RayCastJob*)user_data;
+    int half_height = job->view_height / 2;
+    
+    for (int x = begin; x < end; x++) {
+        float ray_angle = job->start_angle + x * job->angle_step;
+        RaycastResult result = raycaster_cast_ray(job->player_pos, ray_angle, job->map);
+        
+        WallStrip* strip = &job->strips[x];
+        strip->hit = result.hit;
+        if (!result.hit) continue;
+        
+        // Calculate top and bottom of wall strip
+        int half_wall = (int)(result.wall_height * job->height_scale / 2.0f);
+        int wall_top = half_height - half_wall;
+        int wall_bottom = half_height + half_wall;
+        
+        if (wall_top < 0) wall_top = 0;
+        if (wall_bottom > job->view_height) wall_bottom = job->view_height;
+        
+        strip->top = wall_top;
+        strip->bottom = wall_bottom;
+        strip->color = result.color;
+        strip->distance = result.perp_distance;
+    }
+}
+
 void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
                       float health, float max_health, int current_map_id, int coins_collected,
-                      Vector2* enemy_positions, int enemy_count, Color* enemy_colors,
-                      Vector2* coin_positions, int coin_count, bool* coin_collected) {
+                      SpriteList* enemies, SpriteList* coins) {
     if (!map) return;
     
-    // Clear screen with floor and ceiling colors (gradient effect)
+    int screen_width = GetScreenWidth();
+    int screen_height = GetScreenHeight();
+    if (screen_width <= 0 || screen_height <= 0) return;
+    
+    // The view keeps the window's aspect ratio at the current ray count
+    if (g_view.columns == 0) {
+        g_view.columns = renderer3d_clamp_columns(screen_width);
+    }
+    int view_width = g_view.columns;
+    int view_height = (int)((long)view_width * screen_height / screen_width);
+    if (view_height < 1) view_height = 1;
+    float height_scale = view_height / RAYCASTER_REFERENCE_HEIGHT;
+    
+    bool offscreen = renderer3d_prepare_target(view_width, view_height);
+    if (offscreen) {
+        BeginTextureMode(g_view.target);
+    }
+    
+    // Floor and ceiling colors (gradient effect)
     Color floor_color_dark = (Color){30, 30, 30, 255};
     Color floor_color_light = (Color){60, 60, 60, 255};
     Color ceiling_color_dark = (Color){80, 80, 100, 255};
     Color ceiling_color_light = (Color){120, 120, 140, 255};
     
-    // Draw gradient ceiling
-    for (int y = 0; y < SCREEN_HEIGHT / 2; y++) {
-        float t = (float)y / (SCREEN_HEIGHT / 2.0f);
-        Color c = {
-            (unsigned char)(ceiling_color_dark.r + (ceiling_color_light.r - ceiling_color_dark.r) * t),
-            (unsigned char)(ceiling_color_dark.g + (ceiling_color_light.g - ceiling_color_dark.g) * t),
-            (unsigned char)(ceiling_color_dark.b + (ceiling_color_light.b - ceiling_color_dark.b) * t),
-            255
-        };
-        DrawLine(0, y, SCREEN_WIDTH, y, c);
-    }
+    DrawRectangleGradientV(0, 0, view_width, view_height / 2, ceiling_color_dark, ceiling_color_light);
+    DrawRectangleGradientV(0, view_height / 2, view_width, view_height - view_height / 2, floor_color_light, floor_color_dark);
     
-    // Draw gradient floor
-    for (int y = SCREEN_HEIGHT / 2; y < SCREEN_HEIGHT; y++) {
-        float t = (float)(y - SCREEN_HEIGHT / 2) / (SCREEN_HEIGHT / 2.0f);
-        Color c = {
-            (unsigned char)(floor_color_light.r + (floor_color_dark.r - floor_color_light.r) * t),
-            (unsigned char)(floor_color_light.g + (floor_color_dark.g - floor_color_light.g) * t),
-            (unsigned char)(floor_color_light.b + (floor_color_dark.b - floor_color_light.b) * t),
-            255
-        };
-        DrawLine(0, y, SCREEN_WIDTH, y, c);
-    }
+    // Cast one ray per view column, spread over the job system
+    static WallStrip wall_strips[RENDERER3D_MAX_COLUMNS];
     
-    // Store wall rendering data for depth sorting
-    typedef struct {
-        int x;
-        int top;
-        int bottom;
-        Color color;
-        float distance;
-    } WallStrip;
-    
-    static WallStrip wall_strips[SCREEN_WIDTH];
-    int strip_count = 0;
-    
-    // Cast rays for each column of the screen
-    int num_rays = SCREEN_WIDTH;
-    float ray_angle_step = FOV_RADIANS / num_rays;
-    float start_angle = player_angle - FOV_RADIANS / 2.0f;
-    
-    for (int x = 0; x < num_rays; x++) {
-        float ray_angle = start_angle + x * ray_angle_step;
-        
-        // Cast ray
-        RaycastResult result = raycaster_cast_ray(player_pos, ray_angle, map);
-        
-        if (result.hit) {
-            // Use perpendicular distance from result
-            float perp_distance = result.perp_distance;
-            float wall_height = result.wall_height;
-            
-            // Calculate top and bottom of wall strip
-            int wall_top = (SCREEN_HEIGHT / 2) - (int)(wall_height / 2.0f);
-            int wall_bottom = (SCREEN_HEIGHT / 2) + (int)(wall_height / 2.0f);
-            
-            if (wall_top < 0) wall_top = 0;
-            if (wall_bottom > SCREEN_HEIGHT) wall_bottom = SCREEN_HEIGHT;
-            
-            // Store wall strip for rendering
-            if (strip_count < SCREEN_WIDTH) {
-                wall_strips[strip_count].x = x;
-                wall_strips[strip_count].top = wall_top;
-                wall_strips[strip_count].bottom = wall_bottom;
-                wall_strips[strip_count].color = result.color;
-                wall_strips[strip_count].distance = perp_distance;
-                strip_count++;
-            }
-        }
-    }
+    PROFILE_BEGIN("raycast");
+    RayCastJob ray_job = {
+        .map = map,
+        .player_pos = player_pos,
+        .start_angle = player_angle - FOV_RADIANS / 2.0f,
+        .angle_step = FOV_RADIANS / view_width,
+        .view_height = view_height,
+        .height_scale = height_scale,
+        .strips = wall_strips
+    };
+    jobs_parallel_for(g_jobs, view_width, RENDERER3D_RAY_GRAIN, renderer3d_cast_columns, &ray_job);
+    PROFILE_END();
     
     // Render walls
-    for (int i = 0; i < strip_count; i++) {
-        DrawLine(wall_strips[i].x, wall_strips[i].top, wall_strips[i].x, wall_strips[i].bottom, wall_strips[i].color);
+    PROFILE_BEGIN("walls");
+    for (int x = 0; x < view_width; x++) {
+        if (wall_strips[x].hit) {
+            DrawLine(x, wall_strips[x].top, x, wall_strips[x].bottom, wall_strips[x].color);
+        }
     }
+    PROFILE_END();
     
     // Render enemies as sprites
-    if (enemy_positions && enemy_colors && enemy_count > 0) {
-        float enemy_distances[50];
-        float sprite_angles[50];
-        int enemy_indices[50];  // Store original indices
+    PROFILE_BEGIN("sprites");
+    if (enemies && enemies->count > 0) {
+        float* enemy_distances = enemies->distances;
+        float* sprite_angles = enemies->angles;
+        int* enemy_indices = enemies->order;
         int visible_count = raycaster_find_visible_enemies(player_pos, player_angle, map, RAYCASTER_MAX_DISTANCE,
-                                                           enemy_positions, enemy_count, enemy_distances, sprite_angles);
+                                                           enemies->positions, enemies->count, enemy_distances, sprite_angles);
         
         // Initialize indices
         for (int i = 0; i < visible_count; i++) {
@@ -138,10 +313,11 @@ void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
             float sprite_size = (50.0f / dist) * 200.0f;
             if (sprite_size < 5.0f) sprite_size = 5.0f;
             if (sprite_size > 100.0f) sprite_size = 100.0f;
+            sprite_size *= height_scale;
             
-            // Calculate screen position
-            float screen_x = SCREEN_WIDTH / 2.0f + (sprite_angle / (FOV_RADIANS / 2.0f)) * (SCREEN_WIDTH / 2.0f);
-            float screen_y = SCREEN_HEIGHT / 2.0f;
+            // Calculate view position
+            float screen_x = view_width / 2.0f + (sprite_angle / (FOV_RADIANS / 2.0f)) * (view_width / 2.0f);
+            float screen_y = view_height / 2.0f;
             
             // Apply distance shading
             float shade = 1.0f / (1.0f + dist * 0.005f);
@@ -149,9 +325,9 @@ void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
             if (shade > 1.0f) shade = 1.0f;
             
             Color sprite_color = {
-                (unsigned char)(enemy_colors[idx].r * shade),
-                (unsigned char)(enemy_colors[idx].g * shade),
-                (unsigned char)(enemy_colors[idx].b * shade),
+                (unsigned char)(enemies->colors[idx].r * shade),
+                (unsigned char)(enemies->colors[idx].g * shade),
+                (unsigned char)(enemies->colors[idx].b * shade),
                 255
             };
             
@@ -163,19 +339,16 @@ void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
     }
     
     // Render coins as sprites
-    if (coin_positions && coin_collected && coin_count > 0) {
-        float coin_distances[50];
-        float coin_sprite_angles[50];
-        int coin_indices[50];  // Store original indices
+    if (coins && coins->count > 0) {
+        float* coin_distances = coins->distances;
+        float* coin_sprite_angles = coins->angles;
+        int* coin_indices = coins->order;
         int visible_coin_count = 0;
         float fov_half = FOV_RADIANS / 2.0f;
         
         // Find visible coins
-        for (int i = 0; i < coin_count && visible_coin_count < 50; i++) {
-            // Skip collected coins
-            if (coin_collected[i]) continue;
-            
-            Vector2 coin_pos = coin_positions[i];
+        for (int i = 0; i < coins->count; i++) {
+            Vector2 coin_pos = coins->positions[i];
             Vector2 to_coin = {
                 coin_pos.x - player_pos.x,
                 coin_pos.y - player_pos.y
@@ -197,8 +370,8 @@ void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
                 // Check if there's a wall blocking the view
                 RaycastResult result = raycaster_cast_ray(player_pos, coin_angle, map);
                 if (!result.hit || result.distance > dist) {
-                    coin_distances[visible_coin_count] = dist;
-                    coin_sprite_angles[visible_coin_count] = angle_diff;
+                    coin_distances[i] = dist;
+                    coin_sprite_angles[i] = angle_diff;
                     coin_indices[visible_coin_count] = i;
                     visible_coin_count++;
                 }
@@ -227,10 +400,11 @@ void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
             float sprite_size = (30.0f / dist) * 200.0f;
             if (sprite_size < 3.0f) sprite_size = 3.0f;
             if (sprite_size > 60.0f) sprite_size = 60.0f;
+            sprite_size *= height_scale;
             
-            // Calculate screen position
-            float screen_x = SCREEN_WIDTH / 2.0f + (sprite_angle / (FOV_RADIANS / 2.0f)) * (SCREEN_WIDTH / 2.0f);
-            float screen_y = SCREEN_HEIGHT / 2.0f;
+            // Calculate view position
+            float screen_x = view_width / 2.0f + (sprite_angle / (FOV_RADIANS / 2.0f)) * (view_width / 2.0f);
+            float screen_y = view_height / 2.0f;
             
             // Apply distance shading
             float shade = 1.0f / (1.0f + dist * 0.005f);
@@ -260,8 +434,21 @@ void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
         }
     }
     
-    // Draw UI overlay
-    renderer_draw_health_bar(SCREEN_WIDTH - 220, 20, 200, 20, health, max_health);
+    PROFILE_END();
+    
+    // Scale the view up (or down) to the window
+    if (offscreen) {
+        EndTextureMode();
+        PROFILE_BEGIN("upscale");
+        Rectangle source = {0.0f, 0.0f, (float)view_width, -(float)view_height};  // Render textures are stored upside down
+        Rectangle dest = {0.0f, 0.0f, (float)screen_width, (float)screen_height};
+        DrawTexturePro(g_view.target.texture, source, dest, (Vector2){0.0f, 0.0f}, 0.0f, WHITE);
+        PROFILE_END();
+    }
+    
+    // Draw UI overlay at window resolution
+    PROFILE_BEGIN("hud");
+    renderer_draw_health_bar(screen_width - 220, 20, 200, 20, health, max_health);
     
     char map_text[50];
     snprintf(map_text, sizeof(map_text), "Map: %d", current_map_id);
@@ -274,8 +461,13 @@ void renderer3d_render(const Map* map, Vector2 player_pos, float player_angle,
     renderer_draw_text("WASD to move, Mouse to look, Q/E to turn", 10, 60, 18, WHITE);
     renderer_draw_fps(10, 85);
     
+    char view_text[50];
+    snprintf(view_text, sizeof(view_text), "View: %dx%d", view_width, view_height);
+    renderer_draw_text(view_text, 10, 110, 18, LIGHTGRAY);
+    
     // Draw minimap
-    renderer3d_draw_minimap(map, player_pos, player_angle, SCREEN_WIDTH - 150, SCREEN_HEIGHT - 150, 140);
+    renderer3d_draw_minimap(map, player_pos, player_angle, screen_width - 150, screen_height - 150, 140);
+    PROFILE_END();
 }
 
 void renderer3d_draw_minimap(const Map* map, Vector2 player_pos, float player_angle,
@@ -287,7 +479,7 @@ void renderer3d_draw_minimap(const Map* map, Vector2 player_pos, float player_an
     DrawRectangleLines(x, y, size, size, WHITE);
     
     // Scale factor for minimap
-    float scale = size / 800.0f;  // Assuming map is 800x600
+    float scale = size / (float)WORLD_WIDTH;
     
     // Draw walls
     int wall_count;
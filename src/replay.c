@@ -0,0 +1,685 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "../include/replay.h"
+#include "../include/mem.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+// File layout, all integers as LEB128 varints unless noted:
+//   "GERP" (4 bytes), version (1 byte), seed, tick rate, tick count
+//   input segments, one per keyframe (or a single one without keyframes):
+//     repeat, frame, repeat, frame, ..., repeat
+//   keyframe data, back to back
+//   index: keyframe count, then per keyframe its tick, the offset of its
+//     input segment from the end of the header, and its data size
+//   index offset from the start of the file (8 bytes, little endian), "GERI"
+// A repeat is the number of ticks whose input equals the previous tick's
+// (the first tick of a segment is compared against no input, so decoding
+// can start at any keyframe). A frame holds one byte of REPLAY_FIELD_*
+// flags followed by only the fields that changed: held and pressed
+// buttons, mouse x and y as zigzag deltas in 1/16 pixels, and the typed
+// characters (count, then each code point). Version 1 files have a single
+// segment and end after it.
+#define REPLAY_MAGIC "GERP"
+#define REPLAY_INDEX_MAGIC "GERI"
+#define REPLAY_VERSION 2
+#define REPLAY_FOOTER_SIZE 12
+#define REPLAY_INITIAL_CAPACITY 4096
+#define REPLAY_VARINT_MAX_BYTES 10
+
+#define REPLAY_FIELD_HELD    (1 << 0)
+#define REPLAY_FIELD_PRESSED (1 << 1)
+#define REPLAY_FIELD_MOUSE_X (1 << 2)
+#define REPLAY_FIELD_MOUSE_Y (1 << 3)
+#define REPLAY_FIELD_CHARS   (1 << 4)
+
+// Input of one tick as stored in the file
+typedef struct {
+    uint32_t held;
+    uint32_t pressed;
+    int32_t mouse_x;  // 1/16 pixels
+    int32_t mouse_y;
+    int chars[INPUT_MAX_CHARS];
+    int char_count;
+} ReplayFrame;
+
+// Index entry of one keyframe
+typedef struct {
+    int tick;               // Ticks played before the state was saved
+    size_t stream_offset;   // Start of the tick's input segment, after the header
+    size_t data_offset;     // Start of the saved state (writer: in its keyframe buffer)
+    size_t data_size;
+} ReplayKeyframe;
+
+struct ReplayWriter {
+    uint64_t seed;
+    int tick_rate;
+    int tick_count;
+    uint8_t* data;  // Encoded runs and frames, without header and final repeat
+    size_t size;
+    size_t capacity;
+    uint64_t repeat;  // Ticks since the last changed frame
+    ReplayFrame previous;
+    uint8_t* keyframe_data;  // Saved states, back to back
+    size_t keyframe_data_size;
+    size_t keyframe_data_capacity;
+    ReplayKeyframe* keyframes;
+    int keyframe_count;
+    int keyframe_capacity;
+};
+
+struct ReplayReader {
+    uint64_t seed;
+    int tick_rate;
+    int tick_count;
+    const uint8_t* data;  // Whole file, mapped read-only
+    size_t size;
+    size_t stream_start;  // End of the header
+    size_t stream_end;    // End of the input segments
+    size_t position;
+    int ticks_read;
+    uint64_t repeat;  // Ticks left that repeat the previous frame
+    ReplayFrame previous;
+    ReplayKeyframe* keyframes;
+    int keyframe_count;
+    int next_keyframe;  // First keyframe whose segment has not been entered
+#if defined(_WIN32)
+    HANDLE file;
+    HANDLE mapping;
+#endif
+};
+
+/**
+ * Convert a mouse coordinate to the file's fixed point.
+ * @param value Coordinate in pixels
+ * @return Coordinate in 1/16 pixels
+ */
+static int32_t replay_quantize(float value) {
+    float scaled = roundf(value * REPLAY_MOUSE_SCALE);
+    if (scaled > 2147483520.0f) return INT32_MAX;
+    if (scaled < -2147483520.0f) return INT32_MIN;
+    return (int32_t)scaled;
+}
+
+/**
+ * Write a varint into a byte array.
+ * @param out Destination, at least REPLAY_VARINT_MAX_BYTES long
+ * @param value Value to encode
+ * @return Bytes written
+ */
+static int replay_encode_varint(uint8_t* out, uint64_t value) {
+    int length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+/**
+ * Map a signed value to unsigned so small magnitudes stay small.
+ * @param value Signed value
+ * @return Zigzag encoding
+ */
+static uint64_t replay_zigzag(int64_t value) {
+    return ((uint64_t)value << 1) ^ (uint64_t)(value >> 63);
+}
+
+/**
+ * Undo replay_zigzag.
+ * @param value Zigzag encoding
+ * @return Signed value
+ */
+static int64_t replay_unzigzag(uint64_t value) {
+    return (int64_t)(value >> 1) ^ -(int64_t)(value & 1);
+}
+
+/**
+ * Make room for more bytes in a growable buffer.
+ * @param data The buffer, reallocated as needed
+ * @param size Bytes in use
+ * @param capacity Bytes allocated, updated when the buffer grows
+ * @param extra Bytes about to be appended
+ * @return true on success, false if out of memory
+ */
+static bool replay_reserve(uint8_t** data, size_t size, size_t* capacity, size_t extra) {
+    if (size + extra <= *capacity) return true;
+    
+    size_t new_capacity = *capacity ? *capacity * 2 : REPLAY_INITIAL_CAPACITY;
+    while (new_capacity < size + extra) {
+        new_capacity *= 2;
+    }
+    uint8_t* new_data = (uint8_t*)mem_realloc(MEM_TAG_REPLAY, *data, new_capacity);
+    if (!new_data) return false;
+    *data = new_data;
+    *capacity = new_capacity;
+    return true;
+}
+
+/**
+ * Make room for more bytes in the writer's input buffer.
+ * @param writer The writer
+ * @param extra Bytes about to be appended
+ * @return true on success, false if out of memory
+ */
+static bool replay_writer_reserve(ReplayWriter* writer, size_t extra) {
+    return replay_reserve(&writer->data, writer->size, &writer->capacity, extra);
+}
+
+/**
+ * Append a varint to the writer's buffer. Space must be reserved.
+ * @param writer The writer
+ * @param value Value to encode
+ */
+static void replay_writer_put_varint(ReplayWriter* writer, uint64_t value) {
+    writer->size += (size_t)replay_encode_varint(writer->data + writer->size, value);
+}
+
+/**
+ * Compare two stored frames.
+ * @param a First frame
+ * @param b Second frame
+ * @return true if every field matches, false otherwise
+ */
+static bool replay_frames_equal(const ReplayFrame* a, const ReplayFrame* b) {
+    if (a->held != b->held || a->pressed != b->pressed) return false;
+    if (a->mouse_x != b->mouse_x || a->mouse_y != b->mouse_y) return false;
+    if (a->char_count != b->char_count) return false;
+    return memcmp(a->chars, b->chars, sizeof(int) * (size_t)a->char_count) == 0;
+}
+
+ReplayWriter* replay_writer_create(uint64_t seed, int tick_rate) {
+    ReplayWriter* writer = (ReplayWriter*)mem_alloc(MEM_TAG_REPLAY, sizeof(ReplayWriter));
+    if (!writer) return NULL;
+    
+    memset(writer, 0, sizeof(ReplayWriter));
+    writer->seed = seed;
+    writer->tick_rate = tick_rate;
+    return writer;
+}
+
+void replay_writer_destroy(ReplayWriter* writer) {
+    if (!writer) return;
+    mem_free(writer->data);
+    mem_free(writer->keyframe_data);
+    mem_free(writer->keyframes);
+    mem_free(writer);
+}
+
+bool replay_writer_add_tick(ReplayWriter* writer, InputFrame* input) {
+    if (!writer || !input) return false;
+    
+    ReplayFrame frame;
+    frame.held = input->held;
+    frame.pressed = input->pressed;
+    frame.mouse_x = replay_quantize(input->mouse_position.x);
+    frame.mouse_y = replay_quantize(input->mouse_position.y);
+    frame.char_count = input->char_count;
+    memcpy(frame.chars, input->chars, sizeof(int) * (size_t)frame.char_count);
+    
+    input->mouse_position.x = (float)frame.mouse_x / REPLAY_MOUSE_SCALE;
+    input->mouse_position.y = (float)frame.mouse_y / REPLAY_MOUSE_SCALE;
+    
+    if (replay_frames_equal(&frame, &writer->previous)) {
+        writer->repeat++;
+        writer->tick_count++;
+        return true;
+    }
+    
+    // Repeat count, flags, five fields and the characters, all worst case
+    size_t worst = REPLAY_VARINT_MAX_BYTES * (6 + 1 + (size_t)frame.char_count) + 1;
+    if (!replay_writer_reserve(writer, worst)) return false;
+    
+    const ReplayFrame* previous = &writer->previous;
+    uint8_t fields = 0;
+    if (frame.held != previous->held) fields |= REPLAY_FIELD_HELD;
+    if (frame.pressed != previous->pressed) fields |= REPLAY_FIELD_PRESSED;
+    if (frame.mouse_x != previous->mouse_x) fields |= REPLAY_FIELD_MOUSE_X;
+    if (frame.mouse_y != previous->mouse_y) fields |= REPLAY_FIELD_MOUSE_Y;
+    if (frame.char_count != previous->char_count ||
+        memcmp(frame.chars, previous->chars, sizeof(int) * (size_t)frame.char_count) != 0) {
+        fields |= REPLAY_FIELD_CHARS;
+    }
+    
+    replay_writer_put_varint(writer, writer->repeat);
+    writer->data[writer->size++] = fields;
+    if (fields & REPLAY_FIELD_HELD) replay_writer_put_varint(writer, frame.held);
+    if (fields & REPLAY_FIELD_PRESSED) replay_writer_put_varint(writer, frame.pressed);
+    if (fields & REPLAY_FIELD_MOUSE_X) {
+        replay_writer_put_varint(writer, replay_zigzag((int64_t)frame.mouse_x - previous->mouse_x));
+    }
+    if (fields & REPLAY_FIELD_MOUSE_Y) {
+        replay_writer_put_varint(writer, replay_zigzag((int64_t)frame.mouse_y - previous->mouse_y));
+    }
+    if (fields & REPLAY_FIELD_CHARS) {
+        replay_writer_put_varint(writer, (uint64_t)frame.char_count);
+        for (int i = 0; i < frame.char_count; i++) {
+            replay_writer_put_varint(writer, (uint64_t)(uint32_t)frame.chars[i]);
+        }
+    }
+    
+    writer->previous = frame;
+    writer->repeat = 0;
+    writer->tick_count++;
+    return true;
+}
+
+bool replay_writer_add_keyframe(ReplayWriter* writer, const void* state, size_t size) {
+    if (!writer || !state || size == 0) return false;
+    if (writer->keyframe_count > 0 && writer->keyframes[writer->keyframe_count - 1].tick == writer->tick_count) {
+        return false;
+    }
+    
+    if (writer->keyframe_count == writer->keyframe_capacity) {
+        int capacity = writer->keyframe_capacity ? writer->keyframe_capacity * 2 : 64;
+        ReplayKeyframe* keyframes = (ReplayKeyframe*)mem_realloc(MEM_TAG_REPLAY, writer->keyframes, sizeof(ReplayKeyframe) * (size_t)capacity);
+        if (!keyframes) return false;
+        writer->keyframes = keyframes;
+        writer->keyframe_capacity = capacity;
+    }
+    if (!replay_reserve(&writer->keyframe_data, writer->keyframe_data_size, &writer->keyframe_data_capacity, size) ||
+        !replay_writer_reserve(writer, REPLAY_VARINT_MAX_BYTES)) {
+        return false;
+    }
+    
+    // Close the running segment; the next one starts from no input
+    if (writer->tick_count > 0) {
+        replay_writer_put_varint(writer, writer->repeat);
+    }
+    memset(&writer->previous, 0, sizeof(writer->previous));
+    writer->repeat = 0;
+    
+    ReplayKeyframe* keyframe = &writer->keyframes[writer->keyframe_count++];
+    keyframe->tick = writer->tick_count;
+    keyframe->stream_offset = writer->size;
+    keyframe->data_offset = writer->keyframe_data_size;
+    keyframe->data_size = size;
+    memcpy(writer->keyframe_data + writer->keyframe_data_size, state, size);
+    writer->keyframe_data_size += size;
+    return true;
+}
+
+int replay_writer_get_tick_count(const ReplayWriter* writer) {
+    if (!writer) return 0;
+    return writer->tick_count;
+}
+
+long replay_writer_save(ReplayWriter* writer, const char* path) {
+    if (!writer || !path) return 0;
+    
+    uint8_t header[4 + 1 + 3 * REPLAY_VARINT_MAX_BYTES];
+    int header_size = 0;
+    memcpy(header, REPLAY_MAGIC, 4);
+    header_size += 4;
+    header[header_size++] = REPLAY_VERSION;
+    header_size += replay_encode_varint(header + header_size, writer->seed);
+    header_size += replay_encode_varint(header + header_size, (uint64_t)writer->tick_rate);
+    header_size += replay_encode_varint(header + header_size, (uint64_t)writer->tick_count);
+    
+    uint8_t trailer[REPLAY_VARINT_MAX_BYTES];
+    int trailer_size = replay_encode_varint(trailer, writer->repeat);
+    
+    size_t index_capacity = REPLAY_VARINT_MAX_BYTES * (1 + 3 * (size_t)writer->keyframe_count) + REPLAY_FOOTER_SIZE;
+    uint8_t* index = (uint8_t*)mem_alloc(MEM_TAG_REPLAY, index_capacity);
+    if (!index) return 0;
+    size_t index_size = (size_t)replay_encode_varint(index, (uint64_t)writer->keyframe_count);
+    for (int i = 0; i < writer->keyframe_count; i++) {
+        const ReplayKeyframe* keyframe = &writer->keyframes[i];
+        index_size += (size_t)replay_encode_varint(index + index_size, (uint64_t)keyframe->tick);
+        index_size += (size_t)replay_encode_varint(index + index_size, keyframe->stream_offset);
+        index_size += (size_t)replay_encode_varint(index + index_size, keyframe->data_size);
+    }
+    uint64_t index_offset = (uint64_t)header_size + writer->size + (uint64_t)trailer_size + writer->keyframe_data_size;
+    for (int i = 0; i < 8; i++) {
+        index[index_size++] = (uint8_t)(index_offset >> (8 * i));
+    }
+    memcpy(index + index_size, REPLAY_INDEX_MAGIC, 4);
+    index_size += 4;
+    
+    FILE* file = fopen(path, "wb");
+    if (!file) {
+        printf("Error: Could not open replay file %s\n", path);
+        mem_free(index);
+        return 0;
+    }
+    
+    bool ok = fwrite(header, 1, (size_t)header_size, file) == (size_t)header_size &&
+              fwrite(writer->data, 1, writer->size, file) == writer->size &&
+              fwrite(trailer, 1, (size_t)trailer_size, file) == (size_t)trailer_size &&
+              fwrite(writer->keyframe_data, 1, writer->keyframe_data_size, file) == writer->keyframe_data_size &&
+              fwrite(index, 1, index_size, file) == index_size;
+    mem_free(index);
+    if (fclose(file) != 0) ok = false;
+    if (!ok) {
+        printf("Error: Could not write replay file %s\n", path);
+        return 0;
+    }
+    
+    return (long)(index_offset + index_size);
+}
+
+/**
+ * Read a varint from the reader's data.
+ * @param reader The reader
+ * @param value Decoded value
+ * @return true on success, false if the data ends or is malformed
+ */
+static bool replay_reader_get_varint(ReplayReader* reader, uint64_t* value) {
+    uint64_t result = 0;
+    for (int shift = 0; shift < 64; shift += 7) {
+        if (reader->position >= reader->size) return false;
+        uint8_t byte = reader->data[reader->position++];
+        result |= (uint64_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) {
+            *value = result;
+            return true;
+        }
+    }
+    return false;
+}
+
+/**
+ * Map a whole file into memory, read-only.
+ * @param reader The reader to fill in
+ * @param path File to map
+ * @return true on success, false if the file is missing or empty
+ */
+static bool replay_reader_map(ReplayReader* reader, const char* path) {
+#if defined(_WIN32)
+    reader->file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, NULL);
+    if (reader->file == INVALID_HANDLE_VALUE) {
+        reader->file = NULL;
+        return false;
+    }
+    LARGE_INTEGER size;
+    if (!GetFileSizeEx(reader->file, &size) || size.QuadPart <= 0) return false;
+    reader->mapping = CreateFileMappingA(reader->file, NULL, PAGE_READONLY, 0, 0, NULL);
+    if (!reader->mapping) return false;
+    const void* view = MapViewOfFile(reader->mapping, FILE_MAP_READ, 0, 0, 0);
+    if (!view) return false;
+    reader->data = (const uint8_t*)view;
+    reader->size = (size_t)size.QuadPart;
+    return true;
+#else
+    int fd = open(path, O_RDONLY);
+    if (fd < 0) return false;
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size <= 0) {
+        close(fd);
+        return false;
+    }
+    void* view = mmap(NULL, (size_t)info.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    close(fd);
+    if (view == MAP_FAILED) return false;
+    reader->data = (const uint8_t*)view;
+    reader->size = (size_t)info.st_size;
+    return true;
+#endif
+}
+
+/**
+ * Read the keyframe index from the footer of the file.
+ * @param reader The reader, with its header read
+ * @return true on success, false if the index is missing or malformed
+ */
+static bool replay_reader_load_index(ReplayReader* reader) {
+    if (reader->size < reader->stream_start + REPLAY_FOOTER_SIZE) return false;
+    const uint8_t* footer = reader->data + reader->size - REPLAY_FOOTER_SIZE;
+    if (memcmp(footer + 8, REPLAY_INDEX_MAGIC, 4) != 0) return false;
+    
+    uint64_t index_offset = 0;
+    for (int i = 0; i < 8; i++) {
+        index_offset |= (uint64_t)footer[i] << (8 * i);
+    }
+    if (index_offset < reader->stream_start || index_offset > reader->size - REPLAY_FOOTER_SIZE) return false;
+    
+    uint64_t count;
+    reader->position = (size_t)index_offset;
+    if (!replay_reader_get_varint(reader, &count) || count > reader->size / 3) return false;
+    if (count > 0) {
+        reader->keyframes = (ReplayKeyframe*)mem_alloc(MEM_TAG_REPLAY, sizeof(ReplayKeyframe) * (size_t)count);
+        if (!reader->keyframes) return false;
+    }
+    
+    // Keyframe data sits right before the index, so its start is found by size
+    uint64_t data_size = 0;
+    for (uint64_t i = 0; i < count; i++) {
+        uint64_t tick, stream_offset, size;
+        if (!replay_reader_get_varint(reader, &tick) || !replay_reader_get_varint(reader, &stream_offset) ||
+            !replay_reader_get_varint(reader, &size) || tick > (uint64_t)reader->tick_count ||
+            (i > 0 && tick <= (uint64_t)reader->keyframes[i - 1].tick) ||
+            size > index_offset - reader->stream_start - data_size) {
+            return false;
+        }
+        ReplayKeyframe* keyframe = &reader->keyframes[i];
+        keyframe->tick = (int)tick;
+        keyframe->stream_offset = (size_t)stream_offset;
+        keyframe->data_offset = (size_t)data_size;
+        keyframe->data_size = (size_t)size;
+        data_size += size;
+    }
+    reader->keyframe_count = (int)count;
+    reader->stream_end = (size_t)(index_offset - data_size);
+    
+    for (int i = 0; i < reader->keyframe_count; i++) {
+        reader->keyframes[i].data_offset += reader->stream_end;
+        if (reader->keyframes[i].stream_offset >= reader->stream_end - reader->stream_start) return false;
+    }
+    return true;
+}
+
+/**
+ * Start decoding an input segment.
+ * @param reader The reader
+ * @param offset Start of the segment in the file
+ * @return true on success, false if the data is malformed
+ */
+static bool replay_reader_begin_segment(ReplayReader* reader, size_t offset) {
+    reader->position = offset;
+    memset(&reader->previous, 0, sizeof(reader->previous));
+    return replay_reader_get_varint(reader, &reader->repeat);
+}
+
+ReplayReader* replay_reader_open(const char* path) {
+    if (!path) return NULL;
+    
+    ReplayReader* reader = (ReplayReader*)mem_alloc(MEM_TAG_REPLAY, sizeof(ReplayReader));
+    if (!reader) return NULL;
+    memset(reader, 0, sizeof(ReplayReader));
+    
+    if (!replay_reader_map(reader, path)) {
+        printf("Error: Could not open replay file %s\n", path);
+        replay_reader_destroy(reader);
+        return NULL;
+    }
+    
+    uint64_t seed, tick_rate, tick_count;
+    uint8_t version = reader->size > 5 ? reader->data[4] : 0;
+    bool valid = reader->size > 5 && memcmp(reader->data, REPLAY_MAGIC, 4) == 0 &&
+                 (version == 1 || version == REPLAY_VERSION);
+    reader->position = 5;
+    valid = valid && replay_reader_get_varint(reader, &seed) &&
+            replay_reader_get_varint(reader, &tick_rate) &&
+            replay_reader_get_varint(reader, &tick_count) &&
+            tick_rate > 0 && tick_rate <= INT32_MAX && tick_count <= INT32_MAX;
+    if (valid) {
+        reader->tick_count = (int)tick_count;
+        reader->stream_start = reader->position;
+        reader->stream_end = reader->size;
+    }
+    valid = valid && (version == 1 || replay_reader_load_index(reader)) &&
+            replay_reader_begin_segment(reader, reader->stream_start);
+    if (!valid) {
+        printf("Error: %s is not a valid replay file\n", path);
+        replay_reader_destroy(reader);
+        return NULL;
+    }
+    
+    reader->seed = seed;
+    reader->tick_rate = (int)tick_rate;
+    return reader;
+}
+
+void replay_reader_destroy(ReplayReader* reader) {
+    if (!reader) return;
+#if defined(_WIN32)
+    if (reader->data) UnmapViewOfFile(reader->data);
+    if (reader->mapping) CloseHandle(reader->mapping);
+    if (reader->file) CloseHandle(reader->file);
+#else
+    if (reader->data) munmap((void*)reader->data, reader->size);
+#endif
+    mem_free(reader->keyframes);
+    mem_free(reader);
+}
+
+uint64_t replay_reader_get_seed(const ReplayReader* reader) {
+    if (!reader) return 0;
+    return reader->seed;
+}
+
+int replay_reader_get_tick_rate(const ReplayReader* reader) {
+    if (!reader) return 0;
+    return reader->tick_rate;
+}
+
+int replay_reader_get_tick_count(const ReplayReader* reader) {
+    if (!reader) return 0;
+    return reader->tick_count;
+}
+
+/**
+ * Decode the next changed frame over the previous one.
+ * @param reader The reader
+ * @return true on success, false if the data is malformed
+ */
+static bool replay_reader_decode_frame(ReplayReader* reader) {
+    if (reader->position >= reader->size) return false;
+    uint8_t fields = reader->data[reader->position++];
+    
+    ReplayFrame* frame = &reader->previous;
+    uint64_t value;
+    if (fields & REPLAY_FIELD_HELD) {
+        if (!replay_reader_get_varint(reader, &value)) return false;
+        frame->held = (uint32_t)value;
+    }
+    if (fields & REPLAY_FIELD_PRESSED) {
+        if (!replay_reader_get_varint(reader, &value)) return false;
+        frame->pressed = (uint32_t)value;
+    }
+    if (fields & REPLAY_FIELD_MOUSE_X) {
+        if (!replay_reader_get_varint(reader, &value)) return false;
+        frame->mouse_x = (int32_t)(frame->mouse_x + replay_unzigzag(value));
+    }
+    if (fields & REPLAY_FIELD_MOUSE_Y) {
+        if (!replay_reader_get_varint(reader, &value)) return false;
+        frame->mouse_y = (int32_t)(frame->mouse_y + replay_unzigzag(value));
+    }
+    if (fields & REPLAY_FIELD_CHARS) {
+        if (!replay_reader_get_varint(reader, &value) || value > INPUT_MAX_CHARS) return false;
+        frame->char_count = (int)value;
+        for (int i = 0; i < frame->char_count; i++) {
+            if (!replay_reader_get_varint(reader, &value)) return false;
+            frame->chars[i] = (int)(uint32_t)value;
+        }
+    }
+    return true;
+}
+
+bool replay_reader_next_tick(ReplayReader* reader, InputFrame* input) {
+    if (!reader || !input || reader->ticks_read >= reader->tick_count) return false;
+    
+    bool valid = true;
+    if (reader->next_keyframe < reader->keyframe_count &&
+        reader->keyframes[reader->next_keyframe].tick == reader->ticks_read) {
+        valid = replay_reader_begin_segment(reader, reader->stream_start +
+                                            reader->keyframes[reader->next_keyframe].stream_offset);
+        reader->next_keyframe++;
+    }
+    
+    if (valid && reader->repeat > 0) {
+        reader->repeat--;
+    } else if (!valid || !replay_reader_decode_frame(reader) || !replay_reader_get_varint(reader, &reader->repeat)) {
+        printf("Error: Replay data ends early at tick %d\n", reader->ticks_read);
+        reader->ticks_read = reader->tick_count;
+        return false;
+    }
+    
+    const ReplayFrame* frame = &reader->previous;
+    input->held = frame->held;
+    input->pressed = frame->pressed;
+    input->mouse_position.x = (float)frame->mouse_x / REPLAY_MOUSE_SCALE;
+    input->mouse_position.y = (float)frame->mouse_y / REPLAY_MOUSE_SCALE;
+    input->char_count = frame->char_count;
+    memcpy(input->chars, frame->chars, sizeof(int) * (size_t)frame->char_count);
+    
+    reader->ticks_read++;
+    return true;
+}
+
+int replay_reader_get_tick(const ReplayReader* reader) {
+    if (!reader) return 0;
+    return reader->ticks_read;
+}
+
+int replay_reader_get_keyframe_count(const ReplayReader* reader) {
+    if (!reader) return 0;
+    return reader->keyframe_count;
+}
+
+/**
+ * Find the last keyframe at or before a tick.
+ * @param reader The reader
+ * @param tick Tick to search for
+ * @return Keyframe index, or -1 if there is none
+ */
+static int replay_reader_find_keyframe_index(const ReplayReader* reader, int tick) {
+    int found = -1;
+    int low = 0;
+    int high = reader->keyframe_count - 1;
+    while (low <= high) {
+        int middle = low + (high - low) / 2;
+        if (reader->keyframes[middle].tick <= tick) {
+            found = middle;
+            low = middle + 1;
+        } else {
+            high = middle - 1;
+        }
+    }
+    return found;
+}
+
+int replay_reader_find_keyframe(const ReplayReader* reader, int tick) {
+    if (!reader) return -1;
+    int index = replay_reader_find_keyframe_index(reader, tick);
+    return index >= 0 ? reader->keyframes[index].tick : -1;
+}
+
+int replay_reader_seek_keyframe(ReplayReader* reader, int tick, const void** state, size_t* size) {
+    if (!reader) return -1;
+    int index = replay_reader_find_keyframe_index(reader, tick);
+    if (index < 0) return -1;
+    
+    const ReplayKeyframe* keyframe = &reader->keyframes[index];
+    if (!replay_reader_begin_segment(reader, reader->stream_start + keyframe->stream_offset)) return -1;
+    reader->ticks_read = keyframe->tick;
+    reader->next_keyframe = index + 1;
+    if (state) *state = reader->data + keyframe->data_offset;
+    if (size) *size = keyframe->data_size;
+    return keyframe->tick;
+}
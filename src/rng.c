@@ -0,0 +1,71 @@
+#include "../include/rng.h"
+
+/**
+ * Rotate a 32-bit value left.
+ * @param x Value
+ * @param k Bits to rotate by
+ * @return Rotated value
+ */
+static uint32_t rng_rotl(uint32_t x, int k) {
+    return (x << k) | (x >> (32 - k));
+}
+
+/**
+ * SplitMix64 step, used to spread a seed over the stream state.
+ * @param x Generator state, advanced in place
+ * @return Next output
+ */
+static uint64_t rng_splitmix64(uint64_t* x) {
+    uint64_t z = (*x += 0x9E3779B97F4A7C15ull);
+    z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+    z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+    return z ^ (z >> 31);
+}
+
+void rng_seed(Rng* rng, uint64_t seed) {
+    if (!rng) return;
+    
+    uint64_t x = seed;
+    uint64_t a = rng_splitmix64(&x);
+    uint64_t b = rng_splitmix64(&x);
+    rng->s[0] = (uint32_t)a;
+    rng->s[1] = (uint32_t)(a >> 32);
+    rng->s[2] = (uint32_t)b;
+    rng->s[3] = (uint32_t)(b >> 32);
+    
+    // xoshiro must not start from the all-zero state
+    if ((rng->s[0] | rng->s[1] | rng->s[2] | rng->s[3]) == 0) {
+        rng->s[0] = 1;
+    }
+}
+
+uint32_t rng_next(Rng* rng) {
+    uint32_t* s = rng->s;
+    uint32_t result = rng_rotl(s[1] * 5, 7) * 9;
+    uint32_t t = s[1] << 9;
+    
+    s[2] ^= s[0];
+    s[3] ^= s[1];
+    s[1] ^= s[2];
+    s[0] ^= s[3];
+    s[2] ^= t;
+    s[3] = rng_rotl(s[3], 11);
+    
+    return result;
+}
+
+int rng_range(Rng* rng, int min, int max) {
+    if (max < min) {
+        int tmp = min;
+        min = max;
+        max = tmp;
+    }
+    
+    // Multiply-shift maps 32 bits onto the range without a division
+    uint64_t span = (uint64_t)((int64_t)max - (int64_t)min) + 1;
+    return (int)((int64_t)min + (int64_t)(((uint64_t)rng_next(rng) * span) >> 32));
+}
+
+float rng_float(Rng* rng) {
+    return (float)(rng_next(rng) >> 8) * (1.0f / 16777216.0f);
+}
@@ -0,0 +1,312 @@
+#include "../include/rollback.h"
+#include "../include/mem.h"
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define ROLLBACK_VARINT_MAX_BYTES 10
+#define ROLLBACK_DELTA_MAX_SIZE(state_size) ((state_size) * 2 + ROLLBACK_VARINT_MAX_BYTES * 2)
+
+// A delta is the XOR of a state with the next tick's state, both padded
+// with zeros to the longer length, stored as tokens of
+//   zero run length, literal length, literal bytes
+// with both lengths as LEB128 varints. Most of the game does not change
+// between ticks, so the zero runs cover nearly all of it.
+
+// One tick held in the ring
+typedef struct {
+    int tick;
+    InputFrame input;
+    size_t state_size;  // Size of the state at the start of this tick
+    uint8_t* delta;     // This state XOR the next tick's (unused for the newest tick)
+    size_t delta_size;
+    size_t delta_capacity;
+} RollbackEntry;
+
+struct RollbackBuffer {
+    RollbackEntry* entries;
+    int capacity;
+    int count;
+    int newest;  // Slot of the newest tick
+    uint8_t* newest_state;  // Whole state of the newest tick; rewinds rebuild older states here
+    size_t state_capacity;  // Largest state pushed so far
+    uint8_t* scratch;       // Delta being encoded, sized for the worst case
+};
+
+/**
+ * Write a varint into a byte array.
+ * @param out Destination, at least ROLLBACK_VARINT_MAX_BYTES long
+ * @param value Value to encode
+ * @return Bytes written
+ */
+static size_t rollback_encode_varint(uint8_t* out, size_t value) {
+    size_t length = 0;
+    while (value >= 0x80) {
+        out[length++] = (uint8_t)(value | 0x80);
+        value >>= 7;
+    }
+    out[length++] = (uint8_t)value;
+    return length;
+}
+
+/**
+ * Read a varint from a byte array.
+ * @param data Encoded bytes
+ * @param size Size of the data
+ * @param position Read position, advanced past the varint
+ * @return Decoded value
+ */
+static size_t rollback_decode_varint(const uint8_t* data, size_t size, size_t* position) {
+    size_t value = 0;
+    for (int shift = 0; *position < size && shift < 64; shift += 7) {
+        uint8_t byte = data[(*position)++];
+        value |= (size_t)(byte & 0x7F) << shift;
+        if ((byte & 0x80) == 0) break;
+    }
+    return value;
+}
+
+/**
+ * Get one byte of the XOR of two zero-padded states.
+ * @param a First state
+ * @param size_a Its size
+ * @param b Second state
+ * @param size_b Its size
+ * @param i Byte index
+ * @return XOR of the two bytes
+ */
+static uint8_t rollback_xor_byte(const uint8_t* a, size_t size_a, const uint8_t* b, size_t size_b, size_t i) {
+    return (uint8_t)((i < size_a ? a[i] : 0) ^ (i < size_b ? b[i] : 0));
+}
+
+/**
+ * Encode the difference between two states.
+ * @param older State of the earlier tick
+ * @param older_size Its size
+ * @param newer State of the following tick
+ * @param newer_size Its size
+ * @param out Destination, ROLLBACK_DELTA_MAX_SIZE of the larger state
+ * @return Bytes written
+ */
+static size_t rollback_encode_delta(const uint8_t* older, size_t older_size,
+                                    const uint8_t* newer, size_t newer_size, uint8_t* out) {
+    size_t length = older_size > newer_size ? older_size : newer_size;
+    size_t common = older_size < newer_size ? older_size : newer_size;
+    size_t written = 0;
+    size_t i = 0;
+    
+    while (i < length) {
+        size_t run_start = i;
+        // Skip equal bytes eight at a time where both states have them
+        while (i + sizeof(uint64_t) <= common) {
+            uint64_t x, y;
+            memcpy(&x, older + i, sizeof(x));
+            memcpy(&y, newer + i, sizeof(y));
+            if (x != y) break;
+            i += sizeof(uint64_t);
+        }
+        while (i < length && rollback_xor_byte(older, older_size, newer, newer_size, i) == 0) {
+            i++;
+        }
+        
+        size_t literal_start = i;
+        while (i < length && rollback_xor_byte(older, older_size, newer, newer_size, i) != 0) {
+            i++;
+        }
+        
+        written += rollback_encode_varint(out + written, literal_start - run_start);
+        written += rollback_encode_varint(out + written, i - literal_start);
+        for (size_t j = literal_start; j < i; j++) {
+            out[written++] = rollback_xor_byte(older, older_size, newer, newer_size, j);
+        }
+    }
+    return written;
+}
+
+/**
+ * Turn a tick's state into the previous tick's by applying a delta.
+ * @param state Holds the newer state; receives the older one
+ * @param newer_size Size of the newer state
+ * @param older_size Size of the older state
+ * @param delta Delta between them
+ * @param delta_size Size of the delta
+ */
+static void rollback_apply_delta(uint8_t* state, size_t newer_size, size_t older_size,
+                                 const uint8_t* delta, size_t delta_size) {
+    size_t length = older_size > newer_size ? older_size : newer_size;
+    if (older_size > newer_size) {
+        memset(state + newer_size, 0, older_size - newer_size);
+    }
+    
+    size_t position = 0;
+    size_t i = 0;
+    while (position < delta_size && i < length) {
+        i += rollback_decode_varint(delta, delta_size, &position);
+        size_t literal = rollback_decode_varint(delta, delta_size, &position);
+        for (size_t j = 0; j < literal && i < length && position < delta_size; j++) {
+            state[i++] ^= delta[position++];
+        }
+    }
+}
+
+/**
+ * Find the ring slot of a tick.
+ * @param buffer The buffer
+ * @param tick Tick number
+ * @return Slot index, or -1 if the tick is not held
+ */
+static int rollback_find_slot(const RollbackBuffer* buffer, int tick) {
+    if (buffer->count == 0) return -1;
+    int age = buffer->entries[buffer->newest].tick - tick;
+    if (age < 0 || age >= buffer->count) return -1;
+    return (buffer->newest - age + buffer->capacity) % buffer->capacity;
+}
+
+/**
+ * Grow the whole-state and scratch buffers to hold a state of a given size.
+ * The newest state is kept.
+ * @param buffer The buffer
+ * @param size State size in bytes
+ * @return true on success, false if out of memory
+ */
+static bool rollback_reserve(RollbackBuffer* buffer, size_t size) {
+    if (size <= buffer->state_capacity) return true;
+    
+    uint8_t* state = (uint8_t*)mem_realloc(MEM_TAG_ROLLBACK, buffer->newest_state, size);
+    if (!state) return false;
+    buffer->newest_state = state;
+    uint8_t* scratch = (uint8_t*)mem_realloc(MEM_TAG_ROLLBACK, buffer->scratch, ROLLBACK_DELTA_MAX_SIZE(size));
+    if (!scratch) return false;
+    buffer->scratch = scratch;
+    buffer->state_capacity = size;
+    return true;
+}
+
+RollbackBuffer* rollback_create(int capacity) {
+    if (capacity <= 0) return NULL;
+    
+    RollbackBuffer* buffer = (RollbackBuffer*)mem_alloc(MEM_TAG_ROLLBACK, sizeof(RollbackBuffer));
+    if (!buffer) return NULL;
+    memset(buffer, 0, sizeof(RollbackBuffer));
+    
+    buffer->capacity = capacity;
+    buffer->entries = (RollbackEntry*)mem_calloc(MEM_TAG_ROLLBACK, (size_t)capacity, sizeof(RollbackEntry));
+    if (!buffer->entries) {
+        rollback_destroy(buffer);
+        return NULL;
+    }
+    return buffer;
+}
+
+void rollback_destroy(RollbackBuffer* buffer) {
+    if (!buffer) return;
+    if (buffer->entries) {
+        for (int i = 0; i < buffer->capacity; i++) {
+            mem_free(buffer->entries[i].delta);
+        }
+    }
+    mem_free(buffer->entries);
+    mem_free(buffer->newest_state);
+    mem_free(buffer->scratch);
+    mem_free(buffer);
+}
+
+bool rollback_push(RollbackBuffer* buffer, int tick, const void* state, size_t size, const InputFrame* input) {
+    if (!buffer || !state || !input || size == 0) return false;
+    if (buffer->count > 0 && tick != buffer->entries[buffer->newest].tick + 1) return false;
+    if (!rollback_reserve(buffer, size)) return false;
+    
+    if (buffer->count > 0) {
+        RollbackEntry* previous = &buffer->entries[buffer->newest];
+        
+        size_t delta_size = rollback_encode_delta(buffer->newest_state, previous->state_size,
+                                                  (const uint8_t*)state, size, buffer->scratch);
+        if (delta_size > previous->delta_capacity) {
+            size_t capacity = previous->delta_capacity ? previous->delta_capacity : 256;
+            while (capacity < delta_size) {
+                capacity *= 2;
+            }
+            uint8_t* delta = (uint8_t*)mem_realloc(MEM_TAG_ROLLBACK, previous->delta, capacity);
+            if (!delta) return false;
+            previous->delta = delta;
+            previous->delta_capacity = capacity;
+        }
+        memcpy(previous->delta, buffer->scratch, delta_size);
+        previous->delta_size = delta_size;
+    }
+    
+    // A full ring overwrites its oldest slot, which follows the newest
+    buffer->newest = (buffer->count > 0) ? (buffer->newest + 1) % buffer->capacity : 0;
+    if (buffer->count < buffer->capacity) {
+        buffer->count++;
+    }
+    
+    RollbackEntry* entry = &buffer->entries[buffer->newest];
+    entry->tick = tick;
+    entry->input = *input;
+    entry->state_size = size;
+    entry->delta_size = 0;
+    memcpy(buffer->newest_state, state, size);
+    return true;
+}
+
+const void* rollback_rewind(RollbackBuffer* buffer, int tick, size_t* size) {
+    if (!buffer) return NULL;
+    int target = rollback_find_slot(buffer, tick);
+    if (target < 0) return NULL;
+    
+    // Every held state fits the whole-state buffer, so deltas apply in place
+    int slot = buffer->newest;
+    size_t current_size = buffer->entries[slot].state_size;
+    while (slot != target) {
+        slot = (slot - 1 + buffer->capacity) % buffer->capacity;
+        const RollbackEntry* entry = &buffer->entries[slot];
+        rollback_apply_delta(buffer->newest_state, current_size, entry->state_size, entry->delta, entry->delta_size);
+        current_size = entry->state_size;
+    }
+    
+    buffer->count -= buffer->entries[buffer->newest].tick - tick;
+    buffer->newest = target;
+    buffer->entries[target].delta_size = 0;
+    if (size) *size = current_size;
+    return buffer->newest_state;
+}
+
+void rollback_clear(RollbackBuffer* buffer) {
+    if (!buffer) return;
+    buffer->count = 0;
+}
+
+const InputFrame* rollback_get_input(const RollbackBuffer* buffer, int tick) {
+    if (!buffer) return NULL;
+    int slot = rollback_find_slot(buffer, tick);
+    return slot >= 0 ? &buffer->entries[slot].input : NULL;
+}
+
+bool rollback_set_input(RollbackBuffer* buffer, int tick, const InputFrame* input) {
+    if (!buffer || !input) return false;
+    int slot = rollback_find_slot(buffer, tick);
+    if (slot < 0) return false;
+    buffer->entries[slot].input = *input;
+    return true;
+}
+
+int rollback_get_oldest_tick(const RollbackBuffer* buffer) {
+    if (!buffer || buffer->count == 0) return -1;
+    return buffer->entries[buffer->newest].tick - (buffer->count - 1);
+}
+
+int rollback_get_newest_tick(const RollbackBuffer* buffer) {
+    if (!buffer || buffer->count == 0) return -1;
+    return buffer->entries[buffer->newest].tick;
+}
+
+size_t rollback_get_state_bytes(const RollbackBuffer* buffer) {
+    if (!buffer || buffer->count == 0) return 0;
+    
+    size_t bytes = buffer->entries[buffer->newest].state_size;
+    for (int age = 1; age < buffer->count; age++) {
+        bytes += buffer->entries[(buffer->newest - age + buffer->capacity) % buffer->capacity].delta_size;
+    }
+    return bytes;
+}
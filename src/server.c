@@ -0,0 +1,421 @@
+#include "../include/server.h"
+#include "../include/net.h"
+#include "../include/netproto.h"
+#include "../include/timer.h"
+#include "../include/profiler.h"
+#include "../include/mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define SERVER_CLIENT_TIMEOUT_NS 5000000000ull
+#define SERVER_REPORT_INTERVAL_NS 5000000000ull
+
+// One connected client
+typedef struct {
+    bool connected;
+    NetAddress address;
+    uint64_t connect_order;   // Lower numbers connected earlier
+    uint64_t last_heard_ns;
+    uint32_t last_sequence;   // Newest input packet applied
+    int acked_tick;           // Newest snapshot the client holds (NETPROTO_NO_TICK = none)
+    InputFrame input;         // Held buttons from the newest packet, presses since the last tick
+    
+    // Traffic since the last report
+    uint64_t bytes_sent;
+    uint64_t bytes_received;
+    int snapshots_sent;
+    int full_snapshots;
+} ServerClient;
+
+struct GameServer {
+    CoinCollectorGame* game;
+    GameCallbacks callbacks;  // The game's own
+    void* game_data;
+    NetSocket* socket;
+    uint16_t port;
+    
+    ServerClient clients[SERVER_MAX_CLIENTS];
+    uint64_t next_connect_order;
+    NetWorldState history[NETPROTO_HISTORY];  // Sent worlds, by tick modulo NETPROTO_HISTORY
+    int tick;
+    uint8_t packet[NET_MAX_PACKET_SIZE];
+    uint8_t* snapshot;         // One client's encoded snapshot, before it is split into packets
+    size_t snapshot_capacity;
+    
+    // Tick cost since the last report
+    uint64_t report_ns;
+    uint64_t tick_ns_total;
+    uint64_t tick_ns_max;
+    int report_ticks;
+};
+
+GameServer* server_create(CoinCollectorGame* game, uint16_t port) {
+    if (!game) return NULL;
+    
+    GameServer* server = (GameServer*)mem_alloc(MEM_TAG_NET, sizeof(GameServer));
+    if (!server) return NULL;
+    memset(server, 0, sizeof(GameServer));
+    
+    server->socket = net_socket_open(port);
+    if (!server->socket) {
+        mem_free(server);
+        return NULL;
+    }
+    
+    server->game = game;
+    server->callbacks = game_get_callbacks(game);
+    server->game_data = game_get_data(game);
+    server->port = port;
+    for (int i = 0; i < NETPROTO_HISTORY; i++) {
+        netproto_world_init(&server->history[i]);
+    }
+    printf("Server listening on UDP port %u\n", (unsigned)port);
+    return server;
+}
+
+void server_destroy(GameServer* server) {
+    if (!server) return;
+    net_socket_close(server->socket);
+    for (int i = 0; i < NETPROTO_HISTORY; i++) {
+        netproto_world_release(&server->history[i]);
+    }
+    mem_free(server->snapshot);
+    mem_free(server);
+}
+
+/**
+ * Find the slot of a client by address, or claim a free one for a new
+ * client.
+ * @param server The server
+ * @param address Sender of a packet
+ * @param now_ns Current time
+ * @return The client, or NULL if the server is full
+ */
+static ServerClient* server_find_client(GameServer* server, const NetAddress* address, uint64_t now_ns) {
+    ServerClient* free_slot = NULL;
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        ServerClient* client = &server->clients[i];
+        if (client->connected && net_address_equal(&client->address, address)) return client;
+        if (!client->connected && !free_slot) free_slot = client;
+    }
+    if (!free_slot) return NULL;
+    
+    memset(free_slot, 0, sizeof(ServerClient));
+    free_slot->connected = true;
+    free_slot->address = *address;
+    free_slot->connect_order = server->next_connect_order++;
+    free_slot->last_heard_ns = now_ns;
+    free_slot->acked_tick = NETPROTO_NO_TICK;
+    input_clear(&free_slot->input);
+    
+    char name[32];
+    net_address_to_string(address, name, sizeof(name));
+    printf("Client %s connected\n", name);
+    return free_slot;
+}
+
+/**
+ * Read every waiting input packet into its client.
+ * @param server The server
+ * @param now_ns Current time
+ */
+static void server_receive(GameServer* server, uint64_t now_ns) {
+    NetAddress address;
+    int size;
+    while ((size = net_socket_receive(server->socket, &address, server->packet, sizeof(server->packet))) >= 0) {
+        NetInputPacket packet;
+        if (!netproto_read_input(server->packet, (size_t)size, &packet)) continue;
+        ServerClient* client = server_find_client(server, &address, now_ns);
+        if (!client) continue;
+        
+        client->last_heard_ns = now_ns;
+        client->bytes_received += (uint64_t)size;
+        if (packet.ack_tick > client->acked_tick && packet.ack_tick < server->tick) {
+            client->acked_tick = packet.ack_tick;
+        }
+        
+        // Older packets arriving late carry nothing newer than what was applied
+        if (client->last_sequence != 0 && packet.sequence <= client->last_sequence) continue;
+        client->last_sequence = packet.sequence;
+        client->input.held = packet.input.held;
+        client->input.pressed |= packet.input.pressed;
+        client->input.mouse_position = packet.input.mouse_position;
+        for (int i = 0; i < packet.input.char_count && client->input.char_count < INPUT_MAX_CHARS; i++) {
+            client->input.chars[client->input.char_count++] = packet.input.chars[i];
+        }
+    }
+}
+
+/**
+ * Find the client whose input drives the game: the one connected longest.
+ * @param server The server
+ * @return The client, or NULL if none is connected
+ */
+static ServerClient* server_find_player(GameServer* server) {
+    ServerClient* player = NULL;
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        ServerClient* client = &server->clients[i];
+        if (client->connected && (!player || client->connect_order < player->connect_order)) {
+            player = client;
+        }
+    }
+    return player;
+}
+
+/**
+ * Size the world history and the snapshot buffer for the largest map, so
+ * ticks send snapshots without allocating.
+ * @param server The server
+ * @return true on success, false if memory ran out (ticks then grow what they need)
+ */
+static bool server_reserve(GameServer* server) {
+    GameState* state = game_get_state(server->game);
+    for (int i = 0; i < NETPROTO_HISTORY; i++) {
+        if (!netproto_world_reserve(&server->history[i], state)) {
+            printf("Error: Could not reserve the snapshot history\n");
+            return false;
+        }
+    }
+    
+    size_t max_size = netproto_state_max_size(state);
+    if (max_size > server->snapshot_capacity) {
+        uint8_t* snapshot = (uint8_t*)mem_realloc(MEM_TAG_NET, server->snapshot, max_size);
+        if (!snapshot) {
+            printf("Error: Could not allocate %zu bytes for a snapshot\n", max_size);
+            return false;
+        }
+        server->snapshot = snapshot;
+        server->snapshot_capacity = max_size;
+    }
+    return true;
+}
+
+/**
+ * Send an encoded snapshot to a client, split into as many packets as it
+ * takes.
+ * @param server The server
+ * @param client The client
+ * @param baseline_tick Tick the snapshot is relative to (NETPROTO_NO_TICK = none)
+ * @param size Bytes of server->snapshot to send
+ * @return Bytes sent, headers included, or 0 if a packet could not be sent
+ */
+static size_t server_send_fragments(GameServer* server, ServerClient* client, int baseline_tick, size_t size) {
+    int count = netproto_fragment_count(size);
+    if (count == 0) {
+        printf("Error: Snapshot %d is %zu bytes, too big to send\n", server->tick, size);
+        return 0;
+    }
+    size_t sent = 0;
+    for (int i = 0; i < count; i++) {
+        size_t offset = (size_t)i * NETPROTO_FRAGMENT_SIZE;
+        NetSnapshotFragment fragment = {
+            server->tick, baseline_tick, i, count,
+            server->snapshot + offset, size - offset < NETPROTO_FRAGMENT_SIZE ? size - offset : NETPROTO_FRAGMENT_SIZE
+        };
+        size_t packet_size = netproto_write_fragment(&fragment, server->packet, sizeof(server->packet));
+        if (packet_size == 0 || !net_socket_send(server->socket, &client->address, server->packet, packet_size)) return 0;
+        sent += packet_size;
+    }
+    return sent;
+}
+
+/**
+ * Capture this tick's world and send each client a snapshot against the
+ * newest world it acknowledged, or a full one if that is too old.
+ * @param server The server
+ */
+static void server_send_snapshots(GameServer* server) {
+    NetWorldState* world = &server->history[server->tick % NETPROTO_HISTORY];
+    if (!netproto_capture(game_get_state(server->game), server->tick, world)) {
+        printf("Error: Could not capture tick %d\n", server->tick);
+        return;
+    }
+    world->selected_mode = (uint32_t)game_get_selected_mode(server->game) & 1u;
+    
+    // Sized for the largest map at init; grows only if a map outgrew it since
+    size_t max_size = netproto_snapshot_max_size(world);
+    if (max_size > server->snapshot_capacity) {
+        uint8_t* snapshot = (uint8_t*)mem_realloc(MEM_TAG_NET, server->snapshot, max_size);
+        if (!snapshot) {
+            printf("Error: Could not allocate %zu bytes for a snapshot\n", max_size);
+            return;
+        }
+        server->snapshot = snapshot;
+        server->snapshot_capacity = max_size;
+    }
+    
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        ServerClient* client = &server->clients[i];
+        if (!client->connected) continue;
+        
+        const NetWorldState* baseline = NULL;
+        if (client->acked_tick != NETPROTO_NO_TICK && server->tick - client->acked_tick < NETPROTO_HISTORY) {
+            baseline = &server->history[client->acked_tick % NETPROTO_HISTORY];
+            if (baseline->tick != client->acked_tick) baseline = NULL;
+        }
+        
+        size_t size = netproto_write_snapshot(world, baseline, server->snapshot, server->snapshot_capacity);
+        size_t sent = size > 0 ? server_send_fragments(server, client, baseline ? baseline->tick : NETPROTO_NO_TICK, size) : 0;
+        if (sent == 0) continue;
+        client->bytes_sent += sent;
+        client->snapshots_sent++;
+        if (!baseline) client->full_snapshots++;
+    }
+}
+
+/**
+ * Forget clients that have not sent anything for a while.
+ * @param server The server
+ * @param now_ns Current time
+ */
+static void server_drop_idle_clients(GameServer* server, uint64_t now_ns) {
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        ServerClient* client = &server->clients[i];
+        if (!client->connected || now_ns - client->last_heard_ns < SERVER_CLIENT_TIMEOUT_NS) continue;
+        
+        char name[32];
+        net_address_to_string(&client->address, name, sizeof(name));
+        printf("Client %s timed out\n", name);
+        client->connected = false;
+    }
+}
+
+/**
+ * Print the tick cost and each client's traffic since the last report,
+ * then start a new report period.
+ * @param server The server
+ * @param now_ns Current time
+ */
+static void server_report(GameServer* server, uint64_t now_ns) {
+    double seconds = (double)(now_ns - server->report_ns) / 1e9;
+    if (server->report_ticks == 0 || seconds <= 0.0) return;
+    
+    int client_count = 0;
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        if (server->clients[i].connected) client_count++;
+    }
+    printf("Server: tick %d, %d client(s), tick cost %.3f ms avg, %.3f ms max\n",
+           server->tick, client_count, (double)server->tick_ns_total / server->report_ticks / 1e6,
+           (double)server->tick_ns_max / 1e6);
+    
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        ServerClient* client = &server->clients[i];
+        if (!client->connected) continue;
+        
+        char name[32];
+        net_address_to_string(&client->address, name, sizeof(name));
+        double average = client->snapshots_sent > 0 ? (double)client->bytes_sent / client->snapshots_sent : 0.0;
+        printf("  %s%s: out %.2f KB/s (%.0f B/snapshot, %d full), in %.2f KB/s, ack lag %d ticks\n",
+               name, client == server_find_player(server) ? " (player)" : "",
+               client->bytes_sent / 1024.0 / seconds, average, client->full_snapshots,
+               client->bytes_received / 1024.0 / seconds,
+               client->acked_tick == NETPROTO_NO_TICK ? 0 : server->tick - client->acked_tick);
+        client->bytes_sent = 0;
+        client->bytes_received = 0;
+        client->snapshots_sent = 0;
+        client->full_snapshots = 0;
+    }
+    
+    server->report_ns = now_ns;
+    server->tick_ns_total = 0;
+    server->tick_ns_max = 0;
+    server->report_ticks = 0;
+}
+
+/**
+ * Server init callback.
+ * @param data Server pointer
+ */
+static void server_init_callback(void* data) {
+    GameServer* server = (GameServer*)data;
+    if (server->callbacks.init) server->callbacks.init(server->game_data);
+    server_reserve(server);
+    server->report_ns = timer_now_ns();
+}
+
+/**
+ * Server update callback: receive input, run the game, send snapshots.
+ * The engine's own input is ignored.
+ * @param data Server pointer
+ * @param input Unused
+ * @param delta_time Tick length
+ */
+static void server_update_callback(void* data, const InputFrame* input, float delta_time) {
+    GameServer* server = (GameServer*)data;
+    (void)input;
+    uint64_t start_ns = timer_now_ns();
+    
+    PROFILE_BEGIN("server_receive");
+    server_receive(server, start_ns);
+    PROFILE_END();
+    
+    ServerClient* player = server_find_player(server);
+    InputFrame idle;
+    input_clear(&idle);
+    if (server->callbacks.update) {
+        server->callbacks.update(server->game_data, player ? &player->input : &idle, delta_time);
+    }
+    for (int i = 0; i < SERVER_MAX_CLIENTS; i++) {
+        input_consume(&server->clients[i].input);
+    }
+    
+    PROFILE_BEGIN("server_send");
+    server_send_snapshots(server);
+    PROFILE_END();
+    server->tick++;
+    
+    uint64_t now_ns = timer_now_ns();
+    server_drop_idle_clients(server, now_ns);
+    uint64_t tick_ns = now_ns - start_ns;
+    server->tick_ns_total += tick_ns;
+    if (tick_ns > server->tick_ns_max) server->tick_ns_max = tick_ns;
+    server->report_ticks++;
+    if (now_ns - server->report_ns >= SERVER_REPORT_INTERVAL_NS) {
+        server_report(server, now_ns);
+    }
+}
+
+/**
+ * Server cleanup callback: print the last report, then clean up the game.
+ * @param data Server pointer
+ */
+static void server_cleanup_callback(void* data) {
+    GameServer* server = (GameServer*)data;
+    server_report(server, timer_now_ns());
+    if (server->callbacks.cleanup) server->callbacks.cleanup(server->game_data);
+}
+
+/**
+ * Server publish callback.
+ * @param data Server pointer
+ */
+static void server_publish_callback(void* data) {
+    GameServer* server = (GameServer*)data;
+    if (server->callbacks.publish) server->callbacks.publish(server->game_data);
+}
+
+/**
+ * Server render callback.
+ * @param data Server pointer
+ */
+static void server_render_callback(void* data) {
+    GameServer* server = (GameServer*)data;
+    if (server->callbacks.render) server->callbacks.render(server->game_data);
+}
+
+GameCallbacks server_get_callbacks(GameServer* server) {
+    GameCallbacks callbacks = {0};
+    if (server) {
+        callbacks.init = server_init_callback;
+        callbacks.update = server_update_callback;
+        callbacks.render = server_render_callback;
+        callbacks.cleanup = server_cleanup_callback;
+        callbacks.publish = server_publish_callback;
+    }
+    return callbacks;
+}
+
+void* server_get_data(GameServer* server) {
+    return server;
+}
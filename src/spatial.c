@@ -0,0 +1,150 @@
+#include "../include/spatial.h"
+#include <math.h>
+#include <string.h>
+
+#define SPATIAL_MAX_CELLS 4096  // Past this the cell size doubles; the table is rebuilt every tick
+#define SPATIAL_MIN_ENTITIES 32 // Below this everything shares one cell
+
+/**
+ * Get the column or row a coordinate falls in, clamped to the grid.
+ * Entities are clamped the same way, so a clamped query still finds them.
+ * @param position X or Y coordinate
+ * @param origin The grid's origin on the same axis
+ * @param inverse_cell_size 1 / cell size
+ * @param cells Columns or rows in the grid
+ * @return Column or row index
+ */
+static int spatial_cell(float position, float origin, float inverse_cell_size, int cells) {
+    float cell = (position - origin) * inverse_cell_size;
+    if (!(cell >= 0.0f)) return 0;
+    if (cell >= (float)cells) return cells - 1;
+    return (int)cell;
+}
+
+/**
+ * Lay out the cells for a number of entities, without any arrays.
+ * @param bounds Area the cells cover
+ * @param cell_size Requested edge length of a cell
+ * @param count Number of entities
+ * @return The hash's layout, with no cell table or index
+ */
+static SpatialHash spatial_layout(Rectangle bounds, float cell_size, int count) {
+    // A few entities take less time to test than to bucket, so they go in
+    // one cell covering the bounds and every query returns all of them
+    if (count < SPATIAL_MIN_ENTITIES) {
+        cell_size = fmaxf(cell_size, fmaxf(bounds.width, bounds.height));
+    }
+    float columns = ceilf(bounds.width / cell_size);
+    float rows = ceilf(bounds.height / cell_size);
+    while (columns * rows > SPATIAL_MAX_CELLS) {
+        cell_size *= 2.0f;
+        columns = ceilf(bounds.width / cell_size);
+        rows = ceilf(bounds.height / cell_size);
+    }
+    
+    return (SpatialHash){
+        .origin_x = bounds.x,
+        .origin_y = bounds.y,
+        .cell_size = cell_size,
+        .inverse_cell_size = 1.0f / cell_size,
+        .columns = columns > 1.0f ? (int)columns : 1,
+        .rows = rows > 1.0f ? (int)rows : 1,
+        .count = count
+    };
+}
+
+size_t spatial_hash_scratch_bytes(Rectangle bounds, float cell_size, int count) {
+    if (!(cell_size > 0.0f) || count < 0) return 0;
+    
+    // The three arrays spatial_hash_build() takes, each padded to the arena's alignment
+    SpatialHash layout = spatial_layout(bounds, cell_size, count);
+    size_t entities = (size_t)(count > 0 ? count : 1);
+    return sizeof(int32_t) * ((size_t)layout.columns * (size_t)layout.rows + 1 + 2 * entities) +
+           3 * ARENA_ALIGNMENT;
+}
+
+bool spatial_hash_build(SpatialHash* hash, Arena* arena, Rectangle bounds, float cell_size,
+                        const float* x, const float* y, size_t stride, int count) {
+    if (!hash) return false;
+    memset(hash, 0, sizeof(SpatialHash));
+    if (!arena || !(cell_size > 0.0f) || count < 0 || (count > 0 && (!x || !y))) return false;
+    
+    SpatialHash built = spatial_layout(bounds, cell_size, count);
+    int cell_count = built.columns * built.rows;
+    int32_t* cell_start = (int32_t*)arena_calloc(arena, (size_t)cell_count + 1, sizeof(int32_t));
+    int32_t* index = (int32_t*)arena_alloc(arena, sizeof(int32_t) * (size_t)(count > 0 ? count : 1));
+    int32_t* entity_cell = (int32_t*)arena_alloc(arena, sizeof(int32_t) * (size_t)(count > 0 ? count : 1));
+    if (!cell_start || !index || !entity_cell) return false;
+    
+    // Count the entities of each cell, one slot ahead, then sum into offsets
+    const char* x_bytes = (const char*)x;
+    const char* y_bytes = (const char*)y;
+    for (int i = 0; i < count; i++) {
+        float entity_x = *(const float*)(x_bytes + (size_t)i * stride);
+        float entity_y = *(const float*)(y_bytes + (size_t)i * stride);
+        int column = spatial_cell(entity_x, built.origin_x, built.inverse_cell_size, built.columns);
+        int row = spatial_cell(entity_y, built.origin_y, built.inverse_cell_size, built.rows);
+        entity_cell[i] = row * built.columns + column;
+        cell_start[entity_cell[i] + 1]++;
+    }
+    for (int cell = 0; cell < cell_count; cell++) {
+        cell_start[cell + 1] += cell_start[cell];
+    }
+    
+    // Fill using each cell's offset as its cursor, which leaves it at the
+    // next cell's start; shifting the offsets up by one restores them.
+    // Within a cell the entities stay in index order.
+    for (int i = 0; i < count; i++) {
+        index[cell_start[entity_cell[i]]++] = i;
+    }
+    memmove(cell_start + 1, cell_start, sizeof(int32_t) * (size_t)cell_count);
+    cell_start[0] = 0;
+    
+    built.cell_start = cell_start;
+    built.index = index;
+    *hash = built;
+    return true;
+}
+
+void spatial_query_box(const SpatialHash* hash, float left, float top, float right, float bottom, SpatialQuery* query) {
+    if (!query) return;
+    if (!hash || !hash->cell_start || hash->count == 0) {
+        // An empty range; spatial_query_next() returns false straight away
+        *query = (SpatialQuery){hash, 0, -1, 1, 0};
+        return;
+    }
+    
+    query->hash = hash;
+    if (hash->columns == 1 && hash->rows == 1) {
+        *query = (SpatialQuery){hash, 0, 0, 0, 0};
+        return;
+    }
+    query->first_column = spatial_cell(left, hash->origin_x, hash->inverse_cell_size, hash->columns);
+    query->last_column = spatial_cell(right, hash->origin_x, hash->inverse_cell_size, hash->columns);
+    query->row = spatial_cell(top, hash->origin_y, hash->inverse_cell_size, hash->rows);
+    query->last_row = spatial_cell(bottom, hash->origin_y, hash->inverse_cell_size, hash->rows);
+}
+
+void spatial_query_radius(const SpatialHash* hash, Vector2 center, float radius, SpatialQuery* query) {
+    spatial_query_box(hash, center.x - radius, center.y - radius, center.x + radius, center.y + radius, query);
+}
+
+bool spatial_query_next(SpatialQuery* query, SpatialSpan* span) {
+    if (!query || !span) return false;
+    
+    // The cells of one row sit next to each other in the index, so a row
+    // of the query is one span; rows with nothing in them are skipped
+    while (query->row <= query->last_row && query->first_column <= query->last_column) {
+        const SpatialHash* hash = query->hash;
+        int row_cell = query->row * hash->columns;
+        int32_t begin = hash->cell_start[row_cell + query->first_column];
+        int32_t end = hash->cell_start[row_cell + query->last_column + 1];
+        query->row++;
+        if (end > begin) {
+            span->index = hash->index + begin;
+            span->count = end - begin;
+            return true;
+        }
+    }
+    return false;
+}
@@ -3,10 +3,14 @@
 #include "../include/player.h"
 #include "../include/highscore.h"
 #include "../include/projectile.h"
+#include "../include/mem.h"
+#include <stddef.h>
 #include <stdio.h>
 #include <stdlib.h>
 #include <string.h>
 
+#define STATE_SNAPSHOT_MAGIC 0x50414E53u  // "SNAP" in little-endian byte order
+
 struct GameState {
     bool running;
     int frame_count;
@@ -22,16 +26,51 @@ struct GameState {
     char player_name[MAX_NAME_LENGTH + 1];
     int name_char_count;
     HighScore pending_score;
-    Projectile* projectiles[MAX_PROJECTILES];
-    int projectile_count;
-    int projectile_cooldown;
+    ProjectilePool projectiles;
+    float projectile_cooldown;  // Seconds until the next shot
     GameMode game_mode;
+    uint64_t seed;
+    Rng rng;  // All gameplay randomness comes from here
 };
 
+/**
+ * Fixed part of a snapshot. Every GameState field except the maps and the
+ * heap objects; each map's changing parts follow it as map_snapshot()
+ * writes them, then the projectile pool's arrays as
+ * projectile_pool_snapshot() writes them.
+ */
+typedef struct {
+    uint32_t magic;
+    uint32_t version;
+    uint32_t size;             // Whole snapshot in bytes
+    uint32_t header_size;      // Sizes of the records, to catch layout changes
+    uint32_t projectile_size;  // without a version bump
+    uint32_t maps_size;        // All map snapshots together
+    int32_t running;
+    int32_t frame_count;
+    int32_t game_start_frame;
+    int32_t current_map_id;
+    int32_t coins_collected;
+    int32_t total_coins;
+    int32_t state;
+    int32_t game_mode;
+    int32_t high_score_count;
+    int32_t name_char_count;
+    int32_t projectile_count;
+    float projectile_cooldown;
+    uint64_t seed;
+    Rng rng;
+    PlayerSnapshot player;
+    HighScore pending_score;
+    HighScore high_scores[MAX_HIGH_SCORES];
+    char player_name[MAX_NAME_LENGTH + 1];
+} StateSnapshotHeader;
+
 GameState* state_create(void) {
-    GameState* state = (GameState*)malloc(sizeof(GameState));
+    GameState* state = (GameState*)mem_alloc(MEM_TAG_STATE, sizeof(GameState));
     if (!state) return NULL;
     memset(state, 0, sizeof(GameState));
+    projectile_pool_init(&state->projectiles);
     return state;
 }
 
@@ -40,13 +79,10 @@ void state_destroy(GameState* state) {
     if (state->player) {
         player_destroy(state->player);
     }
-    // Clean up all projectiles
-    for (int i = 0; i < state->projectile_count; i++) {
-        if (state->projectiles[i]) {
-            projectile_destroy(state->projectiles[i]);
-        }
+    for (int i = 0; i < NUM_MAPS; i++) {
+        map_release(&state->maps[i]);
     }
-    free(state);
+    mem_free(state);
 }
 
 void state_init(GameState* state) {
@@ -62,10 +98,10 @@ void state_init(GameState* state) {
     memset(state->player_name, 0, sizeof(state->player_name));
     state->name_char_count = 0;
     memset(&state->pending_score, 0, sizeof(state->pending_score));
-    state->projectile_count = 0;
-    memset(state->projectiles, 0, sizeof(state->projectiles));
-    state->projectile_cooldown = 0;
+    projectile_pool_clear(&state->projectiles);
+    state->projectile_cooldown = 0.0f;
     state->game_mode = GAME_MODE_2D;
+    rng_seed(&state->rng, state->seed);
     
     state->player = player_create();
     if (!state->player) {
@@ -73,8 +109,6 @@ void state_init(GameState* state) {
         return;
     }
     
-    highscore_load(state->high_scores, &state->high_score_count);
-    
     for (int i = 0; i < NUM_MAPS; i++) {
         map_init(&state->maps[i], i);
     }
@@ -88,7 +122,6 @@ void state_init(GameState* state) {
     player_init(state->player, start_pos);
     
     printf("Game initialized! Total coins: %d\n", state->total_coins);
-    printf("High scores loaded: %d\n", state->high_score_count);
 }
 
 void state_reset(GameState* state) {
@@ -268,64 +301,35 @@ void state_reset_coins(GameState* state) {
     }
 }
 
-bool state_add_projectile(GameState* state, Projectile* projectile) {
-    if (!state || !projectile) return false;
-    if (state->projectile_count >= MAX_PROJECTILES) return false;
-    
-    state->projectiles[state->projectile_count++] = projectile;
-    return true;
-}
-
-Projectile** state_get_projectiles(GameState* state, int* count) {
-    if (!state) {
-        if (count) *count = 0;
-        return NULL;
-    }
-    if (count) *count = state->projectile_count;
-    return state->projectiles;
+ProjectileHandle state_spawn_projectile(GameState* state, Vector2 position, Vector2 direction) {
+    if (!state) return PROJECTILE_HANDLE_NONE;
+    return projectile_pool_spawn(&state->projectiles, position, direction);
 }
 
-void state_remove_projectile(GameState* state, int index) {
-    if (!state || index < 0 || index >= state->projectile_count) return;
-    
-    if (state->projectiles[index]) {
-        projectile_destroy(state->projectiles[index]);
-    }
-    
-    // Shift remaining projectiles
-    for (int i = index; i < state->projectile_count - 1; i++) {
-        state->projectiles[i] = state->projectiles[i + 1];
-    }
-    state->projectile_count--;
-    state->projectiles[state->projectile_count] = NULL;
+ProjectilePool* state_get_projectiles(GameState* state) {
+    if (!state) return NULL;
+    return &state->projectiles;
 }
 
 void state_clear_projectiles(GameState* state) {
     if (!state) return;
-    
-    for (int i = 0; i < state->projectile_count; i++) {
-        if (state->projectiles[i]) {
-            projectile_destroy(state->projectiles[i]);
-            state->projectiles[i] = NULL;
-        }
-    }
-    state->projectile_count = 0;
+    projectile_pool_clear(&state->projectiles);
 }
 
-int state_get_projectile_cooldown(const GameState* state) {
-    if (!state) return 0;
+float state_get_projectile_cooldown(const GameState* state) {
+    if (!state) return 0.0f;
     return state->projectile_cooldown;
 }
 
-void state_set_projectile_cooldown(GameState* state, int cooldown) {
+void state_set_projectile_cooldown(GameState* state, float cooldown) {
     if (!state) return;
     state->projectile_cooldown = cooldown;
 }
 
-void state_decrement_projectile_cooldown(GameState* state) {
+void state_decrement_projectile_cooldown(GameState* state, float delta_time) {
     if (!state) return;
-    if (state->projectile_cooldown > 0) {
-        state->projectile_cooldown--;
+    if (state->projectile_cooldown > 0.0f) {
+        state->projectile_cooldown -= delta_time;
     }
 }
 
@@ -339,3 +343,147 @@ void state_set_game_mode(GameState* state, GameMode mode) {
     state->game_mode = mode;
 }
 
+
+void state_set_seed(GameState* state, uint64_t seed) {
+    if (!state) return;
+    state->seed = seed;
+    rng_seed(&state->rng, seed);
+}
+
+uint64_t state_get_seed(const GameState* state) {
+    if (!state) return 0;
+    return state->seed;
+}
+
+Rng* state_get_rng(GameState* state) {
+    if (!state) return NULL;
+    return &state->rng;
+}
+
+/**
+ * Get the size of every map's snapshot together.
+ * @param state The game state
+ * @return Size in bytes
+ */
+static size_t state_maps_snapshot_size(const GameState* state) {
+    size_t size = 0;
+    for (int i = 0; i < NUM_MAPS; i++) {
+        size += map_snapshot_size(&state->maps[i]);
+    }
+    return size;
+}
+
+size_t state_snapshot_size(const GameState* state) {
+    if (!state) return 0;
+    return sizeof(StateSnapshotHeader) + state_maps_snapshot_size(state) +
+           PROJECTILE_RECORD_SIZE * (size_t)state->projectiles.count;
+}
+
+size_t state_snapshot_max_size(const GameState* state) {
+    if (!state) return 0;
+    return sizeof(StateSnapshotHeader) + state_maps_snapshot_size(state) + PROJECTILE_RECORD_SIZE * MAX_PROJECTILES;
+}
+
+size_t state_snapshot(const GameState* state, void* buffer, size_t capacity) {
+    if (!state || !buffer) return 0;
+    size_t size = state_snapshot_size(state);
+    if (size > capacity) return 0;
+    
+    StateSnapshotHeader header;
+    memset(&header, 0, sizeof(header));
+    header.magic = STATE_SNAPSHOT_MAGIC;
+    header.version = STATE_SNAPSHOT_VERSION;
+    header.size = (uint32_t)size;
+    header.header_size = sizeof(StateSnapshotHeader);
+    header.projectile_size = PROJECTILE_RECORD_SIZE;
+    header.maps_size = (uint32_t)state_maps_snapshot_size(state);
+    header.running = state->running ? 1 : 0;
+    header.frame_count = state->frame_count;
+    header.game_start_frame = state->game_start_frame;
+    header.current_map_id = state->current_map_id;
+    header.coins_collected = state->coins_collected;
+    header.total_coins = state->total_coins;
+    header.state = (int32_t)state->state;
+    header.game_mode = (int32_t)state->game_mode;
+    header.high_score_count = state->high_score_count;
+    header.name_char_count = state->name_char_count;
+    header.projectile_count = state->projectiles.count;
+    header.projectile_cooldown = state->projectile_cooldown;
+    header.seed = state->seed;
+    header.rng = state->rng;
+    player_snapshot(state->player, &header.player);
+    header.pending_score = state->pending_score;
+    memcpy(header.high_scores, state->high_scores, sizeof(header.high_scores));
+    memcpy(header.player_name, state->player_name, sizeof(header.player_name));
+    
+    uint8_t* out = (uint8_t*)buffer;
+    memcpy(out, &header, sizeof(header));
+    out += sizeof(header);
+    for (int i = 0; i < NUM_MAPS; i++) {
+        out += map_snapshot(&state->maps[i], out);
+    }
+    projectile_pool_snapshot(&state->projectiles, out);
+    return size;
+}
+
+bool state_restore(GameState* state, const void* buffer, size_t size) {
+    if (!state || !buffer || !state->player || size < sizeof(StateSnapshotHeader)) return false;
+    
+    StateSnapshotHeader header;
+    memcpy(&header, buffer, sizeof(header));
+    if (header.magic != STATE_SNAPSHOT_MAGIC || header.version != STATE_SNAPSHOT_VERSION ||
+        header.header_size != sizeof(StateSnapshotHeader) || header.projectile_size != PROJECTILE_RECORD_SIZE ||
+        header.projectile_count < 0 || header.projectile_count > MAX_PROJECTILES ||
+        header.size != size || size != sizeof(header) + (size_t)header.maps_size +
+                                        PROJECTILE_RECORD_SIZE * (size_t)header.projectile_count ||
+        header.current_map_id < 0 || header.current_map_id >= NUM_MAPS ||
+        header.high_score_count < 0 || header.high_score_count > MAX_HIGH_SCORES ||
+        header.name_char_count < 0 || header.name_char_count > MAX_NAME_LENGTH) {
+        return false;
+    }
+    
+    // Every map must fit before any of them changes
+    const uint8_t* maps = (const uint8_t*)buffer + sizeof(header);
+    size_t map_sizes[NUM_MAPS];
+    size_t offset = 0;
+    for (int i = 0; i < NUM_MAPS; i++) {
+        map_sizes[i] = map_check_snapshot(&state->maps[i], maps + offset, header.maps_size - offset);
+        if (map_sizes[i] == 0) return false;
+        offset += map_sizes[i];
+    }
+    if (offset != header.maps_size) return false;
+    
+    // Growing a map's obstacle storage keeps its contents, so a failure
+    // here still leaves the state as it was
+    offset = 0;
+    for (int i = 0; i < NUM_MAPS; i++) {
+        if (!map_reserve_snapshot(&state->maps[i], maps + offset)) return false;
+        offset += map_sizes[i];
+    }
+    
+    state->running = header.running != 0;
+    state->frame_count = header.frame_count;
+    state->game_start_frame = header.game_start_frame;
+    state->current_map_id = header.current_map_id;
+    state->coins_collected = header.coins_collected;
+    state->total_coins = header.total_coins;
+    state->state = (GameStateType)header.state;
+    state->game_mode = (GameMode)header.game_mode;
+    state->high_score_count = header.high_score_count;
+    state->name_char_count = header.name_char_count;
+    state->projectile_cooldown = header.projectile_cooldown;
+    state->seed = header.seed;
+    state->rng = header.rng;
+    player_restore(state->player, &header.player);
+    state->pending_score = header.pending_score;
+    memcpy(state->high_scores, header.high_scores, sizeof(state->high_scores));
+    memcpy(state->player_name, header.player_name, sizeof(state->player_name));
+    
+    const uint8_t* in = maps;
+    for (int i = 0; i < NUM_MAPS; i++) {
+        map_restore(&state->maps[i], in);
+        in += map_sizes[i];
+    }
+    projectile_pool_restore(&state->projectiles, in, header.projectile_count);
+    return true;
+}
@@ -0,0 +1,218 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 200809L
+#endif
+
+#include "../include/thread.h"
+#include "../include/mem.h"
+#include <stdlib.h>
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#include <process.h>
+#else
+#include <pthread.h>
+#include <sched.h>
+#include <unistd.h>
+#endif
+
+struct Thread {
+#if defined(_WIN32)
+    HANDLE handle;
+#else
+    pthread_t handle;
+#endif
+    ThreadFunction function;
+    void* user_data;
+};
+
+struct ThreadMutex {
+#if defined(_WIN32)
+    CRITICAL_SECTION handle;
+#else
+    pthread_mutex_t handle;
+#endif
+};
+
+struct ThreadCond {
+#if defined(_WIN32)
+    CONDITION_VARIABLE handle;
+#else
+    pthread_cond_t handle;
+#endif
+};
+
+#if defined(_WIN32)
+static unsigned __stdcall thread_entry(void* arg) {
+    Thread* thread = (Thread*)arg;
+    thread->function(thread->user_data);
+    return 0;
+}
+#else
+static void* thread_entry(void* arg) {
+    Thread* thread = (Thread*)arg;
+    thread->function(thread->user_data);
+    return NULL;
+}
+#endif
+
+Thread* thread_create(ThreadFunction function, void* user_data) {
+    if (!function) return NULL;
+    
+    Thread* thread = (Thread*)mem_alloc(MEM_TAG_THREAD, sizeof(Thread));
+    if (!thread) return NULL;
+    
+    thread->function = function;
+    thread->user_data = user_data;
+    
+#if defined(_WIN32)
+    thread->handle = (HANDLE)_beginthreadex(NULL, 0, thread_entry, thread, 0, NULL);
+    if (!thread->handle) {
+        mem_free(thread);
+        return NULL;
+    }
+#else
+    if (pthread_create(&thread->handle, NULL, thread_entry, thread) != 0) {
+        mem_free(thread);
+        return NULL;
+    }
+#endif
+    return thread;
+}
+
+void thread_join(Thread* thread) {
+    if (!thread) return;
+#if defined(_WIN32)
+    WaitForSingleObject(thread->handle, INFINITE);
+    CloseHandle(thread->handle);
+#else
+    pthread_join(thread->handle, NULL);
+#endif
+    mem_free(thread);
+}
+
+ThreadMutex* thread_mutex_create(void) {
+    ThreadMutex* mutex = (ThreadMutex*)mem_alloc(MEM_TAG_THREAD, sizeof(ThreadMutex));
+    if (!mutex) return NULL;
+#if defined(_WIN32)
+    InitializeCriticalSection(&mutex->handle);
+#else
+    if (pthread_mutex_init(&mutex->handle, NULL) != 0) {
+        mem_free(mutex);
+        return NULL;
+    }
+#endif
+    return mutex;
+}
+
+void thread_mutex_destroy(ThreadMutex* mutex) {
+    if (!mutex) return;
+#if defined(_WIN32)
+    DeleteCriticalSection(&mutex->handle);
+#else
+    pthread_mutex_destroy(&mutex->handle);
+#endif
+    mem_free(mutex);
+}
+
+void thread_mutex_lock(ThreadMutex* mutex) {
+    if (!mutex) return;
+#if defined(_WIN32)
+    EnterCriticalSection(&mutex->handle);
+#else
+    pthread_mutex_lock(&mutex->handle);
+#endif
+}
+
+void thread_mutex_unlock(ThreadMutex* mutex) {
+    if (!mutex) return;
+#if defined(_WIN32)
+    LeaveCriticalSection(&mutex->handle);
+#else
+    pthread_mutex_unlock(&mutex->handle);
+#endif
+}
+
+ThreadCond* thread_cond_create(void) {
+    ThreadCond* cond = (ThreadCond*)mem_alloc(MEM_TAG_THREAD, sizeof(ThreadCond));
+    if (!cond) return NULL;
+#if defined(_WIN32)
+    InitializeConditionVariable(&cond->handle);
+#else
+    if (pthread_cond_init(&cond->handle, NULL) != 0) {
+        mem_free(cond);
+        return NULL;
+    }
+#endif
+    return cond;
+}
+
+void thread_cond_destroy(ThreadCond* cond) {
+    if (!cond) return;
+#if !defined(_WIN32)
+    pthread_cond_destroy(&cond->handle);
+#endif
+    mem_free(cond);
+}
+
+void thread_cond_wait(ThreadCond* cond, ThreadMutex* mutex) {
+    if (!cond || !mutex) return;
+#if defined(_WIN32)
+    SleepConditionVariableCS(&cond->handle, &mutex->handle, INFINITE);
+#else
+    pthread_cond_wait(&cond->handle, &mutex->handle);
+#endif
+}
+
+void thread_cond_signal(ThreadCond* cond) {
+    if (!cond) return;
+#if defined(_WIN32)
+    WakeConditionVariable(&cond->handle);
+#else
+    pthread_cond_signal(&cond->handle);
+#endif
+}
+
+void thread_cond_broadcast(ThreadCond* cond) {
+    if (!cond) return;
+#if defined(_WIN32)
+    WakeAllConditionVariable(&cond->handle);
+#else
+    pthread_cond_broadcast(&cond->handle);
+#endif
+}
+
+int thread_get_cpu_count(void) {
+#if defined(_WIN32)
+    SYSTEM_INFO info;
+    GetSystemInfo(&info);
+    int count = (int)info.dwNumberOfProcessors;
+#else
+    int count = (int)sysconf(_SC_NPROCESSORS_ONLN);
+#endif
+    return count > 0 ? count : 1;
+}
+
+void thread_yield(void) {
+#if defined(_WIN32)
+    SwitchToThread();
+#else
+    sched_yield();
+#endif
+}
+
+int thread_atomic_add(volatile int* value, int delta) {
+#if defined(_MSC_VER)
+    return (int)InterlockedExchangeAdd((volatile LONG*)value, delta) + delta;
+#else
+    return __atomic_add_fetch(value, delta, __ATOMIC_ACQ_REL);
+#endif
+}
+
+int thread_atomic_load(volatile int* value) {
+#if defined(_MSC_VER)
+    return (int)InterlockedCompareExchange((volatile LONG*)value, 0, 0);
+#else
+    return __atomic_load_n(value, __ATOMIC_ACQUIRE);
+#endif
+}
@@ -0,0 +1,43 @@
+#if !defined(_WIN32)
+#define _POSIX_C_SOURCE 199309L
+#endif
+
+#include "../include/timer.h"
+
+#if defined(_WIN32)
+#define WIN32_LEAN_AND_MEAN
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+uint64_t timer_now_ns(void) {
+#if defined(_WIN32)
+    static LARGE_INTEGER frequency = {0};
+    LARGE_INTEGER counter;
+    if (frequency.QuadPart == 0) {
+        QueryPerformanceFrequency(&frequency);
+    }
+    QueryPerformanceCounter(&counter);
+    // Split to avoid overflowing the multiplication on long uptimes
+    uint64_t seconds = (uint64_t)(counter.QuadPart / frequency.QuadPart);
+    uint64_t remainder = (uint64_t)(counter.QuadPart % frequency.QuadPart);
+    return seconds * 1000000000ull + (remainder * 1000000000ull) / (uint64_t)frequency.QuadPart;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ull + (uint64_t)ts.tv_nsec;
+#endif
+}
+
+void timer_sleep_ns(uint64_t duration_ns) {
+    if (duration_ns == 0) return;
+#if defined(_WIN32)
+    Sleep((DWORD)((duration_ns + 999999ull) / 1000000ull));
+#else
+    struct timespec ts;
+    ts.tv_sec = (time_t)(duration_ns / 1000000000ull);
+    ts.tv_nsec = (long)(duration_ns % 1000000000ull);
+    nanosleep(&ts, NULL);
+#endif
+}
@@ -0,0 +1,266 @@
+#include "../include/trace.h"
+#include "../include/thread.h"
+#include "../include/timer.h"
+#include "../include/mem.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#if defined(_MSC_VER)
+#define TRACE_THREAD_LOCAL __declspec(thread)
+#else
+#define TRACE_THREAD_LOCAL _Thread_local
+#endif
+
+typedef enum {
+    TRACE_EVENT_COMPLETE,
+    TRACE_EVENT_COUNTER,
+    TRACE_EVENT_THREAD_NAME
+} TraceEventType;
+
+typedef struct {
+    TraceEventType type;
+    const char* name;
+    uint64_t timestamp_ns;
+    uint64_t duration_ns;
+    double value;
+    int thread_id;
+} TraceEvent;
+
+static struct {
+    bool enabled;
+    const char* path;
+    FILE* file;
+    char* file_buffer;
+    uint64_t start_ns;
+    
+    Thread* writer;
+    ThreadMutex* mutex;
+    ThreadCond* wake;
+    bool stopping;
+    
+    TraceEvent* ring;
+    TraceEvent* batch;  // Writer-owned copy of the events being formatted
+    int head;
+    int count;
+    int next_thread_id;
+    unsigned long written;
+    unsigned long dropped;
+} g_trace;
+
+static TRACE_THREAD_LOCAL int g_trace_thread_id = 0;
+
+/**
+ * Write a JSON string, escaping quotes and backslashes.
+ * @param file Output file
+ * @param text String to write
+ */
+static void trace_write_string(FILE* file, const char* text) {
+    fputc('"', file);
+    for (const char* c = text; *c; c++) {
+        if (*c == '"' || *c == '\\') fputc('\\', file);
+        fputc(*c, file);
+    }
+    fputc('"', file);
+}
+
+/**
+ * Format one event as a trace-event JSON object.
+ * @param file Output file
+ * @param event The event
+ */
+static void trace_write_event(FILE* file, const TraceEvent* event) {
+    uint64_t since_start = (event->timestamp_ns > g_trace.start_ns) ? event->timestamp_ns - g_trace.start_ns : 0;
+    double ts_us = (double)since_start / 1000.0;
+    
+    fputs(g_trace.written > 0 ? ",\n{\"name\":" : "{\"name\":", file);
+    trace_write_string(file, event->type == TRACE_EVENT_THREAD_NAME ? "thread_name" : event->name);
+    
+    switch (event->type) {
+        case TRACE_EVENT_COMPLETE:
+            fprintf(file, ",\"cat\":\"engine\",\"ph\":\"X\",\"ts\":%.3f,\"dur\":%.3f,\"pid\":1,\"tid\":%d}",
+                    ts_us, (double)event->duration_ns / 1000.0, event->thread_id);
+            break;
+        case TRACE_EVENT_COUNTER:
+            fprintf(file, ",\"ph\":\"C\",\"ts\":%.3f,\"pid\":1,\"tid\":%d,\"args\":{\"value\":%g}}",
+                    ts_us, event->thread_id, event->value);
+            break;
+        case TRACE_EVENT_THREAD_NAME:
+            fprintf(file, ",\"ph\":\"M\",\"pid\":1,\"tid\":%d,\"args\":{\"name\":", event->thread_id);
+            trace_write_string(file, event->name);
+            fputs("}}", file);
+            break;
+    }
+    g_trace.written++;
+}
+
+/**
+ * Writer thread entry point. Drains the ring in batches and formats the
+ * events outside the lock.
+ * @param user_data Unused
+ */
+static void trace_writer_main(void* user_data) {
+    (void)user_data;
+    
+    thread_mutex_lock(g_trace.mutex);
+    while (true) {
+        while (g_trace.count == 0 && !g_trace.stopping) {
+            thread_cond_wait(g_trace.wake, g_trace.mutex);
+        }
+        if (g_trace.count == 0) {
+            break;
+        }
+        
+        int batch_count = g_trace.count;
+        for (int i = 0; i < batch_count; i++) {
+            g_trace.batch[i] = g_trace.ring[(g_trace.head + i) % TRACE_RING_CAPACITY];
+        }
+        g_trace.head = (g_trace.head + batch_count) % TRACE_RING_CAPACITY;
+        g_trace.count = 0;
+        thread_mutex_unlock(g_trace.mutex);
+        
+        for (int i = 0; i < batch_count; i++) {
+            trace_write_event(g_trace.file, &g_trace.batch[i]);
+        }
+        
+        thread_mutex_lock(g_trace.mutex);
+    }
+    thread_mutex_unlock(g_trace.mutex);
+}
+
+/**
+ * Get the trace id of the calling thread, assigning one on first use.
+ * Must be called with the trace mutex held.
+ * @return Thread id
+ */
+static int trace_thread_id_locked(void) {
+    if (g_trace_thread_id == 0) {
+        g_trace_thread_id = ++g_trace.next_thread_id;
+    }
+    return g_trace_thread_id;
+}
+
+/**
+ * Queue an event for the writer thread.
+ * @param event The event (thread id is filled in here)
+ */
+static void trace_push(TraceEvent event) {
+    thread_mutex_lock(g_trace.mutex);
+    event.thread_id = trace_thread_id_locked();
+    if (g_trace.count < TRACE_RING_CAPACITY) {
+        g_trace.ring[(g_trace.head + g_trace.count) % TRACE_RING_CAPACITY] = event;
+        g_trace.count++;
+        if (g_trace.count == TRACE_RING_CAPACITY / 2) {
+            thread_cond_signal(g_trace.wake);
+        }
+    } else {
+        g_trace.dropped++;
+    }
+    thread_mutex_unlock(g_trace.mutex);
+}
+
+/**
+ * Release everything trace_start allocated.
+ */
+static void trace_release(void) {
+    if (g_trace.file) fclose(g_trace.file);
+    if (g_trace.wake) thread_cond_destroy(g_trace.wake);
+    if (g_trace.mutex) thread_mutex_destroy(g_trace.mutex);
+    mem_free(g_trace.file_buffer);
+    mem_free(g_trace.batch);
+    mem_free(g_trace.ring);
+    memset(&g_trace, 0, sizeof(g_trace));
+}
+
+bool trace_start(const char* path) {
+    if (!path || g_trace.enabled) return false;
+    
+    memset(&g_trace, 0, sizeof(g_trace));
+    g_trace.path = path;
+    g_trace.file = fopen(path, "w");
+    if (!g_trace.file) {
+        printf("Error: Could not open trace file %s\n", path);
+        return false;
+    }
+    
+    g_trace.file_buffer = (char*)mem_alloc(MEM_TAG_TRACE, TRACE_FILE_BUFFER_SIZE);
+    g_trace.ring = (TraceEvent*)mem_alloc(MEM_TAG_TRACE, sizeof(TraceEvent) * TRACE_RING_CAPACITY);
+    g_trace.batch = (TraceEvent*)mem_alloc(MEM_TAG_TRACE, sizeof(TraceEvent) * TRACE_RING_CAPACITY);
+    g_trace.mutex = thread_mutex_create();
+    g_trace.wake = thread_cond_create();
+    if (!g_trace.file_buffer || !g_trace.ring || !g_trace.batch || !g_trace.mutex || !g_trace.wake) {
+        printf("Error: Could not allocate trace buffers\n");
+        trace_release();
+        return false;
+    }
+    setvbuf(g_trace.file, g_trace.file_buffer, _IOFBF, TRACE_FILE_BUFFER_SIZE);
+    fputs("[\n", g_trace.file);
+    
+    g_trace.start_ns = timer_now_ns();
+    g_trace.writer = thread_create(trace_writer_main, NULL);
+    if (!g_trace.writer) {
+        printf("Error: Could not start trace writer thread\n");
+        trace_release();
+        return false;
+    }
+    
+    g_trace_thread_id = 0;
+    g_trace.enabled = true;
+    return true;
+}
+
+void trace_stop(void) {
+    if (!g_trace.enabled) return;
+    
+    thread_mutex_lock(g_trace.mutex);
+    g_trace.enabled = false;
+    g_trace.stopping = true;
+    thread_cond_signal(g_trace.wake);
+    thread_mutex_unlock(g_trace.mutex);
+    thread_join(g_trace.writer);
+    
+    fputs("\n]\n", g_trace.file);
+    printf("Trace: %lu events written to %s", g_trace.written, g_trace.path);
+    if (g_trace.dropped > 0) {
+        printf(" (%lu dropped)", g_trace.dropped);
+    }
+    printf("\n");
+    
+    trace_release();
+}
+
+bool trace_is_enabled(void) {
+    return g_trace.enabled;
+}
+
+void trace_flush(void) {
+    if (!g_trace.enabled) return;
+    
+    thread_mutex_lock(g_trace.mutex);
+    if (g_trace.count > 0) {
+        thread_cond_signal(g_trace.wake);
+    }
+    thread_mutex_unlock(g_trace.mutex);
+}
+
+void trace_set_thread_name(const char* name) {
+    if (!g_trace.enabled || !name) return;
+    
+    TraceEvent event = {TRACE_EVENT_THREAD_NAME, name, 0, 0, 0.0, 0};
+    event.timestamp_ns = g_trace.start_ns;
+    trace_push(event);
+}
+
+void trace_complete(const char* name, uint64_t start_ns, uint64_t duration_ns) {
+    if (!g_trace.enabled || !name) return;
+    
+    TraceEvent event = {TRACE_EVENT_COMPLETE, name, start_ns, duration_ns, 0.0, 0};
+    trace_push(event);
+}
+
+void trace_counter(const char* name, double value) {
+    if (!g_trace.enabled || !name) return;
+    
+    TraceEvent event = {TRACE_EVENT_COUNTER, name, timer_now_ns(), 0, value, 0};
+    trace_push(event);
+}